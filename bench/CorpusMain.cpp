@@ -0,0 +1,61 @@
+// dds_corpus: writes the synthetic benchmark corpus to disk, e.g. to load it with other tools or to
+// keep a fixed corpus around between releases
+//
+//   dds_corpus <directory> [--min-size=16] [--max-size=16384] [--max-mb=1024]
+
+#include <charconv>
+#include <cstdio>
+#include <numeric>
+#include <string_view>
+
+#include "SyntheticDds.h"
+
+namespace
+{
+  bool ParseValue(const std::string_view t_argument, const std::string_view t_name, uint64_t& t_value) {
+    if (!t_argument.starts_with(t_name)) {
+      return false;
+    }
+    const std::string_view value = t_argument.substr(t_name.size());
+    return std::from_chars(value.data(), value.data() + value.size(), t_value).ec == std::errc{};
+  }
+}
+
+int main(const int t_argc, char** t_argv) {
+  const char* directory = nullptr;
+  uint64_t    minSize   = 16;
+  uint64_t    maxSize   = 16384;
+  uint64_t    maxMb     = 1024;
+
+  for (int i = 1; i < t_argc; ++i) {
+    const std::string_view argument = t_argv[i];
+    if (ParseValue(argument, "--min-size=", minSize) || ParseValue(argument, "--max-size=", maxSize) ||
+        ParseValue(argument, "--max-mb=", maxMb)) {
+      continue;
+    }
+    if (argument.starts_with("--") || directory) {
+      std::fprintf(stderr, "Unknown argument: %s\n", t_argv[i]);
+      return 1;
+    }
+    directory = t_argv[i];
+  }
+
+  if (!directory) {
+    std::fprintf(stderr, "Usage: %s <directory> [--min-size=16] [--max-size=16384] [--max-mb=1024]\n", t_argv[0]);
+    return 1;
+  }
+
+  const auto descs = Dds::Bench::CorpusDescs(static_cast<uint32_t>(minSize), static_cast<uint32_t>(maxSize), maxMb << 20);
+  const auto paths = Dds::Bench::WriteCorpus(directory, descs);
+  if (paths.size() != descs.size()) {
+    std::fprintf(stderr, "Failed to write the corpus to %s\n", directory);
+    return 1;
+  }
+
+  const size_t bytes = std::accumulate(descs.begin(), descs.end(), size_t{0}, [](const size_t t_sum, const auto& t_desc)
+  {
+    return t_sum + t_desc.PayloadSize();
+  });
+  std::printf("Wrote %zu files, %.1f MB of payload to %s\n", paths.size(), static_cast<double>(bytes) / 1e6, directory);
+  return 0;
+}
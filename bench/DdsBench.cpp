@@ -0,0 +1,304 @@
+// dds_bench: load, flip, probe, region and batch throughput over a synthetic corpus. Every benchmark reports
+// payload bytes/s (SI prefixes, M/s is MB/s) and textures/s next to the usual Google Benchmark
+// timings, so a run can be diffed against the previous release with benchmark's compare.py.
+//
+//   dds_bench [--dds_max_size=4096] [--dds_corpus=<dir>] [benchmark flags...]
+//
+// --dds_max_size caps the texture size (16 to 16384), --dds_corpus is where the on-disk corpus for
+// the file and batch benchmarks is written, a directory under the system temp path by default
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "dds/BatchLoader.h"
+#include "dds/DDSLoader.h"
+#include "dds/FlipKernels.h"
+
+namespace
+{
+  using Dds::Bench::Layout;
+  using Dds::Bench::TEXTURE_DESC;
+
+  constexpr uint32_t MIN_SIZE = 16;
+  // layouts and on-disk loads are measured at one size per format, large enough to leave the caches
+  constexpr uint32_t LAYOUT_SIZE = 1024;
+  // largest texture of the batch corpus, which holds every format and layout (about 100 MB at 256)
+  constexpr uint32_t BATCH_SIZE = 256;
+  // tile edge of the region loads, taken from the top right of a LAYOUT_SIZE file
+  constexpr uint32_t REGION_SIZE = 256;
+
+  struct CONFIG
+  {
+    uint32_t              maxSize = 4096;
+    std::filesystem::path corpusDirectory = std::filesystem::temp_directory_path() / "dds_bench_corpus";
+  };
+
+  // benchmarks of the same texture run back to back, so caching the last generated file is enough to
+  // avoid rebuilding it for every run without holding the whole corpus in memory
+  const std::vector<std::byte>& CachedFile(const TEXTURE_DESC& t_desc) {
+    static TEXTURE_DESC           cachedDesc{Dds::Format::Unknown};
+    static std::vector<std::byte> cachedFile;
+
+    if (cachedDesc.format != t_desc.format || cachedDesc.size != t_desc.size || cachedDesc.mipMaps != t_desc.mipMaps ||
+        cachedDesc.layout != t_desc.layout) {
+      cachedFile = Dds::Bench::MakeDds(t_desc);
+      cachedDesc = t_desc;
+    }
+    return cachedFile;
+  }
+
+  void SetThroughput(benchmark::State& t_state, const size_t t_bytes, const size_t t_textures) {
+    const auto iterations      = static_cast<double>(t_state.iterations());
+    t_state.counters["bytes"]    = benchmark::Counter(static_cast<double>(t_bytes) * iterations,
+                                                   benchmark::Counter::kIsRate,
+                                                   benchmark::Counter::kIs1000);
+    t_state.counters["textures"] = benchmark::Counter(static_cast<double>(t_textures) * iterations, benchmark::Counter::kIsRate);
+  }
+
+  void LoadMemory(benchmark::State& t_state, const TEXTURE_DESC t_desc, const Dds::LoadOptions t_options) {
+    const std::vector<std::byte>& file = CachedFile(t_desc);
+
+    for (auto _ : t_state) {
+      Dds::Result<LoadDds::DDS_FILE> ddsFile = LoadDds::TextureLoadDds(std::span<const std::byte>(file), t_options);
+      if (!ddsFile) {
+        t_state.SkipWithError(Dds::ErrorMessage(ddsFile.Status().error));
+        return;
+      }
+      benchmark::DoNotOptimize(ddsFile->data.data());
+    }
+    SetThroughput(t_state, t_desc.PayloadSize(), 1);
+  }
+
+  void LoadFile(benchmark::State& t_state, const std::string t_path, const size_t t_payloadSize, const Dds::LoadOptions t_options) {
+    for (auto _ : t_state) {
+      Dds::Result<LoadDds::DDS_FILE> ddsFile = LoadDds::TextureLoadDds(t_path.c_str(), t_options);
+      if (!ddsFile) {
+        t_state.SkipWithError(Dds::ErrorMessage(ddsFile.Status().error));
+        return;
+      }
+      benchmark::DoNotOptimize(ddsFile->data.data());
+    }
+    SetThroughput(t_state, t_payloadSize, 1);
+  }
+
+  // one tile out of the top level, the block rows a virtual texturing page request would read
+  void LoadRegion(benchmark::State& t_state, const std::string t_path, const LoadDds::REGION t_region, const Dds::LoadOptions t_options) {
+    size_t bytes = 0;
+    for (auto _ : t_state) {
+      Dds::Result<LoadDds::DDS_FILE> region = LoadDds::LoadRegion(t_path.c_str(), t_region, t_options);
+      if (!region) {
+        t_state.SkipWithError(Dds::ErrorMessage(region.Status().error));
+        return;
+      }
+      bytes = region->totalSizeBytes;
+      benchmark::DoNotOptimize(region->data.data());
+    }
+    SetThroughput(t_state, bytes, 1);
+  }
+
+  // the failure path: a file cut off inside its last mip level, rejected before any payload is touched.
+  // a bad archive pushes thousands of these through the loader, so a failure has to cost about a probe
+  void LoadCorrupt(benchmark::State& t_state) {
+    std::vector<std::byte> file = Dds::Bench::MakeDds({Dds::Format::BC7, 256});
+    file.pop_back();
+
+    for (auto _ : t_state) {
+      Dds::Result<LoadDds::DDS_FILE> ddsFile = LoadDds::TextureLoadDds(std::span<const std::byte>(file));
+      if (ddsFile) {
+        t_state.SkipWithError("Corrupt file loaded");
+        return;
+      }
+      benchmark::DoNotOptimize(ddsFile.Status());
+    }
+    SetThroughput(t_state, 0, 1);
+  }
+
+  // flips the top level in place the way LoadDds::FlipMips does
+  void Flip(benchmark::State& t_state, const TEXTURE_DESC t_desc) {
+    const Dds::FORMAT_INFO& info = Dds::GetFormatInfo(t_desc.format);
+
+    const std::vector<std::byte>& file = CachedFile(t_desc);
+    Dds::AlignedBuffer            surface(info.SurfaceSize(t_desc.size, t_desc.size), LoadDds::PAYLOAD_ALIGNMENT);
+    std::memcpy(surface.Data(), file.data() + file.size() - t_desc.PayloadSize(), surface.Size());
+
+    for (auto _ : t_state) {
+      Dds::FlipSurface(info, surface.Data(), surface.Data(), t_desc.size, t_desc.size);
+      benchmark::ClobberMemory();
+    }
+    SetThroughput(t_state, surface.Size(), 1);
+  }
+
+  // headers only, one per format probed round-robin so the parser's branches see a realistic mix
+  void ProbeMemory(benchmark::State& t_state, const std::vector<TEXTURE_DESC> t_descs) {
+    std::vector<std::vector<std::byte>> headers;
+    for (const TEXTURE_DESC& desc : t_descs) {
+      TEXTURE_DESC single = desc;
+      single.size         = MIN_SIZE;
+      std::vector<std::byte> file = Dds::Bench::MakeDds(single);
+      file.resize(std::min<size_t>(file.size(), 148)); // magic + DDS_HEADER + DDS_HEADER_DXT10
+      headers.push_back(std::move(file));
+    }
+
+    size_t next = 0;
+    for (auto _ : t_state) {
+      Dds::Result<LoadDds::DDS_INFO> info = LoadDds::ProbeDds(std::span<const std::byte>(headers[next]));
+      benchmark::DoNotOptimize(info->totalSizeBytes);
+      next = next + 1 == headers.size() ? 0 : next + 1;
+    }
+    SetThroughput(t_state, 0, 1);
+  }
+
+  void ProbeFile(benchmark::State& t_state, const std::vector<std::string> t_paths, const size_t t_payloadSize) {
+    for (auto _ : t_state) {
+      for (const std::string& path : t_paths) {
+        Dds::Result<LoadDds::DDS_INFO> info = LoadDds::ProbeDds(path.c_str());
+        benchmark::DoNotOptimize(info->totalSizeBytes);
+      }
+    }
+    // bytes/s here is payload described per second, not read
+    SetThroughput(t_state, t_payloadSize, t_paths.size());
+  }
+
+  void BatchLoad(benchmark::State& t_state, const std::vector<std::string> t_paths, const size_t t_payloadSize) {
+    Dds::BatchLoader loader(static_cast<size_t>(t_state.range(0)));
+
+    for (auto _ : t_state) {
+      std::vector<std::future<Dds::BatchLoader::RESULT>> results = loader.Load(t_paths);
+      for (std::future<Dds::BatchLoader::RESULT>& result : results) {
+        if (!result.get().Ok()) {
+          t_state.SkipWithError("Load failed");
+        }
+      }
+    }
+    SetThroughput(t_state, t_payloadSize, t_paths.size());
+  }
+
+  bool ParseArguments(int& t_argc, char** t_argv, CONFIG& t_config) {
+    int kept = 1;
+    for (int i = 1; i < t_argc; ++i) {
+      const std::string_view argument = t_argv[i];
+      if (argument.starts_with("--dds_max_size=")) {
+        const std::string_view value = argument.substr(15);
+        if (std::from_chars(value.data(), value.data() + value.size(), t_config.maxSize).ec != std::errc{}) {
+          return false;
+        }
+      }
+      else if (argument.starts_with("--dds_corpus=")) {
+        t_config.corpusDirectory = argument.substr(13);
+      }
+      else {
+        t_argv[kept++] = t_argv[i];
+      }
+    }
+    t_argc = kept;
+    return true;
+  }
+
+  void RegisterBenchmarks(const CONFIG& t_config) {
+    std::vector<TEXTURE_DESC> formats;
+    for (size_t format = 1; format < static_cast<size_t>(Dds::Format::Count); ++format) {
+      formats.push_back({static_cast<Dds::Format>(format), MIN_SIZE});
+    }
+
+    Dds::LoadOptions flipped;
+    flipped.flipVertical = true;
+
+    for (const TEXTURE_DESC& format : formats) {
+      for (uint32_t size = MIN_SIZE; size <= t_config.maxSize; size *= 4) {
+        TEXTURE_DESC desc = format;
+        desc.size         = size;
+
+        benchmark::RegisterBenchmark(("Load/" + desc.Name()).c_str(), LoadMemory, desc, Dds::LoadOptions{});
+        benchmark::RegisterBenchmark(("LoadFlipped/" + desc.Name()).c_str(), LoadMemory, desc, flipped);
+        if (Dds::SelectFlipKernel(Dds::GetFormatInfo(desc.format))) {
+          desc.mipMaps = false;
+          benchmark::RegisterBenchmark(("Flip/" + desc.Name()).c_str(), Flip, desc);
+        }
+      }
+
+      for (const Layout layout : {Layout::Cubemap, Layout::Array}) {
+        TEXTURE_DESC desc = format;
+        desc.size         = std::min(LAYOUT_SIZE, t_config.maxSize);
+        desc.layout       = layout;
+        if (Dds::Bench::IsWritable(desc)) {
+          benchmark::RegisterBenchmark(("Load/" + desc.Name()).c_str(), LoadMemory, desc, Dds::LoadOptions{});
+        }
+      }
+    }
+
+    benchmark::RegisterBenchmark("Probe/memory", ProbeMemory, formats);
+    benchmark::RegisterBenchmark("LoadCorrupt", LoadCorrupt);
+
+    // the on-disk corpus: every format and layout up to BATCH_SIZE for probing and batch loads, plus one
+    // LAYOUT_SIZE file per format for single file loads. reads come from the page cache after the first
+    // iteration so these measure the loader and the syscalls rather than the disk
+    const std::vector<TEXTURE_DESC> descs = Dds::Bench::CorpusDescs(MIN_SIZE, std::min(BATCH_SIZE, t_config.maxSize), SIZE_MAX);
+    const std::vector<std::string>  paths = Dds::Bench::WriteCorpus(t_config.corpusDirectory / "batch", descs);
+
+    std::vector<TEXTURE_DESC> fileDescs = formats;
+    for (TEXTURE_DESC& desc : fileDescs) {
+      desc.size = std::min(LAYOUT_SIZE, t_config.maxSize);
+    }
+    const std::vector<std::string> filePaths = Dds::Bench::WriteCorpus(t_config.corpusDirectory / "single", fileDescs);
+
+    if (paths.empty() || filePaths.empty()) {
+      std::fprintf(stderr, "Could not write the corpus to %s, skipping file benchmarks\n", t_config.corpusDirectory.string().c_str());
+      return;
+    }
+
+    Dds::LoadOptions mapped;
+    mapped.storage = Dds::Storage::Mapped;
+    for (size_t i = 0; i < fileDescs.size(); ++i) {
+      const std::string name = fileDescs[i].Name();
+      benchmark::RegisterBenchmark(("LoadFile/" + name).c_str(), LoadFile, filePaths[i], fileDescs[i].PayloadSize(), Dds::LoadOptions{});
+      benchmark::RegisterBenchmark(("LoadMapped/" + name).c_str(), LoadFile, filePaths[i], fileDescs[i].PayloadSize(), mapped);
+
+      const uint32_t        tile = std::min(REGION_SIZE, fileDescs[i].size);
+      const LoadDds::REGION region{0, 0, 0, fileDescs[i].size - tile, 0, tile, tile};
+      benchmark::RegisterBenchmark(("LoadRegion/" + name).c_str(), LoadRegion, filePaths[i], region, Dds::LoadOptions{});
+      benchmark::RegisterBenchmark(("LoadRegionMapped/" + name).c_str(), LoadRegion, filePaths[i], region, mapped);
+    }
+
+    size_t corpusBytes = 0;
+    for (const TEXTURE_DESC& desc : descs) {
+      corpusBytes += desc.PayloadSize();
+    }
+
+    benchmark::RegisterBenchmark("Probe/file", ProbeFile, paths, corpusBytes);
+    benchmark::RegisterBenchmark("BatchLoad", BatchLoad, paths, corpusBytes)
+      ->RangeMultiplier(2)
+      ->Range(1, static_cast<int64_t>(std::max(1u, std::thread::hardware_concurrency())))
+      ->UseRealTime()
+      ->Unit(benchmark::kMillisecond);
+  }
+}
+
+int main(int t_argc, char** t_argv) {
+  CONFIG config;
+  if (!ParseArguments(t_argc, t_argv, config)) {
+    std::fprintf(stderr, "Invalid --dds_max_size\n");
+    return 1;
+  }
+
+  benchmark::Initialize(&t_argc, t_argv);
+  if (benchmark::ReportUnrecognizedArguments(t_argc, t_argv)) {
+    return 1;
+  }
+
+  RegisterBenchmarks(config);
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
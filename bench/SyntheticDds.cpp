@@ -0,0 +1,201 @@
+#include "SyntheticDds.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+namespace
+{
+  constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+  constexpr uint32_t DX10      = 0x30315844; // "DX10"
+
+  constexpr uint32_t DDSD_REQUIRED    = 0x1 | 0x2 | 0x4 | 0x1000; // CAPS | HEIGHT | WIDTH | PIXELFORMAT
+  constexpr uint32_t DDSD_PITCH       = 0x8;
+  constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+  constexpr uint32_t DDSD_LINEARSIZE  = 0x80000;
+
+  constexpr uint32_t DDPF_FOURCC = 0x4;
+  constexpr uint32_t DDPF_RGB    = 0x40;
+
+  constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+  constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+  constexpr uint32_t DDSCAPS_MIPMAP  = 0x400000;
+
+  constexpr uint32_t DDSCAPS2_CUBEMAP_ALLFACES       = 0x200 | 0xFC00;
+  constexpr uint32_t D3D10_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+  // xorshift64, plenty for filler bytes and fast enough that generating a corpus is disk bound
+  void FillRandom(std::byte* t_destination, const size_t t_size, uint64_t t_seed) {
+    uint64_t state = t_seed | 1;
+    size_t   i     = 0;
+    for (; i + 8 <= t_size; i += 8) {
+      state ^= state << 13;
+      state ^= state >> 7;
+      state ^= state << 17;
+      std::memcpy(t_destination + i, &state, 8);
+    }
+    for (; i < t_size; ++i) {
+      t_destination[i] = static_cast<std::byte>(state >> (i % 8 * 8));
+    }
+  }
+
+  // the only format without a DXGI value, written with its legacy bit masks
+  void SetLegacyPixelFormat(LoadDds::DDS_PIXELFORMAT& t_pixelFormat) {
+    t_pixelFormat.dwFlags       = DDPF_RGB;
+    t_pixelFormat.dwRGBBitCount = 24;
+    t_pixelFormat.dwRBitMask    = 0x00FF0000;
+    t_pixelFormat.dwGBitMask    = 0x0000FF00;
+    t_pixelFormat.dwBBitMask    = 0x000000FF;
+  }
+}
+
+std::string Dds::Bench::TEXTURE_DESC::Name() const {
+  std::string name = GetFormatInfo(format).name;
+  name += '_' + std::to_string(size);
+  name += mipMaps ? "_mips" : "_nomips";
+  if (layout == Layout::Cubemap) {
+    name += "_cube";
+  }
+  else if (layout == Layout::Array) {
+    name += "_array";
+  }
+  return name;
+}
+
+uint32_t Dds::Bench::TEXTURE_DESC::LayerCount() const {
+  switch (layout) {
+    case Layout::Cubemap:
+      return 6;
+    case Layout::Array:
+      return ARRAY_LAYERS;
+    default:
+      return 1;
+  }
+}
+
+uint32_t Dds::Bench::TEXTURE_DESC::MipCount() const {
+  return mipMaps ? static_cast<uint32_t>(std::bit_width(size)) : 1;
+}
+
+size_t Dds::Bench::TEXTURE_DESC::PayloadSize() const {
+  const FORMAT_INFO& info  = GetFormatInfo(format);
+  size_t             chain = 0;
+  for (uint32_t mip = 0; mip < MipCount(); ++mip) {
+    const uint32_t extent = std::max(1u, size >> mip);
+    chain += info.SurfaceSize(extent, extent);
+  }
+  return chain * LayerCount();
+}
+
+bool Dds::Bench::IsWritable(const TEXTURE_DESC& t_desc) {
+  if (t_desc.format == Format::Unknown || t_desc.format >= Format::Count || t_desc.size == 0) {
+    return false;
+  }
+  return GetDxgiFormat(t_desc.format) != 0 || (t_desc.format == Format::BGR8 && t_desc.layout != Layout::Array);
+}
+
+std::vector<std::byte> Dds::Bench::MakeDds(const TEXTURE_DESC& t_desc, const uint64_t t_seed) {
+  if (!IsWritable(t_desc)) {
+    return {};
+  }
+
+  const FORMAT_INFO& info       = GetFormatInfo(t_desc.format);
+  const uint32_t     dxgiFormat = GetDxgiFormat(t_desc.format);
+
+  LoadDds::DDS_HEADER header{};
+  header.dwSize        = sizeof(LoadDds::DDS_HEADER);
+  header.dwFlags       = DDSD_REQUIRED | (info.Compressed() ? DDSD_LINEARSIZE : DDSD_PITCH);
+  header.dwHeight      = t_desc.size;
+  header.dwWidth       = t_desc.size;
+  header.dwMipMapCount = t_desc.MipCount();
+  header.ddspf.dwSize  = sizeof(LoadDds::DDS_PIXELFORMAT);
+  header.dwCaps        = DDSCAPS_TEXTURE;
+  header.dwPitchOrLinearSize =
+    static_cast<uint32_t>(info.Compressed() ? info.SurfaceSize(t_desc.size, t_desc.size) : info.SurfaceSize(t_desc.size, 1));
+
+  if (t_desc.mipMaps) {
+    header.dwFlags |= DDSD_MIPMAPCOUNT;
+    header.dwCaps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+  }
+  if (t_desc.layout == Layout::Cubemap) {
+    header.dwCaps |= DDSCAPS_COMPLEX;
+    header.dwCaps2 = DDSCAPS2_CUBEMAP_ALLFACES;
+  }
+
+  LoadDds::DDS_HEADER_DXT10 dxt10Header;
+  if (dxgiFormat != 0) {
+    header.ddspf.dwFlags  = DDPF_FOURCC;
+    header.ddspf.dwFourCC = DX10;
+
+    dxt10Header.dxgiFormat        = static_cast<DXGI_FORMAT>(dxgiFormat);
+    dxt10Header.resourceDimension = Dds::D3D10_RESOURCE_DIMENSION_TEXTURE2D;
+    dxt10Header.miscFlag          = t_desc.layout == Layout::Cubemap ? D3D10_RESOURCE_MISC_TEXTURECUBE : 0;
+    // a cubemap counts whole cubes
+    dxt10Header.arraySize = t_desc.layout == Layout::Array ? ARRAY_LAYERS : 1;
+  }
+  else {
+    SetLegacyPixelFormat(header.ddspf);
+  }
+
+  const size_t headerSize = sizeof(DDS_MAGIC) + sizeof(header) + (dxgiFormat != 0 ? sizeof(dxt10Header) : 0);
+
+  std::vector<std::byte> file(headerSize + t_desc.PayloadSize());
+  std::memcpy(file.data(), &DDS_MAGIC, sizeof(DDS_MAGIC));
+  std::memcpy(file.data() + sizeof(DDS_MAGIC), &header, sizeof(header));
+  if (dxgiFormat != 0) {
+    std::memcpy(file.data() + sizeof(DDS_MAGIC) + sizeof(header), &dxt10Header, sizeof(dxt10Header));
+  }
+  FillRandom(file.data() + headerSize, file.size() - headerSize, t_seed);
+
+  return file;
+}
+
+std::vector<Dds::Bench::TEXTURE_DESC> Dds::Bench::CorpusDescs(const uint32_t t_minSize,
+                                                              const uint32_t t_maxSize,
+                                                              const size_t   t_maxBytes) {
+  std::vector<TEXTURE_DESC> descs;
+
+  for (size_t format = 1; format < static_cast<size_t>(Format::Count); ++format) {
+    // stepping by 4x keeps 16..16k at six sizes per format
+    for (uint64_t size = std::max(1u, t_minSize); size <= t_maxSize; size *= 4) {
+      for (const bool mipMaps : {false, true}) {
+        for (const Layout layout : {Layout::Texture2D, Layout::Cubemap, Layout::Array}) {
+          const TEXTURE_DESC desc{static_cast<Format>(format), static_cast<uint32_t>(size), mipMaps, layout};
+          if (IsWritable(desc) && desc.PayloadSize() <= t_maxBytes) {
+            descs.push_back(desc);
+          }
+        }
+      }
+    }
+  }
+
+  return descs;
+}
+
+std::vector<std::string> Dds::Bench::WriteCorpus(const std::filesystem::path&        t_directory,
+                                                 const std::span<const TEXTURE_DESC> t_descs) {
+  std::error_code error;
+  std::filesystem::create_directories(t_directory, error);
+  if (error) {
+    return {};
+  }
+
+  std::vector<std::string> paths;
+  paths.reserve(t_descs.size());
+
+  for (size_t i = 0; i < t_descs.size(); ++i) {
+    const std::vector<std::byte> file = MakeDds(t_descs[i], i + 1);
+    const std::filesystem::path  path = t_directory / (t_descs[i].Name() + ".dds");
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+    if (file.empty() || !out) {
+      return {};
+    }
+    paths.push_back(path.string());
+  }
+
+  return paths;
+}
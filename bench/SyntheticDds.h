@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "dds/Formats.h"
+
+namespace Dds::Bench
+{
+  enum class Layout : uint8_t
+  {
+    Texture2D,
+    Cubemap,
+    Array // ARRAY_LAYERS elements, DX10 header only
+  };
+
+  // One synthetic texture: square, either a single level or the full mip chain. The payload is
+  // pseudo-random, which the loader does not care about and which keeps every block mode in play
+  struct TEXTURE_DESC
+  {
+    Format   format  = Format::BC1;
+    uint32_t size    = 256;
+    bool     mipMaps = true;
+    Layout   layout  = Layout::Texture2D;
+
+    // e.g. BC7_1024_mips_cube
+    [[nodiscard]] std::string Name() const;
+    [[nodiscard]] uint32_t    LayerCount() const;
+    [[nodiscard]] uint32_t    MipCount() const;
+    // bytes of every level of every layer, the file adds its headers on top
+    [[nodiscard]] size_t PayloadSize() const;
+  };
+
+  static constexpr uint32_t ARRAY_LAYERS = 4;
+
+  // whether t_desc can be written at all (formats without a DXGI value have no texture arrays)
+  [[nodiscard]] bool IsWritable(const TEXTURE_DESC& t_desc);
+
+  // a complete DDS file in memory, DX10 header unless the format only exists in legacy headers
+  [[nodiscard]] std::vector<std::byte> MakeDds(const TEXTURE_DESC& t_desc, uint64_t t_seed = 1);
+
+  // every supported format at sizes t_minSize, 4 * t_minSize, ... up to t_maxSize, with and without
+  // mips, as a plain texture, a cubemap and an array. files above t_maxBytes are left out
+  [[nodiscard]] std::vector<TEXTURE_DESC> CorpusDescs(uint32_t t_minSize, uint32_t t_maxSize, size_t t_maxBytes);
+
+  // writes <Name()>.dds for every desc into t_directory (created if missing) and returns the paths,
+  // empty if any file could not be written
+  [[nodiscard]] std::vector<std::string> WriteCorpus(const std::filesystem::path&  t_directory,
+                                                     std::span<const TEXTURE_DESC> t_descs);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <utility>
+
+namespace Dds
+{
+  // Single allocation with a fixed alignment, used to hold a whole mip chain. Memory comes from a
+  // std::pmr::memory_resource so callers can route payloads into arenas or mapped staging memory.
+  class AlignedBuffer
+  {
+  public:
+    AlignedBuffer() = default;
+
+    AlignedBuffer(const size_t                     t_size,
+                  const size_t                     t_alignment,
+                  std::pmr::memory_resource* const t_resource = std::pmr::new_delete_resource())
+      : m_data(static_cast<std::byte*>(t_resource->allocate(t_size, t_alignment))),
+        m_size(t_size),
+        m_alignment(t_alignment),
+        m_resource(t_resource) {}
+
+    ~AlignedBuffer() {
+      Reset();
+    }
+
+    AlignedBuffer(AlignedBuffer&& t_other) noexcept
+      : m_data(std::exchange(t_other.m_data, nullptr)),
+        m_size(std::exchange(t_other.m_size, 0)),
+        m_alignment(t_other.m_alignment),
+        m_resource(t_other.m_resource) {}
+
+    AlignedBuffer& operator=(AlignedBuffer&& t_other) noexcept {
+      if (this != &t_other) {
+        Reset();
+        m_data      = std::exchange(t_other.m_data, nullptr);
+        m_size      = std::exchange(t_other.m_size, 0);
+        m_alignment = t_other.m_alignment;
+        m_resource  = t_other.m_resource;
+      }
+      return *this;
+    }
+
+    AlignedBuffer(const AlignedBuffer& t_other)      = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+    void Reset() {
+      if (m_data) {
+        m_resource->deallocate(m_data, m_size, m_alignment);
+      }
+      m_data = nullptr;
+      m_size = 0;
+    }
+
+    [[nodiscard]] std::byte* Data() const {
+      return m_data;
+    }
+
+    [[nodiscard]] size_t Size() const {
+      return m_size;
+    }
+
+    [[nodiscard]] std::pmr::memory_resource* Resource() const {
+      return m_resource;
+    }
+
+  private:
+    std::byte* m_data      = nullptr;
+    size_t     m_size      = 0;
+    size_t     m_alignment = alignof(std::max_align_t);
+
+    std::pmr::memory_resource* m_resource = std::pmr::new_delete_resource();
+  };
+}
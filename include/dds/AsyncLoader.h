@@ -0,0 +1,74 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+
+#include "dds/BatchLoader.h"
+#include "dds/ThreadPool.h"
+
+namespace Dds
+{
+  // Keeps many DDS reads in flight at once. On Linux a dedicated I/O thread submits the header read and
+  // the payload reads (split into chunks) of every queued file through io_uring, so a single thread can
+  // keep an NVMe queue busy. Parsing, flipping and completion callbacks run on a ThreadPool. Where
+  // io_uring is missing, blocked or cannot do plain reads (kernels before 5.6, seccomp, Windows) every
+  // file is loaded with positioned reads on the pool instead.
+  class AsyncLoader
+  {
+  public:
+    using RESULT       = BatchLoader::RESULT;
+    using CompletionFn = BatchLoader::CompletionFn;
+
+    enum class Backend : uint8_t
+    {
+      IoUring,
+      ThreadPool
+    };
+
+    // t_queueDepth bounds the reads in flight, 0 workers uses std::thread::hardware_concurrency()
+    explicit AsyncLoader(uint32_t t_queueDepth = 128, size_t t_workerCount = 0);
+    // completes everything queued, then shuts the I/O thread down
+    ~AsyncLoader();
+    AsyncLoader(AsyncLoader&& t_other)            = delete;
+    AsyncLoader(const AsyncLoader& t_other)       = delete;
+    AsyncLoader& operator=(AsyncLoader&& t_other) = delete;
+    AsyncLoader& operator=(const AsyncLoader&)    = delete;
+
+    // queues every path and returns immediately, t_onComplete runs on a worker thread per file
+    void Load(std::span<const std::string> t_paths, CompletionFn t_onComplete, const LoadOptions& t_options = {});
+    [[nodiscard]] std::future<RESULT> Load(const std::string& t_path, const LoadOptions& t_options = {});
+    // blocks until every queued file has completed
+    void Wait();
+
+    [[nodiscard]] Backend ActiveBackend() const {
+      return m_ring ? Backend::IoUring : Backend::ThreadPool;
+    }
+
+  private:
+    struct REQUEST;
+    struct RING;
+
+    void Enqueue(std::unique_ptr<REQUEST> t_request);
+    void IoLoop();
+    void Complete(REQUEST* t_request);
+    void Finish();
+
+    ThreadPool            m_pool;
+    std::unique_ptr<RING> m_ring;
+    std::thread           m_ioThread;
+
+    std::mutex                           m_mutex;
+    std::condition_variable              m_wake;
+    std::condition_variable              m_idle;
+    std::deque<std::unique_ptr<REQUEST>> m_incoming;
+    size_t                               m_pending = 0; // queued, not yet completed
+    bool                                 m_stop    = false;
+  };
+}
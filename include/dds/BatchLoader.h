@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "dds/DDSLoader.h"
+#include "dds/ThreadPool.h"
+
+namespace Dds
+{
+  // Loads many DDS files at once on a work-stealing ThreadPool. Every file is parsed, read and flipped
+  // on a worker with the LoadOptions given for the batch, failures are reported per file through
+  // RESULT::status and the log hook.
+  class BatchLoader
+  {
+  public:
+    struct RESULT
+    {
+      std::string       path;
+      LoadDds::DDS_FILE file;
+      STATUS            status;
+
+      [[nodiscard]] bool Ok() const {
+        return status.Ok();
+      }
+    };
+
+    // called on a worker thread as soon as a file is done, t_index is the position in the input list
+    using CompletionFn = std::function<void(size_t t_index, RESULT&& t_result)>;
+
+    // 0 uses std::thread::hardware_concurrency()
+    explicit BatchLoader(size_t t_workerCount = 0);
+
+    // queues every path and returns immediately, results arrive through t_onComplete
+    void Load(std::span<const std::string> t_paths, CompletionFn t_onComplete, const LoadOptions& t_options = {});
+    // queues every path and returns one future per path, in input order
+    [[nodiscard]] std::vector<std::future<RESULT>> Load(std::span<const std::string> t_paths,
+                                                        const LoadOptions&           t_options = {});
+    // blocks until every queued file has completed
+    void Wait();
+
+    [[nodiscard]] size_t WorkerCount() const {
+      return m_pool.ThreadCount();
+    }
+
+  private:
+    static RESULT LoadOne(const std::string& t_path, const LoadOptions& t_options);
+
+    ThreadPool m_pool;
+  };
+}
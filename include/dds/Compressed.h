@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "dds/DDSLoader.h"
+#include "dds/Result.h"
+#include "dds/ThreadPool.h"
+
+/*
+ Compressed DDS Container Structure (.ddsz, native byte order):
+  Section          Length
+  //////////////////////////////////////////
+  DDSZ_HEADER      32
+  DDS headers      headerSize, magic + DDS_HEADER (+ DDS_HEADER_DXT10) exactly as in a .dds file
+  DDSZ_CHUNK[]     chunkCount * 16, in payload order
+  chunk data       every chunk back to back, compressed with the container's codec or stored as is
+                   when that does not make it smaller
+
+ The payload is kept level-major (the order of DDS_FILE::data) rather than in file order, and a chunk
+ never spans two levels, so any mip range is a contiguous run of whole chunks that decompress straight
+ into their place in DDS_FILE::data.
+*/
+
+namespace Dds
+{
+  // Values are only ever appended, they are stored in containers
+  enum class Codec : uint8_t
+  {
+    Lz,   // in-tree LZ4 block format codec, always available
+    Zstd, // only when built with libzstd (DDS_WITH_ZSTD and the library found)
+    Count
+  };
+
+  [[nodiscard]] bool CodecAvailable(Codec t_codec);
+
+  struct COMPRESS_OPTIONS
+  {
+    Codec    codec     = Codec::Lz;
+    uint32_t chunkSize = 256u << 10; // uncompressed bytes per chunk, smaller levels get a chunk each
+    int      level     = 0;          // zstd compression level, 0 is zstd's default. ignored by Lz
+  };
+
+  // Writes t_ddsFile as a compressed container, with the headers SaveDds would write. Like SaveDds the
+  // payload is stored as it is in memory (flipped, trimmed) and a failed save leaves t_path as it was.
+  // Fails with UnsupportedCodec when t_options.codec is not built in
+  STATUS SaveCompressedDds(const char* t_path, const LoadDds::DDS_FILE& t_ddsFile, const COMPRESS_OPTIONS& t_options = {});
+
+  // Loads compressed containers. The calling thread reads the chunks of the selected mip range in
+  // windows of about a megabyte and hands each window's chunks to the pool as soon as it arrives, so
+  // decompression overlaps the reads that follow. Chunks that were stored uncompressed are read straight
+  // into the payload. Several threads may load through one CompressedLoader at once
+  class CompressedLoader
+  {
+  public:
+    // 0 uses std::thread::hardware_concurrency()
+    explicit CompressedLoader(size_t t_workerCount = 0);
+
+    // LoadOptions::storage is ignored, the payload is always on the heap. must not be called from a
+    // task running on this loader's pool
+    [[nodiscard]] Result<LoadDds::DDS_FILE> Load(const char* t_path, const LoadOptions& t_options = {});
+
+    [[nodiscard]] size_t WorkerCount() const {
+      return m_pool.ThreadCount();
+    }
+
+  private:
+    STATUS LoadImpl(LoadDds::DDS_FILE& t_ddsFile, const char* t_path, const LoadOptions& t_options);
+
+    ThreadPool m_pool;
+  };
+}
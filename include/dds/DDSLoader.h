@@ -1,7 +1,18 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory_resource>
+#include <span>
 #include <vector>
 
+#include "dds/AlignedBuffer.h"
+#include "dds/DxgiFormat.h"
+#include "dds/FileReader.h"
+#include "dds/MappedFile.h"
+#include "dds/Result.h"
+
 /*
  File Structure:
   Section     Length
@@ -11,7 +22,7 @@
   HEADER_DX10* 20	(https://msdn.microsoft.com/en-us/library/bb943983(v=vs.85).aspx)
   bdata(2)     fseek(f, 0, SEEK_END); (ftell(f) - 128) - (fourCC == "DX10" ? 17 or 20 : 0)
 * the link tells you that this section isn't written unless its a DX10 file
-Supports DXT1, DXT3, DXT5, DXT10
+Supports DXT1-5, BC4-BC7 and uncompressed formats, legacy and DXT10 headers
 
 File Byte Order:
 typedef unsigned int DWORD;                           32bits little endian
@@ -94,55 +105,146 @@ typedef unsigned int DWORD;                           32bits little endian
 
 */
 
-enum DXGI_FORMAT : int;
-
 namespace Dds
 {
-  enum class Flag : uint8_t
+  class AsyncLoader;
+  class CompressedLoader;
+
+  enum class Flag : uint16_t
   {
-    None  = 0,
-    DXT1  = 1 << 0,
-    DXT3  = 1 << 1,
-    DXT5  = 1 << 2,
-    BC4_U = 1 << 3,
-    BC5_U = 1 << 4,
-    BC7   = 1 << 5
+    None         = 0,
+    DXT1         = 1 << 0,
+    DXT3         = 1 << 1,
+    DXT5         = 1 << 2,
+    BC4_U        = 1 << 3,
+    BC5_U        = 1 << 4,
+    BC7          = 1 << 5,
+    BC6H_UF16    = 1 << 6,
+    BC6H_SF16    = 1 << 7,
+    BC4_S        = 1 << 8,
+    BC5_S        = 1 << 9,
+    Uncompressed = 1 << 10 // plain pixels, DDS_INFO::format tells which
   };
 
   struct BitFlag
   {
-    uint8_t flagValue = 0;
+    uint16_t flagValue = 0;
 
     void SetFlag(Flag t_flag) {
-      flagValue |= static_cast<uint8_t>(t_flag);
+      flagValue |= static_cast<uint16_t>(t_flag);
     }
 
     void UnsetFlag(Flag t_flag) {
-      flagValue &= ~static_cast<uint8_t>(t_flag);
+      flagValue &= ~static_cast<uint16_t>(t_flag);
     }
 
     void FlipFlag(Flag t_flag) {
-      flagValue ^= static_cast<uint8_t>(t_flag);
+      flagValue ^= static_cast<uint16_t>(t_flag);
     }
 
     [[nodiscard]] constexpr bool HasFlag(Flag t_flag) const {
-      return (flagValue & static_cast<uint8_t>(t_flag)) == static_cast<uint8_t>(t_flag);
+      return (flagValue & static_cast<uint16_t>(t_flag)) == static_cast<uint16_t>(t_flag);
     }
 
     [[nodiscard]] constexpr bool HasAnyFlag(Flag t_multiFlag) const {
-      return (flagValue & static_cast<uint8_t>(t_multiFlag)) != 0;
+      return (flagValue & static_cast<uint16_t>(t_multiFlag)) != 0;
     }
   };
 
   // Enable bitwise operations for the enum
   constexpr Flag operator|(Flag t_a, Flag t_b) {
-    return static_cast<Flag>(static_cast<uint8_t>(t_a) | static_cast<uint8_t>(t_b));
+    return static_cast<Flag>(static_cast<uint16_t>(t_a) | static_cast<uint16_t>(t_b));
   }
 
   constexpr Flag operator&(Flag t_a, Flag t_b) {
-    return static_cast<Flag>(static_cast<uint8_t>(t_a) & static_cast<uint8_t>(t_b));
+    return static_cast<Flag>(static_cast<uint16_t>(t_a) & static_cast<uint16_t>(t_b));
   }
 
+  // Every pixel layout the loader understands, see Dds::GetFormatInfo (dds/Formats.h) for its block
+  // size, GL formats and flip layout. Channel order is the memory order of one pixel
+  enum class Format : uint8_t
+  {
+    Unknown,
+    BC1,
+    BC2,
+    BC3,
+    BC4,
+    BC4_S,
+    BC5,
+    BC5_S,
+    BC6H_UF16,
+    BC6H_SF16,
+    BC7,
+    R8,
+    RG8,
+    RGBA8,
+    BGRA8,
+    BGRX8,
+    BGR8,
+    B5G6R5,
+    B5G5R5A1,
+    B4G4R4A4,
+    R10G10B10A2,
+    R16,
+    RG16,
+    RGBA16,
+    R16F,
+    RG16F,
+    RGBA16F,
+    R32F,
+    RG32F,
+    RGBA32F,
+    Count
+  };
+
+  // Where the payload of a loaded DDS_FILE lives
+  enum class Storage : uint8_t
+  {
+    Heap,    // the mip chain is read into a single aligned heap buffer owned by the DDS_FILE
+    Mapped,  // the file is memory-mapped (copy-on-write), the mip chain points straight into the mapping.
+             // arrays and cubemaps are regrouped by level into a heap buffer instead
+    Borrowed // in-memory loads only, the mip chain points into the caller's buffer
+  };
+
+  // colour space assumed for legacy FourCC files, which do not store one
+  enum class ColorSpace : uint8_t
+  {
+    Srgb,
+    Linear
+  };
+
+  enum class Validation : uint8_t
+  {
+    Lenient, // only reject files whose payload is too short for the header
+    Strict   // also reject malformed header sizes/flags, impossible mip counts and trailing data
+  };
+
+  // What flipVertical does with a block compressed level taller than one block row whose height is not
+  // a multiple of 4 (common in the mips of non power of two textures). Its last block row is partly
+  // padding, so reversing the block rows cannot mirror it
+  enum class PartialFlip : uint8_t
+  {
+    BlockRows, // bit exact and as cheap as any flip, but the image ends up lower by the padding rows
+    Reencode   // decoded, mirrored texel by texel and encoded again: the image is mirrored, the blocks are
+               // not bit exact (BC7 becomes mode 6) and the level costs a decode, an encode and a buffer.
+               // formats without an encoder fall back to BlockRows
+  };
+
+  // Per-call load settings, so concurrent loads with different needs never share state
+  struct LoadOptions
+  {
+    // block compressed levels are flipped by reordering blocks and the rows inside them, which is bit
+    // exact except for partial levels (see PartialFlip) and the BC7 blocks whose partition shape has no
+    // mirrored counterpart (2 of 64 two subset and 5 of 64 three subset shapes), which are re-encoded
+    bool        flipVertical     = false;
+    PartialFlip partialFlip      = PartialFlip::BlockRows;
+    uint32_t    firstMip         = 0;          // highest resolution level to keep
+    uint32_t    mipCount         = UINT32_MAX; // levels to keep from firstMip, clamped to the file
+    Storage     storage          = Storage::Heap;
+    ColorSpace  legacyColorSpace = ColorSpace::Srgb;
+    Validation  validation       = Validation::Lenient;
+  };
+
   enum D3D10_RESOURCE_DIMENSION : int // make sure we use the default base type NOLINT(performance-enum-size)
   {
     D3D10_RESOURCE_DIMENSION_UNKNOWN   = 0,
@@ -190,7 +292,7 @@ public:
 
   struct DDS_HEADER_DXT10
   {
-    DXGI_FORMAT                   dxgiFormat        = static_cast<DXGI_FORMAT>(0); // DXGI_FORMAT_UNKNOWN
+    DXGI_FORMAT                   dxgiFormat        = DXGI_FORMAT_UNKNOWN;
     Dds::D3D10_RESOURCE_DIMENSION resourceDimension = Dds::D3D10_RESOURCE_DIMENSION_UNKNOWN;
     uint32_t                      miscFlag          = 0;
     uint32_t                      arraySize         = 0;
@@ -200,20 +302,54 @@ public:
 
   struct MIP_LEVEL
   {
-    uint32_t               width  = 0;
-    uint32_t               height = 0;
-    std::vector<std::byte> data;
+    uint32_t width     = 0;
+    uint32_t height    = 0;
+    uint32_t depth     = 1; // slices of a volume level, 1 for everything else
+    size_t   offset    = 0; // byte offset of this level inside DDS_FILE::data, its layers follow back to back
+    size_t   size      = 0; // byte size of this level across all layers
+    size_t   layerSize = 0; // byte size of a single layer (array element or cube face) of this level
   };
 
-  struct DDS_FILE
+  // everything known about a texture from its headers alone
+  struct DDS_INFO
   {
     DDS_HEADER             header;
     DDS_HEADER_DXT10       dxt10Header;
     Dds::BitFlag           flags;
-    uint32_t               blockSize = 0;
-    uint32_t               glFormat  = 0; // fallback format
+    Dds::Format            format    = Dds::Format::Unknown;
+    uint32_t               blockSize = 0; // bytes per 4x4 block, per pixel for uncompressed formats
+    uint32_t               glFormat  = 0; // GL internal format
     std::vector<MIP_LEVEL> mipMaps;
-    size_t                 totalSizeBytes = 0;
+    size_t                 totalSizeBytes  = 0;
+    size_t                 payloadOffset   = 0; // file offset of the first mip level of the first layer
+    uint32_t               firstMip        = 0; // level index in the file of mipMaps[0]
+    uint32_t               arraySize       = 1; // array elements, a cubemap array counts whole cubes
+    uint32_t               faceCount       = 1; // 6 for cubemaps, fewer for partial legacy cubemaps
+    size_t                 fileLayerStride = 0; // file distance between the same level of two layers
+
+    // layers per level, layer index = array element * faceCount + face
+    [[nodiscard]] uint32_t LayerCount() const {
+      return arraySize * faceCount;
+    }
+  };
+
+  struct DDS_FILE : DDS_INFO
+  {
+    // the whole mip chain, contiguous and totalSizeBytes long. Levels are stored in order with all layers
+    // of a level back to back, so each level of an array, cubemap or volume is a single upload. Files
+    // store every layer's mip chain in turn instead, single layer textures are laid out the same way
+    std::span<std::byte> data;
+    // backing memory for data, at most one of the two is in use depending on Dds::Storage
+    Dds::AlignedBuffer buffer;
+    Dds::MappedFile    mapping;
+
+    [[nodiscard]] std::span<std::byte> MipData(const size_t t_mip) const {
+      return data.subspan(mipMaps[t_mip].offset, mipMaps[t_mip].size);
+    }
+
+    [[nodiscard]] std::span<std::byte> LayerData(const size_t t_mip, const size_t t_layer) const {
+      return data.subspan(mipMaps[t_mip].offset + t_layer * mipMaps[t_mip].layerSize, mipMaps[t_mip].layerSize);
+    }
 
     DDS_FILE()                              = default;
     ~DDS_FILE()                             = default;
@@ -223,50 +359,164 @@ public:
     DDS_FILE& operator=(const DDS_FILE&)    = delete;
   };
 
-  static DDS_FILE TextureLoadDds(const char* t_path);
-  static void     FlipVerticalOnLoad(bool t_flip);
+  // positioned read source (archive entry, decompressor, network blob...). must fill t_destination
+  // completely starting at t_offset or return false
+  using ReadAtFn = std::function<bool(uint64_t t_offset, std::span<std::byte> t_destination)>;
+
+  // size and alignment the mip chain of a file needs, see the destination overload of TextureLoadDds
+  struct PAYLOAD_REQUIREMENTS
+  {
+    size_t size      = 0;
+    size_t alignment = 0;
+  };
+
+  // a rectangle of one level of one layer, in texels of that level. x and y are multiples of the block
+  // size, and so are width and height unless the rectangle ends at the edge of the level
+  struct REGION
+  {
+    uint32_t mip    = 0; // file level index
+    uint32_t layer  = 0; // array element * faceCount + face
+    uint32_t slice  = 0; // depth slice of a volume level
+    uint32_t x      = 0;
+    uint32_t y      = 0;
+    uint32_t width  = 0;
+    uint32_t height = 0;
+  };
+
+  // all loads are reentrant, everything that changes how a file is loaded comes in through t_options.
+  // a mip range other than the full chain rewrites header.dwWidth/dwHeight/dwMipMapCount to match.
+  // failures never throw or print, they come back as a Dds::STATUS (dds/Result.h) and go to the log hook
+  static Dds::Result<DDS_FILE> TextureLoadDds(const char* t_path, const Dds::LoadOptions& t_options = {});
+  // reads the mip chain into memory allocated from t_resource instead of the global heap
+  static Dds::Result<DDS_FILE> TextureLoadDds(const char*                t_path,
+                                              std::pmr::memory_resource* t_resource,
+                                              const Dds::LoadOptions&    t_options = {});
+  // reads the mip chain into caller owned memory (e.g. a mapped staging buffer), which must outlive the
+  // returned DDS_FILE. fails if t_destination is smaller than QueryPayloadRequirements(t_path)->size
+  static Dds::Result<DDS_FILE> TextureLoadDds(const char*             t_path,
+                                              std::span<std::byte>    t_destination,
+                                              const Dds::LoadOptions& t_options = {});
+  // parses a whole DDS file already in memory. Dds::Storage::Borrowed points the mip chain into t_data
+  // (which must then outlive the DDS_FILE) unless flipping is requested or the texture has more than one
+  // layer, anything else copies it
+  static Dds::Result<DDS_FILE> TextureLoadDds(std::span<const std::byte> t_data, const Dds::LoadOptions& t_options = {});
+  // pulls the headers and then the mip chain through t_readAt, the payload is read in a single call per
+  // layer and level (a single call for single layer textures)
+  static Dds::Result<DDS_FILE> TextureLoadDds(const ReadAtFn&            t_readAt,
+                                              std::pmr::memory_resource* t_resource = std::pmr::new_delete_resource(),
+                                              const Dds::LoadOptions&    t_options  = {});
+  // reads only the headers of t_path
+  static Dds::Result<PAYLOAD_REQUIREMENTS> QueryPayloadRequirements(const char*             t_path,
+                                                                     const Dds::LoadOptions& t_options = {});
+  // reads only magic, DDS_HEADER and DDS_HEADER_DXT10 and computes the mip layout without touching the
+  // payload
+  static Dds::Result<DDS_INFO> ProbeDds(const char* t_path, const Dds::LoadOptions& t_options = {});
+  // same as above for the first bytes of a file already in memory. the layout is not checked against
+  // t_data.size() so passing only the headers is enough
+  static Dds::Result<DDS_INFO> ProbeDds(std::span<const std::byte> t_data, const Dds::LoadOptions& t_options = {});
+
+  // texture streaming: loads the higher resolution levels [t_firstMip, t_ddsFile.firstMip) of t_path in
+  // front of an already loaded tail with positioned reads. only the new levels are read and flipped,
+  // t_options must match the ones the tail was loaded with (mip range fields are ignored)
+  static Dds::STATUS StreamInMips(const char*             t_path,
+                                  DDS_FILE&               t_ddsFile,
+                                  uint32_t                t_firstMip,
+                                  const Dds::LoadOptions& t_options = {});
+  // drops every level above t_firstMip (a file level index) to release memory, the tail is kept
+  static Dds::STATUS EvictMips(DDS_FILE& t_ddsFile, uint32_t t_firstMip);
+
+  // tile extraction: reads only the block rows of t_region, one positioned read per row (a single one
+  // when the region spans the whole level), and returns them as a single level 2D texture of the
+  // region's size. With flipVertical the rectangle is taken from the flipped level, matching the same
+  // rectangle of a flipped full load, and only the region is flipped (with the one more block row its
+  // mirrored texel rows straddle when the level's height is not a multiple of the block height).
+  // Dds::Storage::Mapped copies the rows out of a mapping instead of reading them. the mip range fields
+  // of t_options are ignored
+  static Dds::Result<DDS_FILE> LoadRegion(const char* t_path, const REGION& t_region, const Dds::LoadOptions& t_options = {});
+  // same as above out of a whole DDS file already in memory (a pack entry, a mapping)
+  static Dds::Result<DDS_FILE> LoadRegion(std::span<const std::byte> t_data,
+                                          const REGION&              t_region,
+                                          const Dds::LoadOptions&    t_options = {});
+
+  // alignment of DDS_FILE::data for heap and allocator storage, enough for SIMD and GPU staging copies
+  static constexpr size_t PAYLOAD_ALIGNMENT = 64;
 
 private:
-  static constexpr uint32_t DXT1  = 0x31545844;
-  static constexpr uint32_t DXT3  = 0x33545844;
-  static constexpr uint32_t DXT5  = 0x35545844;
-  static constexpr uint32_t DX10  = 0x30315844;
-  static constexpr uint32_t BC5_U = 0x55354342;
-
-#if !defined(GL_VERSION_4_2)
-  enum OGL_FORMAT
+  // drives ParseLayout and Flip itself around its io_uring reads
+  friend class Dds::AsyncLoader;
+  // parses the headers stored in a compressed container and flips after decompressing
+  friend class Dds::CompressedLoader;
+
+  static constexpr uint32_t DX10 = 0x30315844;
+
+  static constexpr uint32_t DDSCAPS2_CUBEMAP                = 0x200;
+  static constexpr uint32_t DDSCAPS2_CUBEMAP_ALLFACES       = 0xFC00;
+  static constexpr uint32_t DDSCAPS2_VOLUME                 = 0x200000;
+  static constexpr uint32_t D3D10_RESOURCE_MISC_TEXTURECUBE = 0x4;
+  // D3D11_REQ_TEXTURE2D_ARRAY_AXIS_DIMENSION
+  static constexpr uint32_t MAX_ARRAY_SIZE = 2048;
+
+  // one contiguous piece of the payload in the file and where it goes in DDS_FILE::data
+  struct PAYLOAD_RUN
   {
-    GL_COMPRESSED_RGB_S3TC_DXT1_EXT        = 0x83F0, // DXT1 RGB linear
-    GL_COMPRESSED_RGBA_S3TC_DXT1_EXT       = 0x83F1, // DXT1 RGBA linear
-    GL_COMPRESSED_RGBA_S3TC_DXT3_EXT       = 0x83F2, // DXT3 RGBA linear
-    GL_COMPRESSED_RGBA_S3TC_DXT5_EXT       = 0x83F3, // DXT5 RGBA linear
-    GL_COMPRESSED_SRGB_S3TC_DXT1_EXT       = 0x8C4C, // DXT1 RGB sRGB 
-    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT = 0x8C4D, // DXT1 RGBA sRGB
-    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT = 0x8C4E, // DXT3 RGBA sRGB
-    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT = 0x8C4F, // DXT5 RGBA sRGB
-    GL_COMPRESSED_RGBA_BPTC_UNORM          = 0x8E8C, // BC7 RGBA linear
-    GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM    = 0x8E8D, // BC7 RGBA sRGB
-    GL_COMPRESSED_RED_RGTC1                = 0x8DBB, // BC4u R linear
-    GL_COMPRESSED_RG_RGTC2                 = 0x8DBD, // BC5n RG linear
+    uint64_t fileOffset = 0;
+    size_t   offset     = 0;
+    size_t   size       = 0;
+    uint32_t mip        = 0; // file level index of the first level in the run, for error reports
   };
-#endif
-
-  static inline bool m_flipOnLoad = false;
-
-  static bool ValidateExpectedSize(DDS_FILE&                               t_ddsFile,
-                                   size_t                                  t_remainingBytes,
-                                   const std::vector<std::byte>::iterator& t_itBegin);
-  static void Flip(DDS_FILE& t_ddsFile);
-  // general 4-byte row swap (DXT1 color/DXT3 alpha or color)
-  static void Flip4ByteRow(std::byte* t_colorBlock);
-  // DXT5 alpha / BC4 / BC5 single channel
-  static void Flip3BitIndicesBlock(std::byte* t_block);
-  // Flips a single 8-byte DXT1 block vertically
-  static void FlipDxt1Block(std::byte* t_block);
-  static void FlipDxt3Block(std::byte* t_block);
-  // Flip a single 16-byte DXT5 block vertically
-  static void FlipDxt5Block(std::byte* t_block);
-  static void FlipBc4Block(std::byte* t_block);
-  // Flip a single 16-byte BC5 block vertically (red + green channels)
-  static void FlipBc5Block(std::byte* t_block);
+
+  static Dds::STATUS TextureLoadDdsImpl(DDS_FILE&                  t_ddsFile,
+                                        const char*                t_path,
+                                        std::pmr::memory_resource* t_resource,
+                                        std::span<std::byte>       t_destination,
+                                        const Dds::LoadOptions&    t_options);
+  static Dds::STATUS LoadFromMemory(DDS_FILE&                  t_ddsFile,
+                                    std::span<const std::byte> t_data,
+                                    const Dds::LoadOptions&    t_options);
+  static Dds::STATUS LoadFromReadAt(DDS_FILE&                  t_ddsFile,
+                                    const ReadAtFn&            t_readAt,
+                                    std::pmr::memory_resource* t_resource,
+                                    const Dds::LoadOptions&    t_options);
+  static Dds::STATUS StreamInMipsImpl(const char*             t_path,
+                                      DDS_FILE&               t_ddsFile,
+                                      uint32_t                t_firstMip,
+                                      const Dds::LoadOptions& t_options);
+  // t_ddsFile holds the layout of t_region's level only, the rows come in through t_readAt and the
+  // result replaces that layout
+  static Dds::STATUS LoadRegionImpl(DDS_FILE&               t_ddsFile,
+                                    const REGION&           t_region,
+                                    const Dds::LoadOptions& t_options,
+                                    const ReadAtFn&         t_readAt);
+  // opens t_path, reads its headers and computes the layout, t_file stays open for the payload read
+  static Dds::STATUS ReadHeaders(Dds::FileReader&        t_file,
+                                 const char*             t_path,
+                                 DDS_INFO&               t_ddsInfo,
+                                 const Dds::LoadOptions& t_options);
+  // ParseHeader + ValidateExpectedSize + options. t_fileSize is SIZE_MAX when the source size is unknown
+  static Dds::STATUS ParseLayout(DDS_INFO&                  t_ddsInfo,
+                                 std::span<const std::byte> t_headerBytes,
+                                 size_t                     t_fileSize,
+                                 const Dds::LoadOptions&    t_options);
+  // parses magic, DDS_HEADER, the optional DDS_HEADER_DXT10 and the format, sets payloadOffset
+  static Dds::STATUS ParseHeader(DDS_INFO& t_ddsInfo, std::span<const std::byte> t_file, const Dds::LoadOptions& t_options);
+  // computes the mip layout, fails with the first level that does not fit in the remaining bytes of the file
+  static Dds::STATUS ValidateExpectedSize(DDS_INFO& t_ddsInfo, size_t t_remainingBytes);
+  static Dds::STATUS ValidateHeaderStrict(const DDS_HEADER& t_header);
+  // array size, cube faces and volume depth from dwCaps2/dwDepth or the DX10 header
+  static Dds::STATUS ParseDimensions(DDS_INFO& t_ddsInfo);
+  // trims the layout to LoadOptions::firstMip/mipCount
+  static Dds::STATUS SelectMipRange(DDS_INFO& t_ddsInfo, const Dds::LoadOptions& t_options);
+  // the selected levels of every layer in file order, a single run for single layer textures
+  static std::vector<PAYLOAD_RUN> PayloadRuns(const DDS_INFO& t_ddsInfo);
+  // gathers the payload out of a whole file in memory into level-major order
+  static void CopyPayload(const DDS_INFO& t_ddsInfo, const std::byte* t_file, std::byte* t_destination);
+  static void Flip(DDS_FILE& t_ddsFile, const Dds::LoadOptions& t_options);
+  // flips the levels [t_begin, t_end) of mipMaps from t_source into t_destination, both laid out like
+  // the payload. The two may be the same payload to flip in place
+  static void FlipMips(const DDS_INFO&         t_ddsInfo,
+                       const std::byte*        t_source,
+                       std::byte*              t_destination,
+                       size_t                  t_begin,
+                       size_t                  t_end,
+                       const Dds::LoadOptions& t_options);
 };
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <span>
+
+#include "dds/DDSLoader.h"
+#include "dds/Result.h"
+
+namespace Dds
+{
+  // gather write sink (pipe, socket, archive builder...). must take every buffer in order or return false
+  using WriteFn = std::function<bool(std::span<const std::span<const std::byte>> t_buffers)>;
+
+  // Serializes t_ddsFile as a DDS file. The payload is written as it is in memory, so a texture loaded
+  // flipped or with a mip range is saved flipped and trimmed, and loads back without either option.
+  //
+  // Files loaded from a legacy header keep their pixel format, DX10 files their DXGI_FORMAT (including
+  // typeless and sRGB variants). Anything else gets a DX10 header for Format, or a legacy mask header
+  // for the few formats without a DXGI value. Width, height, depth, mip count, dwPitchOrLinearSize and
+  // the cubemap, volume and array fields are rebuilt from the layout, never copied.
+  //
+  // Levels go out straight from DDS_FILE::data in the file's layer-major order with one gather write
+  // per batch of pieces, the whole file is never assembled in memory. The file is written under a
+  // temporary name next to t_path and renamed into place, so a failed save leaves an existing t_path
+  // as it was, and a texture mapped from t_path can be saved over it. failures come back as a
+  // Dds::STATUS and go to the log hook like load failures
+  STATUS SaveDds(const char* t_path, const LoadDds::DDS_FILE& t_ddsFile);
+  // same as above into a custom sink, which sees the headers as the first buffer
+  STATUS SaveDds(const WriteFn& t_write, const LoadDds::DDS_FILE& t_ddsFile);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "dds/Formats.h"
+
+namespace Dds
+{
+  enum class PixelFormat : uint8_t
+  {
+    None,
+    Rgba8,  // BC1-BC5 and BC7, channels a format does not store read 0 (alpha 255)
+    Rgba16F // BC6H, half floats with alpha 1.0
+  };
+
+  [[nodiscard]] constexpr size_t PixelSize(const PixelFormat t_format) {
+    return t_format == PixelFormat::Rgba8 ? 4 : t_format == PixelFormat::Rgba16F ? 8 : 0;
+  }
+
+  // Decodes t_blockCount blocks into 4x4 tiles, one row-major tile of 16 texels per block back to back
+  using DecodeKernel = void (*)(const std::byte* t_blocks, size_t t_blockCount, std::byte* t_tiles);
+
+  struct DECODE_KERNEL
+  {
+    DecodeKernel kernel = nullptr;
+    PixelFormat  format = PixelFormat::None;
+  };
+
+  // Picks the kernel for a texture's format once. kernel is nullptr for formats that cannot be decoded
+  [[nodiscard]] DECODE_KERNEL SelectDecodeKernel(const FORMAT_INFO& t_format);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "dds/AlignedBuffer.h"
+#include "dds/DDSLoader.h"
+#include "dds/DecodeKernels.h"
+#include "dds/ThreadPool.h"
+
+namespace Dds
+{
+  // Decodes block compressed levels to plain pixels on the CPU for consumers without BC support
+  // (thumbnails, tools, software renderers). BC1-BC5 and BC7 decode to Rgba8, BC6H to Rgba16F. sRGB
+  // formats keep their encoded values, nothing is linearised. Levels of at least PARALLEL_BLOCKS blocks
+  // are split into bands of block rows that decode in parallel on the decoder's ThreadPool.
+  class Decoder
+  {
+  public:
+    struct IMAGE
+    {
+      uint32_t           width    = 0;
+      uint32_t           height   = 0;
+      PixelFormat        format   = PixelFormat::None;
+      size_t             rowPitch = 0;
+      Dds::AlignedBuffer pixels;
+
+      [[nodiscard]] bool Ok() const {
+        return pixels.Data() != nullptr;
+      }
+    };
+
+    // 0 uses std::thread::hardware_concurrency()
+    explicit Decoder(size_t t_workerCount = 0);
+
+    // t_slice picks the layer (array element * faceCount + face) or, for volumes, the depth slice.
+    // returns an empty IMAGE for formats without a decoder or out of range levels, the reason goes to the
+    // log hook (dds/Result.h)
+    [[nodiscard]] IMAGE Decode(const LoadDds::DDS_FILE& t_ddsFile, size_t t_mip, size_t t_slice = 0);
+    // decodes into caller owned memory, t_destination needs t_rowPitch * (height - 1) + width * pixel size bytes
+    bool Decode(const LoadDds::DDS_FILE& t_ddsFile,
+                size_t                   t_mip,
+                size_t                   t_slice,
+                std::span<std::byte>     t_destination,
+                size_t                   t_rowPitch);
+
+    // decodes one surface of tightly packed blocks on the calling thread
+    static bool DecodeSurface(Format           t_format,
+                              const std::byte* t_blocks,
+                              uint32_t         t_width,
+                              uint32_t         t_height,
+                              std::byte*       t_destination,
+                              size_t           t_rowPitch);
+
+    [[nodiscard]] size_t WorkerCount() const {
+      return m_pool.ThreadCount();
+    }
+
+    // smallest level, in blocks, worth splitting across workers
+    static constexpr size_t PARALLEL_BLOCKS = 4096;
+
+  private:
+    ThreadPool m_pool;
+  };
+}
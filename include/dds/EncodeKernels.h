@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+
+#include "dds/DDSLoader.h"
+
+namespace Dds
+{
+  // Encodes t_blockCount 4x4 tiles of RGBA8 texels, laid out the way DecodeKernel writes them (one
+  // row-major tile of 16 texels per block, back to back), into blocks
+  using EncodeKernel = void (*)(const std::byte* t_tiles, size_t t_blockCount, std::byte* t_blocks);
+
+  // Picks the encoder for a texture's format, nullptr for formats without one (BC6H, BC4/BC5 signed,
+  // uncompressed). The encoders favour speed: BC1-BC3 colour and BC7 fit one line through the block's
+  // principal axis, BC7 always writes mode 6 blocks, and decoding a block gives back the input within
+  // the format's precision for smooth content
+  [[nodiscard]] EncodeKernel SelectEncodeKernel(Format t_format);
+}
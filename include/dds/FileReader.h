@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Dds
+{
+  // Read-only file handle doing positioned reads (pread / overlapped ReadFile), so any byte range can
+  // be fetched without seeking and from several threads at once
+  class FileReader
+  {
+  public:
+    FileReader() = default;
+    ~FileReader();
+    FileReader(FileReader&& t_other) noexcept;
+    FileReader(const FileReader& t_other) = delete;
+    FileReader& operator=(FileReader&& t_other) noexcept;
+    FileReader& operator=(const FileReader&) = delete;
+
+    // returns false if the file could not be opened
+    bool Open(const char* t_path);
+    void Close();
+
+    // fills t_destination from t_offset, returns false on error or if the file ends first
+    bool ReadAt(uint64_t t_offset, std::span<std::byte> t_destination) const;
+
+    [[nodiscard]] uint64_t Size() const {
+      return m_size;
+    }
+
+    [[nodiscard]] bool IsOpen() const {
+      return m_handle != INVALID;
+    }
+
+    // native descriptor (int fd on POSIX, HANDLE on Windows) for async backends
+    [[nodiscard]] intptr_t NativeHandle() const {
+      return m_handle;
+    }
+
+  private:
+    static constexpr intptr_t INVALID = -1;
+
+    intptr_t m_handle = INVALID;
+    uint64_t m_size   = 0;
+  };
+}
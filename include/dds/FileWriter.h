@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace Dds
+{
+  // Write-only file handle doing gather writes (writev / WriteFile per buffer), so a file made of a
+  // header and many separately stored pieces goes out without being assembled in memory first.
+  // The data goes to a temporary file next to the target, which Commit renames over it in one step, so
+  // a failed or abandoned write never touches an existing file (even one the data is mapped from)
+  class FileWriter
+  {
+  public:
+    FileWriter() = default;
+    ~FileWriter();
+    FileWriter(FileWriter&& t_other) noexcept;
+    FileWriter(const FileWriter& t_other) = delete;
+    FileWriter& operator=(FileWriter&& t_other) noexcept;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    // creates the temporary file for t_path, returns false if it could not be created
+    bool Open(const char* t_path);
+    // closes the file and renames it over t_path. returns false if the data did not reach the OS (e.g. a
+    // full disk) or the rename failed, the temporary file is removed and t_path is left as it was
+    bool Commit();
+    // closes and removes the temporary file, t_path is left as it was. the destructor does this too
+    void Discard();
+
+    // appends every buffer in order, returns false on error
+    bool Write(std::span<const std::span<const std::byte>> t_buffers);
+
+    [[nodiscard]] bool IsOpen() const {
+      return m_handle != INVALID;
+    }
+
+  private:
+    static constexpr intptr_t INVALID = -1;
+
+    bool Close();
+
+    intptr_t    m_handle = INVALID;
+    std::string m_path;
+    std::string m_temporary;
+  };
+}
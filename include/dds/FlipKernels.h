@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "dds/Formats.h"
+
+namespace Dds
+{
+  // Flips the texels inside every block of a tightly packed run of t_blockCount blocks vertically.
+  // t_source and t_destination are either the same pointer or do not overlap
+  using FlipKernel = void (*)(const std::byte* t_source, std::byte* t_destination, size_t t_blockCount);
+
+  // Picks the kernel for a texture's format once, so the per-block loop carries no format checks.
+  // t_rows is how many texel rows at the top of each block belong to the image: a level shorter than
+  // a block only mirrors those and leaves the padding rows below them alone.
+  // Returns nullptr for formats that are left untouched by flipping (FlipLayout::None)
+  [[nodiscard]] FlipKernel SelectFlipKernel(const FORMAT_INFO& t_format, uint8_t t_rows = 4);
+
+  // Mirrors a t_width x t_height surface texel by texel: decodes all of it, gathers every new 4x4 tile
+  // from the mirrored rows (padding texels repeat the nearest texel of the image, as the encoders
+  // expect) and encodes the tiles again. Works in place. false, leaving t_destination alone, when
+  // CanFlipTexels is false for the format
+  bool FlipTexels(const FORMAT_INFO& t_format,
+                  const std::byte*   t_source,
+                  std::byte*         t_destination,
+                  uint32_t           t_width,
+                  uint32_t           t_height);
+  // true if t_format has an RGBA8 decoder and encoder pair, so FlipTexels can mirror it
+  [[nodiscard]] bool CanFlipTexels(const FORMAT_INFO& t_format);
+
+  // Flips a t_width x t_height surface of t_format: the texels inside each block and the order of the
+  // block rows. Works in place when t_source == t_destination, otherwise it doubles as the copy into
+  // t_destination. A surface taller than one block row whose height is not a multiple of the block
+  // height cannot be mirrored block by block, its last block row is partly padding. With t_reencode
+  // such surfaces go through FlipTexels where the format has an encoder (so they are not bit exact),
+  // otherwise their block rows are reversed whole and the padding rows end up at the top.
+  // Formats without a kernel are copied unchanged
+  void FlipSurface(const FORMAT_INFO& t_format,
+                   const std::byte*   t_source,
+                   std::byte*         t_destination,
+                   uint32_t           t_width,
+                   uint32_t           t_height,
+                   bool               t_reencode = false);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+#include "dds/DDSLoader.h"
+
+namespace Dds
+{
+  // what flipping a surface has to do besides reversing its block rows
+  enum class FlipLayout : uint8_t
+  {
+    None, // texel rows inside a block cannot be reordered (BC6H), the surface is left as stored
+    Rows, // uncompressed, a block is a single pixel so reversing the rows is all there is
+    BC1,
+    BC2,
+    BC3,
+    BC4,
+    BC5,
+    BC7
+  };
+
+  // Everything the loader needs to know about a Format. Uncompressed formats are 1x1 blocks of
+  // blockBytes, so the same size math covers both
+  struct FORMAT_INFO
+  {
+    Format      format      = Format::Unknown;
+    const char* name        = "Unknown";
+    uint8_t     blockWidth  = 1;
+    uint8_t     blockHeight = 1;
+    uint8_t     blockBytes  = 0; // bytes per block, per pixel for uncompressed formats
+    Flag        flag        = Flag::None;
+    FlipLayout  flip        = FlipLayout::None;
+    // GL internal format, its sRGB counterpart (0 if there is none), and for uncompressed formats the
+    // format/type pair glTexImage wants for the stored bytes
+    uint32_t glInternalFormat     = 0;
+    uint32_t glSrgbInternalFormat = 0;
+    uint32_t glPixelFormat        = 0;
+    uint32_t glPixelType          = 0;
+
+    [[nodiscard]] constexpr bool Compressed() const {
+      return blockWidth > 1;
+    }
+
+    [[nodiscard]] constexpr size_t SurfaceSize(const uint32_t t_width, const uint32_t t_height) const {
+      const size_t blocksWide = (static_cast<size_t>(t_width) + blockWidth - 1) / blockWidth;
+      const size_t blocksHigh = (static_cast<size_t>(t_height) + blockHeight - 1) / blockHeight;
+      return blocksWide * blocksHigh * blockBytes;
+    }
+  };
+
+  // t_format must be a real format (not Format::Count)
+  [[nodiscard]] const FORMAT_INFO& GetFormatInfo(Format t_format);
+
+  // Lookups used by the header parser, nullptr when the file's format is not supported.
+  // t_srgb is set for the _SRGB DXGI variants
+  [[nodiscard]] const FORMAT_INFO* FindDxgiFormat(uint32_t t_dxgiFormat, bool& t_srgb);
+  // legacy FourCC codes ('DXT1', 'ATI2', ...) and the D3DFMT numbers files store for float formats
+  [[nodiscard]] const FORMAT_INFO* FindFourCC(uint32_t t_fourCC);
+  // legacy RGB / luminance / alpha bit mask pixel formats
+  [[nodiscard]] const FORMAT_INFO* FindPixelMasks(const LoadDds::DDS_PIXELFORMAT& t_pixelFormat);
+
+  // the DXGI_FORMAT writers should store for t_format (the _SRGB variant when t_srgb is set), 0
+  // (DXGI_FORMAT_UNKNOWN) for formats that only exist in legacy headers
+  [[nodiscard]] uint32_t GetDxgiFormat(Format t_format, bool t_srgb = false);
+  // fills the flags, bit count and masks of a legacy header for t_format, false if it has no mask layout
+  bool GetPixelMasks(Format t_format, LoadDds::DDS_PIXELFORMAT& t_pixelFormat);
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Dds
+{
+  // XXH64 of t_data. Used for cache keys that end up on disk, so the function must never change;
+  // runs at memory bandwidth on large payloads
+  [[nodiscard]] uint64_t Hash64(std::span<const std::byte> t_data, uint64_t t_seed = 0);
+}
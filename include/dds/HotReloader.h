@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "dds/DDSLoader.h"
+#include "dds/Result.h"
+
+namespace Dds
+{
+  struct WATCH_OPTIONS
+  {
+    LoadOptions               load;                 // storage is ignored, reloaded textures are on the heap
+    bool                      forcePolling = false; // scan the directories even where inotify works
+    std::chrono::milliseconds pollInterval{250};    // time between scans of the polling backend
+    std::chrono::milliseconds settleTime{20};       // inotify: quiet time that ends a burst of events
+  };
+
+  // Keeps the DDS files of watched directories loaded and current for editors and tools. On Linux an
+  // inotify watch reports files that were written and closed or renamed into place; a burst of events is
+  // collected until settleTime passes without one, so a save that touches a file several times reloads
+  // it once. Where inotify is missing (Windows) or fails, a background thread compares the size and
+  // write time of every file each pollInterval instead.
+  //
+  // A changed file is read once and hashed. A save that left the file as it was is dropped there. When
+  // the headers are unchanged only the levels whose bytes hash differently are loaded, the others are
+  // copied from the texture already published; anything else is a full load. The new texture is
+  // published with an atomic swap, readers holding the previous one keep it alive until they let go
+  class HotReloader
+  {
+  public:
+    using TexturePtr = std::shared_ptr<const LoadDds::DDS_FILE>;
+
+    enum class Backend : uint8_t
+    {
+      Inotify,
+      Polling
+    };
+
+    struct RELOAD
+    {
+      std::string path;
+      TexturePtr  texture;               // the texture now published for path
+      uint32_t    changedMips   = 0;     // bit per mipMaps index whose payload changed, 0 for a no-op save
+      bool        layoutChanged = false; // the headers changed (or the file is new), every level was loaded
+    };
+
+    // runs on the thread that reloaded the texture, for every reload that published a new texture
+    using ReloadFn = std::function<void(const RELOAD& t_reload)>;
+
+    explicit HotReloader(ReloadFn t_onReload = {}, const WATCH_OPTIONS& t_options = {});
+    // stops the watch thread, published textures stay valid for whoever holds them
+    ~HotReloader();
+    HotReloader(HotReloader&& t_other)            = delete;
+    HotReloader(const HotReloader& t_other)       = delete;
+    HotReloader& operator=(HotReloader&& t_other) = delete;
+    HotReloader& operator=(const HotReloader&)    = delete;
+
+    // loads every .dds file directly inside t_directory and watches it for changes from then on. files
+    // that fail to load are logged and picked up again when they change. the initial loads do not run
+    // the reload hook
+    STATUS Watch(const std::string& t_directory);
+    // the texture published for t_path (a watched directory joined with the file name), nullptr if it
+    // never loaded
+    [[nodiscard]] TexturePtr Get(const std::string& t_path) const;
+    // checks t_path now on the calling thread, the same way a change event does
+    Result<RELOAD> Reload(const std::string& t_path);
+
+    [[nodiscard]] Backend ActiveBackend() const {
+      return m_inotify >= 0 ? Backend::Inotify : Backend::Polling;
+    }
+
+  private:
+    struct ENTRY
+    {
+      std::atomic<TexturePtr> texture;
+      // what the published texture was loaded from, only touched under m_reloadMutex
+      uint64_t               fileHash = 0;
+      std::vector<std::byte> headers;     // magic, DDS_HEADER and DDS_HEADER_DXT10 as stored
+      std::vector<uint64_t>  levelHashes; // XXH64 of every level across its layers
+    };
+
+    // last size and write time the polling backend saw
+    struct STAMP
+    {
+      uint64_t size      = 0;
+      int64_t  writeTime = 0;
+
+      bool operator==(const STAMP&) const = default;
+    };
+
+    struct DIRECTORY
+    {
+      std::string                            path;
+      int                                    watch = -1; // inotify watch descriptor
+      std::unordered_map<std::string, STAMP> stamps;
+    };
+
+    static STAMP StampOf(const std::filesystem::path& t_path);
+
+    STATUS ReloadImpl(const std::string& t_path, RELOAD& t_reload);
+    ENTRY& FindOrAdd(const std::string& t_path);
+    void   WatchLoop();
+    // inotify: blocks until events arrive (or the reloader stops), then collects them until settleTime
+    void WaitForEvents(std::unordered_set<std::string>& t_changed);
+    // polling: every file of every directory whose stamp differs from the last scan
+    void Scan(std::unordered_set<std::string>& t_changed);
+
+    ReloadFn      m_onReload;
+    WATCH_OPTIONS m_options;
+
+    mutable std::shared_mutex                               m_entriesMutex;
+    std::unordered_map<std::string, std::unique_ptr<ENTRY>> m_entries;
+    std::mutex                                              m_reloadMutex; // one reload at a time
+
+    std::mutex              m_directoriesMutex;
+    std::vector<DIRECTORY>  m_directories;
+    int                     m_inotify = -1;
+    int                     m_wakeFd  = -1; // eventfd that interrupts the inotify wait on shutdown
+    std::condition_variable m_wake;
+    std::atomic<bool>       m_stop = false;
+    std::thread             m_thread;
+  };
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+
+namespace Dds
+{
+  // In-tree LZ codec writing the LZ4 block format (greedy matching, 64KB window), the fallback for
+  // compressed DDS containers when zstd is not available. Decoding is bounds checked throughout, so a
+  // corrupt block fails instead of reading or writing outside the spans
+
+  // largest block LzCompress can produce for t_size input bytes
+  [[nodiscard]] constexpr size_t LzCompressBound(const size_t t_size) {
+    return t_size + t_size / 255 + 16;
+  }
+
+  // returns the size of the block written to t_destination, 0 if it did not fit
+  [[nodiscard]] size_t LzCompress(std::span<const std::byte> t_source, std::span<std::byte> t_destination);
+  // decodes t_source, which must fill t_destination exactly. false on malformed input
+  [[nodiscard]] bool LzDecompress(std::span<const std::byte> t_source, std::span<std::byte> t_destination);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Dds
+{
+  // Whole file mapped into the address space. Pages are mapped copy-on-write, so writing through
+  // Data() (e.g. flipping on load) never reaches the file on disk.
+  class MappedFile
+  {
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(MappedFile&& t_other) noexcept;
+    MappedFile(const MappedFile& t_other) = delete;
+    MappedFile& operator=(MappedFile&& t_other) noexcept;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // returns false if the file could not be opened, is empty or could not be mapped
+    bool Open(const char* t_path);
+    void Close();
+
+    [[nodiscard]] std::byte* Data() const {
+      return m_data;
+    }
+
+    [[nodiscard]] size_t Size() const {
+      return m_size;
+    }
+
+    [[nodiscard]] bool IsOpen() const {
+      return m_data != nullptr;
+    }
+
+  private:
+    std::byte* m_data = nullptr;
+    size_t     m_size = 0;
+  };
+}
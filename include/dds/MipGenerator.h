@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include "dds/DDSLoader.h"
+#include "dds/Result.h"
+#include "dds/ThreadPool.h"
+
+namespace Dds
+{
+  struct MIP_OPTIONS
+  {
+    uint32_t mipCount = UINT32_MAX; // levels of the result including the top one, clamped to the full chain
+  };
+
+  // Ingest-time mip chain generation for textures stored with only their top level (or a short chain).
+  // The top level of every layer is decoded, filtered down one level at a time with a 2x2 box filter in
+  // linear light (sRGB formats are linearised first, alpha and non-colour formats are filtered as stored)
+  // and every new level is encoded back to the texture's own format. The top level is kept as it was,
+  // bit for bit. Each stage splits its rows into bands that run on the generator's ThreadPool.
+  //
+  // Handles BC1-BC3, unsigned BC4/BC5, BC7 (re-encoded as mode 6) and RGBA8/BGRA8/BGRX8. BC6H, the signed
+  // formats, everything else uncompressed and volumes fail with NoEncoder
+  class MipGenerator
+  {
+  public:
+    // 0 uses std::thread::hardware_concurrency()
+    explicit MipGenerator(size_t t_workerCount = 0);
+
+    // a new texture with the levels below t_ddsFile's top level rebuilt, on the heap and ready for
+    // SaveDds. t_ddsFile is only read. must not be called from a task running on this generator's pool
+    [[nodiscard]] Result<LoadDds::DDS_FILE> Generate(const LoadDds::DDS_FILE& t_ddsFile, const MIP_OPTIONS& t_options = {});
+
+    // levels of a complete chain down to 1x1
+    [[nodiscard]] static uint32_t FullMipCount(uint32_t t_width, uint32_t t_height);
+
+    [[nodiscard]] size_t WorkerCount() const {
+      return m_pool.ThreadCount();
+    }
+
+    // smallest level, in pixels, worth splitting across workers
+    static constexpr size_t PARALLEL_PIXELS = 64 * 1024;
+
+  private:
+    STATUS GenerateImpl(LoadDds::DDS_FILE& t_result, const LoadDds::DDS_FILE& t_ddsFile, const MIP_OPTIONS& t_options);
+    // runs t_work over [0, t_rows) in bands, on the pool when t_pixels is at least PARALLEL_PIXELS
+    void ForEachBand(size_t t_rows, size_t t_pixels, const std::function<void(size_t t_begin, size_t t_end)>& t_work);
+
+    ThreadPool m_pool;
+  };
+}
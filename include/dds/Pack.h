@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "dds/DDSLoader.h"
+#include "dds/MappedFile.h"
+#include "dds/Result.h"
+
+/*
+ Pack File Structure (native byte order, every offset from the start of the pack):
+  Section          Length
+  //////////////////////////////////////////
+  PACK_HEADER      64
+  DDS files        each a complete .dds, placed so its mip chain starts PAYLOAD_ALIGNMENT aligned
+  PACK_ENTRY[]     entryCount * 32, sorted by name hash, then name
+  fan-out          (2^fanOutBits + 1) * 4, entries whose hash starts with the bucket's top bits are
+                   [fanOut[bucket], fanOut[bucket + 1])
+  names            every entry name back to back, not terminated
+*/
+
+namespace Dds
+{
+  // Writes many DDS files into one pack. Sources are probed when added and read again, one at a time,
+  // when the pack is written, so building a pack never holds more than one texture in memory
+  class PackBuilder
+  {
+  public:
+    // queues t_path under t_name (the name PackReader::Find takes, e.g. a path relative to the asset
+    // root). fails if the file does not probe cleanly
+    STATUS Add(std::string t_name, const char* t_path);
+    // fails with DuplicateName if two sources share a name and LayoutMismatch if a source changed size
+    // since it was added. a failed write leaves an existing t_path as it was
+    STATUS Write(const char* t_path) const;
+
+    [[nodiscard]] size_t Count() const {
+      return m_sources.size();
+    }
+
+  private:
+    struct SOURCE
+    {
+      std::string name;
+      std::string path;
+      uint64_t    hash          = 0;
+      uint64_t    size          = 0;
+      uint64_t    payloadOffset = 0;
+    };
+
+    std::vector<SOURCE> m_sources;
+  };
+
+  // Read side of a pack: the whole pack is mapped once and textures are parsed out of the mapping, so a
+  // load does no system calls. Lookups by name hash into a fan-out table and compare a handful of index
+  // entries at most, lookups by ID are a plain index
+  class PackReader
+  {
+  public:
+    static constexpr uint32_t INVALID_ID = UINT32_MAX;
+
+    // fails on anything that is not a complete pack of this version, the index is checked once here
+    STATUS Open(const char* t_path);
+    void   Close();
+
+    // ID of t_name, INVALID_ID if the pack has no such entry. IDs are stable for a given pack file
+    [[nodiscard]] uint32_t Find(std::string_view t_name) const;
+    [[nodiscard]] uint32_t Count() const {
+      return m_entryCount;
+    }
+    [[nodiscard]] std::string_view Name(uint32_t t_id) const;
+
+    // Storage::Mapped and Storage::Borrowed both point the mip chain into the pack mapping, which must
+    // outlive the DDS_FILE. like any borrowed load that only holds for single layer textures loaded
+    // without flipping, everything else is copied to the heap
+    [[nodiscard]] Result<LoadDds::DDS_FILE> Load(uint32_t t_id, const LoadOptions& t_options = {}) const;
+    [[nodiscard]] Result<LoadDds::DDS_FILE> Load(std::string_view t_name, const LoadOptions& t_options = {}) const;
+    // the complete DDS file of t_id inside the pack, empty for an invalid ID
+    [[nodiscard]] std::span<const std::byte> FileData(uint32_t t_id) const;
+
+  private:
+    MappedFile       m_mapping;
+    const std::byte* m_entries    = nullptr;
+    const std::byte* m_fanOut     = nullptr;
+    const std::byte* m_names      = nullptr;
+    uint32_t         m_entryCount = 0;
+    uint32_t         m_fanOutBits = 0;
+    std::string      m_path;
+  };
+}
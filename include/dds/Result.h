@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+namespace Dds
+{
+  // Why a load, probe, decode or save failed. Values are only ever appended so they can be stored or sent
+  // elsewhere as plain numbers
+  enum class Error : uint8_t
+  {
+    None,
+    OpenFailed,          // the file could not be opened or mapped
+    EmptyFile,           // the file is 0 bytes long
+    ReadFailed,          // the OS reported an I/O error, detail is the errno where the backend has one
+    ShortRead,           // the source ended before bytes the layout needs, detail is the file mip level
+    BadMagic,            // the data does not start with "DDS "
+    TruncatedHeader,     // the data ends inside DDS_HEADER or DDS_HEADER_DXT10
+    InvalidHeader,       // strict validation: header sizes, required flags, zero extent or mip count
+    InvalidMipCount,     // more levels than any 32-bit extent has
+    InvalidArraySize,    // more array elements than D3D allows
+    InvalidDimension,    // a volume texture that also claims to be an array or cubemap
+    UnsupportedFormat,   // detail is the DXGI_FORMAT of DX10 files, the FourCC (or 0) of legacy ones
+    TruncatedMip,        // the file is too short for a mip level, detail is the file mip level
+    TrailingData,        // strict validation: bytes after the mip chain
+    InvalidMipRange,     // the requested level (or slice) is not in the file or not loaded, detail is the level
+    UnsupportedStorage,  // Storage::Mapped for a texture that is already in memory
+    DestinationTooSmall, // caller provided memory cannot hold the payload
+    LayoutMismatch,      // streamed levels do not continue the loaded tail (the file changed)
+    OutOfMemory,         // the payload allocation failed
+    NoDecoder,           // Dds::Decoder has no kernel for the format, detail is the Dds::Format
+    WriteFailed,         // the output could not be created or written
+    NotFound,            // no entry with that name or ID in a pack
+    DuplicateName,       // a pack builder was given the same entry name twice
+    UnsupportedCodec,    // the container codec is not built in, detail is the Dds::Codec
+    CorruptChunk,        // a compressed chunk did not decode to its size, detail is the chunk index
+    InvalidRegion,       // a region outside its level, layer or slice, empty or not block aligned
+    NoEncoder,           // Dds::MipGenerator cannot re-encode the format (or a volume), detail is the Dds::Format
+    Count
+  };
+
+  struct STATUS
+  {
+    Error    error  = Error::None;
+    uint32_t detail = 0; // error specific value, see Error
+
+    [[nodiscard]] constexpr bool Ok() const {
+      return error == Error::None;
+    }
+  };
+
+  // static description of t_error, never allocates
+  [[nodiscard]] const char* ErrorMessage(Error t_error);
+
+  // std::expected-style result of a load (C++20 has none). The value is default constructed on failure,
+  // so a failed Result still hands out an empty DDS_FILE/DDS_INFO instead of dangling storage
+  template <typename T>
+  class Result
+  {
+  public:
+    Result(T&& t_value)
+      : m_value(std::move(t_value)) {}
+
+    Result(const STATUS t_status)
+      : m_status(t_status) {}
+
+    Result(const Error t_error, const uint32_t t_detail = 0)
+      : m_status{t_error, t_detail} {}
+
+    [[nodiscard]] bool Ok() const {
+      return m_status.Ok();
+    }
+
+    explicit operator bool() const {
+      return Ok();
+    }
+
+    [[nodiscard]] const STATUS& Status() const {
+      return m_status;
+    }
+
+    [[nodiscard]] T& Value() & {
+      assert(Ok());
+      return m_value;
+    }
+
+    [[nodiscard]] const T& Value() const & {
+      assert(Ok());
+      return m_value;
+    }
+
+    [[nodiscard]] T&& Value() && {
+      assert(Ok());
+      return std::move(m_value);
+    }
+
+    T& operator*() & {
+      return Value();
+    }
+
+    const T& operator*() const & {
+      return Value();
+    }
+
+    T&& operator*() && {
+      return std::move(*this).Value();
+    }
+
+    T* operator->() {
+      return &Value();
+    }
+
+    const T* operator->() const {
+      return &Value();
+    }
+
+  private:
+    T      m_value{};
+    STATUS m_status;
+  };
+
+  // Called once for every failed load, probe, stream-in, decode or save with the path of the file, or nullptr
+  // for in-memory and custom sources. Runs on the failing thread, so it has to be thread safe. No hook
+  // is installed by default: failures are only reported through the returned STATUS
+  using LogFn = void (*)(const STATUS& t_status, const char* t_source);
+
+  // installs t_hook (nullptr removes it) and returns the previous one
+  LogFn SetLogHook(LogFn t_hook);
+  // hands t_status to the installed hook, a single atomic load when there is none
+  void Log(const STATUS& t_status, const char* t_source);
+  // ready-made hook printing one line per failure to stderr
+  void LogToStderr(const STATUS& t_status, const char* t_source);
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "dds/DDSLoader.h"
+#include "dds/Result.h"
+
+// Opt-in load instrumentation, built with -DDDS_ENABLE_STATS=ON (which defines DDS_ENABLE_STATS for the
+// library and everything linking it). Without it every instrumentation point below is an empty inline
+// function and the loader carries no timing code at all; the query functions still exist and report
+// zeros so callers do not need their own #if.
+//
+// Every TextureLoadDds overload and StreamInMips is one load. Its stage times and byte counts are
+// collected on the loading thread and merged into a process wide total once, when the load returns, so
+// concurrent loads only share one short lock each. AsyncLoader's io_uring path does not go through
+// those entry points and is not counted, its synchronous fallback is.
+namespace Dds
+{
+#if defined(DDS_ENABLE_STATS)
+  inline constexpr bool STATS_ENABLED = true;
+#else
+  inline constexpr bool STATS_ENABLED = false;
+#endif
+
+  // where a load spends its time, in the order a load goes through them
+  enum class Stage : uint8_t
+  {
+    Open,     // opening or mapping the file
+    Parse,    // headers, layout and mip range
+    Allocate, // the payload allocation
+    Read,     // header and payload reads, including custom ReadAtFn sources
+    Copy,     // regrouping layers by level and moving a streamed tail
+    Flip,     // flipping, or copying formats that cannot be flipped
+    Count
+  };
+
+  struct STAGE_STATS
+  {
+    uint64_t calls       = 0;
+    uint64_t nanoseconds = 0;
+  };
+
+  struct FORMAT_STATS
+  {
+    uint64_t loads = 0;
+    uint64_t bytes = 0; // payload bytes of the successful loads
+  };
+
+  // counters of a single load (handed to the StatsFn) or the sum of all of them (GetLoadStats)
+  struct LOAD_STATS
+  {
+    uint64_t loads          = 0;
+    uint64_t failures       = 0;
+    uint64_t bytesRead      = 0; // from files and ReadAtFn sources
+    uint64_t bytesCopied    = 0; // memory to memory, flips that write to a separate destination included
+    uint64_t allocations    = 0; // payload buffers
+    uint64_t allocatedBytes = 0;
+
+    std::array<STAGE_STATS, static_cast<size_t>(Stage::Count)>   stages{};
+    std::array<FORMAT_STATS, static_cast<size_t>(Format::Count)> formats{};
+
+    LOAD_STATS& operator+=(const LOAD_STATS& t_other);
+  };
+
+  // Called once for every finished load with its own counters and the path of the file, or nullptr for
+  // in-memory and custom sources. Runs on the loading thread, so it has to be thread safe. Never called
+  // when stats are compiled out
+  using StatsFn = void (*)(const LOAD_STATS& t_load, const char* t_source);
+
+  // installs t_hook (nullptr removes it) and returns the previous one
+  StatsFn SetStatsHook(StatsFn t_hook);
+  // totals since start or the last reset
+  [[nodiscard]] LOAD_STATS GetLoadStats();
+  void                     ResetLoadStats();
+  // one JSON object, stages in Stage order and only the formats that were loaded, e.g.
+  // {"loads":1,...,"stages":{"open":{"calls":1,"ns":5200},...},"formats":{"BC7":{"loads":1,"bytes":4096}}}
+  [[nodiscard]] std::string LoadStatsToJson(const LOAD_STATS& t_stats);
+
+  // Instrumentation points used by the loader. They only record while a LoadScope is active on the
+  // calling thread
+#if defined(DDS_ENABLE_STATS)
+  // one load, from the entry point to its result
+  class LoadScope
+  {
+  public:
+    explicit LoadScope(const char* t_source);
+    ~LoadScope();
+    LoadScope(const LoadScope&)            = delete;
+    LoadScope& operator=(const LoadScope&) = delete;
+
+    // adds the load to the totals and hands it to the hook, t_bytes is the payload size on success
+    void Finish(const STATUS& t_status, Format t_format, size_t t_bytes);
+
+  private:
+    LOAD_STATS  m_stats;
+    const char* m_source;
+    LOAD_STATS* m_outer;
+  };
+
+  // times one pass through a stage
+  class StageTimer
+  {
+  public:
+    explicit StageTimer(const Stage t_stage)
+      : m_stage(t_stage),
+        m_start(std::chrono::steady_clock::now()) {}
+
+    ~StageTimer();
+    StageTimer(const StageTimer&)            = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+  private:
+    Stage                                 m_stage;
+    std::chrono::steady_clock::time_point m_start;
+  };
+
+  void CountBytesRead(size_t t_bytes);
+  void CountBytesCopied(size_t t_bytes);
+  void CountAllocation(size_t t_bytes);
+#else
+  class LoadScope
+  {
+  public:
+    explicit LoadScope(const char*) {}
+
+    void Finish(const STATUS&, Format, size_t) {}
+  };
+
+  class StageTimer
+  {
+  public:
+    explicit StageTimer(Stage) {}
+  };
+
+  inline void CountBytesRead(size_t) {}
+  inline void CountBytesCopied(size_t) {}
+  inline void CountAllocation(size_t) {}
+#endif
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "dds/DDSLoader.h"
+#include "dds/Result.h"
+
+namespace Dds
+{
+  // Two level cache of processed textures. The disk level stores every texture already flipped, trimmed
+  // to its mip range and laid out level-major, behind a compact header, in a file named after an XXH64
+  // of the source DDS and the load options that change the payload. A disk hit is a single mapping of
+  // that file with no parsing, copying or flipping. The memory level keeps recently used textures up to
+  // a byte budget of payload and hands out shared references, so a hit there does no I/O at all.
+  //
+  // Sources are only hashed when their size or modification time changed since this cache, or an
+  // earlier one on the same directory, last saw them: the stamps are kept in an index file next to the
+  // entries, loaded when the cache is created and written once by Flush or the destructor. Cache files
+  // and the index are written to a temporary name and renamed into place, so several processes may
+  // share a directory. Entries are never deleted, remove the directory to trim it. Cache files are in
+  // native byte order and not meant to be shipped to other machines.
+  class TextureCache
+  {
+  public:
+    using TexturePtr = std::shared_ptr<const LoadDds::DDS_FILE>;
+
+    struct STATS
+    {
+      size_t memoryHits  = 0;
+      size_t diskHits    = 0;
+      size_t misses      = 0; // loaded from the source and written to disk
+      size_t hashes      = 0; // sources read to hash them, stamps of earlier runs spare these
+      size_t memoryBytes = 0; // payload bytes held by the memory level
+    };
+
+    // t_directory is created on the first write, a t_memoryBudget of 0 disables the memory level. reads
+    // the stamps index of t_directory, a missing or damaged one only means sources are hashed again
+    TextureCache(std::filesystem::path t_directory, size_t t_memoryBudget);
+    // flushes the stamps
+    ~TextureCache();
+
+    // LoadOptions::storage is ignored, disk hits are mapped (copy-on-write) and misses are on the heap.
+    // failures are the loader's, a cache that cannot be written only costs the next launch a miss
+    [[nodiscard]] Result<TexturePtr> Load(const char* t_path, const LoadOptions& t_options = {});
+    // drops the memory level, textures still referenced by callers stay alive until released
+    void Clear();
+    // writes the stamps of the sources hashed since the last flush to the index, merged with what other
+    // caches on the directory wrote meanwhile. does nothing when no source was hashed
+    void Flush();
+    [[nodiscard]] STATS Stats() const;
+
+    // cache file name of a source hash and options, exposed for tools that pre-populate a cache
+    [[nodiscard]] static std::string EntryName(uint64_t t_sourceHash, const LoadOptions& t_options);
+
+  private:
+    struct KEY
+    {
+      uint64_t sourceHash = 0;
+      uint64_t options    = 0;
+
+      bool operator==(const KEY&) const = default;
+    };
+
+    struct KEY_HASH
+    {
+      size_t operator()(const KEY& t_key) const {
+        return static_cast<size_t>(t_key.sourceHash ^ (t_key.options * 0x9E3779B97F4A7C15ull));
+      }
+    };
+
+    // last size and write time a source was hashed at
+    struct STAMP
+    {
+      uint64_t size      = 0;
+      int64_t  writeTime = 0;
+      uint64_t hash      = 0;
+    };
+
+    struct ENTRY
+    {
+      TexturePtr               texture;
+      size_t                   bytes = 0;
+      std::list<KEY>::iterator use; // position in m_lru
+    };
+
+    static uint64_t OptionsKey(const LoadOptions& t_options);
+    static STATUS   ReadEntry(const std::filesystem::path& t_path, const KEY& t_key, LoadDds::DDS_FILE& t_ddsFile);
+    static bool     WriteEntry(const std::filesystem::path& t_path, const KEY& t_key, const LoadDds::DDS_FILE& t_ddsFile);
+
+    // merges the stamps index into m_stamps, keeping the stamps already there
+    void ReadStamps();
+
+    TexturePtr FindInMemory(const KEY& t_key);
+    void       Remember(const KEY& t_key, const TexturePtr& t_texture);
+
+    std::filesystem::path m_directory;
+    size_t                m_memoryBudget;
+
+    mutable std::mutex                       m_mutex;
+    std::unordered_map<std::string, STAMP>   m_stamps; // by absolute source path
+    bool                                     m_stampsDirty = false; // hashed a source since the last Flush
+    std::unordered_map<KEY, ENTRY, KEY_HASH> m_entries;
+    std::list<KEY>                           m_lru; // most recently used first
+    STATS                                    m_stats;
+  };
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Dds
+{
+  // Fixed size work-stealing pool. Every worker owns a deque, tasks submitted from outside are spread
+  // round-robin, tasks submitted from a worker go to its own deque. Idle workers steal from the back of
+  // other deques, so one long task never holds up the work queued behind it.
+  class ThreadPool
+  {
+  public:
+    // 0 uses std::thread::hardware_concurrency()
+    explicit ThreadPool(size_t t_threadCount = 0);
+    // finishes all queued tasks, then joins
+    ~ThreadPool();
+    ThreadPool(ThreadPool&& t_other)            = delete;
+    ThreadPool(const ThreadPool& t_other)       = delete;
+    ThreadPool& operator=(ThreadPool&& t_other) = delete;
+    ThreadPool& operator=(const ThreadPool&)    = delete;
+
+    // tasks must not throw
+    void Submit(std::function<void()> t_task);
+    // blocks until every task submitted so far has finished. must not be called from a worker
+    void Wait();
+
+    [[nodiscard]] size_t ThreadCount() const {
+      return m_threads.size();
+    }
+
+  private:
+    struct WORKER_QUEUE
+    {
+      std::mutex                        mutex;
+      std::deque<std::function<void()>> tasks;
+    };
+
+    void WorkerLoop(size_t t_index);
+    bool TryPop(size_t t_index, std::function<void()>& t_task);
+
+    std::vector<std::unique_ptr<WORKER_QUEUE>> m_queues;
+    std::vector<std::thread>                   m_threads;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::atomic<size_t>     m_queued    = 0; // submitted, not yet picked up
+    std::atomic<size_t>     m_pending   = 0; // submitted, not yet finished
+    std::atomic<size_t>     m_nextQueue = 0;
+    bool                    m_stop      = false;
+  };
+}
@@ -0,0 +1,470 @@
+#include "dds/AsyncLoader.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "dds/FileReader.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define DDS_HAS_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  // payload reads are split so a large atlas becomes many reads in flight instead of one long one
+  constexpr size_t CHUNK_SIZE = 1u << 20;
+}
+
+struct Dds::AsyncLoader::REQUEST
+{
+  // one outstanding read into the header scratch or the payload buffer
+  struct READ
+  {
+    REQUEST*             request = nullptr;
+    uint64_t             offset  = 0;
+    std::span<std::byte> destination;
+    uint32_t             mip     = 0; // file level the bytes belong to, for error reports
+  };
+
+  size_t            index = 0;
+  std::string       path;
+  LoadOptions       options;
+  CompletionFn      onComplete;
+  FileReader        file;
+  LoadDds::DDS_FILE ddsFile;
+  STATUS            status;
+
+  std::byte         header[4 + sizeof(LoadDds::DDS_HEADER) + sizeof(LoadDds::DDS_HEADER_DXT10)];
+  bool              headerDone = false;
+  std::vector<READ> reads;
+  size_t            outstanding = 0;
+};
+
+#if defined(DDS_HAS_IO_URING)
+// Minimal io_uring wrapper on the raw syscalls, no liburing needed. Only the I/O thread touches it.
+struct Dds::AsyncLoader::RING
+{
+  int      fd = -1;
+  uint32_t entries = 0;
+
+  void*  sqRing  = nullptr;
+  void*  cqRing  = nullptr;
+  size_t sqSize  = 0;
+  size_t cqSize  = 0;
+  bool   single  = false;
+
+  io_uring_sqe* sqes     = nullptr;
+  size_t        sqesSize = 0;
+
+  uint32_t* sqHead  = nullptr;
+  uint32_t* sqTail  = nullptr;
+  uint32_t* sqMask  = nullptr;
+  uint32_t* sqArray = nullptr;
+
+  uint32_t*     cqHead = nullptr;
+  uint32_t*     cqTail = nullptr;
+  uint32_t*     cqMask = nullptr;
+  io_uring_cqe* cqes   = nullptr;
+
+  uint32_t unsubmitted = 0;
+
+  ~RING() {
+    if (sqes) {
+      ::munmap(sqes, sqesSize);
+    }
+    if (cqRing && !single) {
+      ::munmap(cqRing, cqSize);
+    }
+    if (sqRing) {
+      ::munmap(sqRing, sqSize);
+    }
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+
+  bool Setup(const uint32_t t_entries) {
+    io_uring_params params{};
+    fd = static_cast<int>(::syscall(__NR_io_uring_setup, t_entries, &params));
+    if (fd < 0) {
+      return false;
+    }
+
+    entries = params.sq_entries;
+    sqSize  = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    cqSize  = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    single  = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single) {
+      sqSize = cqSize = std::max(sqSize, cqSize);
+    }
+
+    sqRing = ::mmap(nullptr, sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (sqRing == MAP_FAILED) {
+      sqRing = nullptr;
+      return false;
+    }
+
+    if (single) {
+      cqRing = sqRing;
+    }
+    else {
+      cqRing = ::mmap(nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+      if (cqRing == MAP_FAILED) {
+        cqRing = nullptr;
+        return false;
+      }
+    }
+
+    sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void* sqeMap = ::mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqeMap == MAP_FAILED) {
+      return false;
+    }
+    sqes = static_cast<io_uring_sqe*>(sqeMap);
+
+    auto* sq = static_cast<std::byte*>(sqRing);
+    sqHead   = reinterpret_cast<uint32_t*>(sq + params.sq_off.head);
+    sqTail   = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+    sqMask   = reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+    sqArray  = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+    auto* cq = static_cast<std::byte*>(cqRing);
+    cqHead   = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+    cqTail   = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+    cqMask   = reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+    cqes     = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    return SupportsRead();
+  }
+
+  // IORING_OP_READ needs Linux 5.6. Older kernels set the ring up fine and then fail every read with
+  // EINVAL, so ask for the opcode. The probe itself arrived in 5.6 too, an error here means no READ
+  bool SupportsRead() const {
+    constexpr unsigned OP_COUNT = 256;
+    alignas(io_uring_probe) std::byte storage[sizeof(io_uring_probe) + OP_COUNT * sizeof(io_uring_probe_op)]{};
+    auto* probe = reinterpret_cast<io_uring_probe*>(storage);
+
+    if (::syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, OP_COUNT) < 0) {
+      return false;
+    }
+    return IORING_OP_READ <= probe->last_op && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED) != 0;
+  }
+
+  // queues a read, the caller keeps the number in flight at or below entries
+  void PrepareRead(const int t_fd, const REQUEST::READ* t_read) {
+    const uint32_t tail  = *sqTail;
+    const uint32_t index = tail & *sqMask;
+
+    io_uring_sqe& sqe = sqes[index];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode    = IORING_OP_READ;
+    sqe.fd        = t_fd;
+    sqe.off       = t_read->offset;
+    sqe.addr      = reinterpret_cast<uint64_t>(t_read->destination.data());
+    sqe.len       = static_cast<uint32_t>(t_read->destination.size());
+    sqe.user_data = reinterpret_cast<uint64_t>(t_read);
+
+    sqArray[index] = index;
+    std::atomic_ref(*sqTail).store(tail + 1, std::memory_order_release);
+    ++unsubmitted;
+  }
+
+  // submits everything prepared and optionally waits for at least one completion. failures are transient
+  // here (EINTR, EAGAIN, EBUSY), unsubmitted entries stay in the ring and go out with the next call
+  void Enter(const bool t_wait) {
+    const long result = ::syscall(__NR_io_uring_enter,
+                                  fd,
+                                  unsubmitted,
+                                  t_wait ? 1u : 0u,
+                                  IORING_ENTER_GETEVENTS,
+                                  nullptr,
+                                  0);
+    if (result > 0) {
+      unsubmitted -= std::min(unsubmitted, static_cast<uint32_t>(result));
+    }
+  }
+
+  template<typename Fn>
+  void Reap(Fn&& t_onCompletion) {
+    uint32_t       head = *cqHead;
+    const uint32_t tail = std::atomic_ref(*cqTail).load(std::memory_order_acquire);
+
+    for (; head != tail; ++head) {
+      const io_uring_cqe& cqe = cqes[head & *cqMask];
+      t_onCompletion(reinterpret_cast<REQUEST::READ*>(cqe.user_data), cqe.res);
+    }
+
+    std::atomic_ref(*cqHead).store(head, std::memory_order_release);
+  }
+};
+#else
+struct Dds::AsyncLoader::RING {};
+#endif
+
+Dds::AsyncLoader::AsyncLoader(const uint32_t t_queueDepth, const size_t t_workerCount)
+  : m_pool(t_workerCount) {
+#if defined(DDS_HAS_IO_URING)
+  auto ring = std::make_unique<RING>();
+  if (ring->Setup(std::max(1u, t_queueDepth))) {
+    m_ring     = std::move(ring);
+    m_ioThread = std::thread(&AsyncLoader::IoLoop, this);
+  }
+#else
+  (void)t_queueDepth;
+#endif
+}
+
+Dds::AsyncLoader::~AsyncLoader() {
+  Wait();
+
+  {
+    std::lock_guard lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+
+  if (m_ioThread.joinable()) {
+    m_ioThread.join();
+  }
+}
+
+void Dds::AsyncLoader::Load(const std::span<const std::string> t_paths,
+                            CompletionFn                       t_onComplete,
+                            const LoadOptions&                 t_options) {
+  for (size_t i = 0; i < t_paths.size(); ++i) {
+    auto request        = std::make_unique<REQUEST>();
+    request->index      = i;
+    request->path       = t_paths[i];
+    request->options    = t_options;
+    request->onComplete = t_onComplete;
+    Enqueue(std::move(request));
+  }
+}
+
+std::future<Dds::AsyncLoader::RESULT> Dds::AsyncLoader::Load(const std::string& t_path, const LoadOptions& t_options) {
+  auto promise = std::make_shared<std::promise<RESULT>>();
+  auto future  = promise->get_future();
+
+  auto request        = std::make_unique<REQUEST>();
+  request->path       = t_path;
+  request->options    = t_options;
+  request->onComplete = [promise] (size_t, RESULT&& t_result) { promise->set_value(std::move(t_result)); };
+  Enqueue(std::move(request));
+
+  return future;
+}
+
+void Dds::AsyncLoader::Wait() {
+  std::unique_lock lock(m_mutex);
+  m_idle.wait(lock, [this] { return m_pending == 0; });
+}
+
+void Dds::AsyncLoader::Enqueue(std::unique_ptr<REQUEST> t_request) {
+  {
+    std::lock_guard lock(m_mutex);
+    ++m_pending;
+  }
+
+  // mapping is not I/O, and without a ring everything goes through positioned reads on the pool
+  if (!m_ring || t_request->options.storage == Storage::Mapped) {
+    m_pool.Submit([this, request = t_request.release()]
+    {
+      Result<LoadDds::DDS_FILE> loaded = LoadDds::TextureLoadDds(request->path.c_str(), request->options);
+      request->status                  = loaded.Status();
+      if (loaded) {
+        request->ddsFile = *std::move(loaded);
+      }
+      Complete(request);
+    });
+    return;
+  }
+
+  {
+    std::lock_guard lock(m_mutex);
+    m_incoming.push_back(std::move(t_request));
+  }
+  m_wake.notify_one();
+}
+
+void Dds::AsyncLoader::Complete(REQUEST* t_request) {
+  std::unique_ptr<REQUEST> request(t_request);
+
+  RESULT result;
+  result.path   = std::move(request->path);
+  result.file   = std::move(request->ddsFile);
+  result.status = request->status;
+
+  if (!result.Ok()) {
+    result.file = {};
+  }
+
+  request->onComplete(request->index, std::move(result));
+  Finish();
+}
+
+void Dds::AsyncLoader::Finish() {
+  std::lock_guard lock(m_mutex);
+  if (--m_pending == 0) {
+    m_idle.notify_all();
+  }
+}
+
+void Dds::AsyncLoader::IoLoop() {
+#if defined(DDS_HAS_IO_URING)
+  RING&                      ring = *m_ring;
+  std::deque<REQUEST::READ*> queued; // waiting for a free submission slot
+  uint32_t                   inFlight = 0;
+
+  // parsing and flipping are CPU work, keep them off the I/O thread
+  auto fail = [this] (REQUEST* t_request, const STATUS t_status)
+  {
+    t_request->status = t_status;
+    Log(t_status, t_request->path.c_str());
+    m_pool.Submit([this, t_request] { Complete(t_request); });
+  };
+
+  auto finishPayload = [this] (REQUEST* t_request)
+  {
+    m_pool.Submit([this, t_request]
+    {
+      if (t_request->options.flipVertical) {
+        LoadDds::Flip(t_request->ddsFile, t_request->options);
+      }
+      Complete(t_request);
+    });
+  };
+
+  auto startPayload = [&] (REQUEST* t_request)
+  {
+    try {
+      LoadDds::DDS_FILE& ddsFile = t_request->ddsFile;
+      const size_t headerBytes   = std::min<size_t>(t_request->file.Size(), sizeof(t_request->header));
+      const STATUS status        = LoadDds::ParseLayout(ddsFile,
+                                                        std::span(t_request->header, headerBytes),
+                                                        t_request->file.Size(),
+                                                        t_request->options);
+      if (!status.Ok()) {
+        fail(t_request, status);
+        return;
+      }
+
+      ddsFile.buffer = AlignedBuffer(ddsFile.totalSizeBytes, LoadDds::PAYLOAD_ALIGNMENT);
+      ddsFile.data   = {ddsFile.buffer.Data(), ddsFile.totalSizeBytes};
+
+      if (ddsFile.totalSizeBytes == 0) {
+        finishPayload(t_request);
+        return;
+      }
+
+      // one run for plain textures, one per layer and level for arrays, cubemaps and volumes
+      for (const LoadDds::PAYLOAD_RUN& run : LoadDds::PayloadRuns(ddsFile)) {
+        for (size_t offset = 0; offset < run.size; offset += CHUNK_SIZE) {
+          const size_t size = std::min(CHUNK_SIZE, run.size - offset);
+          t_request->reads.push_back({t_request, run.fileOffset + offset, ddsFile.data.subspan(run.offset + offset, size), run.mip});
+        }
+      }
+      t_request->outstanding = t_request->reads.size();
+      for (REQUEST::READ& read : t_request->reads) {
+        queued.push_back(&read);
+      }
+    }
+    catch (const std::bad_alloc&) {
+      fail(t_request, {Error::OutOfMemory});
+    }
+  };
+
+  while (true) {
+    std::deque<std::unique_ptr<REQUEST>> incoming;
+    {
+      std::unique_lock lock(m_mutex);
+      if (inFlight == 0 && queued.empty()) {
+        m_wake.wait(lock, [this] { return m_stop || !m_incoming.empty(); });
+        if (m_incoming.empty()) {
+          return; // stopping and nothing left
+        }
+      }
+      incoming.swap(m_incoming);
+    }
+
+    // open and queue the header read of every new file
+    for (std::unique_ptr<REQUEST>& owned : incoming) {
+      REQUEST* request = owned.release();
+      if (!request->file.Open(request->path.c_str())) {
+        fail(request, {Error::OpenFailed});
+        continue;
+      }
+      if (request->file.Size() == 0) {
+        fail(request, {Error::EmptyFile});
+        continue;
+      }
+
+      const size_t headerBytes = std::min<size_t>(request->file.Size(), sizeof(request->header));
+      request->reads.push_back({request, 0, std::span(request->header, headerBytes)});
+      request->outstanding = 1;
+      queued.push_back(&request->reads.back());
+    }
+
+    while (!queued.empty() && inFlight < ring.entries) {
+      REQUEST::READ* read = queued.front();
+      queued.pop_front();
+      ring.PrepareRead(static_cast<int>(read->request->file.NativeHandle()), read);
+      ++inFlight;
+    }
+
+    ring.Enter(inFlight > 0);
+
+    ring.Reap([&] (REQUEST::READ* t_read, const int t_result)
+    {
+      --inFlight;
+      REQUEST* request = t_read->request;
+
+      if (!request->status.Ok()) {
+        // an earlier chunk of this file failed, wait for the rest to drain before giving it back
+        if (--request->outstanding == 0) {
+          fail(request, request->status);
+        }
+        return;
+      }
+
+      if (t_result <= 0) {
+        request->status = t_result < 0 ? STATUS{Error::ReadFailed, static_cast<uint32_t>(-t_result)}
+                                       : STATUS{Error::ShortRead, t_read->mip};
+        if (--request->outstanding == 0) {
+          fail(request, request->status);
+        }
+        return;
+      }
+
+      // short read, queue the remainder of the same chunk
+      if (static_cast<size_t>(t_result) < t_read->destination.size()) {
+        t_read->offset      += static_cast<uint64_t>(t_result);
+        t_read->destination  = t_read->destination.subspan(static_cast<size_t>(t_result));
+        queued.push_back(t_read);
+        return;
+      }
+
+      if (--request->outstanding > 0) {
+        return;
+      }
+
+      if (!request->headerDone) {
+        request->headerDone = true;
+        request->reads.clear();
+        startPayload(request);
+      }
+      else {
+        request->file.Close();
+        finishPayload(request);
+      }
+    });
+  }
+#endif
+}
@@ -0,0 +1,56 @@
+#include "dds/BatchLoader.h"
+
+#include <memory>
+
+Dds::BatchLoader::BatchLoader(const size_t t_workerCount)
+  : m_pool(t_workerCount) {}
+
+void Dds::BatchLoader::Load(const std::span<const std::string> t_paths,
+                            CompletionFn                       t_onComplete,
+                            const LoadOptions&                 t_options) {
+  // shared so every task can hold on to the same callback
+  auto onComplete = std::make_shared<CompletionFn>(std::move(t_onComplete));
+
+  for (size_t i = 0; i < t_paths.size(); ++i) {
+    m_pool.Submit([onComplete, i, path = t_paths[i], t_options]
+    {
+      (*onComplete)(i, LoadOne(path, t_options));
+    });
+  }
+}
+
+std::vector<std::future<Dds::BatchLoader::RESULT>> Dds::BatchLoader::Load(const std::span<const std::string> t_paths,
+                                                                          const LoadOptions& t_options) {
+  std::vector<std::future<RESULT>> futures;
+  futures.reserve(t_paths.size());
+
+  for (const std::string& path : t_paths) {
+    // std::function needs a copyable callable, so the promise lives on the heap
+    auto promise = std::make_shared<std::promise<RESULT>>();
+    futures.push_back(promise->get_future());
+
+    m_pool.Submit([promise, path, t_options]
+    {
+      promise->set_value(LoadOne(path, t_options));
+    });
+  }
+
+  return futures;
+}
+
+void Dds::BatchLoader::Wait() {
+  m_pool.Wait();
+}
+
+Dds::BatchLoader::RESULT Dds::BatchLoader::LoadOne(const std::string& t_path, const LoadOptions& t_options) {
+  RESULT result;
+  result.path = t_path;
+
+  Result<LoadDds::DDS_FILE> loaded = LoadDds::TextureLoadDds(t_path.c_str(), t_options);
+  result.status                    = loaded.Status();
+  if (loaded) {
+    result.file = *std::move(loaded);
+  }
+
+  return result;
+}
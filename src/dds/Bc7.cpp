@@ -0,0 +1,113 @@
+#include "dds/Bc7.h"
+
+#include <cstring>
+
+namespace
+{
+  // 128-bit block read/written least significant bit first, fields never span more than 8 bits
+  struct BIT_STREAM
+  {
+    uint64_t lo       = 0;
+    uint64_t hi       = 0;
+    unsigned position = 0;
+
+    uint8_t Read(const unsigned t_bits) {
+      uint64_t value;
+      if (position >= 64) {
+        value = hi >> (position - 64);
+      }
+      else {
+        value = lo >> position;
+        if (position + t_bits > 64) {
+          value |= hi << (64 - position);
+        }
+      }
+      position += t_bits;
+      return static_cast<uint8_t>(value & ((1u << t_bits) - 1));
+    }
+
+    void Write(const unsigned t_bits, const uint8_t t_value) {
+      const uint64_t value = t_value & ((1u << t_bits) - 1);
+      if (position >= 64) {
+        hi |= value << (position - 64);
+      }
+      else {
+        lo |= value << position;
+        if (position + t_bits > 64) {
+          hi |= value >> (64 - position);
+        }
+      }
+      position += t_bits;
+    }
+  };
+
+  // shared by Unpack and Pack so both walk the fields in exactly the same order
+  template <class Stream, class Field>
+  void VisitFields(Stream& t_stream, Field&& t_field, Dds::Bc7::BLOCK& t_block) {
+    const Dds::Bc7::MODE_INFO& info      = Dds::Bc7::MODES[t_block.mode];
+    const unsigned             endpoints = info.subsets * 2u;
+
+    t_field(t_stream, info.partitionBits, t_block.partition);
+    t_field(t_stream, info.rotationBits, t_block.rotation);
+    t_field(t_stream, info.indexSelectionBits, t_block.indexSelection);
+
+    for (unsigned channel = 0; channel < 3; ++channel) {
+      for (unsigned e = 0; e < endpoints; ++e) {
+        t_field(t_stream, info.colorBits, t_block.endpoints[e][channel]);
+      }
+    }
+    for (unsigned e = 0; e < endpoints; ++e) {
+      t_field(t_stream, info.alphaBits, t_block.endpoints[e][3]);
+    }
+
+    const unsigned pBitCount = info.endpointPBits ? endpoints : info.sharedPBits ? info.subsets : 0u;
+    for (unsigned p = 0; p < pBitCount; ++p) {
+      t_field(t_stream, 1, t_block.pBits[p]);
+    }
+
+    for (uint8_t texel = 0; texel < 16; ++texel) {
+      const uint8_t subset   = Dds::Bc7::Subset(info.subsets, t_block.partition, texel);
+      const bool    isAnchor = Dds::Bc7::Anchor(info.subsets, t_block.partition, subset) == texel;
+      t_field(t_stream, info.indexBits - isAnchor, t_block.indices[texel]);
+    }
+    if (info.secondIndexBits) {
+      for (uint8_t texel = 0; texel < 16; ++texel) {
+        t_field(t_stream, info.secondIndexBits - (texel == 0), t_block.secondIndices[texel]);
+      }
+    }
+  }
+}
+
+bool Dds::Bc7::Unpack(const std::byte* t_block, BLOCK& t_out) {
+  BIT_STREAM stream;
+  std::memcpy(&stream.lo, t_block, 8);
+  std::memcpy(&stream.hi, t_block + 8, 8);
+
+  t_out = {};
+  while (t_out.mode < 8 && stream.Read(1) == 0) {
+    ++t_out.mode;
+  }
+  if (t_out.mode == 8) {
+    return false;
+  }
+
+  VisitFields(stream, [](BIT_STREAM& t_stream, const unsigned t_bits, uint8_t& t_value) {
+    t_value = t_bits ? t_stream.Read(t_bits) : 0;
+  }, t_out);
+  return true;
+}
+
+void Dds::Bc7::Pack(const BLOCK& t_block, std::byte* t_out) {
+  BIT_STREAM stream;
+  stream.Write(t_block.mode + 1, static_cast<uint8_t>(1u << t_block.mode));
+
+  BLOCK fields = t_block;
+  VisitFields(stream, [](BIT_STREAM& t_stream, const unsigned t_bits, uint8_t& t_value) {
+    if (t_bits) {
+      t_stream.Write(t_bits, t_value);
+    }
+  }, fields);
+
+  std::memcpy(t_out, &stream.lo, 8);
+  std::memcpy(t_out + 8, &stream.hi, 8);
+}
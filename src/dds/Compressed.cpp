@@ -0,0 +1,464 @@
+#include "dds/Compressed.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <latch>
+#include <memory>
+#include <new>
+#include <span>
+#include <vector>
+
+#include "dds/DDSWriter.h"
+#include "dds/FileReader.h"
+#include "dds/FileWriter.h"
+#include "dds/Lz.h"
+#include "dds/Stats.h"
+
+#if defined(DDS_HAVE_ZSTD)
+#include <zstd.h>
+#endif
+
+namespace
+{
+  constexpr uint32_t DDSZ_MAGIC   = 0x5A534444; // "DDSZ"
+  constexpr uint32_t DDSZ_VERSION = 1;
+
+  // compressed bytes read in one go before their chunks go to the pool
+  constexpr size_t READ_WINDOW     = 1u << 20;
+  constexpr size_t MAX_HEADER_SIZE = 4 + sizeof(LoadDds::DDS_HEADER) + sizeof(LoadDds::DDS_HEADER_DXT10);
+
+#pragma pack(push, 1)
+  struct DDSZ_HEADER
+  {
+    uint32_t magic       = DDSZ_MAGIC;
+    uint32_t version     = DDSZ_VERSION;
+    uint32_t codec       = 0;
+    uint32_t chunkCount  = 0;
+    uint32_t headerSize  = 0; // of the DDS headers that follow
+    uint32_t reserved    = 0;
+    uint64_t payloadSize = 0; // uncompressed, every chunk's rawSize summed
+  };
+
+  struct DDSZ_CHUNK
+  {
+    uint64_t offset         = 0; // from the start of the container
+    uint32_t compressedSize = 0; // equal to rawSize for chunks stored as is
+    uint32_t rawSize        = 0;
+  };
+#pragma pack(pop)
+
+  static_assert(sizeof(DDSZ_HEADER) == 32 && sizeof(DDSZ_CHUNK) == 16);
+
+  bool IsStored(const DDSZ_CHUNK& t_chunk) {
+    return t_chunk.compressedSize == t_chunk.rawSize;
+  }
+
+  // size of the compressed chunk in t_destination, 0 when the codec fails or does not save anything.
+  // t_destination is one byte short of t_source, so anything that fits is a saving
+  size_t CompressChunk(const Dds::COMPRESS_OPTIONS&     t_options,
+                       const std::span<const std::byte> t_source,
+                       const std::span<std::byte>       t_destination) {
+    switch (t_options.codec) {
+      case Dds::Codec::Lz:
+        return Dds::LzCompress(t_source, t_destination);
+      case Dds::Codec::Zstd:
+#if defined(DDS_HAVE_ZSTD)
+      {
+        const size_t size = ZSTD_compress(t_destination.data(),
+                                          t_destination.size(),
+                                          t_source.data(),
+                                          t_source.size(),
+                                          t_options.level);
+        return ZSTD_isError(size) ? 0 : size;
+      }
+#else
+        break;
+#endif
+      case Dds::Codec::Count:
+        break;
+    }
+    return 0;
+  }
+
+  bool DecompressChunk(const Dds::Codec t_codec, const std::span<const std::byte> t_source, const std::span<std::byte> t_destination) {
+    switch (t_codec) {
+      case Dds::Codec::Lz:
+        return Dds::LzDecompress(t_source, t_destination);
+      case Dds::Codec::Zstd:
+#if defined(DDS_HAVE_ZSTD)
+      {
+        const size_t size = ZSTD_decompress(t_destination.data(), t_destination.size(), t_source.data(), t_source.size());
+        return !ZSTD_isError(size) && size == t_destination.size();
+      }
+#else
+        break;
+#endif
+      case Dds::Codec::Count:
+        break;
+    }
+    return false;
+  }
+
+  // compresses every level of t_ddsFile in chunks and gathers the container, everything but t_ddsFile
+  // is filled in here and must outlive t_pieces
+  void Gather(const LoadDds::DDS_FILE&                 t_ddsFile,
+              const Dds::COMPRESS_OPTIONS&             t_options,
+              const std::vector<std::byte>&            t_ddsHeaders,
+              DDSZ_HEADER&                             t_header,
+              std::vector<DDSZ_CHUNK>&                 t_chunks,
+              std::unique_ptr<std::byte[]>&            t_staging,
+              std::vector<std::span<const std::byte>>& t_pieces) {
+    const size_t chunkSize = std::max<uint32_t>(t_options.chunkSize, 1);
+
+    // compressed chunks are always smaller than their source, so the payload size bounds them all
+    t_staging     = std::make_unique_for_overwrite<std::byte[]>(t_ddsFile.totalSizeBytes);
+    size_t staged = 0;
+
+    std::vector<std::span<const std::byte>> data;
+    for (size_t mip = 0; mip < t_ddsFile.mipMaps.size(); ++mip) {
+      const std::span<const std::byte> level = t_ddsFile.MipData(mip);
+      for (size_t offset = 0; offset < level.size(); offset += chunkSize) {
+        const std::span<const std::byte> raw = level.subspan(offset, std::min(chunkSize, level.size() - offset));
+        const size_t size = CompressChunk(t_options, raw, std::span(t_staging.get() + staged, raw.size() - 1));
+
+        if (size != 0 && size < raw.size()) {
+          data.emplace_back(t_staging.get() + staged, size);
+          staged += size;
+        }
+        else {
+          data.push_back(raw);
+        }
+        t_chunks.push_back({0, static_cast<uint32_t>(data.back().size()), static_cast<uint32_t>(raw.size())});
+      }
+    }
+
+    t_header.codec       = static_cast<uint32_t>(t_options.codec);
+    t_header.chunkCount  = static_cast<uint32_t>(t_chunks.size());
+    t_header.headerSize  = static_cast<uint32_t>(t_ddsHeaders.size());
+    t_header.payloadSize = t_ddsFile.totalSizeBytes;
+
+    uint64_t offset = sizeof(DDSZ_HEADER) + t_ddsHeaders.size() + t_chunks.size() * sizeof(DDSZ_CHUNK);
+    for (DDSZ_CHUNK& chunk : t_chunks) {
+      chunk.offset = offset;
+      offset += chunk.compressedSize;
+    }
+
+    t_pieces.reserve(3 + data.size());
+    t_pieces.push_back(std::as_bytes(std::span(&t_header, 1)));
+    t_pieces.emplace_back(t_ddsHeaders.data(), t_ddsHeaders.size());
+    t_pieces.push_back(std::as_bytes(std::span(t_chunks)));
+    // runs of stored chunks and runs of compressed ones are each contiguous in memory
+    for (const std::span<const std::byte> piece : data) {
+      if (t_pieces.back().data() + t_pieces.back().size() == piece.data()) {
+        t_pieces.back() = {t_pieces.back().data(), t_pieces.back().size() + piece.size()};
+      }
+      else {
+        t_pieces.push_back(piece);
+      }
+    }
+  }
+}
+
+bool Dds::CodecAvailable(const Codec t_codec) {
+  switch (t_codec) {
+    case Codec::Lz:
+      return true;
+    case Codec::Zstd:
+#if defined(DDS_HAVE_ZSTD)
+      return true;
+#else
+      return false;
+#endif
+    case Codec::Count:
+      break;
+  }
+  return false;
+}
+
+Dds::STATUS Dds::SaveCompressedDds(const char* t_path, const LoadDds::DDS_FILE& t_ddsFile, const COMPRESS_OPTIONS& t_options) {
+  if (!CodecAvailable(t_options.codec)) {
+    const STATUS status{Error::UnsupportedCodec, static_cast<uint32_t>(t_options.codec)};
+    Log(status, t_path);
+    return status;
+  }
+
+  // SaveDds checks the texture and builds its headers, the sink sees them as the first buffer. its
+  // failures are already logged
+  std::vector<std::byte> ddsHeaders;
+  const STATUS           headerStatus = SaveDds([&](const std::span<const std::span<const std::byte>> t_buffers)
+  {
+    ddsHeaders.assign(t_buffers.front().begin(), t_buffers.front().end());
+    return true;
+  }, t_ddsFile);
+  if (!headerStatus.Ok()) {
+    return headerStatus;
+  }
+
+  STATUS status;
+  try {
+    DDSZ_HEADER                             header;
+    std::vector<DDSZ_CHUNK>                 chunks;
+    std::unique_ptr<std::byte[]>            staging;
+    std::vector<std::span<const std::byte>> pieces;
+    Gather(t_ddsFile, t_options, ddsHeaders, header, chunks, staging, pieces);
+
+    FileWriter writer;
+    if (!writer.Open(t_path)) {
+      status = {Error::WriteFailed};
+    }
+    else {
+      if (!writer.Write(pieces) || !writer.Commit()) {
+        status = {Error::WriteFailed};
+      }
+    }
+  }
+  catch (const std::bad_alloc&) {
+    status = {Error::OutOfMemory};
+  }
+
+  if (!status.Ok()) {
+    Log(status, t_path);
+  }
+  return status;
+}
+
+Dds::CompressedLoader::CompressedLoader(const size_t t_workerCount)
+  : m_pool(t_workerCount) {}
+
+Dds::Result<LoadDds::DDS_FILE> Dds::CompressedLoader::Load(const char* t_path, const LoadOptions& t_options) {
+  LoadDds::DDS_FILE ddsFile;
+  STATUS            status;
+  LoadScope         scope(t_path);
+
+  try {
+    status = LoadImpl(ddsFile, t_path, t_options);
+  }
+  catch (const std::bad_alloc&) {
+    status = {Error::OutOfMemory};
+  }
+  scope.Finish(status, ddsFile.format, ddsFile.totalSizeBytes);
+
+  if (!status.Ok()) {
+    Log(status, t_path);
+    return status;
+  }
+  return ddsFile;
+}
+
+Dds::STATUS Dds::CompressedLoader::LoadImpl(LoadDds::DDS_FILE& t_ddsFile, const char* t_path, const LoadOptions& t_options) {
+  FileReader file;
+  {
+    const StageTimer timer(Stage::Open);
+    if (!file.Open(t_path)) {
+      return {Error::OpenFailed};
+    }
+  }
+  if (file.Size() == 0) {
+    return {Error::EmptyFile};
+  }
+
+  auto read = [&file](const uint64_t t_offset, const std::span<std::byte> t_destination)
+  {
+    const StageTimer timer(Stage::Read);
+    if (!file.ReadAt(t_offset, t_destination)) {
+      return false;
+    }
+    CountBytesRead(t_destination.size());
+    return true;
+  };
+
+  DDSZ_HEADER header;
+  if (!read(0, std::as_writable_bytes(std::span(&header, 1)))) {
+    return {Error::TruncatedHeader};
+  }
+  if (header.magic != DDSZ_MAGIC || header.version != DDSZ_VERSION) {
+    return {Error::BadMagic};
+  }
+  if (header.codec >= static_cast<uint32_t>(Codec::Count) || !CodecAvailable(static_cast<Codec>(header.codec))) {
+    return {Error::UnsupportedCodec, header.codec};
+  }
+
+  // the chunk table has to fit in the file before it is allocated
+  std::byte      ddsHeaders[MAX_HEADER_SIZE];
+  const uint64_t tableOffset = sizeof(header) + uint64_t{header.headerSize};
+  if (header.headerSize > sizeof(ddsHeaders) || file.Size() < tableOffset ||
+      (file.Size() - tableOffset) / sizeof(DDSZ_CHUNK) < header.chunkCount) {
+    return {Error::TruncatedHeader};
+  }
+  std::vector<DDSZ_CHUNK> chunks(header.chunkCount);
+  if (!read(sizeof(header), std::span(ddsHeaders, header.headerSize)) ||
+      !read(tableOffset, std::as_writable_bytes(std::span(chunks)))) {
+    return {Error::TruncatedHeader};
+  }
+
+  // the full chain locates the selected levels inside the stored payload
+  const std::span<const std::byte> headerBytes(ddsHeaders, header.headerSize);
+  LoadOptions                      fullChain = t_options;
+  fullChain.firstMip                         = 0;
+  fullChain.mipCount                         = UINT32_MAX;
+
+  LoadDds::DDS_INFO layout;
+  if (const STATUS status = LoadDds::ParseLayout(layout, headerBytes, SIZE_MAX, fullChain); !status.Ok()) {
+    return status;
+  }
+  if (const STATUS status = LoadDds::ParseLayout(t_ddsFile, headerBytes, SIZE_MAX, t_options); !status.Ok()) {
+    return status;
+  }
+  if (layout.totalSizeBytes != header.payloadSize) {
+    return {Error::LayoutMismatch};
+  }
+
+  // chunks follow each other in the file and in the payload and none spans two levels, so the selected
+  // range starts and ends on chunk boundaries
+  const size_t begin = layout.mipMaps[t_ddsFile.firstMip].offset;
+  const size_t end   = begin + t_ddsFile.totalSizeBytes;
+
+  std::vector<uint32_t> chunkMips(chunks.size());
+  size_t                firstChunk = chunks.size();
+  size_t                lastChunk  = chunks.size();
+  uint64_t              fileOffset = tableOffset + chunks.size() * sizeof(DDSZ_CHUNK);
+  size_t                rawOffset  = 0;
+  size_t                mip        = 0;
+
+  for (size_t chunk = 0; chunk < chunks.size(); ++chunk) {
+    while (mip < layout.mipMaps.size() && rawOffset >= layout.mipMaps[mip].offset + layout.mipMaps[mip].size) {
+      ++mip;
+    }
+    const DDSZ_CHUNK& entry = chunks[chunk];
+    if (entry.offset != fileOffset || entry.rawSize == 0 || entry.compressedSize > entry.rawSize ||
+        mip == layout.mipMaps.size() || rawOffset + entry.rawSize > layout.mipMaps[mip].offset + layout.mipMaps[mip].size) {
+      return {Error::InvalidHeader, static_cast<uint32_t>(chunk)};
+    }
+
+    if (rawOffset == begin) {
+      firstChunk = chunk;
+    }
+    if (rawOffset == end) {
+      lastChunk = chunk;
+    }
+    chunkMips[chunk] = static_cast<uint32_t>(mip);
+    fileOffset += entry.compressedSize;
+    rawOffset += entry.rawSize;
+  }
+  if (rawOffset != header.payloadSize || firstChunk == chunks.size()) {
+    return {Error::InvalidHeader};
+  }
+
+  {
+    const StageTimer timer(Stage::Allocate);
+    CountAllocation(t_ddsFile.totalSizeBytes);
+    t_ddsFile.buffer = AlignedBuffer(t_ddsFile.totalSizeBytes, LoadDds::PAYLOAD_ALIGNMENT);
+    t_ddsFile.data   = {t_ddsFile.buffer.Data(), t_ddsFile.totalSizeBytes};
+  }
+
+  // every compressed chunk goes through staging, the calling thread decompresses the last one itself
+  // instead of idling on the latch
+  size_t stagingSize    = 0;
+  size_t compressed     = 0;
+  size_t lastCompressed = lastChunk;
+  for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk) {
+    if (!IsStored(chunks[chunk])) {
+      stagingSize += chunks[chunk].compressedSize;
+      lastCompressed = chunk;
+      ++compressed;
+    }
+  }
+  const auto tasks = static_cast<std::ptrdiff_t>(compressed == 0 ? 0 : compressed - 1);
+
+  const std::unique_ptr<std::byte[]> staging = std::make_unique_for_overwrite<std::byte[]>(stagingSize);
+  const Codec                        codec   = static_cast<Codec>(header.codec);
+  std::atomic<uint32_t>              corrupt = UINT32_MAX;
+  std::latch                         done(tasks);
+  std::ptrdiff_t                     submitted = 0;
+
+  auto decompress = [&](const std::span<const std::byte> t_source, const std::span<std::byte> t_target, const uint32_t t_chunk)
+  {
+    if (!DecompressChunk(codec, t_source, t_target)) {
+      uint32_t none = UINT32_MAX;
+      corrupt.compare_exchange_strong(none, t_chunk);
+    }
+  };
+
+  STATUS                     status;
+  std::span<const std::byte> lastSource;
+  std::span<std::byte>       lastTarget;
+
+  try {
+    size_t chunk  = firstChunk;
+    size_t staged = 0;
+    rawOffset     = begin;
+
+    while (chunk < lastChunk) {
+      // a run of stored chunks is one read straight into the payload
+      size_t runEnd  = chunk;
+      size_t runSize = 0;
+      if (IsStored(chunks[chunk])) {
+        while (runEnd < lastChunk && IsStored(chunks[runEnd])) {
+          runSize += chunks[runEnd++].rawSize;
+        }
+        if (!read(chunks[chunk].offset, t_ddsFile.data.subspan(rawOffset - begin, runSize))) {
+          status = {Error::ShortRead, chunkMips[chunk]};
+          break;
+        }
+        rawOffset += runSize;
+        chunk = runEnd;
+        continue;
+      }
+
+      // compressed chunks are read a window at a time and decompressed while the next window loads
+      while (runEnd < lastChunk && !IsStored(chunks[runEnd]) &&
+             (runSize == 0 || runSize + chunks[runEnd].compressedSize <= READ_WINDOW)) {
+        runSize += chunks[runEnd++].compressedSize;
+      }
+      if (!read(chunks[chunk].offset, std::span(staging.get() + staged, runSize))) {
+        status = {Error::ShortRead, chunkMips[chunk]};
+        break;
+      }
+
+      for (; chunk < runEnd; ++chunk) {
+        const std::span<const std::byte> source(staging.get() + staged, chunks[chunk].compressedSize);
+        const std::span<std::byte>       target = t_ddsFile.data.subspan(rawOffset - begin, chunks[chunk].rawSize);
+        staged += source.size();
+        rawOffset += target.size();
+
+        if (chunk == lastCompressed) {
+          lastSource = source;
+          lastTarget = target;
+          continue;
+        }
+        m_pool.Submit([&, source, target, index = static_cast<uint32_t>(chunk)]
+        {
+          decompress(source, target, index);
+          done.count_down();
+        });
+        ++submitted;
+      }
+    }
+  }
+  catch (...) {
+    // the tasks already queued point into this frame
+    done.count_down(tasks - submitted);
+    done.wait();
+    throw;
+  }
+
+  if (status.Ok() && lastCompressed != lastChunk) {
+    decompress(lastSource, lastTarget, static_cast<uint32_t>(lastCompressed));
+  }
+  // chunks behind a failed read were never queued
+  done.count_down(tasks - submitted);
+  done.wait();
+
+  if (!status.Ok()) {
+    return status;
+  }
+  if (const uint32_t chunk = corrupt.load(); chunk != UINT32_MAX) {
+    return {Error::CorruptChunk, chunk};
+  }
+
+  if (t_options.flipVertical) {
+    LoadDds::Flip(t_ddsFile, t_options);
+  }
+  return {};
+}
@@ -1,356 +1,922 @@
 #include "dds/DDSLoader.h"
 
-#include <Dxgiformat.h>
-#include <fstream>
-#include <iostream>
-#include <string>
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+#include "dds/FlipKernels.h"
+#include "dds/Formats.h"
+#include "dds/Stats.h"
+
+namespace
+{
+  // the public entry points share one shape: t_load fills a fresh value, an allocation failure (a corrupt
+  // header on a source of unknown size) becomes OutOfMemory, and any failure is logged once
+  template <typename T, typename FN>
+  Dds::Result<T> Run(const char* t_source, FN&& t_load) {
+    constexpr bool isLoad = std::is_same_v<T, LoadDds::DDS_FILE>;
+
+    T           value;
+    Dds::STATUS status;
+    // probes are not loads, their stages are not counted anywhere
+    std::optional<Dds::LoadScope> scope;
+    if constexpr (isLoad) {
+      scope.emplace(t_source);
+    }
+
+    try {
+      status = t_load(value);
+    }
+    catch (const std::bad_alloc&) {
+      status = {Dds::Error::OutOfMemory};
+    }
+
+    if constexpr (isLoad) {
+      scope->Finish(status, value.format, value.totalSizeBytes);
+    }
+
+    if (!status.Ok()) {
+      Dds::Log(status, t_source);
+      return status;
+    }
+    return value;
+  }
+
+  // every payload allocation of a load goes through here to be timed and counted
+  Dds::AlignedBuffer AllocatePayload(const size_t                     t_size,
+                                     std::pmr::memory_resource* const t_resource = std::pmr::new_delete_resource()) {
+    const Dds::StageTimer timer(Dds::Stage::Allocate);
+    Dds::CountAllocation(t_size);
+    return Dds::AlignedBuffer(t_size, LoadDds::PAYLOAD_ALIGNMENT, t_resource);
+  }
+}
+
+Dds::Result<LoadDds::DDS_FILE> LoadDds::TextureLoadDds(const char* t_path, const Dds::LoadOptions& t_options) {
+  return Run<DDS_FILE>(t_path, [&](DDS_FILE& t_ddsFile)
+  {
+    return TextureLoadDdsImpl(t_ddsFile, t_path, std::pmr::new_delete_resource(), {}, t_options);
+  });
+}
+
+Dds::Result<LoadDds::DDS_FILE> LoadDds::TextureLoadDds(const char*                t_path,
+                                                       std::pmr::memory_resource* t_resource,
+                                                       const Dds::LoadOptions&    t_options) {
+  Dds::LoadOptions options = t_options;
+  options.storage          = Dds::Storage::Heap;
+  return Run<DDS_FILE>(t_path, [&](DDS_FILE& t_ddsFile)
+  {
+    return TextureLoadDdsImpl(t_ddsFile, t_path, t_resource, {}, options);
+  });
+}
+
+Dds::Result<LoadDds::DDS_FILE> LoadDds::TextureLoadDds(const char*                t_path,
+                                                       const std::span<std::byte> t_destination,
+                                                       const Dds::LoadOptions&    t_options) {
+  Dds::LoadOptions options = t_options;
+  options.storage          = Dds::Storage::Heap;
+  return Run<DDS_FILE>(t_path, [&](DDS_FILE& t_ddsFile)
+  {
+    return TextureLoadDdsImpl(t_ddsFile, t_path, nullptr, t_destination, options);
+  });
+}
+
+Dds::Result<LoadDds::DDS_FILE> LoadDds::TextureLoadDds(const std::span<const std::byte> t_data,
+                                                       const Dds::LoadOptions&          t_options) {
+  return Run<DDS_FILE>(nullptr, [&](DDS_FILE& t_ddsFile)
+  {
+    return LoadFromMemory(t_ddsFile, t_data, t_options);
+  });
+}
+
+Dds::Result<LoadDds::DDS_FILE> LoadDds::TextureLoadDds(const ReadAtFn&            t_readAt,
+                                                       std::pmr::memory_resource* t_resource,
+                                                       const Dds::LoadOptions&    t_options) {
+  return Run<DDS_FILE>(nullptr, [&](DDS_FILE& t_ddsFile)
+  {
+    return LoadFromReadAt(t_ddsFile, t_readAt, t_resource, t_options);
+  });
+}
+
+Dds::Result<LoadDds::PAYLOAD_REQUIREMENTS> LoadDds::QueryPayloadRequirements(const char*             t_path,
+                                                                             const Dds::LoadOptions& t_options) {
+  const Dds::Result<DDS_INFO> ddsInfo = ProbeDds(t_path, t_options);
+  if (!ddsInfo) {
+    return ddsInfo.Status();
+  }
 
-LoadDds::DDS_FILE LoadDds::TextureLoadDds(const char* t_path) {
+  return PAYLOAD_REQUIREMENTS{ddsInfo->totalSizeBytes, PAYLOAD_ALIGNMENT};
+}
+
+Dds::Result<LoadDds::DDS_INFO> LoadDds::ProbeDds(const char* t_path, const Dds::LoadOptions& t_options) {
+  return Run<DDS_INFO>(t_path, [&](DDS_INFO& t_ddsInfo)
+  {
+    Dds::FileReader file;
+    return ReadHeaders(file, t_path, t_ddsInfo, t_options);
+  });
+}
+
+Dds::Result<LoadDds::DDS_INFO> LoadDds::ProbeDds(const std::span<const std::byte> t_data, const Dds::LoadOptions& t_options) {
+  return Run<DDS_INFO>(nullptr, [&](DDS_INFO& t_ddsInfo)
+  {
+    // layout only, the payload is not part of t_data
+    return ParseLayout(t_ddsInfo, t_data, SIZE_MAX, t_options);
+  });
+}
+
+Dds::STATUS LoadDds::StreamInMips(const char*             t_path,
+                                  DDS_FILE&               t_ddsFile,
+                                  const uint32_t          t_firstMip,
+                                  const Dds::LoadOptions& t_options) {
+  Dds::LoadScope scope(t_path);
+  const size_t   loadedBytes = t_ddsFile.totalSizeBytes;
+
+  Dds::STATUS status;
   try {
-    DDS_FILE ddsFile;
-
-    // open the DDS file for binary reading and get file size
-    std::ifstream file(t_path, std::ios::binary | std::ios::ate);
-
-    if (!file) {
-      throw std::runtime_error("Failed to open file: " + std::string(t_path));
-    }
-
-    // get file size
-    std::streampos pos = file.tellg();
-    // validate
-    if (pos <= 0) {
-      throw std::runtime_error("Failed to determine file size");
-    }
-
-    const size_t fileSize = pos;
-    file.seekg(0, std::ios::beg);
-
-    if (fileSize == 0) {
-      // avoid undefined behavior
-      throw std::runtime_error("Filesize 0");
-    }
-
-    // read whole file at once
-    auto buffer = std::vector<std::byte>(fileSize);
-    if (!file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(fileSize))) {
-      throw std::runtime_error("DDS: Failed to read file");
-    }
-
-    if (std::memcmp(buffer.data(), "DDS ", 4) != 0) {
-      throw std::runtime_error("Not a .dds file");
-    }
-
-    size_t headerOffset = 4;
-
-    // copy header
-    std::memcpy(&ddsFile.header, buffer.data() + headerOffset, sizeof(DDS_HEADER));
-    headerOffset += sizeof(DDS_HEADER);
-
-    // handle DX10 header if present
-    if (ddsFile.header.ddspf.dwFourCC == DX10) {
-      std::memcpy(&ddsFile.dxt10Header, buffer.data() + headerOffset, sizeof(DDS_HEADER_DXT10));
-      headerOffset += sizeof(DDS_HEADER_DXT10);
-    }
-
-    // make sure mip map is always at least 1
-    ddsFile.header.dwMipMapCount = ddsFile.header.dwMipMapCount ? ddsFile.header.dwMipMapCount : 1;
-    ddsFile.mipMaps.reserve(ddsFile.header.dwMipMapCount);
-
-    switch (ddsFile.header.ddspf.dwFourCC) {
-      case DXT1:                                                   // little-endian
-        ddsFile.glFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; // assume sRGB for all non-DXT10 header files
-        ddsFile.blockSize = 8;
-        ddsFile.flags.SetFlag(Dds::Flag::DXT1);
-        break;
-      case DXT3:
-        ddsFile.glFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
-        ddsFile.blockSize = 16;
-        ddsFile.flags.SetFlag(Dds::Flag::DXT3);
-        break;
-      case DXT5:
-        ddsFile.glFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
-        ddsFile.blockSize = 16;
-        ddsFile.flags.SetFlag(Dds::Flag::DXT5);
-        break;
-      case BC5_U: // non DXT10 header BC5u
-        ddsFile.glFormat = GL_COMPRESSED_RG_RGTC2;
-        ddsFile.blockSize = 16;
-        ddsFile.flags.SetFlag(Dds::Flag::BC5_U);
-        break;
-      case DX10:                                  // FourCC (DXT10 extension header)
-        switch (ddsFile.dxt10Header.dxgiFormat) { // NOLINT(clang-diagnostic-switch-enum)
-          case DXGI_FORMAT_BC1_UNORM:
-          case DXGI_FORMAT_BC1_TYPELESS:
-            ddsFile.glFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; // DXT1
-            ddsFile.blockSize = 8;
-            ddsFile.flags.SetFlag(Dds::Flag::DXT1);
-            break;
-          case DXGI_FORMAT_BC1_UNORM_SRGB:
-            ddsFile.glFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT; // DXT1
-            ddsFile.blockSize = 8;
-            ddsFile.flags.SetFlag(Dds::Flag::DXT1);
-            break;
-          case DXGI_FORMAT_BC2_UNORM:
-          case DXGI_FORMAT_BC2_TYPELESS:
-            ddsFile.glFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT; // DXT3
-            ddsFile.blockSize = 16;
-            ddsFile.flags.SetFlag(Dds::Flag::DXT3);
-            break;
-          case DXGI_FORMAT_BC2_UNORM_SRGB:
-            ddsFile.glFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT; // DXT3
-            ddsFile.blockSize = 16;
-            ddsFile.flags.SetFlag(Dds::Flag::DXT3);
-            break;
-          case DXGI_FORMAT_BC3_UNORM:
-          case DXGI_FORMAT_BC3_TYPELESS:
-            ddsFile.glFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; // DXT5
-            ddsFile.blockSize = 16;
-            ddsFile.flags.SetFlag(Dds::Flag::DXT5);
-            break;
-          case DXGI_FORMAT_BC3_UNORM_SRGB:
-            ddsFile.glFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT; // DXT5
-            ddsFile.blockSize = 16;
-            ddsFile.flags.SetFlag(Dds::Flag::DXT5);
-            break;
-          case DXGI_FORMAT_BC4_UNORM:
-          case DXGI_FORMAT_BC4_TYPELESS:
-            ddsFile.glFormat = GL_COMPRESSED_RED_RGTC1; // BC4u
-            ddsFile.blockSize = 8;
-            ddsFile.flags.SetFlag(Dds::Flag::BC4_U);
-            break;
-          case DXGI_FORMAT_BC4_SNORM:
-            throw std::runtime_error("Unsupported DX10 DXGI_FORMAT: DXGI_FORMAT_BC4_SNORM");
-          case DXGI_FORMAT_BC5_TYPELESS:
-          case DXGI_FORMAT_BC5_UNORM:
-            ddsFile.glFormat = GL_COMPRESSED_RG_RGTC2; // BC5u
-            ddsFile.blockSize = 16;
-            ddsFile.flags.SetFlag(Dds::Flag::BC5_U);
-            break;
-          case DXGI_FORMAT_BC5_SNORM:
-            throw std::runtime_error("Unsupported DX10 DXGI_FORMAT: DXGI_FORMAT_BC5_SNORM");
-          case DXGI_FORMAT_BC7_UNORM:
-          case DXGI_FORMAT_BC7_TYPELESS:
-            ddsFile.glFormat = GL_COMPRESSED_RGBA_BPTC_UNORM; // BC7
-            ddsFile.blockSize = 16;
-            ddsFile.flags.SetFlag(Dds::Flag::BC7);
-            break;
-          case DXGI_FORMAT_BC7_UNORM_SRGB:
-            ddsFile.glFormat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM; // BC7
-            ddsFile.blockSize = 16;
-            ddsFile.flags.SetFlag(Dds::Flag::BC7);
-            break;
-          default:
-            throw std::runtime_error("Unsupported DX10 DXGI_FORMAT");
+    status = StreamInMipsImpl(t_path, t_ddsFile, t_firstMip, t_options);
+  }
+  catch (const std::bad_alloc&) {
+    status = {Dds::Error::OutOfMemory};
+  }
+  // counted as a load of just the new levels
+  scope.Finish(status, t_ddsFile.format, t_ddsFile.totalSizeBytes - loadedBytes);
+
+  if (!status.Ok()) {
+    Dds::Log(status, t_path);
+  }
+  return status;
+}
+
+Dds::STATUS LoadDds::EvictMips(DDS_FILE& t_ddsFile, const uint32_t t_firstMip) {
+  const size_t loadedEnd = t_ddsFile.firstMip + t_ddsFile.mipMaps.size();
+  if (t_firstMip <= t_ddsFile.firstMip) {
+    return {}; // nothing loaded above t_firstMip
+  }
+  if (t_firstMip >= loadedEnd) {
+    // evicting every loaded level
+    const Dds::STATUS status{Dds::Error::InvalidMipRange, t_firstMip};
+    Dds::Log(status, nullptr);
+    return status;
+  }
+
+  const size_t dropped = t_firstMip - t_ddsFile.firstMip;
+  const size_t base    = t_ddsFile.mipMaps[dropped].offset;
+  const size_t total   = t_ddsFile.totalSizeBytes - base;
+
+  size_t layerBase = 0;
+  for (size_t mip = 0; mip < dropped; ++mip) {
+    layerBase += t_ddsFile.mipMaps[mip].layerSize;
+  }
+
+  if (t_ddsFile.buffer.Data()) {
+    // shrink into a fresh allocation so the memory is actually returned
+    Dds::AlignedBuffer buffer(total, PAYLOAD_ALIGNMENT, t_ddsFile.buffer.Resource());
+    std::memcpy(buffer.Data(), t_ddsFile.data.data() + base, total);
+
+    t_ddsFile.buffer = std::move(buffer);
+    t_ddsFile.data   = {t_ddsFile.buffer.Data(), total};
+  }
+  else {
+    // mapped, borrowed or caller owned memory, only the view shrinks
+    t_ddsFile.data = t_ddsFile.data.subspan(base, total);
+  }
+
+  t_ddsFile.mipMaps.erase(t_ddsFile.mipMaps.begin(), t_ddsFile.mipMaps.begin() + static_cast<ptrdiff_t>(dropped));
+  for (MIP_LEVEL& mip : t_ddsFile.mipMaps) {
+    mip.offset -= base;
+  }
+
+  t_ddsFile.totalSizeBytes       = total;
+  t_ddsFile.payloadOffset       += layerBase;
+  t_ddsFile.firstMip             = t_firstMip;
+  t_ddsFile.header.dwWidth       = t_ddsFile.mipMaps.front().width;
+  t_ddsFile.header.dwHeight      = t_ddsFile.mipMaps.front().height;
+  t_ddsFile.header.dwDepth       = t_ddsFile.mipMaps.front().depth;
+  t_ddsFile.header.dwMipMapCount = static_cast<uint32_t>(t_ddsFile.mipMaps.size());
+
+  return {};
+}
+
+Dds::Result<LoadDds::DDS_FILE> LoadDds::LoadRegion(const char* t_path, const REGION& t_region, const Dds::LoadOptions& t_options) {
+  Dds::LoadOptions options = t_options;
+  options.firstMip         = t_region.mip;
+  options.mipCount         = 1;
+
+  return Run<DDS_FILE>(t_path, [&](DDS_FILE& t_ddsFile)
+  {
+    if (options.storage == Dds::Storage::Mapped) {
+      // the rows are copied out, the mapping is only needed while they are
+      Dds::MappedFile mapping;
+      {
+        const Dds::StageTimer timer(Dds::Stage::Open);
+        if (!mapping.Open(t_path)) {
+          return Dds::STATUS{Dds::Error::OpenFailed};
         }
-        break;
-      default:
-        throw std::runtime_error("Unsupported format");
+      }
+      const std::span<const std::byte> file(mapping.Data(), mapping.Size());
+      if (const Dds::STATUS status = ParseLayout(t_ddsFile, file, file.size(), options); !status.Ok()) {
+        return status;
+      }
+      return LoadRegionImpl(t_ddsFile, t_region, options, [file](const uint64_t t_offset, const std::span<std::byte> t_destination)
+      {
+        std::memcpy(t_destination.data(), file.data() + t_offset, t_destination.size());
+        Dds::CountBytesCopied(t_destination.size());
+        return true;
+      });
     }
 
-    auto   itBegin        = buffer.begin() + static_cast<long long int>(headerOffset);
-    size_t remainingBytes = fileSize - headerOffset;
+    Dds::FileReader file;
+    if (const Dds::STATUS status = ReadHeaders(file, t_path, t_ddsFile, options); !status.Ok()) {
+      return status;
+    }
+    return LoadRegionImpl(t_ddsFile, t_region, options, [&file](const uint64_t t_offset, const std::span<std::byte> t_destination)
+    {
+      if (!file.ReadAt(t_offset, t_destination)) {
+        return false;
+      }
+      Dds::CountBytesRead(t_destination.size());
+      return true;
+    });
+  });
+}
 
-    // verify we read all bytes based on the block size, mip maps and resolution
-    if (!ValidateExpectedSize(ddsFile, remainingBytes, itBegin)) {
-      throw std::runtime_error("Data size smaller than expected (corrupt or mismatched header)");
+Dds::Result<LoadDds::DDS_FILE> LoadDds::LoadRegion(const std::span<const std::byte> t_data,
+                                                   const REGION&                    t_region,
+                                                   const Dds::LoadOptions&          t_options) {
+  Dds::LoadOptions options = t_options;
+  options.firstMip         = t_region.mip;
+  options.mipCount         = 1;
+
+  return Run<DDS_FILE>(nullptr, [&](DDS_FILE& t_ddsFile)
+  {
+    if (const Dds::STATUS status = ParseLayout(t_ddsFile, t_data, t_data.size(), options); !status.Ok()) {
+      return status;
     }
+    return LoadRegionImpl(t_ddsFile, t_region, options, [t_data](const uint64_t t_offset, const std::span<std::byte> t_destination)
+    {
+      std::memcpy(t_destination.data(), t_data.data() + t_offset, t_destination.size());
+      Dds::CountBytesCopied(t_destination.size());
+      return true;
+    });
+  });
+}
 
-    if (m_flipOnLoad) {
-      Flip(ddsFile);
+Dds::STATUS LoadDds::TextureLoadDdsImpl(DDS_FILE&                        t_ddsFile,
+                                        const char*                      t_path,
+                                        std::pmr::memory_resource* const t_resource,
+                                        const std::span<std::byte>       t_destination,
+                                        const Dds::LoadOptions&          t_options) {
+  if (t_options.storage == Dds::Storage::Mapped) {
+    // map the whole file, the mip chain will point straight into the mapping
+    {
+      const Dds::StageTimer timer(Dds::Stage::Open);
+      if (!t_ddsFile.mapping.Open(t_path)) {
+        return {Dds::Error::OpenFailed};
+      }
     }
 
-    return ddsFile;
+    const std::span<std::byte> file(t_ddsFile.mapping.Data(), t_ddsFile.mapping.Size());
+    if (const Dds::STATUS status = ParseLayout(t_ddsFile, file, file.size(), t_options); !status.Ok()) {
+      return status;
+    }
+
+    if (t_ddsFile.LayerCount() == 1) {
+      t_ddsFile.data = file.subspan(t_ddsFile.payloadOffset, t_ddsFile.totalSizeBytes);
+    }
+    else {
+      // layers have to be regrouped by level, which the mapping cannot do without copying anyway
+      t_ddsFile.buffer = AllocatePayload(t_ddsFile.totalSizeBytes);
+      t_ddsFile.data   = {t_ddsFile.buffer.Data(), t_ddsFile.totalSizeBytes};
+      CopyPayload(t_ddsFile, file.data(), t_ddsFile.data.data());
+      t_ddsFile.mapping.Close();
+    }
+  }
+  else {
+    Dds::FileReader file;
+    if (const Dds::STATUS status = ReadHeaders(file, t_path, t_ddsFile, t_options); !status.Ok()) {
+      return status;
+    }
+
+    if (t_resource) {
+      // single allocation for the whole mip chain
+      t_ddsFile.buffer = AllocatePayload(t_ddsFile.totalSizeBytes, t_resource);
+      t_ddsFile.data   = {t_ddsFile.buffer.Data(), t_ddsFile.totalSizeBytes};
+    }
+    else {
+      if (t_destination.size() < t_ddsFile.totalSizeBytes) {
+        return {Dds::Error::DestinationTooSmall};
+      }
+
+      t_ddsFile.data = t_destination.first(t_ddsFile.totalSizeBytes);
+    }
+
+    // positioned reads of only the selected mip range, straight into its final location
+    const Dds::StageTimer timer(Dds::Stage::Read);
+    for (const PAYLOAD_RUN& run : PayloadRuns(t_ddsFile)) {
+      if (!file.ReadAt(run.fileOffset, t_ddsFile.data.subspan(run.offset, run.size))) {
+        return {Dds::Error::ShortRead, run.mip};
+      }
+      Dds::CountBytesRead(run.size);
+    }
   }
-  catch (const std::runtime_error& e) {
-    std::cerr << "[DDS] - Error: " << e.what() << '\n';
-    return {}; // return default initialized
+
+  if (t_options.flipVertical) {
+    Flip(t_ddsFile, t_options);
   }
-}
 
-void LoadDds::FlipVerticalOnLoad(const bool t_flip) {
-  m_flipOnLoad = t_flip;
+  return {};
 }
 
-bool LoadDds::ValidateExpectedSize(DDS_FILE&                               t_ddsFile,
-                                   const size_t                            t_remainingBytes,
-                                   const std::vector<std::byte>::iterator& t_itBegin) {
-  // compute expected size (compressed) and validate
-  auto mipSurfaceSize = [&] (const uint32_t t_w, const uint32_t t_h)-> size_t
-  {
-    const uint32_t blocksW = (t_w + 3) / 4;
-    const uint32_t blocksH = (t_h + 3) / 4;
-    return static_cast<size_t>(blocksW) * static_cast<size_t>(blocksH) * static_cast<size_t>(t_ddsFile.blockSize);
-  };
+Dds::STATUS LoadDds::LoadFromMemory(DDS_FILE&                        t_ddsFile,
+                                    const std::span<const std::byte> t_data,
+                                    const Dds::LoadOptions&          t_options) {
+  if (const Dds::STATUS status = ParseLayout(t_ddsFile, t_data, t_data.size(), t_options); !status.Ok()) {
+    return status;
+  }
+
+  // only single layer textures are already in level-major order inside the file
+  const bool fileOrder = t_ddsFile.LayerCount() == 1;
 
-  uint32_t w = t_ddsFile.header.dwWidth;
-  uint32_t h = t_ddsFile.header.dwHeight;
+  // a borrowed view is never written to, flipping forces a copy
+  if (t_options.storage == Dds::Storage::Borrowed && !t_options.flipVertical && fileOrder) {
+    t_ddsFile.data = {const_cast<std::byte*>(t_data.data()) + t_ddsFile.payloadOffset, t_ddsFile.totalSizeBytes};
+    return {};
+  }
+  if (t_options.storage == Dds::Storage::Mapped) {
+    return {Dds::Error::UnsupportedStorage};
+  }
 
-  size_t offset = 0;
+  t_ddsFile.buffer = AllocatePayload(t_ddsFile.totalSizeBytes);
+  t_ddsFile.data   = {t_ddsFile.buffer.Data(), t_ddsFile.totalSizeBytes};
 
-  for (uint32_t mip = 0; mip < t_ddsFile.header.dwMipMapCount; ++mip) {
-    const size_t mipSize = mipSurfaceSize(w, h); // size of this mip level in bytes
+  if (t_options.flipVertical && fileOrder) {
+    // flip on the way out of the source instead of copying first and flipping in place
+    FlipMips(t_ddsFile, t_data.data() + t_ddsFile.payloadOffset, t_ddsFile.data.data(), 0, t_ddsFile.mipMaps.size(), t_options);
+  }
+  else {
+    CopyPayload(t_ddsFile, t_data.data(), t_ddsFile.data.data());
+    if (t_options.flipVertical) {
+      Flip(t_ddsFile, t_options);
+    }
+  }
 
-    const size_t beginOffset = offset;
-    const size_t endOffset   = offset + mipSize;
+  return {};
+}
 
-    // Safety check
-    if (endOffset > t_remainingBytes) {
-      return false; // file too short for this mip
+Dds::STATUS LoadDds::LoadFromReadAt(DDS_FILE&                  t_ddsFile,
+                                    const ReadAtFn&            t_readAt,
+                                    std::pmr::memory_resource* t_resource,
+                                    const Dds::LoadOptions&    t_options) {
+  // legacy header first, the DX10 extension is only read when the FourCC says it exists so files
+  // smaller than both headers together still load
+  std::byte headerBytes[4 + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10)];
+  size_t    headerRead = 4 + sizeof(DDS_HEADER);
+  {
+    const Dds::StageTimer timer(Dds::Stage::Read);
+    if (!t_readAt(0, std::span(headerBytes, headerRead))) {
+      return {Dds::Error::TruncatedHeader};
     }
 
-    t_ddsFile.mipMaps.emplace_back(
-      w,
-      h,
-      std::vector(t_itBegin + static_cast<ptrdiff_t>(beginOffset), t_itBegin + static_cast<ptrdiff_t>(endOffset)));
+    uint32_t fourCC;
+    std::memcpy(&fourCC, headerBytes + 4 + offsetof(DDS_HEADER, ddspf) + offsetof(DDS_PIXELFORMAT, dwFourCC), 4);
+    if (fourCC == DX10) {
+      if (!t_readAt(headerRead, std::span(headerBytes + headerRead, sizeof(DDS_HEADER_DXT10)))) {
+        return {Dds::Error::TruncatedHeader};
+      }
+      headerRead += sizeof(DDS_HEADER_DXT10);
+    }
+    Dds::CountBytesRead(headerRead);
+  }
 
-    offset += mipSize;
+  // the source size is unknown, a short payload read below catches truncated files
+  if (const Dds::STATUS status = ParseLayout(t_ddsFile, std::span(headerBytes, headerRead), SIZE_MAX, t_options);
+      !status.Ok()) {
+    return status;
+  }
 
-    w = std::max(1u, w / 2u);
-    h = std::max(1u, h / 2u);
+  t_ddsFile.buffer = AllocatePayload(t_ddsFile.totalSizeBytes, t_resource);
+  t_ddsFile.data   = {t_ddsFile.buffer.Data(), t_ddsFile.totalSizeBytes};
+
+  {
+    const Dds::StageTimer timer(Dds::Stage::Read);
+    for (const PAYLOAD_RUN& run : PayloadRuns(t_ddsFile)) {
+      if (!t_readAt(run.fileOffset, t_ddsFile.data.subspan(run.offset, run.size))) {
+        return {Dds::Error::ShortRead, run.mip};
+      }
+      Dds::CountBytesRead(run.size);
+    }
   }
 
-  t_ddsFile.totalSizeBytes = offset;
+  if (t_options.flipVertical) {
+    Flip(t_ddsFile, t_options);
+  }
 
-  // return true if the calculated size is less than or equal to the length of the rest of the file 
-  return t_remainingBytes >= t_ddsFile.totalSizeBytes;
+  return {};
 }
 
-void LoadDds::Flip(DDS_FILE& t_ddsFile) {
-  const uint32_t blockSize = t_ddsFile.blockSize;
+Dds::STATUS LoadDds::StreamInMipsImpl(const char*             t_path,
+                                      DDS_FILE&               t_ddsFile,
+                                      const uint32_t          t_firstMip,
+                                      const Dds::LoadOptions& t_options) {
+  if (t_ddsFile.mipMaps.empty()) {
+    return {Dds::Error::InvalidMipRange, t_firstMip};
+  }
+  if (t_firstMip >= t_ddsFile.firstMip) {
+    return {}; // nothing to add
+  }
 
-  for (auto& [width, height, data] : t_ddsFile.mipMaps) {
-    // this mip's resolution
-    const uint32_t blocksWide = (width + 3) / 4;
-    const uint32_t blocksHigh = (height + 3) / 4;
+  // layout of just the missing levels
+  Dds::LoadOptions options = t_options;
+  options.firstMip         = t_firstMip;
+  options.mipCount         = t_ddsFile.firstMip - t_firstMip;
 
-    const uint32_t rowSize = blocksWide * blockSize;
+  DDS_INFO        missing;
+  Dds::FileReader file;
+  if (const Dds::STATUS status = ReadHeaders(file, t_path, missing, options); !status.Ok()) {
+    return status;
+  }
 
-    // flip blocks vertically row by row
-    for (uint32_t y = 0; y < blocksHigh / 2; ++y) {
-      std::byte* topRow    = data.data() + static_cast<size_t>(y * rowSize);
-      std::byte* bottomRow = data.data() + static_cast<size_t>((blocksHigh - 1 - y) * rowSize);
-      for (uint32_t x = 0; x < blocksWide; ++x) {
-        std::byte* topBlock    = topRow + static_cast<size_t>(x * blockSize);
-        std::byte* bottomBlock = bottomRow + static_cast<size_t>(x * blockSize);
+  // the new levels have to end where the loaded ones start inside every layer of the file
+  size_t missingLayerBytes = 0;
+  for (const MIP_LEVEL& mip : missing.mipMaps) {
+    missingLayerBytes += mip.layerSize;
+  }
 
-        if (t_ddsFile.flags.HasFlag(Dds::Flag::DXT1)) {
-          FlipDxt1Block(topBlock);
-          FlipDxt1Block(bottomBlock);
-        }
-        else if (t_ddsFile.flags.HasFlag(Dds::Flag::DXT3)) {
-          FlipDxt3Block(topBlock);
-          FlipDxt3Block(bottomBlock);
-        }
-        else if (t_ddsFile.flags.HasFlag(Dds::Flag::DXT5)) {
-          FlipDxt5Block(topBlock);
-          FlipDxt5Block(bottomBlock);
-        }
-        else if (t_ddsFile.flags.HasFlag(Dds::Flag::BC4_U)) {
-          FlipBc4Block(topBlock);
-          FlipBc4Block(bottomBlock);
-        }
-        else if (t_ddsFile.flags.HasFlag(Dds::Flag::BC5_U)) {
-          FlipBc5Block(topBlock);
-          FlipBc5Block(bottomBlock);
+  if (missing.glFormat != t_ddsFile.glFormat || missing.mipMaps.size() != options.mipCount ||
+      missing.LayerCount() != t_ddsFile.LayerCount() ||
+      missing.payloadOffset + missingLayerBytes != t_ddsFile.payloadOffset) {
+    return {Dds::Error::LayoutMismatch};
+  }
+
+  const size_t added = missing.mipMaps.size();
+  const size_t total = missing.totalSizeBytes + t_ddsFile.totalSizeBytes;
+
+  if (t_ddsFile.mapping.IsOpen()) {
+    // the mapping already holds every level, the levels in front of the tail are simply exposed. only
+    // single layer textures stay mapped, so file and memory order agree
+    t_ddsFile.data = {t_ddsFile.data.data() - missing.totalSizeBytes, total};
+  }
+  else {
+    // new single allocation: new levels first, then the tail moved over
+    std::pmr::memory_resource* resource = t_ddsFile.buffer.Data() ? t_ddsFile.buffer.Resource()
+                                                                  : std::pmr::new_delete_resource();
+    Dds::AlignedBuffer buffer = AllocatePayload(total, resource);
+
+    {
+      const Dds::StageTimer timer(Dds::Stage::Read);
+      for (const PAYLOAD_RUN& run : PayloadRuns(missing)) {
+        if (!file.ReadAt(run.fileOffset, std::span(buffer.Data() + run.offset, run.size))) {
+          return {Dds::Error::ShortRead, run.mip};
         }
+        Dds::CountBytesRead(run.size);
       }
     }
 
-    if (blocksHigh % 2 == 1) {
-      std::byte* middleRow = data.data() + static_cast<size_t>((blocksHigh / 2) * rowSize);
-      for (uint32_t z = 0; z < blocksWide; ++z) {
-        if (t_ddsFile.flags.HasFlag(Dds::Flag::DXT1)) {
-          FlipDxt1Block(middleRow + static_cast<size_t>(z * blockSize));
-        }
-        else if (t_ddsFile.flags.HasFlag(Dds::Flag::DXT3)) {
-          FlipDxt3Block(middleRow + static_cast<size_t>(z * blockSize));
-        }
-        else if (t_ddsFile.flags.HasFlag(Dds::Flag::DXT5)) {
-          FlipDxt5Block(middleRow + static_cast<size_t>(z * blockSize));
-        }
-        else if (t_ddsFile.flags.HasFlag(Dds::Flag::BC4_U)) {
-          FlipBc4Block(middleRow + static_cast<size_t>(z * blockSize));
-        }
-        else if (t_ddsFile.flags.HasFlag(Dds::Flag::BC5_U)) {
-          FlipBc5Block(middleRow + static_cast<size_t>(z * blockSize));
-        }
+    const Dds::StageTimer timer(Dds::Stage::Copy);
+    std::memcpy(buffer.Data() + missing.totalSizeBytes, t_ddsFile.data.data(), t_ddsFile.totalSizeBytes);
+    Dds::CountBytesCopied(t_ddsFile.totalSizeBytes);
+
+    t_ddsFile.buffer = std::move(buffer);
+    t_ddsFile.data   = {t_ddsFile.buffer.Data(), total};
+  }
+
+  for (MIP_LEVEL& mip : t_ddsFile.mipMaps) {
+    mip.offset += missing.totalSizeBytes;
+  }
+  t_ddsFile.mipMaps.insert(t_ddsFile.mipMaps.begin(), missing.mipMaps.begin(), missing.mipMaps.end());
+
+  t_ddsFile.totalSizeBytes       = total;
+  t_ddsFile.payloadOffset        = missing.payloadOffset;
+  t_ddsFile.firstMip             = t_firstMip;
+  t_ddsFile.header.dwWidth       = missing.header.dwWidth;
+  t_ddsFile.header.dwHeight      = missing.header.dwHeight;
+  t_ddsFile.header.dwDepth       = missing.header.dwDepth;
+  t_ddsFile.header.dwMipMapCount = static_cast<uint32_t>(t_ddsFile.mipMaps.size());
+
+  if (t_options.flipVertical) {
+    FlipMips(t_ddsFile, t_ddsFile.data.data(), t_ddsFile.data.data(), 0, added, t_options);
+  }
+
+  return {};
+}
+
+Dds::STATUS LoadDds::LoadRegionImpl(DDS_FILE&               t_ddsFile,
+                                    const REGION&           t_region,
+                                    const Dds::LoadOptions& t_options,
+                                    const ReadAtFn&         t_readAt) {
+  const Dds::FORMAT_INFO& format = Dds::GetFormatInfo(t_ddsFile.format);
+  const MIP_LEVEL         level  = t_ddsFile.mipMaps.front();
+
+  // the rectangle may only end inside a block at the edge of the level
+  const bool alignedX = t_region.x % format.blockWidth == 0 &&
+                        (t_region.width % format.blockWidth == 0 || t_region.x + t_region.width == level.width);
+  const bool alignedY = t_region.y % format.blockHeight == 0 &&
+                        (t_region.height % format.blockHeight == 0 || t_region.y + t_region.height == level.height);
+  if (t_region.width == 0 || t_region.height == 0 || t_region.x > level.width || t_region.width > level.width - t_region.x ||
+      t_region.y > level.height || t_region.height > level.height - t_region.y || !alignedX || !alignedY ||
+      t_region.layer >= t_ddsFile.LayerCount() || t_region.slice >= level.depth) {
+    return {Dds::Error::InvalidRegion};
+  }
+
+  const size_t rowPitch   = format.SurfaceSize(level.width, 1); // one row of blocks
+  const size_t blocksHigh = (level.height + format.blockHeight - 1) / format.blockHeight;
+  const size_t rows       = (t_region.height + format.blockHeight - 1) / format.blockHeight;
+  const size_t rowBytes   = format.SurfaceSize(t_region.width, 1);
+  const size_t size       = rows * rowBytes;
+
+  // flipped, the rectangle's texel rows [y, y + height) come from the mirrored rows [h - y - height, h - y) of
+  // the level. when h is not a multiple of the block height those straddle one more block row, so the rows
+  // covering them are read and flipped as a surface h - y texels high starting at the first of them, which
+  // puts the rectangle in its leading block rows. that only applies when a level taller than one block
+  // row is mirrored texel by texel (PartialFlip::Reencode and a format with an encoder), otherwise its
+  // whole block rows are reversed and so are the region's. formats that cannot be flipped are loaded as
+  // stored
+  const bool     flip       = t_options.flipVertical && Dds::SelectFlipKernel(format) != nullptr;
+  const bool     partial    = level.height % format.blockHeight != 0 && level.height > format.blockHeight;
+  const bool     reencode   = t_options.partialFlip == Dds::PartialFlip::Reencode && Dds::CanFlipTexels(format);
+  const bool     blockRows  = flip && partial && !reencode;
+  const size_t   firstRow   = !flip       ? t_region.y / format.blockHeight
+                            : blockRows ? blocksHigh - t_region.y / format.blockHeight - rows
+                                        : (level.height - t_region.y - t_region.height) / format.blockHeight;
+  const size_t   readRows   = flip && !blockRows ? (level.height - t_region.y - 1) / format.blockHeight - firstRow + 1 : rows;
+  const uint32_t flipHeight = blockRows ? static_cast<uint32_t>(rows) * format.blockHeight
+                                        : level.height - t_region.y - static_cast<uint32_t>(firstRow) * format.blockHeight;
+  const uint64_t base       = t_ddsFile.payloadOffset + uint64_t{t_region.layer} * t_ddsFile.fileLayerStride +
+                          t_region.slice * (level.layerSize / level.depth) + firstRow * rowPitch +
+                          t_region.x / format.blockWidth * format.blockBytes;
+
+  Dds::AlignedBuffer buffer = AllocatePayload(readRows * rowBytes);
+  {
+    const Dds::StageTimer timer(Dds::Stage::Read);
+    // rows spanning the whole level follow each other in the file
+    const size_t reads = rowBytes == rowPitch ? 1 : readRows;
+    const size_t bytes = rowBytes == rowPitch ? readRows * rowBytes : rowBytes;
+    for (size_t read = 0; read < reads; ++read) {
+      if (!t_readAt(base + read * rowPitch, std::span(buffer.Data() + read * bytes, bytes))) {
+        return {Dds::Error::ShortRead, t_ddsFile.firstMip};
       }
     }
   }
+
+  if (flip) {
+    const Dds::StageTimer timer(Dds::Stage::Flip);
+    if (partial && !blockRows) {
+      Dds::FlipTexels(format, buffer.Data(), buffer.Data(), t_region.width, flipHeight);
+    }
+    else {
+      Dds::FlipSurface(format, buffer.Data(), buffer.Data(), t_region.width, flipHeight);
+    }
+  }
+
+  // the region is a texture of its own: one level, one layer, two dimensions
+  t_ddsFile.buffer          = std::move(buffer);
+  t_ddsFile.data            = {t_ddsFile.buffer.Data(), size};
+  t_ddsFile.mipMaps         = {MIP_LEVEL{t_region.width, t_region.height, 1, 0, size, size}};
+  t_ddsFile.totalSizeBytes  = size;
+  t_ddsFile.payloadOffset   = base;
+  t_ddsFile.arraySize       = 1;
+  t_ddsFile.faceCount       = 1;
+  t_ddsFile.fileLayerStride = size;
+
+  t_ddsFile.header.dwWidth  = t_region.width;
+  t_ddsFile.header.dwHeight = t_region.height;
+  t_ddsFile.header.dwDepth  = 1;
+  t_ddsFile.header.dwCaps2 &= ~(DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_ALLFACES | DDSCAPS2_VOLUME);
+  if (t_ddsFile.header.ddspf.dwFourCC == DX10) {
+    t_ddsFile.dxt10Header.arraySize = 1;
+    t_ddsFile.dxt10Header.miscFlag &= ~D3D10_RESOURCE_MISC_TEXTURECUBE;
+    if (t_ddsFile.dxt10Header.resourceDimension == Dds::D3D10_RESOURCE_DIMENSION_TEXTURE3D) {
+      t_ddsFile.dxt10Header.resourceDimension = Dds::D3D10_RESOURCE_DIMENSION_TEXTURE2D;
+    }
+  }
+
+  return {};
+}
+
+Dds::STATUS LoadDds::ReadHeaders(Dds::FileReader&        t_file,
+                                 const char*             t_path,
+                                 DDS_INFO&               t_ddsInfo,
+                                 const Dds::LoadOptions& t_options) {
+  {
+    const Dds::StageTimer timer(Dds::Stage::Open);
+    if (!t_file.Open(t_path)) {
+      return {Dds::Error::OpenFailed};
+    }
+  }
+
+  const size_t fileSize = t_file.Size();
+  if (fileSize == 0) {
+    return {Dds::Error::EmptyFile};
+  }
+
+  // read only the headers so the mip chain can be sized before touching the payload
+  std::byte    headerBytes[4 + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10)];
+  const size_t headerRead = std::min(fileSize, sizeof(headerBytes));
+  {
+    const Dds::StageTimer timer(Dds::Stage::Read);
+    if (!t_file.ReadAt(0, std::span(headerBytes, headerRead))) {
+      return {Dds::Error::ReadFailed};
+    }
+    Dds::CountBytesRead(headerRead);
+  }
+
+  return ParseLayout(t_ddsInfo, std::span(headerBytes, headerRead), fileSize, t_options);
 }
 
-// general 4-byte row swap (DXT1 color/DXT3 alpha or color)
-void LoadDds::Flip4ByteRow(std::byte* t_colorBlock) {
-  std::swap(t_colorBlock[0], t_colorBlock[3]);
-  std::swap(t_colorBlock[1], t_colorBlock[2]);
+Dds::STATUS LoadDds::ParseLayout(DDS_INFO&                        t_ddsInfo,
+                                 const std::span<const std::byte> t_headerBytes,
+                                 const size_t                     t_fileSize,
+                                 const Dds::LoadOptions&          t_options) {
+  const Dds::StageTimer timer(Dds::Stage::Parse);
+  if (const Dds::STATUS status = ParseHeader(t_ddsInfo, t_headerBytes, t_options); !status.Ok()) {
+    return status;
+  }
+  if (const Dds::STATUS status = ParseDimensions(t_ddsInfo); !status.Ok()) {
+    return status;
+  }
+
+  // verify the file holds all bytes based on the block size, mip maps and resolution
+  const size_t remainingBytes = t_fileSize - t_ddsInfo.payloadOffset;
+  if (const Dds::STATUS status = ValidateExpectedSize(t_ddsInfo, remainingBytes); !status.Ok()) {
+    return status;
+  }
+
+  if (t_options.validation == Dds::Validation::Strict && t_fileSize != SIZE_MAX &&
+      remainingBytes != t_ddsInfo.totalSizeBytes) {
+    return {Dds::Error::TrailingData};
+  }
+
+  return SelectMipRange(t_ddsInfo, t_options);
 }
 
-// DXT5 alpha / BC4 / BC5 single channel
-void LoadDds::Flip3BitIndicesBlock(std::byte* t_block) {
-  // Extract 6-byte 3-bit indices like DXT5 alpha
-  uint8_t indices[6];
-  for (int i = 0; i < 6; ++i) {
-    indices[i] = std::to_integer<uint8_t>(t_block[2 + i]);
+Dds::STATUS LoadDds::ParseHeader(DDS_INFO&                        t_ddsInfo,
+                                 const std::span<const std::byte> t_file,
+                                 const Dds::LoadOptions&          t_options) {
+  if (t_file.size() < 4 || std::memcmp(t_file.data(), "DDS ", 4) != 0) {
+    return {Dds::Error::BadMagic};
   }
+  if (t_file.size() < 4 + sizeof(DDS_HEADER)) {
+    return {Dds::Error::TruncatedHeader};
+  }
+
+  size_t headerOffset = 4;
+
+  // copy header
+  std::memcpy(&t_ddsInfo.header, t_file.data() + headerOffset, sizeof(DDS_HEADER));
+  headerOffset += sizeof(DDS_HEADER);
+
+  // handle DX10 header if present
+  if (t_ddsInfo.header.ddspf.dwFourCC == DX10) {
+    if (t_file.size() < headerOffset + sizeof(DDS_HEADER_DXT10)) {
+      return {Dds::Error::TruncatedHeader};
+    }
 
-  uint8_t  grid[16];
-  uint64_t bits = 0;
-  for (int i = 0; i < 6; ++i) {
-    bits |= static_cast<uint64_t>(indices[i]) << (8 * i);
+    std::memcpy(&t_ddsInfo.dxt10Header, t_file.data() + headerOffset, sizeof(DDS_HEADER_DXT10));
+    headerOffset += sizeof(DDS_HEADER_DXT10);
   }
-  for (int i = 0; i < 16; ++i) {
-    grid[i] = static_cast<uint8_t>((bits >> (3 * i)) & 0x7);
+
+  t_ddsInfo.payloadOffset = headerOffset;
+
+  // make sure mip map is always at least 1
+  t_ddsInfo.header.dwMipMapCount = t_ddsInfo.header.dwMipMapCount ? t_ddsInfo.header.dwMipMapCount : 1;
+  // no 32-bit extent has more levels than this, anything larger is a corrupt header
+  if (t_ddsInfo.header.dwMipMapCount > 32) {
+    return {Dds::Error::InvalidMipCount, t_ddsInfo.header.dwMipMapCount};
   }
+  t_ddsInfo.mipMaps.reserve(t_ddsInfo.header.dwMipMapCount);
 
-  // Flip 4x4 vertically
-  for (int x = 0; x < 4; ++x) {
-    std::swap(grid[0 * 4 + x], grid[3 * 4 + x]);
-    std::swap(grid[1 * 4 + x], grid[2 * 4 + x]);
+  if (t_options.validation == Dds::Validation::Strict) {
+    if (const Dds::STATUS status = ValidateHeaderStrict(t_ddsInfo.header); !status.Ok()) {
+      return status;
+    }
   }
 
-  // Repack back into 6 bytes
-  bits = 0;
-  for (int i = 0; i < 16; ++i) {
-    bits |= static_cast<uint64_t>(grid[i] & 0x7) << (3 * i);
+  const Dds::FORMAT_INFO* format = nullptr;
+  bool                    srgb   = false;
+
+  if (t_ddsInfo.header.ddspf.dwFourCC == DX10) {
+    format = Dds::FindDxgiFormat(static_cast<uint32_t>(t_ddsInfo.dxt10Header.dxgiFormat), srgb);
+    if (!format) {
+      return {Dds::Error::UnsupportedFormat, static_cast<uint32_t>(t_ddsInfo.dxt10Header.dxgiFormat)};
+    }
   }
-  for (int i = 0; i < 6; ++i) {
-    t_block[2 + i] = static_cast<std::byte>((bits >> (8 * i)) & 0xFF);
+  else {
+    format = t_ddsInfo.header.ddspf.dwFourCC ? Dds::FindFourCC(t_ddsInfo.header.ddspf.dwFourCC)
+                                             : Dds::FindPixelMasks(t_ddsInfo.header.ddspf);
+    if (!format) {
+      return {Dds::Error::UnsupportedFormat, t_ddsInfo.header.ddspf.dwFourCC};
+    }
+    // legacy files carry no colour space, sRGB is assumed unless the caller says otherwise
+    srgb = t_options.legacyColorSpace == Dds::ColorSpace::Srgb;
   }
+
+  t_ddsInfo.format    = format->format;
+  t_ddsInfo.blockSize = format->blockBytes;
+  t_ddsInfo.glFormat  = srgb && format->glSrgbInternalFormat ? format->glSrgbInternalFormat : format->glInternalFormat;
+  t_ddsInfo.flags.SetFlag(format->flag);
+
+  return {};
 }
 
-// Flips a single 8-byte DXT1 block vertically
-void LoadDds::FlipDxt1Block(std::byte* t_block) {
-  // layout: 2 bytes color0, 2 bytes color1, 4 bytes indices
-  // Break indices into 4 rows (8 bits each)
-  Flip4ByteRow(t_block + 4);
+Dds::STATUS LoadDds::ValidateExpectedSize(DDS_INFO& t_ddsInfo, const size_t t_remainingBytes) {
+  // compute expected size and validate
+  const Dds::FORMAT_INFO& format = Dds::GetFormatInfo(t_ddsInfo.format);
+
+  uint32_t w = t_ddsInfo.header.dwWidth;
+  uint32_t h = t_ddsInfo.header.dwHeight;
+  uint32_t d = t_ddsInfo.header.dwDepth;
+
+  const size_t layers = t_ddsInfo.LayerCount();
+
+  size_t offset      = 0;
+  size_t layerStride = 0;
+
+  for (uint32_t mip = 0; mip < t_ddsInfo.header.dwMipMapCount; ++mip) {
+    const size_t layerSize = format.SurfaceSize(w, h) * d; // one layer of this mip level in bytes
+
+    // Safety check, also keeps the multiplications below from overflowing on garbage extents
+    if (layerSize > t_remainingBytes / layers || offset + layerSize * layers > t_remainingBytes) {
+      return {Dds::Error::TruncatedMip, mip}; // file too short for this mip
+    }
+
+    // level-major in memory: every layer of this level back to back
+    t_ddsInfo.mipMaps.push_back({w, h, d, offset, layerSize * layers, layerSize});
 
-  // Colors stay the same, no need to touch them
+    offset      += layerSize * layers;
+    layerStride += layerSize;
+
+    w = std::max(1u, w / 2u);
+    h = std::max(1u, h / 2u);
+    d = std::max(1u, d / 2u);
+  }
+
+  t_ddsInfo.totalSizeBytes  = offset;
+  t_ddsInfo.fileLayerStride = layerStride;
+
+  return {};
 }
 
-void LoadDds::FlipDxt3Block(std::byte* t_block) {
-  // Alpha: 4x4 pixels, 4 bits each
-  Flip4ByteRow(t_block);
+Dds::STATUS LoadDds::ValidateHeaderStrict(const DDS_HEADER& t_header) {
+  constexpr uint32_t requiredFlags = 0x1 | 0x2 | 0x4 | 0x1000; // CAPS | HEIGHT | WIDTH | PIXELFORMAT
 
-  // Color indices (like DXT1): 4 bytes starting at t_block + 12
-  Flip4ByteRow(t_block + 12);
+  // invalid header or pixel format size, missing required flags or a zero extent
+  if (t_header.dwSize != sizeof(DDS_HEADER) || t_header.ddspf.dwSize != sizeof(DDS_PIXELFORMAT) ||
+      (t_header.dwFlags & requiredFlags) != requiredFlags || t_header.dwWidth == 0 || t_header.dwHeight == 0) {
+    return {Dds::Error::InvalidHeader};
+  }
+
+  // a full chain ends at 1x1, anything longer repeats 1x1 levels
+  const uint32_t maxMips = std::bit_width(std::max(t_header.dwWidth, t_header.dwHeight));
+  if (t_header.dwMipMapCount > maxMips) {
+    return {Dds::Error::InvalidMipCount, t_header.dwMipMapCount};
+  }
+
+  return {};
 }
 
-// Flip a single 16-byte DXT5 block vertically
-void LoadDds::FlipDxt5Block(std::byte* t_block) {
-  // Flip alpha (first 8 bytes as BC4)
-  Flip3BitIndicesBlock(t_block);
+Dds::STATUS LoadDds::ParseDimensions(DDS_INFO& t_ddsInfo) {
+  DDS_HEADER& header = t_ddsInfo.header;
+  bool        volume;
+
+  if (header.ddspf.dwFourCC == DX10) {
+    const DDS_HEADER_DXT10& dxt10Header = t_ddsInfo.dxt10Header;
+
+    volume = dxt10Header.resourceDimension == Dds::D3D10_RESOURCE_DIMENSION_TEXTURE3D;
+    // 0 is invalid but some writers store it for plain textures
+    t_ddsInfo.arraySize = std::max(1u, dxt10Header.arraySize);
+    t_ddsInfo.faceCount = (dxt10Header.miscFlag & D3D10_RESOURCE_MISC_TEXTURECUBE) ? 6 : 1;
+  }
+  else {
+    volume              = (header.dwCaps2 & DDSCAPS2_VOLUME) != 0;
+    t_ddsInfo.arraySize = 1;
+    // legacy cubemaps may leave faces out, the ones present are stored in +X, -X, +Y, -Y, +Z, -Z order
+    t_ddsInfo.faceCount = (header.dwCaps2 & DDSCAPS2_CUBEMAP)
+                            ? static_cast<uint32_t>(std::max(1, std::popcount(header.dwCaps2 & DDSCAPS2_CUBEMAP_ALLFACES)))
+                            : 1;
+  }
+
+  if (t_ddsInfo.arraySize > MAX_ARRAY_SIZE) {
+    return {Dds::Error::InvalidArraySize, t_ddsInfo.arraySize};
+  }
+  if (volume && t_ddsInfo.LayerCount() != 1) {
+    return {Dds::Error::InvalidDimension};
+  }
 
-  // Flip color indices (like DXT1)
-  Flip4ByteRow(t_block + 12);
+  header.dwDepth = volume ? std::max(1u, header.dwDepth) : 1;
+  return {};
 }
 
-void LoadDds::FlipBc4Block(std::byte* t_block) {
-  Flip3BitIndicesBlock(t_block);
+Dds::STATUS LoadDds::SelectMipRange(DDS_INFO& t_ddsInfo, const Dds::LoadOptions& t_options) {
+  const size_t mipCount = t_ddsInfo.mipMaps.size();
+  if (t_options.firstMip == 0 && t_options.mipCount >= mipCount) {
+    return {};
+  }
+
+  if (t_options.firstMip >= mipCount || t_options.mipCount == 0) {
+    return {Dds::Error::InvalidMipRange, t_options.firstMip};
+  }
+
+  const size_t first = t_options.firstMip;
+  const size_t last  = std::min(mipCount, first + t_options.mipCount);
+  const size_t base  = t_ddsInfo.mipMaps[first].offset;
+
+  // the kept levels are contiguous in memory and inside every layer of the file
+  size_t layerBase = 0;
+  for (size_t mip = 0; mip < first; ++mip) {
+    layerBase += t_ddsInfo.mipMaps[mip].layerSize;
+  }
+
+  t_ddsInfo.mipMaps.erase(t_ddsInfo.mipMaps.begin() + static_cast<ptrdiff_t>(last), t_ddsInfo.mipMaps.end());
+  t_ddsInfo.mipMaps.erase(t_ddsInfo.mipMaps.begin(), t_ddsInfo.mipMaps.begin() + static_cast<ptrdiff_t>(first));
+
+  t_ddsInfo.totalSizeBytes = 0;
+  for (MIP_LEVEL& mip : t_ddsInfo.mipMaps) {
+    mip.offset -= base;
+    t_ddsInfo.totalSizeBytes += mip.size;
+  }
+  t_ddsInfo.payloadOffset += layerBase;
+  t_ddsInfo.firstMip = static_cast<uint32_t>(first);
+
+  // keep the header describing what was actually loaded
+  t_ddsInfo.header.dwWidth       = t_ddsInfo.mipMaps.front().width;
+  t_ddsInfo.header.dwHeight      = t_ddsInfo.mipMaps.front().height;
+  t_ddsInfo.header.dwDepth       = t_ddsInfo.mipMaps.front().depth;
+  t_ddsInfo.header.dwMipMapCount = static_cast<uint32_t>(t_ddsInfo.mipMaps.size());
+
+  return {};
+}
+
+std::vector<LoadDds::PAYLOAD_RUN> LoadDds::PayloadRuns(const DDS_INFO& t_ddsInfo) {
+  const uint32_t layers = t_ddsInfo.LayerCount();
+  if (layers == 1) {
+    return {{t_ddsInfo.payloadOffset, 0, t_ddsInfo.totalSizeBytes, t_ddsInfo.firstMip}};
+  }
+
+  std::vector<PAYLOAD_RUN> runs;
+  runs.reserve(layers * t_ddsInfo.mipMaps.size());
+
+  for (uint32_t layer = 0; layer < layers; ++layer) {
+    uint64_t fileOffset = t_ddsInfo.payloadOffset + layer * t_ddsInfo.fileLayerStride;
+    for (size_t mip = 0; mip < t_ddsInfo.mipMaps.size(); ++mip) {
+      const MIP_LEVEL& level = t_ddsInfo.mipMaps[mip];
+      runs.push_back({fileOffset, level.offset + layer * level.layerSize, level.layerSize,
+                      t_ddsInfo.firstMip + static_cast<uint32_t>(mip)});
+      fileOffset += level.layerSize;
+    }
+  }
+
+  return runs;
+}
+
+void LoadDds::CopyPayload(const DDS_INFO& t_ddsInfo, const std::byte* t_file, std::byte* t_destination) {
+  const Dds::StageTimer timer(Dds::Stage::Copy);
+  Dds::CountBytesCopied(t_ddsInfo.totalSizeBytes);
+  for (const PAYLOAD_RUN& run : PayloadRuns(t_ddsInfo)) {
+    std::memcpy(t_destination + run.offset, t_file + run.fileOffset, run.size);
+  }
 }
 
-// Flip a single 16-byte BC5 block vertically (red + green channels)
-void LoadDds::FlipBc5Block(std::byte* t_block) {
-  Flip3BitIndicesBlock(t_block);     // Red channel
-  Flip3BitIndicesBlock(t_block + 8); // Green channel
+void LoadDds::Flip(DDS_FILE& t_ddsFile, const Dds::LoadOptions& t_options) {
+  FlipMips(t_ddsFile, t_ddsFile.data.data(), t_ddsFile.data.data(), 0, t_ddsFile.mipMaps.size(), t_options);
+}
+
+void LoadDds::FlipMips(const DDS_INFO&         t_ddsInfo,
+                       const std::byte*        t_source,
+                       std::byte*              t_destination,
+                       const size_t            t_begin,
+                       const size_t            t_end,
+                       const Dds::LoadOptions& t_options) {
+  const Dds::StageTimer timer(Dds::Stage::Flip);
+  if (t_source != t_destination && t_begin < t_end) {
+    // flipping on the way out of the source replaces the copy, so it counts as one
+    Dds::CountBytesCopied(t_ddsInfo.mipMaps[t_end - 1].offset + t_ddsInfo.mipMaps[t_end - 1].size -
+                          t_ddsInfo.mipMaps[t_begin].offset);
+  }
+
+  const Dds::FORMAT_INFO& format = Dds::GetFormatInfo(t_ddsInfo.format);
+  if (!Dds::SelectFlipKernel(format)) {
+    // formats that cannot be flipped are left as stored, a separate destination still has to get the bytes
+    if (t_source != t_destination && t_begin < t_end) {
+      const size_t begin = t_ddsInfo.mipMaps[t_begin].offset;
+      const size_t end   = t_ddsInfo.mipMaps[t_end - 1].offset + t_ddsInfo.mipMaps[t_end - 1].size;
+      std::memcpy(t_destination + begin, t_source + begin, end - begin);
+    }
+    return;
+  }
+
+  const bool reencode = t_options.partialFlip == Dds::PartialFlip::Reencode;
+  for (size_t level = t_begin; level < t_end; ++level) {
+    const MIP_LEVEL& mip = t_ddsInfo.mipMaps[level];
+
+    // every layer and every volume slice is its own 2D surface, all of them the same size
+    const size_t slices    = static_cast<size_t>(t_ddsInfo.LayerCount()) * mip.depth;
+    const size_t sliceSize = mip.layerSize / mip.depth;
+    for (size_t slice = 0; slice < slices; ++slice) {
+      const size_t offset = mip.offset + slice * sliceSize;
+      Dds::FlipSurface(format, t_source + offset, t_destination + offset, mip.width, mip.height, reencode);
+    }
+  }
 }
@@ -0,0 +1,247 @@
+#include "dds/DDSWriter.h"
+
+#include <array>
+#include <bit>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "dds/FileWriter.h"
+#include "dds/Formats.h"
+
+namespace
+{
+  constexpr uint32_t DX10 = 0x30315844; // "DX10"
+
+  constexpr uint32_t DDSD_REQUIRED    = 0x1 | 0x2 | 0x4 | 0x1000; // CAPS | HEIGHT | WIDTH | PIXELFORMAT
+  constexpr uint32_t DDSD_PITCH       = 0x8;
+  constexpr uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+  constexpr uint32_t DDSD_LINEARSIZE  = 0x80000;
+  constexpr uint32_t DDSD_DEPTH       = 0x800000;
+
+  constexpr uint32_t DDPF_FOURCC = 0x4;
+
+  constexpr uint32_t DDSCAPS_COMPLEX = 0x8;
+  constexpr uint32_t DDSCAPS_TEXTURE = 0x1000;
+  constexpr uint32_t DDSCAPS_MIPMAP  = 0x400000;
+
+  constexpr uint32_t DDSCAPS2_CUBEMAP                = 0x200;
+  constexpr uint32_t DDSCAPS2_CUBEMAP_ALLFACES       = 0xFC00;
+  constexpr uint32_t DDSCAPS2_VOLUME                 = 0x200000;
+  constexpr uint32_t D3D10_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+  // magic, DDS_HEADER and DDS_HEADER_DXT10 as they go to disk, size is 128 for legacy headers
+  struct FILE_HEADERS
+  {
+    std::array<std::byte, 4 + sizeof(LoadDds::DDS_HEADER) + sizeof(LoadDds::DDS_HEADER_DXT10)> bytes{};
+    size_t                                                                                   size = 0;
+  };
+
+  bool IsVolume(const LoadDds::DDS_INFO& t_ddsInfo) {
+    if (t_ddsInfo.mipMaps[0].depth > 1) {
+      return true;
+    }
+    return t_ddsInfo.header.ddspf.dwFourCC == DX10
+             ? t_ddsInfo.dxt10Header.resourceDimension == Dds::D3D10_RESOURCE_DIMENSION_TEXTURE3D
+             : (t_ddsInfo.header.dwCaps2 & DDSCAPS2_VOLUME) != 0;
+  }
+
+  // the legacy pixel format the texture was loaded from, if it still describes t_ddsInfo.format
+  bool KeepsLegacyPixelFormat(const LoadDds::DDS_INFO& t_ddsInfo) {
+    const LoadDds::DDS_PIXELFORMAT& pixelFormat = t_ddsInfo.header.ddspf;
+    if (pixelFormat.dwFourCC == DX10 || t_ddsInfo.arraySize != 1) {
+      return false;
+    }
+    const Dds::FORMAT_INFO* format = pixelFormat.dwFlags & DDPF_FOURCC ? Dds::FindFourCC(pixelFormat.dwFourCC)
+                                                                       : Dds::FindPixelMasks(pixelFormat);
+    return format && format->format == t_ddsInfo.format;
+  }
+
+  // the DXGI_FORMAT to store, the loaded one when it still describes t_ddsInfo.format
+  uint32_t SelectDxgiFormat(const LoadDds::DDS_INFO& t_ddsInfo, const Dds::FORMAT_INFO& t_info) {
+    if (t_ddsInfo.header.ddspf.dwFourCC == DX10) {
+      bool                    srgb   = false;
+      const Dds::FORMAT_INFO* format = Dds::FindDxgiFormat(static_cast<uint32_t>(t_ddsInfo.dxt10Header.dxgiFormat), srgb);
+      if (format && format->format == t_ddsInfo.format) {
+        return static_cast<uint32_t>(t_ddsInfo.dxt10Header.dxgiFormat);
+      }
+    }
+    const bool srgb = t_info.glSrgbInternalFormat != 0 && t_ddsInfo.glFormat == t_info.glSrgbInternalFormat;
+    return Dds::GetDxgiFormat(t_ddsInfo.format, srgb);
+  }
+
+  Dds::STATUS BuildHeaders(const LoadDds::DDS_INFO& t_ddsInfo, FILE_HEADERS& t_headers) {
+    if (t_ddsInfo.mipMaps.empty() || t_ddsInfo.mipMaps.size() > 32) {
+      return {Dds::Error::InvalidMipCount};
+    }
+    if (t_ddsInfo.format == Dds::Format::Unknown || t_ddsInfo.format >= Dds::Format::Count) {
+      return {Dds::Error::UnsupportedFormat};
+    }
+
+    const Dds::FORMAT_INFO&   info   = Dds::GetFormatInfo(t_ddsInfo.format);
+    const LoadDds::MIP_LEVEL& top    = t_ddsInfo.mipMaps[0];
+    const uint32_t            mips   = static_cast<uint32_t>(t_ddsInfo.mipMaps.size());
+    const bool                volume = IsVolume(t_ddsInfo);
+    const bool                cube   = t_ddsInfo.faceCount > 1;
+
+    LoadDds::DDS_HEADER header{};
+    header.dwSize        = sizeof(LoadDds::DDS_HEADER);
+    header.dwFlags       = DDSD_REQUIRED | (info.Compressed() ? DDSD_LINEARSIZE : DDSD_PITCH);
+    header.dwHeight      = top.height;
+    header.dwWidth       = top.width;
+    header.dwMipMapCount = mips;
+    header.ddspf.dwSize  = sizeof(LoadDds::DDS_PIXELFORMAT);
+    header.dwCaps        = DDSCAPS_TEXTURE;
+    // bytes of the top level for block compressed formats, of one row of it otherwise
+    header.dwPitchOrLinearSize =
+      static_cast<uint32_t>(info.Compressed() ? info.SurfaceSize(top.width, top.height) : info.SurfaceSize(top.width, 1));
+
+    if (mips > 1) {
+      header.dwFlags |= DDSD_MIPMAPCOUNT;
+      header.dwCaps |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+    }
+    if (volume) {
+      header.dwFlags |= DDSD_DEPTH;
+      header.dwDepth = top.depth;
+      header.dwCaps |= DDSCAPS_COMPLEX;
+      header.dwCaps2 |= DDSCAPS2_VOLUME;
+    }
+
+    LoadDds::DDS_HEADER_DXT10 dxt10Header;
+    uint32_t                  dxgiFormat = 0;
+
+    if (KeepsLegacyPixelFormat(t_ddsInfo)) {
+      header.ddspf = t_ddsInfo.header.ddspf;
+    }
+    else if ((dxgiFormat = SelectDxgiFormat(t_ddsInfo, info)) != 0) {
+      header.ddspf.dwFlags  = DDPF_FOURCC;
+      header.ddspf.dwFourCC = DX10;
+
+      const bool loadedDx10 = t_ddsInfo.header.ddspf.dwFourCC == DX10;
+      dxt10Header.dxgiFormat = static_cast<DXGI_FORMAT>(dxgiFormat);
+      dxt10Header.resourceDimension =
+        volume ? Dds::D3D10_RESOURCE_DIMENSION_TEXTURE3D
+               : loadedDx10 && t_ddsInfo.dxt10Header.resourceDimension == Dds::D3D10_RESOURCE_DIMENSION_TEXTURE1D
+                   ? Dds::D3D10_RESOURCE_DIMENSION_TEXTURE1D
+                   : Dds::D3D10_RESOURCE_DIMENSION_TEXTURE2D;
+      dxt10Header.miscFlag   = cube ? D3D10_RESOURCE_MISC_TEXTURECUBE : 0;
+      dxt10Header.arraySize  = t_ddsInfo.arraySize;
+      dxt10Header.miscFlags2 = loadedDx10 ? t_ddsInfo.dxt10Header.miscFlags2 : 0;
+    }
+    else if (t_ddsInfo.arraySize != 1 || !Dds::GetPixelMasks(t_ddsInfo.format, header.ddspf)) {
+      return {Dds::Error::UnsupportedFormat, static_cast<uint32_t>(t_ddsInfo.format)};
+    }
+
+    if (cube) {
+      // only legacy headers can leave faces out, and only the ones the texture was loaded with
+      uint32_t faces = DDSCAPS2_CUBEMAP_ALLFACES;
+      if (t_ddsInfo.faceCount != 6) {
+        faces = t_ddsInfo.header.dwCaps2 & DDSCAPS2_CUBEMAP_ALLFACES;
+        if (dxgiFormat != 0 || std::popcount(faces) != static_cast<int>(t_ddsInfo.faceCount)) {
+          return {Dds::Error::InvalidDimension};
+        }
+      }
+      header.dwCaps |= DDSCAPS_COMPLEX;
+      header.dwCaps2 |= DDSCAPS2_CUBEMAP | faces;
+    }
+    if (volume && t_ddsInfo.LayerCount() != 1) {
+      return {Dds::Error::InvalidDimension};
+    }
+
+    std::memcpy(t_headers.bytes.data(), "DDS ", 4);
+    std::memcpy(t_headers.bytes.data() + 4, &header, sizeof(header));
+    t_headers.size = 4 + sizeof(header);
+    if (dxgiFormat != 0) {
+      std::memcpy(t_headers.bytes.data() + t_headers.size, &dxt10Header, sizeof(dxt10Header));
+      t_headers.size += sizeof(dxt10Header);
+    }
+    return {};
+  }
+
+  // headers plus the payload as the buffers to write, t_headers must outlive t_pieces
+  Dds::STATUS Gather(const LoadDds::DDS_FILE&                 t_ddsFile,
+                     FILE_HEADERS&                            t_headers,
+                     std::vector<std::span<const std::byte>>& t_pieces) {
+    if (const Dds::STATUS status = BuildHeaders(t_ddsFile, t_headers); !status.Ok()) {
+      return status;
+    }
+
+    const size_t layers = t_ddsFile.LayerCount();
+    for (size_t mip = 0; mip < t_ddsFile.mipMaps.size(); ++mip) {
+      const LoadDds::MIP_LEVEL& level = t_ddsFile.mipMaps[mip];
+      if (level.layerSize * layers != level.size || level.offset > t_ddsFile.data.size() ||
+          level.size > t_ddsFile.data.size() - level.offset) {
+        return {Dds::Error::TruncatedMip, static_cast<uint32_t>(t_ddsFile.firstMip + mip)};
+      }
+    }
+
+    // file order is every level of a layer in turn, pieces that already follow each other in memory
+    // (all of them for single layer textures) go out as one
+    t_pieces.reserve(1 + layers * t_ddsFile.mipMaps.size());
+    t_pieces.emplace_back(t_headers.bytes.data(), t_headers.size);
+
+    for (size_t layer = 0; layer < layers; ++layer) {
+      for (size_t mip = 0; mip < t_ddsFile.mipMaps.size(); ++mip) {
+        const std::span<const std::byte> piece = t_ddsFile.LayerData(mip, layer);
+        if (t_pieces.size() > 1 && t_pieces.back().data() + t_pieces.back().size() == piece.data()) {
+          t_pieces.back() = {t_pieces.back().data(), t_pieces.back().size() + piece.size()};
+        }
+        else if (!piece.empty()) {
+          t_pieces.push_back(piece);
+        }
+      }
+    }
+    return {};
+  }
+
+  // same shape as the loader's entry points: bad_alloc becomes OutOfMemory and failures are logged once
+  template <typename FN>
+  Dds::STATUS Run(const char* t_source, FN&& t_save) {
+    Dds::STATUS status;
+    try {
+      status = t_save();
+    }
+    catch (const std::bad_alloc&) {
+      status = {Dds::Error::OutOfMemory};
+    }
+
+    if (!status.Ok()) {
+      Dds::Log(status, t_source);
+    }
+    return status;
+  }
+}
+
+Dds::STATUS Dds::SaveDds(const char* t_path, const LoadDds::DDS_FILE& t_ddsFile) {
+  return Run(t_path, [&]
+  {
+    // everything is checked before the file is created, a texture that cannot be saved leaves no file
+    FILE_HEADERS                            headers;
+    std::vector<std::span<const std::byte>> pieces;
+    if (const STATUS status = Gather(t_ddsFile, headers, pieces); !status.Ok()) {
+      return status;
+    }
+
+    FileWriter writer;
+    if (!writer.Open(t_path)) {
+      return STATUS{Error::WriteFailed};
+    }
+
+    if (!writer.Write(pieces) || !writer.Commit()) {
+      return STATUS{Error::WriteFailed};
+    }
+    return STATUS{};
+  });
+}
+
+Dds::STATUS Dds::SaveDds(const WriteFn& t_write, const LoadDds::DDS_FILE& t_ddsFile) {
+  return Run(nullptr, [&]
+  {
+    FILE_HEADERS                            headers;
+    std::vector<std::span<const std::byte>> pieces;
+    if (const STATUS status = Gather(t_ddsFile, headers, pieces); !status.Ok()) {
+      return status;
+    }
+    return t_write(pieces) ? STATUS{} : STATUS{Error::WriteFailed};
+  });
+}
@@ -0,0 +1,581 @@
+#include "dds/DecodeKernels.h"
+
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "dds/Bc7.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Every kernel writes whole 4x4 tiles of RGBA texels, the caller clips them to the surface and scatters
+// them into rows. Interpolation follows the integer rounding of the D3D reference decoders, and the
+// AVX2 path for BC1-style colour produces the same bytes as the scalar one.
+
+namespace
+{
+  using namespace Dds;
+
+  // ---- BC1-BC5 ----
+
+  void Expand565(const uint16_t t_color, uint8_t* t_rgb) {
+    const unsigned r = (t_color >> 11) & 31;
+    const unsigned g = (t_color >> 5) & 63;
+    const unsigned b = t_color & 31;
+    t_rgb[0]         = static_cast<uint8_t>((r << 3) | (r >> 2));
+    t_rgb[1]         = static_cast<uint8_t>((g << 2) | (g >> 4));
+    t_rgb[2]         = static_cast<uint8_t>((b << 3) | (b >> 2));
+  }
+
+  // BC1 colour half. BC2/BC3 colour always uses the four colour palette, BC1 switches to three colours
+  // plus transparent black when the endpoints are not in descending order
+  void DecodeColorBlock(const std::byte* t_block, uint8_t* t_tile, const bool t_forceFourColor) {
+    uint16_t c0, c1;
+    uint32_t indices;
+    std::memcpy(&c0, t_block, 2);
+    std::memcpy(&c1, t_block + 2, 2);
+    std::memcpy(&indices, t_block + 4, 4);
+
+    uint8_t palette[4][4];
+    Expand565(c0, palette[0]);
+    Expand565(c1, palette[1]);
+    palette[0][3] = palette[1][3] = palette[2][3] = palette[3][3] = 255;
+
+    for (size_t channel = 0; channel < 3; ++channel) {
+      const unsigned a = palette[0][channel];
+      const unsigned b = palette[1][channel];
+      if (t_forceFourColor || c0 > c1) {
+        palette[2][channel] = static_cast<uint8_t>((2 * a + b) / 3);
+        palette[3][channel] = static_cast<uint8_t>((a + 2 * b) / 3);
+      }
+      else {
+        palette[2][channel] = static_cast<uint8_t>((a + b) / 2);
+        palette[3][channel] = 0;
+      }
+    }
+    if (!t_forceFourColor && c0 <= c1) {
+      palette[3][3] = 0;
+    }
+
+    for (size_t texel = 0; texel < 16; ++texel) {
+      std::memcpy(t_tile + texel * 4, palette[(indices >> (texel * 2)) & 3], 4);
+    }
+  }
+
+  // BC3 alpha / BC4 / BC5 channel: two endpoints and 3-bit indices into an 8 or 6 step ramp, the 6
+  // step ramp adds 0 and 255. Writes every t_stride'th byte of the tile
+  void DecodeChannelBlock(const std::byte* t_block, uint8_t* t_tile, const size_t t_stride) {
+    uint64_t bits;
+    std::memcpy(&bits, t_block, 8);
+    const unsigned a = bits & 0xFF;
+    const unsigned b = (bits >> 8) & 0xFF;
+    bits >>= 16;
+
+    uint8_t palette[8] = {static_cast<uint8_t>(a), static_cast<uint8_t>(b)};
+    if (a > b) {
+      for (unsigned i = 1; i < 7; ++i) {
+        palette[i + 1] = static_cast<uint8_t>(((7 - i) * a + i * b + 3) / 7);
+      }
+    }
+    else {
+      for (unsigned i = 1; i < 5; ++i) {
+        palette[i + 1] = static_cast<uint8_t>(((5 - i) * a + i * b + 2) / 5);
+      }
+      palette[6] = 0;
+      palette[7] = 255;
+    }
+
+    for (size_t texel = 0; texel < 16; ++texel) {
+      t_tile[texel * t_stride] = palette[(bits >> (texel * 3)) & 7];
+    }
+  }
+
+  void FillTile(uint8_t* t_tile, const uint32_t t_texel) {
+    for (size_t texel = 0; texel < 16; ++texel) {
+      std::memcpy(t_tile + texel * 4, &t_texel, 4);
+    }
+  }
+
+#if defined(__AVX2__)
+  // Eight colour blocks t_stride bytes apart at once, one block per 32-bit lane: the palettes are built
+  // in parallel, then every tile is expanded with two permutes of 8 texels each
+  template <size_t Stride, bool ForceFourColor>
+  void DecodeColorBlocks8(const std::byte* t_blocks, uint8_t* t_tiles) {
+    const auto    base    = reinterpret_cast<const int*>(t_blocks);
+    const __m256i offsets = _mm256_setr_epi32(0, Stride, 2 * Stride, 3 * Stride, 4 * Stride, 5 * Stride, 6 * Stride, 7 * Stride);
+    const __m256i words   = _mm256_i32gather_epi32(base, offsets, 1);
+    const __m256i indices = _mm256_i32gather_epi32(base + 1, offsets, 1);
+    const __m256i c0      = _mm256_and_si256(words, _mm256_set1_epi32(0xFFFF));
+    const __m256i c1      = _mm256_srli_epi32(words, 16);
+    const __m256i four    = ForceFourColor ? _mm256_set1_epi32(-1) : _mm256_cmpgt_epi32(c0, c1);
+    // x / 3 == (x * 0xAAAB) >> 17 for every x up to 2 * 255 + 255
+    const __m256i third   = _mm256_set1_epi32(0xAAAB);
+
+    __m256i p[4] = {_mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_setzero_si256()};
+    constexpr int SHIFTS[3] = {11, 5, 0};
+    constexpr int WIDTHS[3] = {5, 6, 5};
+    for (int channel = 0; channel < 3; ++channel) {
+      const __m256i mask   = _mm256_set1_epi32((1 << WIDTHS[channel]) - 1);
+      const __m128i up     = _mm_cvtsi32_si128(8 - WIDTHS[channel]);
+      const __m128i down   = _mm_cvtsi32_si128(2 * WIDTHS[channel] - 8);
+      const __m128i source = _mm_cvtsi32_si128(SHIFTS[channel]);
+      const auto    expand = [&](const __m256i t_color) {
+        const __m256i v = _mm256_and_si256(_mm256_srl_epi32(t_color, source), mask);
+        return _mm256_or_si256(_mm256_sll_epi32(v, up), _mm256_srl_epi32(v, down));
+      };
+
+      const __m256i a    = expand(c0);
+      const __m256i b    = expand(c1);
+      const __m256i twoA = _mm256_mullo_epi32(_mm256_add_epi32(_mm256_add_epi32(a, a), b), third);
+      const __m256i twoB = _mm256_mullo_epi32(_mm256_add_epi32(_mm256_add_epi32(b, b), a), third);
+      const __m256i half = _mm256_srli_epi32(_mm256_add_epi32(a, b), 1);
+      const __m256i p2   = _mm256_blendv_epi8(half, _mm256_srli_epi32(twoA, 17), four);
+      const __m256i p3   = _mm256_and_si256(_mm256_srli_epi32(twoB, 17), four);
+
+      const __m128i shift = _mm_cvtsi32_si128(channel * 8);
+      p[0]                = _mm256_or_si256(p[0], _mm256_sll_epi32(a, shift));
+      p[1]                = _mm256_or_si256(p[1], _mm256_sll_epi32(b, shift));
+      p[2]                = _mm256_or_si256(p[2], _mm256_sll_epi32(p2, shift));
+      p[3]                = _mm256_or_si256(p[3], _mm256_sll_epi32(p3, shift));
+    }
+
+    alignas(32) uint32_t palette[4][8];
+    const __m256i opaque = _mm256_set1_epi32(static_cast<int>(0xFF000000u));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(palette[0]), _mm256_or_si256(p[0], opaque));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(palette[1]), _mm256_or_si256(p[1], opaque));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(palette[2]), _mm256_or_si256(p[2], opaque));
+    _mm256_store_si256(reinterpret_cast<__m256i*>(palette[3]), _mm256_or_si256(p[3], _mm256_and_si256(opaque, four)));
+
+    alignas(32) uint32_t blockIndices[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(blockIndices), indices);
+
+    const __m256i lowShifts  = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+    const __m256i highShifts = _mm256_setr_epi32(16, 18, 20, 22, 24, 26, 28, 30);
+    const __m256i indexMask  = _mm256_set1_epi32(3);
+    for (size_t block = 0; block < 8; ++block) {
+      const __m256i colors   = _mm256_broadcastsi128_si256(_mm_setr_epi32(static_cast<int>(palette[0][block]),
+                                                                        static_cast<int>(palette[1][block]),
+                                                                        static_cast<int>(palette[2][block]),
+                                                                        static_cast<int>(palette[3][block])));
+      const __m256i selector = _mm256_set1_epi32(static_cast<int>(blockIndices[block]));
+      const __m256i low      = _mm256_and_si256(_mm256_srlv_epi32(selector, lowShifts), indexMask);
+      const __m256i high     = _mm256_and_si256(_mm256_srlv_epi32(selector, highShifts), indexMask);
+      auto*         tile     = reinterpret_cast<__m256i*>(t_tiles + block * 64);
+      _mm256_storeu_si256(tile, _mm256_permutevar8x32_epi32(colors, low));
+      _mm256_storeu_si256(tile + 1, _mm256_permutevar8x32_epi32(colors, high));
+    }
+  }
+#endif
+
+  // colour half of t_blockCount blocks, Stride bytes apart starting at t_blocks
+  template <size_t Stride, bool ForceFourColor>
+  void DecodeColorBlocks(const std::byte* t_blocks, const size_t t_blockCount, uint8_t* t_tiles) {
+    size_t block = 0;
+#if defined(__AVX2__)
+    for (; block + 8 <= t_blockCount; block += 8) {
+      DecodeColorBlocks8<Stride, ForceFourColor>(t_blocks + block * Stride, t_tiles + block * 64);
+    }
+#endif
+    for (; block < t_blockCount; ++block) {
+      DecodeColorBlock(t_blocks + block * Stride, t_tiles + block * 64, ForceFourColor);
+    }
+  }
+
+  void DecodeBc1(const std::byte* t_blocks, const size_t t_blockCount, std::byte* t_tiles) {
+    DecodeColorBlocks<8, false>(t_blocks, t_blockCount, reinterpret_cast<uint8_t*>(t_tiles));
+  }
+
+  void DecodeBc2(const std::byte* t_blocks, const size_t t_blockCount, std::byte* t_tiles) {
+    const auto tiles = reinterpret_cast<uint8_t*>(t_tiles);
+    DecodeColorBlocks<16, true>(t_blocks + 8, t_blockCount, tiles);
+
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      uint64_t alpha;
+      std::memcpy(&alpha, t_blocks + block * 16, 8);
+      for (size_t texel = 0; texel < 16; ++texel) {
+        tiles[block * 64 + texel * 4 + 3] = static_cast<uint8_t>(((alpha >> (texel * 4)) & 15) * 17);
+      }
+    }
+  }
+
+  void DecodeBc3(const std::byte* t_blocks, const size_t t_blockCount, std::byte* t_tiles) {
+    const auto tiles = reinterpret_cast<uint8_t*>(t_tiles);
+    DecodeColorBlocks<16, true>(t_blocks + 8, t_blockCount, tiles);
+
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      DecodeChannelBlock(t_blocks + block * 16, tiles + block * 64 + 3, 4);
+    }
+  }
+
+  void DecodeBc4(const std::byte* t_blocks, const size_t t_blockCount, std::byte* t_tiles) {
+    const auto tiles = reinterpret_cast<uint8_t*>(t_tiles);
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      FillTile(tiles + block * 64, 0xFF000000u);
+      DecodeChannelBlock(t_blocks + block * 8, tiles + block * 64, 4);
+    }
+  }
+
+  void DecodeBc5(const std::byte* t_blocks, const size_t t_blockCount, std::byte* t_tiles) {
+    const auto tiles = reinterpret_cast<uint8_t*>(t_tiles);
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      FillTile(tiles + block * 64, 0xFF000000u);
+      DecodeChannelBlock(t_blocks + block * 16, tiles + block * 64, 4);
+      DecodeChannelBlock(t_blocks + block * 16 + 8, tiles + block * 64 + 1, 4);
+    }
+  }
+
+  // ---- BC7 ----
+
+  void DecodeBc7Block(const std::byte* t_block, uint8_t* t_tile) {
+    Bc7::BLOCK block;
+    if (!Bc7::Unpack(t_block, block)) {
+      // reserved mode
+      std::memset(t_tile, 0, 64);
+      return;
+    }
+
+    const Bc7::MODE_INFO& info = Bc7::MODES[block.mode];
+
+    // endpoints to 8 bits: append the p-bit, then replicate the top bits into the bottom
+    uint8_t endpoints[6][4];
+    for (unsigned e = 0; e < info.subsets * 2u; ++e) {
+      for (unsigned channel = 0; channel < 4; ++channel) {
+        unsigned bits = channel < 3 ? info.colorBits : info.alphaBits;
+        if (bits == 0) {
+          endpoints[e][channel] = 255;
+          continue;
+        }
+
+        unsigned value = block.endpoints[e][channel];
+        if (info.endpointPBits || info.sharedPBits) {
+          value = (value << 1) | block.pBits[info.endpointPBits ? e : e / 2];
+          ++bits;
+        }
+        value <<= 8 - bits;
+        endpoints[e][channel] = static_cast<uint8_t>(value | (value >> bits));
+      }
+    }
+
+    const uint8_t* weights       = Bc7::Weights(info.indexBits);
+    const uint8_t* secondWeights = info.secondIndexBits ? Bc7::Weights(info.secondIndexBits) : nullptr;
+
+    for (uint8_t texel = 0; texel < 16; ++texel) {
+      const uint8_t  subset      = Bc7::Subset(info.subsets, block.partition, texel);
+      const uint8_t* e0          = endpoints[subset * 2];
+      const uint8_t* e1          = endpoints[subset * 2 + 1];
+      unsigned       colorWeight = weights[block.indices[texel]];
+      unsigned       alphaWeight = colorWeight;
+      if (secondWeights) {
+        alphaWeight = secondWeights[block.secondIndices[texel]];
+        if (block.indexSelection) {
+          std::swap(colorWeight, alphaWeight);
+        }
+      }
+
+      uint8_t* out = t_tile + texel * 4;
+      for (unsigned channel = 0; channel < 4; ++channel) {
+        const unsigned weight = channel < 3 ? colorWeight : alphaWeight;
+        out[channel]          = static_cast<uint8_t>(((64 - weight) * e0[channel] + weight * e1[channel] + 32) >> 6);
+      }
+      if (block.rotation) {
+        std::swap(out[3], out[block.rotation - 1]);
+      }
+    }
+  }
+
+  void DecodeBc7(const std::byte* t_blocks, const size_t t_blockCount, std::byte* t_tiles) {
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      DecodeBc7Block(t_blocks + block * 16, reinterpret_cast<uint8_t*>(t_tiles) + block * 64);
+    }
+  }
+
+  // ---- BC6H ----
+
+  // endpoint fields of the header, endpoint-major: w (the base), x, y, z, each with r, g, b
+  enum Bc6hField : uint8_t { RW, GW, BW, RX, GX, BX, RY, GY, BY, RZ, GZ, BZ, D };
+
+  // Bits [t_last..t_first] of a field in stored order, t_first is read first. The spec writes a few
+  // fields reversed (rw[10:15]), those have t_first above t_last
+  struct BC6H_SEGMENT
+  {
+    uint8_t field;
+    uint8_t last;
+    uint8_t first;
+  };
+
+  struct BC6H_MODE
+  {
+    uint8_t             regions;
+    uint8_t             precision;  // bits of the base endpoint
+    uint8_t             delta[3];   // bits of the other endpoints per channel
+    bool                transformed;
+    const BC6H_SEGMENT* layout;
+    uint8_t             segmentCount;
+  };
+
+  // header layouts after the mode bits, as listed in the BC6H format specification
+  constexpr BC6H_SEGMENT LAYOUT_0[] = {
+    {GY, 4, 4}, {BY, 4, 4}, {BZ, 4, 4}, {RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 4, 0}, {GZ, 4, 4},
+    {GY, 3, 0}, {GX, 4, 0}, {BZ, 0, 0}, {GZ, 3, 0}, {BX, 4, 0}, {BZ, 1, 1}, {BY, 3, 0}, {RY, 4, 0},
+    {BZ, 2, 2}, {RZ, 4, 0}, {BZ, 3, 3}, {D, 4, 0},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_1[] = {
+    {GY, 5, 5}, {GZ, 4, 4}, {GZ, 5, 5}, {RW, 6, 0}, {BZ, 0, 0}, {BZ, 1, 1}, {BY, 4, 4}, {GW, 6, 0},
+    {BY, 5, 5}, {BZ, 2, 2}, {GY, 4, 4}, {BW, 6, 0}, {BZ, 3, 3}, {BZ, 5, 5}, {BZ, 4, 4}, {RX, 5, 0},
+    {GY, 3, 0}, {GX, 5, 0}, {GZ, 3, 0}, {BX, 5, 0}, {BY, 3, 0}, {RY, 5, 0}, {RZ, 5, 0}, {D, 4, 0},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_2[] = {
+    {RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 4, 0}, {RW, 10, 10}, {GY, 3, 0}, {GX, 3, 0}, {GW, 10, 10},
+    {BZ, 0, 0}, {GZ, 3, 0}, {BX, 3, 0}, {BW, 10, 10}, {BZ, 1, 1}, {BY, 3, 0}, {RY, 4, 0}, {BZ, 2, 2},
+    {RZ, 4, 0}, {BZ, 3, 3}, {D, 4, 0},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_3[] = {
+    {RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 3, 0}, {RW, 10, 10}, {GZ, 4, 4}, {GY, 3, 0}, {GX, 4, 0},
+    {GW, 10, 10}, {GZ, 3, 0}, {BX, 3, 0}, {BW, 10, 10}, {BZ, 1, 1}, {BY, 3, 0}, {RY, 3, 0}, {BZ, 0, 0},
+    {BZ, 2, 2}, {RZ, 3, 0}, {GY, 4, 4}, {BZ, 3, 3}, {D, 4, 0},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_4[] = {
+    {RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 3, 0}, {RW, 10, 10}, {BY, 4, 4}, {GY, 3, 0}, {GX, 3, 0},
+    {GW, 10, 10}, {BZ, 0, 0}, {GZ, 3, 0}, {BX, 4, 0}, {BW, 10, 10}, {BY, 3, 0}, {RY, 3, 0}, {BZ, 1, 1},
+    {BZ, 2, 2}, {RZ, 3, 0}, {BZ, 4, 4}, {BZ, 3, 3}, {D, 4, 0},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_5[] = {
+    {RW, 8, 0}, {BY, 4, 4}, {GW, 8, 0}, {GY, 4, 4}, {BW, 8, 0}, {BZ, 4, 4}, {RX, 4, 0}, {GZ, 4, 4},
+    {GY, 3, 0}, {GX, 4, 0}, {BZ, 0, 0}, {GZ, 3, 0}, {BX, 4, 0}, {BZ, 1, 1}, {BY, 3, 0}, {RY, 4, 0},
+    {BZ, 2, 2}, {RZ, 4, 0}, {BZ, 3, 3}, {D, 4, 0},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_6[] = {
+    {RW, 7, 0}, {GZ, 4, 4}, {BY, 4, 4}, {GW, 7, 0}, {BZ, 2, 2}, {GY, 4, 4}, {BW, 7, 0}, {BZ, 3, 3},
+    {BZ, 4, 4}, {RX, 5, 0}, {GY, 3, 0}, {GX, 4, 0}, {BZ, 0, 0}, {GZ, 3, 0}, {BX, 4, 0}, {BZ, 1, 1},
+    {BY, 3, 0}, {RY, 5, 0}, {RZ, 5, 0}, {D, 4, 0},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_7[] = {
+    {RW, 7, 0}, {BZ, 0, 0}, {BY, 4, 4}, {GW, 7, 0}, {GY, 5, 5}, {GY, 4, 4}, {BW, 7, 0}, {GZ, 5, 5},
+    {BZ, 4, 4}, {RX, 4, 0}, {GZ, 4, 4}, {GY, 3, 0}, {GX, 5, 0}, {GZ, 3, 0}, {BX, 4, 0}, {BZ, 1, 1},
+    {BY, 3, 0}, {RY, 4, 0}, {BZ, 2, 2}, {RZ, 4, 0}, {BZ, 3, 3}, {D, 4, 0},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_8[] = {
+    {RW, 7, 0}, {BZ, 1, 1}, {BY, 4, 4}, {GW, 7, 0}, {BY, 5, 5}, {GY, 4, 4}, {BW, 7, 0}, {BZ, 5, 5},
+    {BZ, 4, 4}, {RX, 4, 0}, {GZ, 4, 4}, {GY, 3, 0}, {GX, 4, 0}, {BZ, 0, 0}, {GZ, 3, 0}, {BX, 5, 0},
+    {BY, 3, 0}, {RY, 4, 0}, {BZ, 2, 2}, {RZ, 4, 0}, {BZ, 3, 3}, {D, 4, 0},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_9[] = {
+    {RW, 5, 0}, {GZ, 4, 4}, {BZ, 0, 0}, {BZ, 1, 1}, {BY, 4, 4}, {GW, 5, 0}, {GY, 5, 5}, {BY, 5, 5},
+    {BZ, 2, 2}, {GY, 4, 4}, {BW, 5, 0}, {GZ, 5, 5}, {BZ, 3, 3}, {BZ, 5, 5}, {BZ, 4, 4}, {RX, 5, 0},
+    {GY, 3, 0}, {GX, 5, 0}, {GZ, 3, 0}, {BX, 5, 0}, {BY, 3, 0}, {RY, 5, 0}, {RZ, 5, 0}, {D, 4, 0},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_10[] = {
+    {RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 9, 0}, {GX, 9, 0}, {BX, 9, 0},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_11[] = {
+    {RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 8, 0}, {RW, 10, 10}, {GX, 8, 0}, {GW, 10, 10}, {BX, 8, 0},
+    {BW, 10, 10},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_12[] = {
+    {RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 7, 0}, {RW, 10, 11}, {GX, 7, 0}, {GW, 10, 11}, {BX, 7, 0},
+    {BW, 10, 11},
+  };
+  constexpr BC6H_SEGMENT LAYOUT_13[] = {
+    {RW, 9, 0}, {GW, 9, 0}, {BW, 9, 0}, {RX, 3, 0}, {RW, 10, 15}, {GX, 3, 0}, {GW, 10, 15}, {BX, 3, 0},
+    {BW, 10, 15},
+  };
+
+  template <size_t N>
+  constexpr BC6H_MODE Bc6hMode(const uint8_t              t_regions,
+                               const uint8_t              t_precision,
+                               const uint8_t              t_r,
+                               const uint8_t              t_g,
+                               const uint8_t              t_b,
+                               const bool                 t_transformed,
+                               const BC6H_SEGMENT (&t_layout)[N]) {
+    return {t_regions, t_precision, {t_r, t_g, t_b}, t_transformed, t_layout, static_cast<uint8_t>(N)};
+  }
+
+  constexpr BC6H_MODE BC6H_MODES[14] = {
+    Bc6hMode(2, 10, 5, 5, 5, true, LAYOUT_0),
+    Bc6hMode(2, 7, 6, 6, 6, true, LAYOUT_1),
+    Bc6hMode(2, 11, 5, 4, 4, true, LAYOUT_2),
+    Bc6hMode(2, 11, 4, 5, 4, true, LAYOUT_3),
+    Bc6hMode(2, 11, 4, 4, 5, true, LAYOUT_4),
+    Bc6hMode(2, 9, 5, 5, 5, true, LAYOUT_5),
+    Bc6hMode(2, 8, 6, 5, 5, true, LAYOUT_6),
+    Bc6hMode(2, 8, 5, 6, 5, true, LAYOUT_7),
+    Bc6hMode(2, 8, 5, 5, 6, true, LAYOUT_8),
+    Bc6hMode(2, 6, 6, 6, 6, false, LAYOUT_9),
+    Bc6hMode(1, 10, 10, 10, 10, false, LAYOUT_10),
+    Bc6hMode(1, 11, 9, 9, 9, true, LAYOUT_11),
+    Bc6hMode(1, 12, 8, 8, 8, true, LAYOUT_12),
+    Bc6hMode(1, 16, 4, 4, 4, true, LAYOUT_13),
+  };
+
+  // mode index per 5-bit mode value, 2-bit modes 0 and 1 are read before this is consulted
+  constexpr int8_t BC6H_MODE_INDEX[32] = {
+    -1, -1, 2, 10, -1, -1, 3, 11, -1, -1, 4, 12, -1, -1, 5, 13,
+    -1, -1, 6, -1, -1, -1, 7, -1, -1, -1, 8, -1, -1, -1, 9, -1,
+  };
+
+  constexpr int SignExtend(const int t_value, const unsigned t_bits) {
+    const int shift = 32 - static_cast<int>(t_bits);
+    return static_cast<int>(static_cast<unsigned>(t_value) << shift) >> shift;
+  }
+
+  template <bool Signed>
+  int Unquantize(int t_value, const unsigned t_precision) {
+    if constexpr (!Signed) {
+      if (t_precision >= 15 || t_value == 0) {
+        return t_value;
+      }
+      if (t_value == (1 << t_precision) - 1) {
+        return 0xFFFF;
+      }
+      return ((t_value << 16) + 0x8000) >> t_precision;
+    }
+    else {
+      if (t_precision >= 16) {
+        return t_value;
+      }
+      const bool negative = t_value < 0;
+      t_value             = negative ? -t_value : t_value;
+      int result;
+      if (t_value == 0) {
+        result = 0;
+      }
+      else if (t_value >= (1 << (t_precision - 1)) - 1) {
+        result = 0x7FFF;
+      }
+      else {
+        result = ((t_value << 15) + 0x4000) >> (t_precision - 1);
+      }
+      return negative ? -result : result;
+    }
+  }
+
+  // scales the interpolated value into the half float range and returns its bit pattern
+  template <bool Signed>
+  uint16_t FinishUnquantize(const int t_value) {
+    if constexpr (!Signed) {
+      return static_cast<uint16_t>((t_value * 31) >> 6);
+    }
+    else {
+      return t_value < 0 ? static_cast<uint16_t>(0x8000 | ((-t_value * 31) >> 5))
+                         : static_cast<uint16_t>((t_value * 31) >> 5);
+    }
+  }
+
+  template <bool Signed>
+  void DecodeBc6hBlock(const std::byte* t_block, uint16_t* t_tile) {
+    uint64_t lo, hi;
+    std::memcpy(&lo, t_block, 8);
+    std::memcpy(&hi, t_block + 8, 8);
+    unsigned position = 0;
+    const auto read = [&](const unsigned t_bits) {
+      uint64_t value = position >= 64 ? hi >> (position - 64) : lo >> position;
+      if (position < 64 && position + t_bits > 64) {
+        value |= hi << (64 - position);
+      }
+      position += t_bits;
+      return static_cast<int>(value & ((uint64_t{1} << t_bits) - 1));
+    };
+
+    int modeIndex = read(2);
+    if (modeIndex > 1) {
+      modeIndex = BC6H_MODE_INDEX[modeIndex | (read(3) << 2)];
+    }
+    if (modeIndex < 0) {
+      // reserved mode
+      std::memset(t_tile, 0, 16 * 8);
+      return;
+    }
+
+    const BC6H_MODE& mode = BC6H_MODES[modeIndex];
+
+    int fields[13] = {};
+    for (size_t s = 0; s < mode.segmentCount; ++s) {
+      const BC6H_SEGMENT& segment = mode.layout[s];
+      const int           step    = segment.last >= segment.first ? 1 : -1;
+      for (int bit = segment.first;; bit += step) {
+        fields[segment.field] |= read(1) << bit;
+        if (bit == segment.last) {
+          break;
+        }
+      }
+    }
+
+    // endpoints[e][channel] for e = w, x, y, z
+    int            endpoints[4][3];
+    const unsigned endpointCount = mode.regions * 2u;
+    for (unsigned channel = 0; channel < 3; ++channel) {
+      const int mask = (1 << mode.precision) - 1;
+      int       base = fields[RW + channel];
+      if constexpr (Signed) {
+        base = SignExtend(base, mode.precision);
+      }
+      endpoints[0][channel] = base;
+
+      for (unsigned e = 1; e < endpointCount; ++e) {
+        int value = fields[e * 3 + channel];
+        if (mode.transformed) {
+          value = (fields[RW + channel] + SignExtend(value, mode.delta[channel])) & mask;
+        }
+        if constexpr (Signed) {
+          value = SignExtend(value, mode.precision);
+        }
+        endpoints[e][channel] = value;
+      }
+      for (unsigned e = 0; e < endpointCount; ++e) {
+        endpoints[e][channel] = Unquantize<Signed>(endpoints[e][channel], mode.precision);
+      }
+    }
+
+    const unsigned indexBits = mode.regions == 2 ? 3 : 4;
+    const uint8_t* weights   = Bc7::Weights(indexBits);
+    const auto     partition = static_cast<uint8_t>(fields[D]);
+
+    for (uint8_t texel = 0; texel < 16; ++texel) {
+      const uint8_t subset   = Bc7::Subset(mode.regions, partition, texel);
+      const bool    isAnchor = Bc7::Anchor(mode.regions, partition, subset) == texel;
+      const int     weight   = weights[read(indexBits - isAnchor)];
+      const int*    e0       = endpoints[subset * 2];
+      const int*    e1       = endpoints[subset * 2 + 1];
+
+      uint16_t* out = t_tile + texel * 4;
+      for (unsigned channel = 0; channel < 3; ++channel) {
+        out[channel] = FinishUnquantize<Signed>((e0[channel] * (64 - weight) + e1[channel] * weight + 32) >> 6);
+      }
+      out[3] = 0x3C00; // 1.0
+    }
+  }
+
+  template <bool Signed>
+  void DecodeBc6h(const std::byte* t_blocks, const size_t t_blockCount, std::byte* t_tiles) {
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      DecodeBc6hBlock<Signed>(t_blocks + block * 16, reinterpret_cast<uint16_t*>(t_tiles) + block * 64);
+    }
+  }
+}
+
+Dds::DECODE_KERNEL Dds::SelectDecodeKernel(const FORMAT_INFO& t_format) {
+  switch (t_format.format) {
+    case Format::BC1:
+      return {&DecodeBc1, PixelFormat::Rgba8};
+    case Format::BC2:
+      return {&DecodeBc2, PixelFormat::Rgba8};
+    case Format::BC3:
+      return {&DecodeBc3, PixelFormat::Rgba8};
+    case Format::BC4:
+      return {&DecodeBc4, PixelFormat::Rgba8};
+    case Format::BC5:
+      return {&DecodeBc5, PixelFormat::Rgba8};
+    case Format::BC7:
+      return {&DecodeBc7, PixelFormat::Rgba8};
+    case Format::BC6H_UF16:
+      return {&DecodeBc6h<false>, PixelFormat::Rgba16F};
+    case Format::BC6H_SF16:
+      return {&DecodeBc6h<true>, PixelFormat::Rgba16F};
+    default:
+      break;
+  }
+  return {};
+}
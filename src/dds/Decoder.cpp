@@ -0,0 +1,182 @@
+#include "dds/Decoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <latch>
+#include <utility>
+#include <vector>
+
+namespace
+{
+  struct SURFACE
+  {
+    Dds::DECODE_KERNEL decode;
+    const std::byte*   blocks    = nullptr;
+    uint32_t           width     = 0;
+    uint32_t           height    = 0;
+    size_t             blockSize = 0;
+  };
+
+  size_t BlocksWide(const SURFACE& t_surface) {
+    return std::max<size_t>(1, (t_surface.width + 3) / 4);
+  }
+
+  size_t BlocksHigh(const SURFACE& t_surface) {
+    return std::max<size_t>(1, (t_surface.height + 3) / 4);
+  }
+
+  // Decodes the block rows [t_begin, t_end) one row at a time into a strip of tiles, then copies the
+  // texels that fall inside the surface into destination rows
+  void DecodeRows(const SURFACE& t_surface,
+                  const size_t   t_begin,
+                  const size_t   t_end,
+                  std::byte*     t_destination,
+                  const size_t   t_rowPitch) {
+    const size_t pixelSize  = Dds::PixelSize(t_surface.decode.format);
+    const size_t blocksWide = BlocksWide(t_surface);
+    const size_t tileSize   = 16 * pixelSize;
+
+    std::vector<std::byte> tiles(blocksWide * tileSize);
+
+    for (size_t y = t_begin; y < t_end; ++y) {
+      t_surface.decode.kernel(t_surface.blocks + y * blocksWide * t_surface.blockSize, blocksWide, tiles.data());
+
+      const size_t rows = std::min<size_t>(4, t_surface.height - y * 4);
+      for (size_t row = 0; row < rows; ++row) {
+        std::byte* out = t_destination + (y * 4 + row) * t_rowPitch;
+        for (size_t x = 0; x < blocksWide; ++x) {
+          const size_t columns = std::min<size_t>(4, t_surface.width - x * 4);
+          std::memcpy(out + x * 4 * pixelSize, tiles.data() + x * tileSize + row * 4 * pixelSize, columns * pixelSize);
+        }
+      }
+    }
+  }
+
+  // the blocks of one layer or volume slice of a level, nullptr if the level is not loaded (or has been
+  // evicted) or the slice is out of range
+  const std::byte* SliceBlocks(const LoadDds::DDS_FILE& t_ddsFile, const size_t t_mip, const size_t t_slice) {
+    if (t_mip >= t_ddsFile.mipMaps.size()) {
+      return nullptr;
+    }
+
+    const LoadDds::MIP_LEVEL& level  = t_ddsFile.mipMaps[t_mip];
+    const size_t              slices = static_cast<size_t>(t_ddsFile.LayerCount()) * level.depth;
+    if (t_slice >= slices || t_ddsFile.data.size() < level.offset + level.size) {
+      return nullptr;
+    }
+
+    // layers follow each other, and so do the slices inside a volume layer
+    return t_ddsFile.data.data() + level.offset + t_slice * (level.layerSize / level.depth);
+  }
+
+  bool Fail(const Dds::Error t_error, const size_t t_detail) {
+    Dds::Log({t_error, static_cast<uint32_t>(t_detail)}, nullptr);
+    return false;
+  }
+}
+
+Dds::Decoder::Decoder(const size_t t_workerCount)
+  : m_pool(t_workerCount) {}
+
+Dds::Decoder::IMAGE Dds::Decoder::Decode(const LoadDds::DDS_FILE& t_ddsFile, const size_t t_mip, const size_t t_slice) {
+  IMAGE image;
+
+  const DECODE_KERNEL decode = SelectDecodeKernel(GetFormatInfo(t_ddsFile.format));
+  if (!decode.kernel) {
+    Fail(Error::NoDecoder, static_cast<size_t>(t_ddsFile.format));
+    return image;
+  }
+  if (t_mip >= t_ddsFile.mipMaps.size()) {
+    Fail(Error::InvalidMipRange, t_mip);
+    return image;
+  }
+
+  const LoadDds::MIP_LEVEL& level = t_ddsFile.mipMaps[t_mip];
+  const size_t              pitch = static_cast<size_t>(level.width) * PixelSize(decode.format);
+
+  AlignedBuffer pixels(pitch * level.height, 64);
+  if (!Decode(t_ddsFile, t_mip, t_slice, {pixels.Data(), pixels.Size()}, pitch)) {
+    return image;
+  }
+
+  image.width    = level.width;
+  image.height   = level.height;
+  image.format   = decode.format;
+  image.rowPitch = pitch;
+  image.pixels   = std::move(pixels);
+  return image;
+}
+
+bool Dds::Decoder::Decode(const LoadDds::DDS_FILE&   t_ddsFile,
+                          const size_t               t_mip,
+                          const size_t               t_slice,
+                          const std::span<std::byte> t_destination,
+                          const size_t               t_rowPitch) {
+  const FORMAT_INFO& format = GetFormatInfo(t_ddsFile.format);
+
+  SURFACE surface;
+  surface.decode = SelectDecodeKernel(format);
+  if (!surface.decode.kernel) {
+    return Fail(Error::NoDecoder, static_cast<size_t>(t_ddsFile.format));
+  }
+
+  surface.blocks = SliceBlocks(t_ddsFile, t_mip, t_slice);
+  if (!surface.blocks) {
+    return Fail(Error::InvalidMipRange, t_mip);
+  }
+  surface.width     = t_ddsFile.mipMaps[t_mip].width;
+  surface.height    = t_ddsFile.mipMaps[t_mip].height;
+  surface.blockSize = format.blockBytes;
+
+  const size_t rowSize = static_cast<size_t>(surface.width) * PixelSize(surface.decode.format);
+  if (t_rowPitch < rowSize || t_destination.size() < t_rowPitch * (surface.height - 1) + rowSize) {
+    return Fail(Error::DestinationTooSmall, 0);
+  }
+
+  const size_t blocksHigh = BlocksHigh(surface);
+  if (BlocksWide(surface) * blocksHigh < PARALLEL_BLOCKS || m_pool.ThreadCount() < 2) {
+    DecodeRows(surface, 0, blocksHigh, t_destination.data(), t_rowPitch);
+    return true;
+  }
+
+  // a few bands per worker evens out formats whose blocks differ in cost (BC7 modes), the calling
+  // thread takes the last band instead of idling on the latch
+  const size_t bandCount = std::min(blocksHigh, m_pool.ThreadCount() * 4);
+  const size_t bandRows  = (blocksHigh + bandCount - 1) / bandCount;
+  const size_t bands     = (blocksHigh + bandRows - 1) / bandRows;
+
+  std::latch done(static_cast<std::ptrdiff_t>(bands - 1));
+  for (size_t band = 0; band + 1 < bands; ++band) {
+    m_pool.Submit([&, band]
+    {
+      DecodeRows(surface, band * bandRows, (band + 1) * bandRows, t_destination.data(), t_rowPitch);
+      done.count_down();
+    });
+  }
+  DecodeRows(surface, (bands - 1) * bandRows, blocksHigh, t_destination.data(), t_rowPitch);
+  done.wait();
+  return true;
+}
+
+bool Dds::Decoder::DecodeSurface(const Format     t_format,
+                                 const std::byte* t_blocks,
+                                 const uint32_t   t_width,
+                                 const uint32_t   t_height,
+                                 std::byte*       t_destination,
+                                 const size_t     t_rowPitch) {
+  const FORMAT_INFO& format = GetFormatInfo(t_format);
+
+  SURFACE surface;
+  surface.decode = SelectDecodeKernel(format);
+  if (!surface.decode.kernel || !t_blocks || !t_destination) {
+    return false;
+  }
+
+  surface.blocks    = t_blocks;
+  surface.width     = t_width;
+  surface.height    = t_height;
+  surface.blockSize = format.blockBytes;
+
+  DecodeRows(surface, 0, BlocksHigh(surface), t_destination, t_rowPitch);
+  return true;
+}
@@ -0,0 +1,343 @@
+#include "dds/EncodeKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "dds/Bc7.h"
+
+// Every kernel reads whole 4x4 tiles of RGBA texels, the caller gathers them from rows (replicating the
+// edge of levels that do not fill their last blocks). Palettes are rebuilt with the integer rounding of
+// DecodeKernels.cpp, so each texel picks the entry the decoder will actually produce.
+
+namespace
+{
+  using namespace Dds;
+
+  // ---- endpoint fitting ----
+
+  // Least squares line through the first t_channels channels of a tile: the mean plus the principal
+  // axis of the covariance, found by power iteration. t_low and t_high are the extreme projections onto
+  // it, clamped to the channel range. A flat tile gives its mean twice
+  void FitLine(const uint8_t* t_tile, const size_t t_channels, float* t_low, float* t_high) {
+    float mean[4] = {};
+    for (size_t texel = 0; texel < 16; ++texel) {
+      for (size_t channel = 0; channel < t_channels; ++channel) {
+        mean[channel] += t_tile[texel * 4 + channel];
+      }
+    }
+    for (size_t channel = 0; channel < t_channels; ++channel) {
+      mean[channel] /= 16.0f;
+    }
+
+    float covariance[4][4] = {};
+    for (size_t texel = 0; texel < 16; ++texel) {
+      float delta[4];
+      for (size_t channel = 0; channel < t_channels; ++channel) {
+        delta[channel] = t_tile[texel * 4 + channel] - mean[channel];
+      }
+      for (size_t i = 0; i < t_channels; ++i) {
+        for (size_t j = 0; j < t_channels; ++j) {
+          covariance[i][j] += delta[i] * delta[j];
+        }
+      }
+    }
+
+    // start from the channel with the largest spread, a few steps are plenty for a 4x4 block
+    size_t widest = 0;
+    for (size_t channel = 1; channel < t_channels; ++channel) {
+      if (covariance[channel][channel] > covariance[widest][widest]) {
+        widest = channel;
+      }
+    }
+    if (covariance[widest][widest] < 1e-3f) {
+      std::copy_n(mean, t_channels, t_low);
+      std::copy_n(mean, t_channels, t_high);
+      return;
+    }
+
+    float axis[4] = {};
+    axis[widest]  = 1.0f;
+    for (int step = 0; step < 8; ++step) {
+      float next[4] = {};
+      float largest = 0.0f;
+      for (size_t i = 0; i < t_channels; ++i) {
+        for (size_t j = 0; j < t_channels; ++j) {
+          next[i] += covariance[i][j] * axis[j];
+        }
+        largest = std::max(largest, std::abs(next[i]));
+      }
+      if (largest < 1e-6f) {
+        break;
+      }
+      for (size_t channel = 0; channel < t_channels; ++channel) {
+        axis[channel] = next[channel] / largest;
+      }
+    }
+
+    float length = 0.0f;
+    for (size_t channel = 0; channel < t_channels; ++channel) {
+      length += axis[channel] * axis[channel];
+    }
+    length = std::sqrt(length);
+
+    float lowest  = 0.0f;
+    float highest = 0.0f;
+    for (size_t texel = 0; texel < 16; ++texel) {
+      float projection = 0.0f;
+      for (size_t channel = 0; channel < t_channels; ++channel) {
+        projection += (t_tile[texel * 4 + channel] - mean[channel]) * axis[channel];
+      }
+      projection /= length;
+      lowest  = std::min(lowest, projection);
+      highest = std::max(highest, projection);
+    }
+
+    for (size_t channel = 0; channel < t_channels; ++channel) {
+      const float direction = axis[channel] / length;
+      t_low[channel]        = std::clamp(mean[channel] + direction * lowest, 0.0f, 255.0f);
+      t_high[channel]       = std::clamp(mean[channel] + direction * highest, 0.0f, 255.0f);
+    }
+  }
+
+  template <size_t Channels>
+  unsigned Distance(const uint8_t* t_a, const uint8_t* t_b) {
+    unsigned distance = 0;
+    for (size_t channel = 0; channel < Channels; ++channel) {
+      const int delta = static_cast<int>(t_a[channel]) - static_cast<int>(t_b[channel]);
+      distance += static_cast<unsigned>(delta * delta);
+    }
+    return distance;
+  }
+
+  // index of the palette entry closest to t_texel
+  template <size_t Channels>
+  unsigned Nearest(const uint8_t* t_texel, const uint8_t (*t_palette)[4], const unsigned t_entries) {
+    unsigned best         = 0;
+    unsigned bestDistance = Distance<Channels>(t_texel, t_palette[0]);
+    for (unsigned entry = 1; entry < t_entries && bestDistance != 0; ++entry) {
+      const unsigned distance = Distance<Channels>(t_texel, t_palette[entry]);
+      if (distance < bestDistance) {
+        best         = entry;
+        bestDistance = distance;
+      }
+    }
+    return best;
+  }
+
+  // ---- BC1-BC5 ----
+
+  uint16_t Quantize565(const float* t_rgb) {
+    const auto r = static_cast<unsigned>(t_rgb[0] * 31.0f / 255.0f + 0.5f);
+    const auto g = static_cast<unsigned>(t_rgb[1] * 63.0f / 255.0f + 0.5f);
+    const auto b = static_cast<unsigned>(t_rgb[2] * 31.0f / 255.0f + 0.5f);
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+  }
+
+  void Expand565(const uint16_t t_color, uint8_t* t_rgb) {
+    const unsigned r = (t_color >> 11) & 31;
+    const unsigned g = (t_color >> 5) & 63;
+    const unsigned b = t_color & 31;
+    t_rgb[0]         = static_cast<uint8_t>((r << 3) | (r >> 2));
+    t_rgb[1]         = static_cast<uint8_t>((g << 2) | (g >> 4));
+    t_rgb[2]         = static_cast<uint8_t>((b << 3) | (b >> 2));
+  }
+
+  // BC1 colour half. Tiles with a texel below half alpha use BC1's three colour mode and map those
+  // texels to transparent black, BC2/BC3 colour always uses four colours
+  void EncodeColorBlock(const uint8_t* t_tile, std::byte* t_block, const bool t_forceFourColor) {
+    bool transparent = false;
+    for (size_t texel = 0; texel < 16 && !t_forceFourColor; ++texel) {
+      transparent |= t_tile[texel * 4 + 3] < 128;
+    }
+
+    float low[3], high[3];
+    FitLine(t_tile, 3, low, high);
+    uint16_t c0 = Quantize565(high);
+    uint16_t c1 = Quantize565(low);
+    // the endpoint order selects the mode
+    if (transparent ? c0 > c1 : c0 < c1) {
+      std::swap(c0, c1);
+    }
+
+    uint8_t palette[4][4] = {};
+    Expand565(c0, palette[0]);
+    Expand565(c1, palette[1]);
+    const bool fourColor = t_forceFourColor || c0 > c1;
+    for (size_t channel = 0; channel < 3; ++channel) {
+      const unsigned a = palette[0][channel];
+      const unsigned b = palette[1][channel];
+      if (fourColor) {
+        palette[2][channel] = static_cast<uint8_t>((2 * a + b) / 3);
+        palette[3][channel] = static_cast<uint8_t>((a + 2 * b) / 3);
+      }
+      else {
+        palette[2][channel] = static_cast<uint8_t>((a + b) / 2);
+      }
+    }
+
+    uint32_t indices = 0;
+    for (size_t texel = 0; texel < 16; ++texel) {
+      const uint8_t* color = t_tile + texel * 4;
+      const unsigned index = transparent && color[3] < 128 ? 3 : Nearest<3>(color, palette, fourColor ? 4 : 3);
+      indices |= index << (texel * 2);
+    }
+
+    std::memcpy(t_block, &c0, 2);
+    std::memcpy(t_block + 2, &c1, 2);
+    std::memcpy(t_block + 4, &indices, 4);
+  }
+
+  // BC3 alpha / BC4 / BC5 channel: the block's extremes as endpoints of the 8 step ramp, reads every
+  // t_stride'th byte of the tile
+  void EncodeChannelBlock(const uint8_t* t_tile, std::byte* t_block, const size_t t_stride) {
+    unsigned low  = 255;
+    unsigned high = 0;
+    for (size_t texel = 0; texel < 16; ++texel) {
+      low  = std::min<unsigned>(low, t_tile[texel * t_stride]);
+      high = std::max<unsigned>(high, t_tile[texel * t_stride]);
+    }
+
+    uint64_t bits = high | (low << 8);
+    if (low != high) {
+      uint8_t palette[8][4] = {{static_cast<uint8_t>(high)}, {static_cast<uint8_t>(low)}};
+      for (unsigned i = 1; i < 7; ++i) {
+        palette[i + 1][0] = static_cast<uint8_t>(((7 - i) * high + i * low + 3) / 7);
+      }
+      for (size_t texel = 0; texel < 16; ++texel) {
+        bits |= static_cast<uint64_t>(Nearest<1>(t_tile + texel * t_stride, palette, 8)) << (16 + texel * 3);
+      }
+    }
+    // equal endpoints select the 6 step ramp, whose index 0 is the endpoint
+    std::memcpy(t_block, &bits, 8);
+  }
+
+  void EncodeBc1(const std::byte* t_tiles, const size_t t_blockCount, std::byte* t_blocks) {
+    const auto tiles = reinterpret_cast<const uint8_t*>(t_tiles);
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      EncodeColorBlock(tiles + block * 64, t_blocks + block * 8, false);
+    }
+  }
+
+  void EncodeBc2(const std::byte* t_tiles, const size_t t_blockCount, std::byte* t_blocks) {
+    const auto tiles = reinterpret_cast<const uint8_t*>(t_tiles);
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      uint64_t alpha = 0;
+      for (size_t texel = 0; texel < 16; ++texel) {
+        alpha |= static_cast<uint64_t>((tiles[block * 64 + texel * 4 + 3] * 15u + 127) / 255) << (texel * 4);
+      }
+      std::memcpy(t_blocks + block * 16, &alpha, 8);
+      EncodeColorBlock(tiles + block * 64, t_blocks + block * 16 + 8, true);
+    }
+  }
+
+  void EncodeBc3(const std::byte* t_tiles, const size_t t_blockCount, std::byte* t_blocks) {
+    const auto tiles = reinterpret_cast<const uint8_t*>(t_tiles);
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      EncodeChannelBlock(tiles + block * 64 + 3, t_blocks + block * 16, 4);
+      EncodeColorBlock(tiles + block * 64, t_blocks + block * 16 + 8, true);
+    }
+  }
+
+  void EncodeBc4(const std::byte* t_tiles, const size_t t_blockCount, std::byte* t_blocks) {
+    const auto tiles = reinterpret_cast<const uint8_t*>(t_tiles);
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      EncodeChannelBlock(tiles + block * 64, t_blocks + block * 8, 4);
+    }
+  }
+
+  void EncodeBc5(const std::byte* t_tiles, const size_t t_blockCount, std::byte* t_blocks) {
+    const auto tiles = reinterpret_cast<const uint8_t*>(t_tiles);
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      EncodeChannelBlock(tiles + block * 64, t_blocks + block * 16, 4);
+      EncodeChannelBlock(tiles + block * 64 + 1, t_blocks + block * 16 + 8, 4);
+    }
+  }
+
+  // ---- BC7 ----
+
+  // mode 6 endpoints are 7 bits per channel plus one p-bit shared by the endpoint's four channels, so
+  // every 8-bit value is reachable on its own and the p-bit goes to whichever parity fits the colour best
+  void QuantizeMode6Endpoint(const float* t_color, uint8_t* t_endpoint, uint8_t& t_pBit, uint8_t* t_expanded) {
+    unsigned bestError = UINT32_MAX;
+    for (uint8_t pBit = 0; pBit < 2; ++pBit) {
+      uint8_t  endpoint[4];
+      unsigned error = 0;
+      for (size_t channel = 0; channel < 4; ++channel) {
+        const int value   = static_cast<int>(t_color[channel] + 0.5f);
+        endpoint[channel] = static_cast<uint8_t>(std::clamp((value - pBit + 1) / 2, 0, 127));
+        const int delta   = (endpoint[channel] << 1 | pBit) - value;
+        error += static_cast<unsigned>(delta * delta);
+      }
+      if (error < bestError) {
+        bestError = error;
+        t_pBit    = pBit;
+        std::copy_n(endpoint, 4, t_endpoint);
+      }
+    }
+    for (size_t channel = 0; channel < 4; ++channel) {
+      t_expanded[channel] = static_cast<uint8_t>(t_endpoint[channel] << 1 | t_pBit);
+    }
+  }
+
+  void EncodeBc7Block(const uint8_t* t_tile, std::byte* t_block) {
+    float low[4], high[4];
+    FitLine(t_tile, 4, low, high);
+
+    Bc7::BLOCK block;
+    block.mode = 6;
+    uint8_t endpoints[2][4];
+    QuantizeMode6Endpoint(low, block.endpoints[0], block.pBits[0], endpoints[0]);
+    QuantizeMode6Endpoint(high, block.endpoints[1], block.pBits[1], endpoints[1]);
+
+    uint8_t palette[16][4];
+    for (size_t index = 0; index < 16; ++index) {
+      const unsigned weight = Bc7::WEIGHTS_4[index];
+      for (size_t channel = 0; channel < 4; ++channel) {
+        palette[index][channel] =
+          static_cast<uint8_t>(((64 - weight) * endpoints[0][channel] + weight * endpoints[1][channel] + 32) >> 6);
+      }
+    }
+    for (size_t texel = 0; texel < 16; ++texel) {
+      block.indices[texel] = static_cast<uint8_t>(Nearest<4>(t_tile + texel * 4, palette, 16));
+    }
+
+    // the anchor texel stores its index without the top bit, swapping the endpoints mirrors the indices
+    if (block.indices[0] >= 8) {
+      std::swap(block.endpoints[0], block.endpoints[1]);
+      std::swap(block.pBits[0], block.pBits[1]);
+      for (uint8_t& index : block.indices) {
+        index = static_cast<uint8_t>(15 - index);
+      }
+    }
+    Bc7::Pack(block, t_block);
+  }
+
+  void EncodeBc7(const std::byte* t_tiles, const size_t t_blockCount, std::byte* t_blocks) {
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      EncodeBc7Block(reinterpret_cast<const uint8_t*>(t_tiles) + block * 64, t_blocks + block * 16);
+    }
+  }
+}
+
+Dds::EncodeKernel Dds::SelectEncodeKernel(const Format t_format) {
+  switch (t_format) {
+    case Format::BC1:
+      return &EncodeBc1;
+    case Format::BC2:
+      return &EncodeBc2;
+    case Format::BC3:
+      return &EncodeBc3;
+    case Format::BC4:
+      return &EncodeBc4;
+    case Format::BC5:
+      return &EncodeBc5;
+    case Format::BC7:
+      return &EncodeBc7;
+    default:
+      break;
+  }
+  return nullptr;
+}
@@ -0,0 +1,127 @@
+#include "dds/FileReader.h"
+
+#include <algorithm>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Dds::FileReader::~FileReader() {
+  Close();
+}
+
+Dds::FileReader::FileReader(FileReader&& t_other) noexcept
+  : m_handle(std::exchange(t_other.m_handle, INVALID)),
+    m_size(std::exchange(t_other.m_size, 0)) {}
+
+Dds::FileReader& Dds::FileReader::operator=(FileReader&& t_other) noexcept {
+  if (this != &t_other) {
+    Close();
+    m_handle = std::exchange(t_other.m_handle, INVALID);
+    m_size   = std::exchange(t_other.m_size, 0);
+  }
+  return *this;
+}
+
+bool Dds::FileReader::Open(const char* t_path) {
+  Close();
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(t_path,
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+
+  m_handle = reinterpret_cast<intptr_t>(file);
+  m_size   = static_cast<uint64_t>(size.QuadPart);
+#else
+  const int fd = ::open(t_path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st{};
+  if (::fstat(fd, &st) != 0) {
+    ::close(fd);
+    return false;
+  }
+
+  m_handle = fd;
+  m_size   = static_cast<uint64_t>(st.st_size);
+#endif
+
+  return true;
+}
+
+void Dds::FileReader::Close() {
+  if (m_handle == INVALID) {
+    return;
+  }
+
+#if defined(_WIN32)
+  CloseHandle(reinterpret_cast<HANDLE>(m_handle));
+#else
+  ::close(static_cast<int>(m_handle));
+#endif
+
+  m_handle = INVALID;
+  m_size   = 0;
+}
+
+bool Dds::FileReader::ReadAt(uint64_t t_offset, std::span<std::byte> t_destination) const {
+  if (m_handle == INVALID) {
+    return false;
+  }
+
+  // both APIs may return less than asked for, keep going until the span is full
+  while (!t_destination.empty()) {
+#if defined(_WIN32)
+    OVERLAPPED overlapped{};
+    overlapped.Offset     = static_cast<DWORD>(t_offset);
+    overlapped.OffsetHigh = static_cast<DWORD>(t_offset >> 32);
+
+    const DWORD request = static_cast<DWORD>(std::min<size_t>(t_destination.size(), 1u << 30));
+    DWORD       read    = 0;
+    if (!ReadFile(reinterpret_cast<HANDLE>(m_handle), t_destination.data(), request, &read, &overlapped) ||
+        read == 0) {
+      return false;
+    }
+#else
+    const ssize_t read = ::pread(static_cast<int>(m_handle),
+                                 t_destination.data(),
+                                 t_destination.size(),
+                                 static_cast<off_t>(t_offset));
+    if (read < 0 && errno == EINTR) {
+      continue;
+    }
+    if (read <= 0) {
+      return false;
+    }
+#endif
+
+    t_offset += static_cast<uint64_t>(read);
+    t_destination = t_destination.subspan(static_cast<size_t>(read));
+  }
+
+  return true;
+}
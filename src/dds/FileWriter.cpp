@@ -0,0 +1,188 @@
+#include "dds/FileWriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <random>
+#include <system_error>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if !defined(_WIN32)
+  // buffers per writev call, a DDS file rarely has more pieces than this (layers * levels + header)
+#if defined(IOV_MAX)
+  constexpr size_t BATCH = std::min<size_t>(IOV_MAX, 64);
+#else
+  constexpr size_t BATCH = 64;
+#endif
+#endif
+}
+
+Dds::FileWriter::~FileWriter() {
+  Discard();
+}
+
+Dds::FileWriter::FileWriter(FileWriter&& t_other) noexcept
+  : m_handle(std::exchange(t_other.m_handle, INVALID)),
+    m_path(std::move(t_other.m_path)),
+    m_temporary(std::move(t_other.m_temporary)) {}
+
+Dds::FileWriter& Dds::FileWriter::operator=(FileWriter&& t_other) noexcept {
+  if (this != &t_other) {
+    Discard();
+    m_handle    = std::exchange(t_other.m_handle, INVALID);
+    m_path      = std::move(t_other.m_path);
+    m_temporary = std::move(t_other.m_temporary);
+  }
+  return *this;
+}
+
+bool Dds::FileWriter::Open(const char* t_path) {
+  Discard();
+
+  // a name no other writer uses, in the target's directory so the rename stays on one file system
+  static std::atomic<uint64_t> counter = 0;
+  m_path      = t_path;
+  m_temporary = m_path + ".tmp" + std::to_string(std::random_device{}()) + "_" + std::to_string(counter++);
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(m_temporary.c_str(),
+                            GENERIC_WRITE,
+                            0,
+                            nullptr,
+                            CREATE_NEW,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    m_temporary.clear();
+    return false;
+  }
+
+  m_handle = reinterpret_cast<intptr_t>(file);
+#else
+  const int fd = ::open(m_temporary.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+  if (fd < 0) {
+    m_temporary.clear();
+    return false;
+  }
+
+  m_handle = fd;
+#endif
+
+  return true;
+}
+
+bool Dds::FileWriter::Commit() {
+  if (m_handle == INVALID) {
+    return false;
+  }
+
+  std::error_code error;
+  if (Close()) {
+    std::filesystem::rename(m_temporary, m_path, error);
+    if (!error) {
+      m_temporary.clear();
+      return true;
+    }
+  }
+  Discard();
+  return false;
+}
+
+void Dds::FileWriter::Discard() {
+  Close();
+  if (!m_temporary.empty()) {
+    std::error_code error;
+    std::filesystem::remove(m_temporary, error);
+    m_temporary.clear();
+  }
+}
+
+bool Dds::FileWriter::Close() {
+  if (m_handle == INVALID) {
+    return true;
+  }
+
+#if defined(_WIN32)
+  const bool closed = CloseHandle(reinterpret_cast<HANDLE>(m_handle)) != 0;
+#else
+  // NFS and friends report write errors as late as close
+  const bool closed = ::close(static_cast<int>(m_handle)) == 0;
+#endif
+
+  m_handle = INVALID;
+  return closed;
+}
+
+bool Dds::FileWriter::Write(std::span<const std::span<const std::byte>> t_buffers) {
+  if (m_handle == INVALID) {
+    return false;
+  }
+
+#if defined(_WIN32)
+  // WriteFileGather only takes page sized, page aligned buffers, so one call per buffer it is
+  for (std::span<const std::byte> buffer : t_buffers) {
+    while (!buffer.empty()) {
+      const DWORD request = static_cast<DWORD>(std::min<size_t>(buffer.size(), 1u << 30));
+      DWORD       written = 0;
+      if (!WriteFile(reinterpret_cast<HANDLE>(m_handle), buffer.data(), request, &written, nullptr) || written == 0) {
+        return false;
+      }
+      buffer = buffer.subspan(written);
+    }
+  }
+#else
+  iovec  vectors[BATCH];
+  size_t next = 0; // first buffer not completely written
+  size_t done = 0; // bytes of t_buffers[next] already written
+
+  while (next < t_buffers.size()) {
+    // the batch starts part way into the buffer a short write stopped in
+    int count = 0;
+    for (size_t i = next; i < t_buffers.size() && count < static_cast<int>(BATCH); ++i) {
+      const size_t skip = i == next ? done : 0;
+      if (t_buffers[i].size() == skip) {
+        continue;
+      }
+      vectors[count].iov_base = const_cast<std::byte*>(t_buffers[i].data() + skip);
+      vectors[count].iov_len  = t_buffers[i].size() - skip;
+      ++count;
+    }
+    if (count == 0) {
+      break;
+    }
+
+    const ssize_t written = ::writev(static_cast<int>(m_handle), vectors, count);
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (written <= 0) {
+      return false;
+    }
+
+    // writev may stop anywhere, skip what went out
+    size_t remaining = static_cast<size_t>(written);
+    while (next < t_buffers.size() && remaining >= t_buffers[next].size() - done) {
+      remaining -= t_buffers[next].size() - done;
+      done = 0;
+      ++next;
+    }
+    done += remaining;
+  }
+#endif
+
+  return true;
+}
@@ -0,0 +1,556 @@
+#include "dds/FlipKernels.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "dds/Bc7.h"
+#include "dds/DecodeKernels.h"
+#include "dds/EncodeKernels.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DDS_FLIP_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define DDS_FLIP_NEON
+#include <arm_neon.h>
+#endif
+
+// Every BC block is handled as one or two little-endian 64-bit lanes. The index data of a 4x4 block is
+// stored row by row, so a vertical flip is a reversal of four equally wide bit fields inside a lane,
+// which is four shift + mask pairs. Vector paths run the same shifts on 2 (SSE2/NEON) or 4 (AVX2)
+// lanes at once.
+static_assert(std::endian::native == std::endian::little, "block lanes are read as little-endian words");
+
+namespace
+{
+  // four RowBits wide rows starting at bit Base of a lane, row 0 lowest
+  template <unsigned Base, unsigned RowBits>
+  struct ROWS
+  {
+    static_assert(Base + 4 * RowBits <= 64);
+
+    static constexpr unsigned BASE     = Base;
+    static constexpr unsigned ROW_BITS = RowBits;
+    static constexpr unsigned NEAR_SHIFT = RowBits;
+    static constexpr unsigned FAR_SHIFT  = 3 * RowBits;
+
+    static constexpr uint64_t ROW_MASK = (uint64_t{1} << RowBits) - 1;
+    // rows 3 -> 0, 2 -> 1, 1 -> 2 and 0 -> 3
+    static constexpr uint64_t FAR_DOWN  = ROW_MASK << Base;
+    static constexpr uint64_t NEAR_DOWN = ROW_MASK << (Base + RowBits);
+    static constexpr uint64_t NEAR_UP   = ROW_MASK << (Base + 2 * RowBits);
+    static constexpr uint64_t FAR_UP    = ROW_MASK << (Base + 3 * RowBits);
+    // bits outside the rows (endpoints) pass through
+    static constexpr uint64_t KEEP = ~(FAR_DOWN | NEAR_DOWN | NEAR_UP | FAR_UP);
+  };
+
+  // BC1 colour indices: 2 bits per texel, one byte per row, upper half of the lane
+  using ColorRows = ROWS<32, 8>;
+  // BC3 alpha / BC4 / BC5 channel indices: 3 bits per texel, 12 bits per row after the two endpoints
+  using AlphaIndexRows = ROWS<16, 12>;
+  // BC2 explicit alpha: 4 bits per texel, 16 bits per row, the whole lane
+  using ExplicitAlphaRows = ROWS<0, 16>;
+
+  // reverses rows 0 .. Rows - 1 of a lane, the padding rows of a level shorter than a block keep their place
+  template <class Lane, unsigned Rows = 4>
+  uint64_t FlipLane(const uint64_t t_lane) {
+    if constexpr (Rows == 4) {
+      return (t_lane & Lane::KEEP) |
+             ((t_lane >> Lane::FAR_SHIFT) & Lane::FAR_DOWN) |
+             ((t_lane >> Lane::NEAR_SHIFT) & Lane::NEAR_DOWN) |
+             ((t_lane << Lane::NEAR_SHIFT) & Lane::NEAR_UP) |
+             ((t_lane << Lane::FAR_SHIFT) & Lane::FAR_UP);
+    }
+    else {
+      uint64_t flipped = t_lane;
+      for (unsigned row = 0; row < Rows; ++row) {
+        const unsigned to   = Lane::BASE + row * Lane::ROW_BITS;
+        const unsigned from = Lane::BASE + (Rows - 1 - row) * Lane::ROW_BITS;
+        flipped = (flipped & ~(Lane::ROW_MASK << to)) | (((t_lane >> from) & Lane::ROW_MASK) << to);
+      }
+      return flipped;
+    }
+  }
+
+#if defined(__AVX2__)
+  constexpr size_t VECTOR_LANES = 4;
+
+  // t_loSelect/t_hiSelect zero the masks of the lane the row layout does not apply to
+  template <class Lane>
+  __m256i FlipTerms(const __m256i t_v, const uint64_t t_loSelect, const uint64_t t_hiSelect) {
+    const auto mask = [&](const uint64_t t_mask) {
+      const auto lo = static_cast<long long>(t_mask & t_loSelect);
+      const auto hi = static_cast<long long>(t_mask & t_hiSelect);
+      return _mm256_set_epi64x(hi, lo, hi, lo);
+    };
+
+    __m256i r = _mm256_and_si256(_mm256_srli_epi64(t_v, Lane::FAR_SHIFT), mask(Lane::FAR_DOWN));
+    r = _mm256_or_si256(r, _mm256_and_si256(_mm256_srli_epi64(t_v, Lane::NEAR_SHIFT), mask(Lane::NEAR_DOWN)));
+    r = _mm256_or_si256(r, _mm256_and_si256(_mm256_slli_epi64(t_v, Lane::NEAR_SHIFT), mask(Lane::NEAR_UP)));
+    return _mm256_or_si256(r, _mm256_and_si256(_mm256_slli_epi64(t_v, Lane::FAR_SHIFT), mask(Lane::FAR_UP)));
+  }
+
+  template <class Lo, class Hi>
+  void FlipVector(const std::byte* t_source, std::byte* t_destination) {
+    const __m256i v  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t_source));
+    const auto    lo = static_cast<long long>(Lo::KEEP);
+    const auto    hi = static_cast<long long>(Hi::KEEP);
+    __m256i       r  = _mm256_and_si256(v, _mm256_set_epi64x(hi, lo, hi, lo));
+
+    if constexpr (std::is_same_v<Lo, Hi>) {
+      r = _mm256_or_si256(r, FlipTerms<Lo>(v, ~uint64_t{0}, ~uint64_t{0}));
+    }
+    else {
+      r = _mm256_or_si256(r, FlipTerms<Lo>(v, ~uint64_t{0}, 0));
+      r = _mm256_or_si256(r, FlipTerms<Hi>(v, 0, ~uint64_t{0}));
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(t_destination), r);
+  }
+#elif defined(DDS_FLIP_SSE2)
+  constexpr size_t VECTOR_LANES = 2;
+
+  template <class Lane>
+  __m128i FlipTerms(const __m128i t_v, const uint64_t t_loSelect, const uint64_t t_hiSelect) {
+    const auto mask = [&](const uint64_t t_mask) {
+      return _mm_set_epi64x(static_cast<long long>(t_mask & t_hiSelect), static_cast<long long>(t_mask & t_loSelect));
+    };
+
+    __m128i r = _mm_and_si128(_mm_srli_epi64(t_v, Lane::FAR_SHIFT), mask(Lane::FAR_DOWN));
+    r = _mm_or_si128(r, _mm_and_si128(_mm_srli_epi64(t_v, Lane::NEAR_SHIFT), mask(Lane::NEAR_DOWN)));
+    r = _mm_or_si128(r, _mm_and_si128(_mm_slli_epi64(t_v, Lane::NEAR_SHIFT), mask(Lane::NEAR_UP)));
+    return _mm_or_si128(r, _mm_and_si128(_mm_slli_epi64(t_v, Lane::FAR_SHIFT), mask(Lane::FAR_UP)));
+  }
+
+  template <class Lo, class Hi>
+  void FlipVector(const std::byte* t_source, std::byte* t_destination) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(t_source));
+    __m128i r = _mm_and_si128(v, _mm_set_epi64x(static_cast<long long>(Hi::KEEP), static_cast<long long>(Lo::KEEP)));
+
+    if constexpr (std::is_same_v<Lo, Hi>) {
+      r = _mm_or_si128(r, FlipTerms<Lo>(v, ~uint64_t{0}, ~uint64_t{0}));
+    }
+    else {
+      r = _mm_or_si128(r, FlipTerms<Lo>(v, ~uint64_t{0}, 0));
+      r = _mm_or_si128(r, FlipTerms<Hi>(v, 0, ~uint64_t{0}));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(t_destination), r);
+  }
+#elif defined(DDS_FLIP_NEON)
+  constexpr size_t VECTOR_LANES = 2;
+
+  template <class Lane>
+  uint64x2_t FlipTerms(const uint64x2_t t_v, const uint64_t t_loSelect, const uint64_t t_hiSelect) {
+    const auto mask = [&](const uint64_t t_mask) {
+      return vcombine_u64(vcreate_u64(t_mask & t_loSelect), vcreate_u64(t_mask & t_hiSelect));
+    };
+
+    uint64x2_t r = vandq_u64(vshrq_n_u64(t_v, Lane::FAR_SHIFT), mask(Lane::FAR_DOWN));
+    r = vorrq_u64(r, vandq_u64(vshrq_n_u64(t_v, Lane::NEAR_SHIFT), mask(Lane::NEAR_DOWN)));
+    r = vorrq_u64(r, vandq_u64(vshlq_n_u64(t_v, Lane::NEAR_SHIFT), mask(Lane::NEAR_UP)));
+    return vorrq_u64(r, vandq_u64(vshlq_n_u64(t_v, Lane::FAR_SHIFT), mask(Lane::FAR_UP)));
+  }
+
+  template <class Lo, class Hi>
+  void FlipVector(const std::byte* t_source, std::byte* t_destination) {
+    const uint64x2_t v = vreinterpretq_u64_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(t_source)));
+    uint64x2_t       r = vandq_u64(v, vcombine_u64(vcreate_u64(Lo::KEEP), vcreate_u64(Hi::KEEP)));
+
+    if constexpr (std::is_same_v<Lo, Hi>) {
+      r = vorrq_u64(r, FlipTerms<Lo>(v, ~uint64_t{0}, ~uint64_t{0}));
+    }
+    else {
+      r = vorrq_u64(r, FlipTerms<Lo>(v, ~uint64_t{0}, 0));
+      r = vorrq_u64(r, FlipTerms<Hi>(v, 0, ~uint64_t{0}));
+    }
+    vst1q_u8(reinterpret_cast<uint8_t*>(t_destination), vreinterpretq_u8_u64(r));
+  }
+#endif
+
+  // Lo applies to even lanes, Hi to odd lanes. 8-byte formats use the same layout for both, 16-byte
+  // formats put the alpha/red half in Lo and the colour/green half in Hi. Fewer than 4 Rows only occur
+  // in the single block row of a level shorter than a block, those skip the vector path
+  template <class Lo, class Hi, size_t BlockSize, unsigned Rows = 4>
+  void FlipBlocks(const std::byte* t_source, std::byte* t_destination, const size_t t_blockCount) {
+    static_assert(BlockSize == 8 || BlockSize == 16);
+    static_assert(BlockSize == 16 || std::is_same_v<Lo, Hi>);
+
+    const size_t laneCount = t_blockCount * (BlockSize / 8);
+    size_t       lane      = 0;
+
+#if defined(__AVX2__) || defined(DDS_FLIP_SSE2) || defined(DDS_FLIP_NEON)
+    // VECTOR_LANES is even, so the Lo/Hi parity holds for every vector and for the scalar tail
+    if constexpr (Rows == 4) {
+      for (; lane + VECTOR_LANES <= laneCount; lane += VECTOR_LANES) {
+        FlipVector<Lo, Hi>(t_source + lane * 8, t_destination + lane * 8);
+      }
+    }
+#endif
+
+    for (; lane < laneCount; ++lane) {
+      uint64_t value;
+      std::memcpy(&value, t_source + lane * 8, sizeof(value));
+      value = lane % 2 == 0 ? FlipLane<Lo, Rows>(value) : FlipLane<Hi, Rows>(value);
+      std::memcpy(t_destination + lane * 8, &value, sizeof(value));
+    }
+  }
+
+  // a level one texel row high looks the same either way up
+  template <size_t BlockSize>
+  void CopyBlocks(const std::byte* t_source, std::byte* t_destination, const size_t t_blockCount) {
+    if (t_source != t_destination) {
+      std::memcpy(t_destination, t_source, t_blockCount * BlockSize);
+    }
+  }
+
+  // the texel that lands on t_texel when rows 0 .. t_rows - 1 of a block are reversed
+  constexpr size_t FlippedTexel(const size_t t_texel, const unsigned t_rows) {
+    const size_t row = t_texel / 4;
+    return row < t_rows ? (t_rows - 1 - row) * 4 + t_texel % 4 : t_texel;
+  }
+
+  // Partition shape that is the vertical mirror of another one. Shapes are only equal up to the
+  // numbering of their subsets, so subsetMap renumbers the subsets of the original shape
+  struct PARTITION_FLIP
+  {
+    uint8_t partition    = 0;
+    uint8_t subsetMap[3] = {};
+    bool    valid        = false;
+  };
+
+  // compares the first t_checkedRows rows of shape t_to with shape t_from after its first Rows rows
+  // are reversed
+  template <uint8_t Subsets, unsigned Rows>
+  constexpr PARTITION_FLIP MatchPartition(const uint8_t t_from, const uint8_t t_to, const unsigned t_checkedRows) {
+    uint8_t map[3]  = {0xFF, 0xFF, 0xFF};
+    bool    used[3] = {};
+    for (size_t texel = 0; texel < t_checkedRows * 4; ++texel) {
+      const uint8_t original = Dds::Bc7::Subset(Subsets, t_from, FlippedTexel(texel, Rows));
+      const uint8_t mirrored = Dds::Bc7::Subset(Subsets, t_to, texel);
+      if (map[original] == 0xFF && !used[mirrored]) {
+        map[original]  = mirrored;
+        used[mirrored] = true;
+      }
+      if (map[original] != mirrored) {
+        return {};
+      }
+    }
+    // a subset that only owns padding texels takes a number that is left, so the map stays a permutation
+    for (uint8_t& target : map) {
+      for (uint8_t subset = 0; target == 0xFF && subset < Subsets; ++subset) {
+        if (!used[subset]) {
+          target       = subset;
+          used[subset] = true;
+        }
+      }
+    }
+    return {t_to, {map[0], map[1], map[2]}, true};
+  }
+
+  // Rows below 4 are the height of a level shorter than a block. A shape that mirrors the whole block
+  // is preferred, so flipping twice gives back the same bytes. Failing that any shape that agrees on
+  // the rows inside the image will do, the padding rows are never seen
+  template <uint8_t Subsets, unsigned Rows>
+  constexpr std::array<PARTITION_FLIP, 64> BuildPartitionFlips() {
+    std::array<PARTITION_FLIP, 64> flips{};
+    for (uint8_t from = 0; from < 64; ++from) {
+      for (const unsigned checkedRows : {4u, Rows}) {
+        for (uint8_t to = 0; to < 64 && !flips[from].valid; ++to) {
+          flips[from] = MatchPartition<Subsets, Rows>(from, to, checkedRows);
+        }
+      }
+    }
+    return flips;
+  }
+
+  template <unsigned Rows>
+  constexpr std::array<PARTITION_FLIP, 64> PARTITION_FLIPS_2 = BuildPartitionFlips<2, Rows>();
+  template <unsigned Rows>
+  constexpr std::array<PARTITION_FLIP, 64> PARTITION_FLIPS_3 = BuildPartitionFlips<3, Rows>();
+
+  // swaps endpoint 0 and 1 of a subset for the channels [t_firstChannel, t_endChannel)
+  void SwapEndpoints(Dds::Bc7::BLOCK& t_block, const unsigned t_subset, const unsigned t_firstChannel, const unsigned t_endChannel) {
+    for (unsigned channel = t_firstChannel; channel < t_endChannel; ++channel) {
+      std::swap(t_block.endpoints[t_subset * 2][channel], t_block.endpoints[t_subset * 2 + 1][channel]);
+    }
+  }
+
+  // Index values interpolate symmetrically (weight[max - i] == 64 - weight[i]), so inverting every
+  // index of a set and swapping its endpoints decodes to the same texels. That is how an anchor texel
+  // that ended up with its most significant index bit set gets it back to the implied 0
+  void InvertIndices(uint8_t* t_indices, const unsigned t_bits, const auto& t_inSet) {
+    const auto max = static_cast<uint8_t>((1u << t_bits) - 1);
+    for (size_t texel = 0; texel < 16; ++texel) {
+      if (t_inSet(texel)) {
+        t_indices[texel] = max - t_indices[texel];
+      }
+    }
+  }
+
+  // a block whose shape has no mirrored counterpart: decoded, mirrored texel by texel and encoded again
+  // (as mode 6), so it is the right way up but no longer bit exact. works in place
+  template <unsigned Rows>
+  void ReencodeBc7Block(const std::byte* t_source, std::byte* t_destination) {
+    static const Dds::DecodeKernel decode = Dds::SelectDecodeKernel(Dds::GetFormatInfo(Dds::Format::BC7)).kernel;
+    static const Dds::EncodeKernel encode = Dds::SelectEncodeKernel(Dds::Format::BC7);
+
+    std::byte tile[64];
+    std::byte mirrored[64];
+    decode(t_source, 1, tile);
+    for (size_t texel = 0; texel < 16; ++texel) {
+      std::memcpy(mirrored + texel * 4, tile + FlippedTexel(texel, Rows) * 4, 4);
+    }
+    encode(mirrored, 1, t_destination);
+  }
+
+  // Single subset modes (4, 5, 6) always flip exactly. Multi subset modes flip exactly when their
+  // partition shape has a mirrored counterpart the mode can encode: 62 of 64 two subset shapes, 59 of
+  // 64 three subset shapes and 14 of the 16 shapes of mode 0. The remaining blocks are re-encoded
+  template <unsigned Rows>
+  void FlipBc7Block(const std::byte* t_source, std::byte* t_destination) {
+    Dds::Bc7::BLOCK block;
+    if (!Dds::Bc7::Unpack(t_source, block)) {
+      // reserved mode, decodes to transparent black whichever way up it is
+      std::memmove(t_destination, t_source, 16);
+      return;
+    }
+
+    const Dds::Bc7::MODE_INFO& info    = Dds::Bc7::MODES[block.mode];
+    Dds::Bc7::BLOCK            flipped = block;
+
+    if (info.subsets > 1) {
+      const PARTITION_FLIP& flip = (info.subsets == 2 ? PARTITION_FLIPS_2<Rows> : PARTITION_FLIPS_3<Rows>)[block.partition];
+      if (!flip.valid || flip.partition >= (1u << info.partitionBits)) {
+        ReencodeBc7Block<Rows>(t_source, t_destination);
+        return;
+      }
+
+      flipped.partition = flip.partition;
+      for (unsigned subset = 0; subset < info.subsets; ++subset) {
+        const unsigned target = flip.subsetMap[subset];
+        for (unsigned e = 0; e < 2; ++e) {
+          std::memcpy(flipped.endpoints[target * 2 + e], block.endpoints[subset * 2 + e], 4);
+          if (info.endpointPBits) {
+            flipped.pBits[target * 2 + e] = block.pBits[subset * 2 + e];
+          }
+        }
+        if (info.sharedPBits) {
+          flipped.pBits[target] = block.pBits[subset];
+        }
+      }
+    }
+
+    for (size_t texel = 0; texel < 16; ++texel) {
+      flipped.indices[texel]       = block.indices[FlippedTexel(texel, Rows)];
+      flipped.secondIndices[texel] = block.secondIndices[FlippedTexel(texel, Rows)];
+    }
+
+    // modes 4 and 5 interpolate colour and alpha with separate index sets, the first stored set drives
+    // colour unless the index selection bit hands it the alpha channel
+    const bool     splitSets    = info.secondIndexBits != 0;
+    const unsigned firstChannel = splitSets && flipped.indexSelection ? 3u : 0u;
+    const unsigned endChannel   = splitSets && !flipped.indexSelection ? 3u : 4u;
+
+    for (uint8_t subset = 0; subset < info.subsets; ++subset) {
+      const uint8_t anchor = Dds::Bc7::Anchor(info.subsets, flipped.partition, subset);
+      if ((flipped.indices[anchor] >> (info.indexBits - 1)) == 0) {
+        continue;
+      }
+
+      InvertIndices(flipped.indices, info.indexBits, [&](const size_t t_texel) {
+        return Dds::Bc7::Subset(info.subsets, flipped.partition, t_texel) == subset;
+      });
+      SwapEndpoints(flipped, subset, firstChannel, endChannel);
+      if (info.endpointPBits) {
+        std::swap(flipped.pBits[subset * 2], flipped.pBits[subset * 2 + 1]);
+      }
+    }
+
+    if (splitSets && (flipped.secondIndices[0] >> (info.secondIndexBits - 1)) != 0) {
+      InvertIndices(flipped.secondIndices, info.secondIndexBits, [](size_t) {
+        return true;
+      });
+      SwapEndpoints(flipped, 0, firstChannel == 0 ? 3u : 0u, firstChannel == 0 ? 4u : 3u);
+    }
+
+    Dds::Bc7::Pack(flipped, t_destination);
+  }
+
+  template <unsigned Rows>
+  void FlipBc7Blocks(const std::byte* t_source, std::byte* t_destination, const size_t t_blockCount) {
+    for (size_t block = 0; block < t_blockCount; ++block) {
+      FlipBc7Block<Rows>(t_source + block * 16, t_destination + block * 16);
+    }
+  }
+
+  // uncompressed rows, FlipSurface hands them over as runs of single byte blocks
+  void CopyBytes(const std::byte* t_source, std::byte* t_destination, const size_t t_blockCount) {
+    if (t_source != t_destination) {
+      std::memcpy(t_destination, t_source, t_blockCount);
+    }
+  }
+
+  template <unsigned Rows>
+  Dds::FlipKernel SelectBlockKernel(const Dds::FlipLayout t_layout) {
+    using Dds::FlipLayout;
+
+    switch (t_layout) {
+      case FlipLayout::BC1:
+        return &FlipBlocks<ColorRows, ColorRows, 8, Rows>;
+      case FlipLayout::BC2:
+        return &FlipBlocks<ExplicitAlphaRows, ColorRows, 16, Rows>;
+      case FlipLayout::BC3:
+        return &FlipBlocks<AlphaIndexRows, ColorRows, 16, Rows>;
+      case FlipLayout::BC4:
+        return &FlipBlocks<AlphaIndexRows, AlphaIndexRows, 8, Rows>;
+      case FlipLayout::BC5:
+        return &FlipBlocks<AlphaIndexRows, AlphaIndexRows, 16, Rows>;
+      case FlipLayout::BC7:
+        return &FlipBc7Blocks<Rows>;
+      case FlipLayout::Rows:
+        return &CopyBytes;
+      case FlipLayout::None:
+        break;
+    }
+    return nullptr;
+  }
+
+  // reverses the order of the block rows and flips the texels of every block on the way
+  void FlipBlockRows(const Dds::FlipKernel t_kernel,
+                     const std::byte*      t_source,
+                     std::byte*            t_destination,
+                     const size_t          t_blocksWide,
+                     const size_t          t_blocksHigh,
+                     const size_t          t_blockSize) {
+    const size_t rowSize = t_blocksWide * t_blockSize;
+
+    if (t_source != t_destination) {
+      // the copy and the flip are the same pass
+      for (size_t y = 0; y < t_blocksHigh; ++y) {
+        t_kernel(t_source + y * rowSize, t_destination + (t_blocksHigh - 1 - y) * rowSize, t_blocksWide);
+      }
+      return;
+    }
+
+    // in place: park a piece of the top row, flip the bottom row up into it, then flip the parked piece
+    // down, so every block is read and written once plus one memcpy of the top half
+    alignas(64) std::byte scratch[4096];
+    const size_t          chunkBlocks = sizeof(scratch) / t_blockSize;
+
+    for (size_t y = 0; y < t_blocksHigh / 2; ++y) {
+      std::byte* top    = t_destination + y * rowSize;
+      std::byte* bottom = t_destination + (t_blocksHigh - 1 - y) * rowSize;
+
+      for (size_t x = 0; x < t_blocksWide; x += chunkBlocks) {
+        const size_t count  = std::min(chunkBlocks, t_blocksWide - x);
+        const size_t offset = x * t_blockSize;
+
+        std::memcpy(scratch, top + offset, count * t_blockSize);
+        t_kernel(bottom + offset, top + offset, count);
+        t_kernel(scratch, bottom + offset, count);
+      }
+    }
+
+    if (t_blocksHigh % 2 == 1) {
+      std::byte* middle = t_destination + (t_blocksHigh / 2) * rowSize;
+      t_kernel(middle, middle, t_blocksWide);
+    }
+  }
+}
+
+Dds::FlipKernel Dds::SelectFlipKernel(const FORMAT_INFO& t_format, const uint8_t t_rows) {
+  switch (t_rows) {
+    case 1:
+      if (t_format.Compressed() && t_format.flip != FlipLayout::None) {
+        return t_format.blockBytes == 8 ? &CopyBlocks<8> : &CopyBlocks<16>;
+      }
+      break;
+    case 2:
+      return SelectBlockKernel<2>(t_format.flip);
+    case 3:
+      return SelectBlockKernel<3>(t_format.flip);
+    default:
+      break;
+  }
+  return SelectBlockKernel<4>(t_format.flip);
+}
+
+bool Dds::CanFlipTexels(const FORMAT_INFO& t_format) {
+  return SelectDecodeKernel(t_format).format == PixelFormat::Rgba8 && SelectEncodeKernel(t_format.format) != nullptr;
+}
+
+bool Dds::FlipTexels(const FORMAT_INFO& t_format,
+                     const std::byte*   t_source,
+                     std::byte*         t_destination,
+                     const uint32_t     t_width,
+                     const uint32_t     t_height) {
+  if (!CanFlipTexels(t_format)) {
+    return false;
+  }
+  const DECODE_KERNEL decode = SelectDecodeKernel(t_format);
+  const EncodeKernel  encode = SelectEncodeKernel(t_format.format);
+
+  const size_t blocksWide = (t_width + 3) / 4;
+  const size_t blocksHigh = (t_height + 3) / 4;
+
+  // every block is decoded before the first one is written, so this works in place too
+  std::vector<uint8_t> decoded(blocksWide * blocksHigh * 64);
+  decode.kernel(t_source, blocksWide * blocksHigh, reinterpret_cast<std::byte*>(decoded.data()));
+
+  std::vector<uint8_t> tiles(blocksWide * 64);
+  for (size_t blockRow = 0; blockRow < blocksHigh; ++blockRow) {
+    for (size_t row = 0; row < 4; ++row) {
+      const size_t y = t_height - 1 - std::min<size_t>(blockRow * 4 + row, t_height - 1);
+      for (size_t x = 0; x < blocksWide * 4; ++x) {
+        const size_t   column = std::min<size_t>(x, t_width - 1);
+        const uint8_t* texel  = decoded.data() + ((y / 4) * blocksWide + column / 4) * 64 + ((y % 4) * 4 + column % 4) * 4;
+        std::memcpy(tiles.data() + (x / 4) * 64 + (row * 4 + x % 4) * 4, texel, 4);
+      }
+    }
+    encode(reinterpret_cast<const std::byte*>(tiles.data()), blocksWide, t_destination + blockRow * blocksWide * t_format.blockBytes);
+  }
+  return true;
+}
+
+void Dds::FlipSurface(const FORMAT_INFO& t_format,
+                      const std::byte*   t_source,
+                      std::byte*         t_destination,
+                      const uint32_t     t_width,
+                      const uint32_t     t_height,
+                      const bool         t_reencode) {
+  const FlipKernel kernel = SelectFlipKernel(t_format);
+  if (!kernel) {
+    if (t_source != t_destination) {
+      std::memcpy(t_destination, t_source, t_format.SurfaceSize(t_width, t_height));
+    }
+    return;
+  }
+
+  const size_t blocksHigh = (static_cast<size_t>(t_height) + t_format.blockHeight - 1) / t_format.blockHeight;
+  size_t       blocksWide = (static_cast<size_t>(t_width) + t_format.blockWidth - 1) / t_format.blockWidth;
+  size_t       blockSize  = t_format.blockBytes;
+  if (!t_format.Compressed()) {
+    // whole rows are copied unchanged, moving them as runs of bytes spares the kernel a pixel size
+    blocksWide *= blockSize;
+    blockSize = 1;
+  }
+
+  // texel rows of the last block row that are part of the image, the rest of it is padding
+  const auto lastRows = static_cast<uint8_t>(t_height - (blocksHigh - 1) * t_format.blockHeight);
+  if (lastRows == t_format.blockHeight) {
+    FlipBlockRows(kernel, t_source, t_destination, blocksWide, blocksHigh, blockSize);
+  }
+  else if (blocksHigh == 1) {
+    SelectFlipKernel(t_format, lastRows)(t_source, t_destination, blocksWide);
+  }
+  else if (!t_reencode || !FlipTexels(t_format, t_source, t_destination, t_width, t_height)) {
+    FlipBlockRows(kernel, t_source, t_destination, blocksWide, blocksHigh, blockSize);
+  }
+}
@@ -0,0 +1,326 @@
+#include "dds/Formats.h"
+
+#include <array>
+#include <cstddef>
+
+namespace
+{
+  using Dds::FlipLayout;
+  using Dds::Flag;
+  using Dds::Format;
+  using Dds::FORMAT_INFO;
+
+  // GL enum values, this file never sees a GL header
+  enum OGL_FORMAT : uint32_t
+  {
+    GL_COMPRESSED_RGBA_S3TC_DXT1_EXT       = 0x83F1, // DXT1 RGBA linear
+    GL_COMPRESSED_RGBA_S3TC_DXT3_EXT       = 0x83F2, // DXT3 RGBA linear
+    GL_COMPRESSED_RGBA_S3TC_DXT5_EXT       = 0x83F3, // DXT5 RGBA linear
+    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT = 0x8C4D, // DXT1 RGBA sRGB
+    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT = 0x8C4E, // DXT3 RGBA sRGB
+    GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT = 0x8C4F, // DXT5 RGBA sRGB
+    GL_COMPRESSED_RGBA_BPTC_UNORM          = 0x8E8C, // BC7 RGBA linear
+    GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM    = 0x8E8D, // BC7 RGBA sRGB
+    GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT    = 0x8E8E, // BC6H RGB signed half float
+    GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT  = 0x8E8F, // BC6H RGB unsigned half float
+    GL_COMPRESSED_RED_RGTC1                = 0x8DBB, // BC4u R linear
+    GL_COMPRESSED_SIGNED_RED_RGTC1         = 0x8DBC, // BC4s R linear
+    GL_COMPRESSED_RG_RGTC2                 = 0x8DBD, // BC5u RG linear
+    GL_COMPRESSED_SIGNED_RG_RGTC2          = 0x8DBE, // BC5s RG linear
+
+    GL_R8           = 0x8229,
+    GL_RG8          = 0x822B,
+    GL_RGB8         = 0x8051,
+    GL_RGBA8        = 0x8058,
+    GL_SRGB8        = 0x8C41,
+    GL_SRGB8_ALPHA8 = 0x8C43,
+    GL_RGB565       = 0x8D62,
+    GL_RGB5_A1      = 0x8057,
+    GL_RGBA4        = 0x8056,
+    GL_RGB10_A2     = 0x8059,
+    GL_R16          = 0x822A,
+    GL_RG16         = 0x822C,
+    GL_RGBA16       = 0x805B,
+    GL_R16F         = 0x822D,
+    GL_RG16F        = 0x822F,
+    GL_RGBA16F      = 0x881A,
+    GL_R32F         = 0x822E,
+    GL_RG32F        = 0x8230,
+    GL_RGBA32F      = 0x8814,
+
+    GL_RED          = 0x1903,
+    GL_RG           = 0x8227,
+    GL_RGB          = 0x1907,
+    GL_RGBA         = 0x1908,
+    GL_BGR          = 0x80E0,
+    GL_BGRA         = 0x80E1,
+
+    GL_UNSIGNED_BYTE               = 0x1401,
+    GL_UNSIGNED_SHORT              = 0x1403,
+    GL_FLOAT                       = 0x1406,
+    GL_HALF_FLOAT                  = 0x140B,
+    GL_UNSIGNED_SHORT_5_6_5        = 0x8363,
+    GL_UNSIGNED_SHORT_4_4_4_4_REV  = 0x8365,
+    GL_UNSIGNED_SHORT_1_5_5_5_REV  = 0x8366,
+    GL_UNSIGNED_INT_2_10_10_10_REV = 0x8368,
+  };
+
+  constexpr FORMAT_INFO Compressed(const Format     t_format,
+                                   const char*      t_name,
+                                   const uint8_t    t_blockBytes,
+                                   const Flag       t_flag,
+                                   const FlipLayout t_flip,
+                                   const uint32_t   t_gl,
+                                   const uint32_t   t_glSrgb = 0) {
+    return {t_format, t_name, 4, 4, t_blockBytes, t_flag, t_flip, t_gl, t_glSrgb, 0, 0};
+  }
+
+  constexpr FORMAT_INFO Uncompressed(const Format   t_format,
+                                     const char*    t_name,
+                                     const uint8_t  t_pixelBytes,
+                                     const uint32_t t_gl,
+                                     const uint32_t t_glSrgb,
+                                     const uint32_t t_glPixelFormat,
+                                     const uint32_t t_glPixelType) {
+    return {t_format, t_name, 1, 1, t_pixelBytes, Flag::Uncompressed, FlipLayout::Rows, t_gl, t_glSrgb, t_glPixelFormat, t_glPixelType};
+  }
+
+  // indexed by Format
+  constexpr std::array<FORMAT_INFO, static_cast<size_t>(Format::Count)> FORMATS = {{
+    {},
+    Compressed(Format::BC1, "BC1", 8, Flag::DXT1, FlipLayout::BC1, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT),
+    Compressed(Format::BC2, "BC2", 16, Flag::DXT3, FlipLayout::BC2, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT),
+    Compressed(Format::BC3, "BC3", 16, Flag::DXT5, FlipLayout::BC3, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT),
+    Compressed(Format::BC4, "BC4", 8, Flag::BC4_U, FlipLayout::BC4, GL_COMPRESSED_RED_RGTC1),
+    Compressed(Format::BC4_S, "BC4_S", 8, Flag::BC4_S, FlipLayout::BC4, GL_COMPRESSED_SIGNED_RED_RGTC1),
+    Compressed(Format::BC5, "BC5", 16, Flag::BC5_U, FlipLayout::BC5, GL_COMPRESSED_RG_RGTC2),
+    Compressed(Format::BC5_S, "BC5_S", 16, Flag::BC5_S, FlipLayout::BC5, GL_COMPRESSED_SIGNED_RG_RGTC2),
+    Compressed(Format::BC6H_UF16, "BC6H_UF16", 16, Flag::BC6H_UF16, FlipLayout::None, GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT),
+    Compressed(Format::BC6H_SF16, "BC6H_SF16", 16, Flag::BC6H_SF16, FlipLayout::None, GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT),
+    Compressed(Format::BC7, "BC7", 16, Flag::BC7, FlipLayout::BC7, GL_COMPRESSED_RGBA_BPTC_UNORM, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM),
+    Uncompressed(Format::R8, "R8", 1, GL_R8, 0, GL_RED, GL_UNSIGNED_BYTE),
+    Uncompressed(Format::RG8, "RG8", 2, GL_RG8, 0, GL_RG, GL_UNSIGNED_BYTE),
+    Uncompressed(Format::RGBA8, "RGBA8", 4, GL_RGBA8, GL_SRGB8_ALPHA8, GL_RGBA, GL_UNSIGNED_BYTE),
+    Uncompressed(Format::BGRA8, "BGRA8", 4, GL_RGBA8, GL_SRGB8_ALPHA8, GL_BGRA, GL_UNSIGNED_BYTE),
+    Uncompressed(Format::BGRX8, "BGRX8", 4, GL_RGB8, GL_SRGB8, GL_BGRA, GL_UNSIGNED_BYTE),
+    Uncompressed(Format::BGR8, "BGR8", 3, GL_RGB8, GL_SRGB8, GL_BGR, GL_UNSIGNED_BYTE),
+    Uncompressed(Format::B5G6R5, "B5G6R5", 2, GL_RGB565, 0, GL_RGB, GL_UNSIGNED_SHORT_5_6_5),
+    Uncompressed(Format::B5G5R5A1, "B5G5R5A1", 2, GL_RGB5_A1, 0, GL_BGRA, GL_UNSIGNED_SHORT_1_5_5_5_REV),
+    Uncompressed(Format::B4G4R4A4, "B4G4R4A4", 2, GL_RGBA4, 0, GL_BGRA, GL_UNSIGNED_SHORT_4_4_4_4_REV),
+    Uncompressed(Format::R10G10B10A2, "R10G10B10A2", 4, GL_RGB10_A2, 0, GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV),
+    Uncompressed(Format::R16, "R16", 2, GL_R16, 0, GL_RED, GL_UNSIGNED_SHORT),
+    Uncompressed(Format::RG16, "RG16", 4, GL_RG16, 0, GL_RG, GL_UNSIGNED_SHORT),
+    Uncompressed(Format::RGBA16, "RGBA16", 8, GL_RGBA16, 0, GL_RGBA, GL_UNSIGNED_SHORT),
+    Uncompressed(Format::R16F, "R16F", 2, GL_R16F, 0, GL_RED, GL_HALF_FLOAT),
+    Uncompressed(Format::RG16F, "RG16F", 4, GL_RG16F, 0, GL_RG, GL_HALF_FLOAT),
+    Uncompressed(Format::RGBA16F, "RGBA16F", 8, GL_RGBA16F, 0, GL_RGBA, GL_HALF_FLOAT),
+    Uncompressed(Format::R32F, "R32F", 4, GL_R32F, 0, GL_RED, GL_FLOAT),
+    Uncompressed(Format::RG32F, "RG32F", 8, GL_RG32F, 0, GL_RG, GL_FLOAT),
+    Uncompressed(Format::RGBA32F, "RGBA32F", 16, GL_RGBA32F, 0, GL_RGBA, GL_FLOAT),
+  }};
+
+  constexpr bool FormatsInOrder() {
+    for (size_t i = 0; i < FORMATS.size(); ++i) {
+      if (static_cast<size_t>(FORMATS[i].format) != i) {
+        return false;
+      }
+    }
+    return true;
+  }
+  static_assert(FormatsInOrder(), "FORMATS must be indexed by Format");
+
+  struct DXGI_ENTRY
+  {
+    DXGI_FORMAT dxgiFormat;
+    Format      format;
+    bool        srgb = false;
+  };
+
+  // typeless formats are only accepted where the bits can be read one way
+  constexpr DXGI_ENTRY DXGI_FORMATS[] = {
+    {DXGI_FORMAT_BC1_TYPELESS, Format::BC1},
+    {DXGI_FORMAT_BC1_UNORM, Format::BC1},
+    {DXGI_FORMAT_BC1_UNORM_SRGB, Format::BC1, true},
+    {DXGI_FORMAT_BC2_TYPELESS, Format::BC2},
+    {DXGI_FORMAT_BC2_UNORM, Format::BC2},
+    {DXGI_FORMAT_BC2_UNORM_SRGB, Format::BC2, true},
+    {DXGI_FORMAT_BC3_TYPELESS, Format::BC3},
+    {DXGI_FORMAT_BC3_UNORM, Format::BC3},
+    {DXGI_FORMAT_BC3_UNORM_SRGB, Format::BC3, true},
+    {DXGI_FORMAT_BC4_TYPELESS, Format::BC4},
+    {DXGI_FORMAT_BC4_UNORM, Format::BC4},
+    {DXGI_FORMAT_BC4_SNORM, Format::BC4_S},
+    {DXGI_FORMAT_BC5_TYPELESS, Format::BC5},
+    {DXGI_FORMAT_BC5_UNORM, Format::BC5},
+    {DXGI_FORMAT_BC5_SNORM, Format::BC5_S},
+    {DXGI_FORMAT_BC6H_TYPELESS, Format::BC6H_UF16},
+    {DXGI_FORMAT_BC6H_UF16, Format::BC6H_UF16},
+    {DXGI_FORMAT_BC6H_SF16, Format::BC6H_SF16},
+    {DXGI_FORMAT_BC7_TYPELESS, Format::BC7},
+    {DXGI_FORMAT_BC7_UNORM, Format::BC7},
+    {DXGI_FORMAT_BC7_UNORM_SRGB, Format::BC7, true},
+    {DXGI_FORMAT_R8_UNORM, Format::R8},
+    {DXGI_FORMAT_R8G8_UNORM, Format::RG8},
+    {DXGI_FORMAT_R8G8B8A8_TYPELESS, Format::RGBA8},
+    {DXGI_FORMAT_R8G8B8A8_UNORM, Format::RGBA8},
+    {DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, Format::RGBA8, true},
+    {DXGI_FORMAT_B8G8R8A8_TYPELESS, Format::BGRA8},
+    {DXGI_FORMAT_B8G8R8A8_UNORM, Format::BGRA8},
+    {DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, Format::BGRA8, true},
+    {DXGI_FORMAT_B8G8R8X8_TYPELESS, Format::BGRX8},
+    {DXGI_FORMAT_B8G8R8X8_UNORM, Format::BGRX8},
+    {DXGI_FORMAT_B8G8R8X8_UNORM_SRGB, Format::BGRX8, true},
+    {DXGI_FORMAT_B5G6R5_UNORM, Format::B5G6R5},
+    {DXGI_FORMAT_B5G5R5A1_UNORM, Format::B5G5R5A1},
+    {DXGI_FORMAT_B4G4R4A4_UNORM, Format::B4G4R4A4},
+    {DXGI_FORMAT_R10G10B10A2_TYPELESS, Format::R10G10B10A2},
+    {DXGI_FORMAT_R10G10B10A2_UNORM, Format::R10G10B10A2},
+    {DXGI_FORMAT_R16_UNORM, Format::R16},
+    {DXGI_FORMAT_R16G16_UNORM, Format::RG16},
+    {DXGI_FORMAT_R16G16B16A16_UNORM, Format::RGBA16},
+    {DXGI_FORMAT_R16_FLOAT, Format::R16F},
+    {DXGI_FORMAT_R16G16_FLOAT, Format::RG16F},
+    {DXGI_FORMAT_R16G16B16A16_FLOAT, Format::RGBA16F},
+    {DXGI_FORMAT_R32_FLOAT, Format::R32F},
+    {DXGI_FORMAT_R32G32_FLOAT, Format::RG32F},
+    {DXGI_FORMAT_R32G32B32A32_FLOAT, Format::RGBA32F},
+  };
+
+  // DXGI_FORMAT value -> 1 + index into DXGI_FORMATS, 0 for unsupported values. Every supported value
+  // is below 128
+  constexpr std::array<uint8_t, 128> BuildDxgiIndex() {
+    std::array<uint8_t, 128> index{};
+    for (size_t i = 0; i < std::size(DXGI_FORMATS); ++i) {
+      index[static_cast<size_t>(DXGI_FORMATS[i].dxgiFormat)] = static_cast<uint8_t>(i + 1);
+    }
+    return index;
+  }
+
+  constexpr std::array<uint8_t, 128> DXGI_INDEX = BuildDxgiIndex();
+
+  constexpr uint32_t MakeFourCC(const char (&t_code)[5]) {
+    return static_cast<uint32_t>(t_code[0]) | static_cast<uint32_t>(t_code[1]) << 8 |
+           static_cast<uint32_t>(t_code[2]) << 16 | static_cast<uint32_t>(t_code[3]) << 24;
+  }
+
+  struct FOURCC_ENTRY
+  {
+    uint32_t fourCC;
+    Format   format;
+  };
+
+  constexpr FOURCC_ENTRY FOURCC_FORMATS[] = {
+    {MakeFourCC("DXT1"), Format::BC1},
+    {MakeFourCC("DXT2"), Format::BC2}, // premultiplied alpha, same bits
+    {MakeFourCC("DXT3"), Format::BC2},
+    {MakeFourCC("DXT4"), Format::BC3}, // premultiplied alpha, same bits
+    {MakeFourCC("DXT5"), Format::BC3},
+    {MakeFourCC("ATI1"), Format::BC4},
+    {MakeFourCC("BC4U"), Format::BC4},
+    {MakeFourCC("BC4S"), Format::BC4_S},
+    {MakeFourCC("ATI2"), Format::BC5},
+    {MakeFourCC("BC5U"), Format::BC5},
+    {MakeFourCC("BC5S"), Format::BC5_S},
+    // D3DFORMAT values, written into dwFourCC by legacy tools for formats without a mask layout
+    {36, Format::RGBA16},   // D3DFMT_A16B16G16R16
+    {111, Format::R16F},    // D3DFMT_R16F
+    {112, Format::RG16F},   // D3DFMT_G16R16F
+    {113, Format::RGBA16F}, // D3DFMT_A16B16G16R16F
+    {114, Format::R32F},    // D3DFMT_R32F
+    {115, Format::RG32F},   // D3DFMT_G32R32F
+    {116, Format::RGBA32F}, // D3DFMT_A32B32G32R32F
+  };
+
+  constexpr uint32_t DDPF_ALPHAPIXELS = 0x1;
+  constexpr uint32_t DDPF_ALPHA       = 0x2;
+  constexpr uint32_t DDPF_RGB         = 0x40;
+  constexpr uint32_t DDPF_LUMINANCE   = 0x20000;
+
+  struct MASK_ENTRY
+  {
+    uint32_t kind; // DDPF_RGB or DDPF_LUMINANCE
+    uint32_t bitCount;
+    uint32_t r, g, b, a;
+    Format   format;
+  };
+
+  constexpr MASK_ENTRY MASK_FORMATS[] = {
+    {DDPF_RGB, 32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000, Format::RGBA8},
+    {DDPF_RGB, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000, Format::BGRA8},
+    {DDPF_RGB, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0x00000000, Format::BGRX8},
+    {DDPF_RGB, 32, 0x000003FF, 0x000FFC00, 0x3FF00000, 0xC0000000, Format::R10G10B10A2},
+    {DDPF_RGB, 32, 0x0000FFFF, 0xFFFF0000, 0x00000000, 0x00000000, Format::RG16},
+    {DDPF_RGB, 24, 0x00FF0000, 0x0000FF00, 0x000000FF, 0x00000000, Format::BGR8},
+    {DDPF_RGB, 16, 0x0000F800, 0x000007E0, 0x0000001F, 0x00000000, Format::B5G6R5},
+    {DDPF_RGB, 16, 0x00007C00, 0x000003E0, 0x0000001F, 0x00008000, Format::B5G5R5A1},
+    {DDPF_RGB, 16, 0x00000F00, 0x000000F0, 0x0000000F, 0x0000F000, Format::B4G4R4A4},
+    {DDPF_RGB, 16, 0x000000FF, 0x0000FF00, 0x00000000, 0x00000000, Format::RG8},
+    {DDPF_LUMINANCE, 8, 0x000000FF, 0x00000000, 0x00000000, 0x00000000, Format::R8},
+    {DDPF_LUMINANCE, 16, 0x0000FFFF, 0x00000000, 0x00000000, 0x00000000, Format::R16},
+    {DDPF_LUMINANCE, 16, 0x000000FF, 0x00000000, 0x00000000, 0x0000FF00, Format::RG8}, // L8A8, alpha in G
+  };
+}
+
+const Dds::FORMAT_INFO& Dds::GetFormatInfo(const Format t_format) {
+  return FORMATS[static_cast<size_t>(t_format)];
+}
+
+const Dds::FORMAT_INFO* Dds::FindDxgiFormat(const uint32_t t_dxgiFormat, bool& t_srgb) {
+  if (t_dxgiFormat >= DXGI_INDEX.size() || DXGI_INDEX[t_dxgiFormat] == 0) {
+    return nullptr;
+  }
+
+  const DXGI_ENTRY& entry = DXGI_FORMATS[DXGI_INDEX[t_dxgiFormat] - 1];
+  t_srgb                  = entry.srgb;
+  return &GetFormatInfo(entry.format);
+}
+
+uint32_t Dds::GetDxgiFormat(const Format t_format, const bool t_srgb) {
+  // the typed value of a format follows its typeless one, so the last match is the one to write
+  uint32_t dxgiFormat = 0;
+  for (const DXGI_ENTRY& entry : DXGI_FORMATS) {
+    if (entry.format == t_format && entry.srgb == t_srgb) {
+      dxgiFormat = static_cast<uint32_t>(entry.dxgiFormat);
+    }
+  }
+  return dxgiFormat;
+}
+
+const Dds::FORMAT_INFO* Dds::FindFourCC(const uint32_t t_fourCC) {
+  for (const FOURCC_ENTRY& entry : FOURCC_FORMATS) {
+    if (entry.fourCC == t_fourCC) {
+      return &GetFormatInfo(entry.format);
+    }
+  }
+  return nullptr;
+}
+
+const Dds::FORMAT_INFO* Dds::FindPixelMasks(const LoadDds::DDS_PIXELFORMAT& t_pixelFormat) {
+  const uint32_t kind = t_pixelFormat.dwFlags & (DDPF_RGB | DDPF_LUMINANCE);
+  // writers fill the alpha mask of opaque formats in now and then, it only counts when flagged
+  const uint32_t alpha = t_pixelFormat.dwFlags & (DDPF_ALPHAPIXELS | DDPF_ALPHA) ? t_pixelFormat.dwABitMask : 0;
+
+  for (const MASK_ENTRY& entry : MASK_FORMATS) {
+    if (entry.kind == kind && entry.bitCount == t_pixelFormat.dwRGBBitCount && entry.r == t_pixelFormat.dwRBitMask &&
+        entry.g == t_pixelFormat.dwGBitMask && entry.b == t_pixelFormat.dwBBitMask && entry.a == alpha) {
+      return &GetFormatInfo(entry.format);
+    }
+  }
+  return nullptr;
+}
+
+bool Dds::GetPixelMasks(const Format t_format, LoadDds::DDS_PIXELFORMAT& t_pixelFormat) {
+  for (const MASK_ENTRY& entry : MASK_FORMATS) {
+    if (entry.format == t_format) {
+      t_pixelFormat.dwFlags       = entry.kind | (entry.a != 0 ? DDPF_ALPHAPIXELS : 0);
+      t_pixelFormat.dwFourCC      = 0;
+      t_pixelFormat.dwRGBBitCount = entry.bitCount;
+      t_pixelFormat.dwRBitMask    = entry.r;
+      t_pixelFormat.dwGBitMask    = entry.g;
+      t_pixelFormat.dwBBitMask    = entry.b;
+      t_pixelFormat.dwABitMask    = entry.a;
+      return true;
+    }
+  }
+  return false;
+}
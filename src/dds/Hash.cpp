@@ -0,0 +1,95 @@
+#include "dds/Hash.h"
+
+#include <bit>
+#include <cstring>
+
+namespace
+{
+  constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ull;
+  constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4Full;
+  constexpr uint64_t PRIME3 = 0x165667B19E3779F9ull;
+  constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ull;
+  constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ull;
+
+  // little endian loads, the hash is defined on the byte stream
+  template <typename T>
+  T ReadLittle(const std::byte* t_data) {
+    T value = 0;
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(&value, t_data, sizeof(value));
+    }
+    else {
+      for (size_t i = sizeof(T); i-- > 0;) {
+        value = static_cast<T>(value << 8) | static_cast<T>(t_data[i]);
+      }
+    }
+    return value;
+  }
+
+  uint64_t Round(uint64_t t_accumulator, const uint64_t t_input) {
+    t_accumulator += t_input * PRIME2;
+    t_accumulator  = std::rotl(t_accumulator, 31);
+    return t_accumulator * PRIME1;
+  }
+
+  uint64_t MergeRound(uint64_t t_accumulator, const uint64_t t_value) {
+    t_accumulator ^= Round(0, t_value);
+    return t_accumulator * PRIME1 + PRIME4;
+  }
+}
+
+uint64_t Dds::Hash64(const std::span<const std::byte> t_data, const uint64_t t_seed) {
+  const std::byte* data = t_data.data();
+  const std::byte* end  = data + t_data.size();
+  uint64_t         hash;
+
+  if (t_data.size() >= 32) {
+    // four independent lanes over 32 byte stripes keep the multipliers busy
+    uint64_t v1 = t_seed + PRIME1 + PRIME2;
+    uint64_t v2 = t_seed + PRIME2;
+    uint64_t v3 = t_seed;
+    uint64_t v4 = t_seed - PRIME1;
+
+    const std::byte* limit = end - 32;
+    do {
+      v1 = Round(v1, ReadLittle<uint64_t>(data));
+      v2 = Round(v2, ReadLittle<uint64_t>(data + 8));
+      v3 = Round(v3, ReadLittle<uint64_t>(data + 16));
+      v4 = Round(v4, ReadLittle<uint64_t>(data + 24));
+      data += 32;
+    } while (data <= limit);
+
+    hash = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+    hash = MergeRound(hash, v1);
+    hash = MergeRound(hash, v2);
+    hash = MergeRound(hash, v3);
+    hash = MergeRound(hash, v4);
+  }
+  else {
+    hash = t_seed + PRIME5;
+  }
+
+  hash += static_cast<uint64_t>(t_data.size());
+
+  for (; end - data >= 8; data += 8) {
+    hash ^= Round(0, ReadLittle<uint64_t>(data));
+    hash  = std::rotl(hash, 27) * PRIME1 + PRIME4;
+  }
+  if (end - data >= 4) {
+    hash ^= static_cast<uint64_t>(ReadLittle<uint32_t>(data)) * PRIME1;
+    hash  = std::rotl(hash, 23) * PRIME2 + PRIME3;
+    data += 4;
+  }
+  for (; data != end; ++data) {
+    hash ^= static_cast<uint64_t>(*data) * PRIME5;
+    hash  = std::rotl(hash, 11) * PRIME1;
+  }
+
+  // avalanche
+  hash ^= hash >> 33;
+  hash *= PRIME2;
+  hash ^= hash >> 29;
+  hash *= PRIME3;
+  hash ^= hash >> 32;
+  return hash;
+}
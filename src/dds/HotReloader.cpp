@@ -0,0 +1,399 @@
+#include "dds/HotReloader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#include "dds/FileReader.h"
+#include "dds/Hash.h"
+
+#if defined(__linux__) && __has_include(<sys/inotify.h>)
+#define DDS_HAS_INOTIFY
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  constexpr uint32_t DX10 = 0x30315844; // "DX10"
+
+  bool IsDds(const std::filesystem::path& t_path) {
+    std::string extension = t_path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](const unsigned char t_char)
+    {
+      return static_cast<char>(std::tolower(t_char));
+    });
+    return extension == ".dds";
+  }
+
+  // magic, DDS_HEADER and DDS_HEADER_DXT10 when the file has one
+  size_t HeaderSize(const LoadDds::DDS_INFO& t_ddsInfo) {
+    return 4 + sizeof(LoadDds::DDS_HEADER) + (t_ddsInfo.header.ddspf.dwFourCC == DX10 ? sizeof(LoadDds::DDS_HEADER_DXT10) : 0);
+  }
+
+  // XXH64 of every level of the layout across its layers, read out of the file in its layer-major
+  // order. false if the file is too short for the layout
+  bool HashLevels(const LoadDds::DDS_INFO& t_ddsInfo, const std::span<const std::byte> t_file, std::vector<uint64_t>& t_hashes) {
+    t_hashes.assign(t_ddsInfo.mipMaps.size(), 0);
+
+    size_t levelOffset = 0; // of the level inside a layer
+    for (size_t mip = 0; mip < t_ddsInfo.mipMaps.size(); ++mip) {
+      const LoadDds::MIP_LEVEL& level = t_ddsInfo.mipMaps[mip];
+      for (size_t layer = 0; layer < t_ddsInfo.LayerCount(); ++layer) {
+        const uint64_t offset = t_ddsInfo.payloadOffset + layer * t_ddsInfo.fileLayerStride + levelOffset;
+        if (offset > t_file.size() || level.layerSize > t_file.size() - offset) {
+          return false;
+        }
+        t_hashes[mip] = Dds::Hash64(t_file.subspan(offset, level.layerSize), t_hashes[mip]);
+      }
+      levelOffset += level.layerSize;
+    }
+    return true;
+  }
+}
+
+Dds::HotReloader::HotReloader(ReloadFn t_onReload, const WATCH_OPTIONS& t_options)
+  : m_onReload(std::move(t_onReload)),
+    m_options(t_options) {
+  m_options.load.storage = Storage::Heap;
+
+#if defined(DDS_HAS_INOTIFY)
+  if (!m_options.forcePolling) {
+    m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_wakeFd  = m_inotify >= 0 ? eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) : -1;
+    if (m_inotify >= 0 && m_wakeFd < 0) {
+      close(m_inotify);
+      m_inotify = -1;
+    }
+  }
+#endif
+
+  m_thread = std::thread(&HotReloader::WatchLoop, this);
+}
+
+Dds::HotReloader::~HotReloader() {
+  {
+    const std::lock_guard lock(m_directoriesMutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+#if defined(DDS_HAS_INOTIFY)
+  if (m_wakeFd >= 0) {
+    const uint64_t                one     = 1;
+    [[maybe_unused]] const ssize_t written = write(m_wakeFd, &one, sizeof(one));
+  }
+#endif
+  m_thread.join();
+
+#if defined(DDS_HAS_INOTIFY)
+  if (m_inotify >= 0) {
+    close(m_inotify);
+    close(m_wakeFd);
+  }
+#endif
+}
+
+Dds::STATUS Dds::HotReloader::Watch(const std::string& t_directory) {
+  std::error_code error;
+  if (!std::filesystem::is_directory(t_directory, error)) {
+    const STATUS status{Error::OpenFailed};
+    Log(status, t_directory.c_str());
+    return status;
+  }
+
+  DIRECTORY directory;
+  directory.path = t_directory;
+#if defined(DDS_HAS_INOTIFY)
+  if (m_inotify >= 0) {
+    // written and closed, or renamed into place by editors that save to a temporary file
+    directory.watch = inotify_add_watch(m_inotify, t_directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (directory.watch < 0) {
+      const STATUS status{Error::OpenFailed, static_cast<uint32_t>(errno)};
+      Log(status, t_directory.c_str());
+      return status;
+    }
+  }
+#endif
+
+  // stamped before loading, so a save that lands in between is seen by the next scan
+  std::vector<std::string> paths;
+  for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(t_directory, error)) {
+    if (file.is_regular_file(error) && IsDds(file.path())) {
+      paths.push_back(file.path().string());
+      directory.stamps[paths.back()] = StampOf(file.path());
+    }
+  }
+  {
+    const std::lock_guard lock(m_directoriesMutex);
+    m_directories.push_back(std::move(directory));
+  }
+
+  for (const std::string& path : paths) {
+    RELOAD reload;
+    STATUS status;
+    {
+      const std::lock_guard lock(m_reloadMutex);
+      try {
+        status = ReloadImpl(path, reload);
+      }
+      catch (const std::bad_alloc&) {
+        status = {Error::OutOfMemory};
+      }
+    }
+    if (!status.Ok()) {
+      Log(status, path.c_str());
+    }
+  }
+  return {};
+}
+
+Dds::HotReloader::TexturePtr Dds::HotReloader::Get(const std::string& t_path) const {
+  const std::shared_lock lock(m_entriesMutex);
+  const auto             entry = m_entries.find(t_path);
+  return entry == m_entries.end() ? nullptr : entry->second->texture.load();
+}
+
+Dds::Result<Dds::HotReloader::RELOAD> Dds::HotReloader::Reload(const std::string& t_path) {
+  RELOAD reload;
+  STATUS status;
+  {
+    const std::lock_guard lock(m_reloadMutex);
+    try {
+      status = ReloadImpl(t_path, reload);
+    }
+    catch (const std::bad_alloc&) {
+      status = {Error::OutOfMemory};
+    }
+  }
+
+  if (!status.Ok()) {
+    Log(status, t_path.c_str());
+    return status;
+  }
+  // outside the lock, the hook may well look at other textures
+  if (reload.changedMips != 0 && m_onReload) {
+    m_onReload(reload);
+  }
+  return reload;
+}
+
+Dds::HotReloader::STAMP Dds::HotReloader::StampOf(const std::filesystem::path& t_path) {
+  std::error_code error;
+  const uint64_t  size      = std::filesystem::file_size(t_path, error);
+  const int64_t   writeTime = error ? 0 : std::filesystem::last_write_time(t_path, error).time_since_epoch().count();
+  return error ? STAMP{} : STAMP{size, writeTime};
+}
+
+Dds::STATUS Dds::HotReloader::ReloadImpl(const std::string& t_path, RELOAD& t_reload) {
+  t_reload.path = t_path;
+
+  // the whole file in one read, every byte of it is hashed anyway
+  std::vector<std::byte> file;
+  {
+    FileReader reader;
+    if (!reader.Open(t_path.c_str())) {
+      return {Error::OpenFailed};
+    }
+    if (reader.Size() == 0) {
+      return {Error::EmptyFile};
+    }
+    file.resize(reader.Size());
+    if (!reader.ReadAt(0, file)) {
+      return {Error::ReadFailed};
+    }
+  }
+  const std::span<const std::byte> bytes(file);
+  const uint64_t                   fileHash = Hash64(bytes);
+
+  ENTRY&           entry   = FindOrAdd(t_path);
+  const TexturePtr current = entry.texture.load();
+  if (current && fileHash == entry.fileHash) {
+    // saved without changes
+    t_reload.texture = current;
+    return {};
+  }
+
+  const Result<LoadDds::DDS_INFO> info = LoadDds::ProbeDds(bytes, m_options.load);
+  if (!info) {
+    return info.Status();
+  }
+  const size_t          headerSize = HeaderSize(*info);
+  std::vector<uint64_t> levelHashes;
+  const bool            hashed     = HashLevels(*info, bytes, levelHashes);
+  const bool            sameLayout = current && hashed && entry.headers.size() == headerSize &&
+                                     std::memcmp(entry.headers.data(), file.data(), headerSize) == 0;
+
+  TexturePtr texture;
+  if (sameLayout) {
+    for (size_t mip = 0; mip < levelHashes.size(); ++mip) {
+      if (levelHashes[mip] != entry.levelHashes[mip]) {
+        t_reload.changedMips |= 1u << mip;
+      }
+    }
+    if (t_reload.changedMips == 0) {
+      // only bytes past the mip chain changed
+      entry.fileHash   = fileHash;
+      t_reload.texture = current;
+      return {};
+    }
+
+    // readers may hold the published texture, so the new one is a copy with the changed levels loaded in
+    auto next                                 = std::make_shared<LoadDds::DDS_FILE>();
+    static_cast<LoadDds::DDS_INFO&>(*next) = *current;
+    next->buffer                              = AlignedBuffer(current->totalSizeBytes, LoadDds::PAYLOAD_ALIGNMENT);
+    next->data                                = {next->buffer.Data(), current->totalSizeBytes};
+    std::memcpy(next->data.data(), current->data.data(), current->totalSizeBytes);
+
+    for (size_t mip = 0; mip < levelHashes.size(); ++mip) {
+      if ((t_reload.changedMips & (1u << mip)) == 0) {
+        continue;
+      }
+      LoadOptions options = m_options.load;
+      options.firstMip    = current->firstMip + static_cast<uint32_t>(mip);
+      options.mipCount    = 1;
+
+      const Result<LoadDds::DDS_FILE> level = LoadDds::TextureLoadDds(bytes, options);
+      if (!level) {
+        return level.Status();
+      }
+      std::memcpy(next->MipData(mip).data(), level->data.data(), next->mipMaps[mip].size);
+    }
+    texture = std::move(next);
+  }
+  else {
+    Result<LoadDds::DDS_FILE> loaded = LoadDds::TextureLoadDds(bytes, m_options.load);
+    if (!loaded) {
+      return loaded.Status();
+    }
+    const size_t mips      = loaded->mipMaps.size();
+    texture                = std::make_shared<const LoadDds::DDS_FILE>(std::move(loaded).Value());
+    t_reload.changedMips   = mips >= 32 ? UINT32_MAX : (1u << mips) - 1;
+    t_reload.layoutChanged = true;
+  }
+
+  entry.fileHash    = fileHash;
+  entry.headers     = {file.begin(), file.begin() + static_cast<std::ptrdiff_t>(headerSize)};
+  entry.levelHashes = std::move(levelHashes);
+  entry.texture.store(texture);
+  t_reload.texture = std::move(texture);
+  return {};
+}
+
+Dds::HotReloader::ENTRY& Dds::HotReloader::FindOrAdd(const std::string& t_path) {
+  {
+    const std::shared_lock lock(m_entriesMutex);
+    if (const auto entry = m_entries.find(t_path); entry != m_entries.end()) {
+      return *entry->second;
+    }
+  }
+  const std::unique_lock   lock(m_entriesMutex);
+  std::unique_ptr<ENTRY>& entry = m_entries[t_path];
+  if (!entry) {
+    entry = std::make_unique<ENTRY>();
+  }
+  return *entry;
+}
+
+void Dds::HotReloader::WatchLoop() {
+  std::unordered_set<std::string> changed;
+  while (!m_stop) {
+    if (m_inotify >= 0) {
+      WaitForEvents(changed);
+    }
+    else {
+      Scan(changed);
+    }
+
+    for (const std::string& path : changed) {
+      if (m_stop) {
+        break;
+      }
+      // failures are logged by Reload, the next change tries again
+      (void)Reload(path);
+    }
+    changed.clear();
+  }
+}
+
+#if defined(DDS_HAS_INOTIFY)
+void Dds::HotReloader::WaitForEvents(std::unordered_set<std::string>& t_changed) {
+  pollfd descriptors[2] = {{m_inotify, POLLIN, 0}, {m_wakeFd, POLLIN, 0}};
+  int    timeout        = -1; // the first event, then only until things settle
+
+  while (!m_stop) {
+    const int ready = poll(descriptors, 2, timeout);
+    if (ready < 0 && errno == EINTR) {
+      continue;
+    }
+    if (ready <= 0 || descriptors[1].revents & POLLIN) {
+      return;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    ssize_t                     length;
+    while ((length = read(m_inotify, buffer, sizeof(buffer))) > 0) {
+      for (const char* next = buffer; next < buffer + length;) {
+        const auto* event = reinterpret_cast<const inotify_event*>(next);
+        next += sizeof(inotify_event) + event->len;
+
+        const std::lock_guard lock(m_directoriesMutex);
+        if (event->mask & IN_Q_OVERFLOW) {
+          // events were dropped, every known file goes through the hash check instead
+          for (const DIRECTORY& directory : m_directories) {
+            for (const auto& [path, stamp] : directory.stamps) {
+              t_changed.insert(path);
+            }
+          }
+          continue;
+        }
+        if (event->len == 0 || !IsDds(event->name)) {
+          continue;
+        }
+        for (DIRECTORY& directory : m_directories) {
+          if (directory.watch == event->wd) {
+            const std::string path = (std::filesystem::path(directory.path) / event->name).string();
+            directory.stamps.try_emplace(path);
+            t_changed.insert(path);
+          }
+        }
+      }
+    }
+    timeout = static_cast<int>(m_options.settleTime.count());
+  }
+}
+#else
+void Dds::HotReloader::WaitForEvents(std::unordered_set<std::string>&) {}
+#endif
+
+void Dds::HotReloader::Scan(std::unordered_set<std::string>& t_changed) {
+  std::unique_lock lock(m_directoriesMutex);
+  m_wake.wait_for(lock, m_options.pollInterval, [this]
+  {
+    return m_stop.load();
+  });
+  if (m_stop) {
+    return;
+  }
+
+  for (DIRECTORY& directory : m_directories) {
+    std::error_code error;
+    for (const std::filesystem::directory_entry& file : std::filesystem::directory_iterator(directory.path, error)) {
+      if (!file.is_regular_file(error) || !IsDds(file.path())) {
+        continue;
+      }
+      const std::string path          = file.path().string();
+      const STAMP       stamp         = StampOf(file.path());
+      const auto [known, inserted] = directory.stamps.try_emplace(path, stamp);
+      if (inserted || !(known->second == stamp)) {
+        known->second = stamp;
+        t_changed.insert(path);
+      }
+    }
+  }
+}
@@ -0,0 +1,175 @@
+#include "dds/Lz.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+  constexpr size_t MIN_MATCH     = 4;
+  constexpr size_t LAST_LITERALS = 5;  // the block always ends in at least this many literals
+  constexpr size_t MATCH_LIMIT   = 12; // and no match starts in its last 12 bytes
+  constexpr size_t MAX_OFFSET    = 65535;
+  constexpr int    HASH_BITS     = 14;
+
+  uint32_t Read32(const std::byte* t_data) {
+    uint32_t value;
+    std::memcpy(&value, t_data, sizeof(value));
+    return value;
+  }
+
+  uint32_t HashOf(const uint32_t t_sequence) {
+    return (t_sequence * 2654435761u) >> (32 - HASH_BITS);
+  }
+
+  // 15 in the token nibble, then 255s and the remainder
+  std::byte* PutLength(std::byte* t_out, size_t t_length) {
+    for (; t_length >= 255; t_length -= 255) {
+      *t_out++ = std::byte{255};
+    }
+    *t_out++ = static_cast<std::byte>(t_length);
+    return t_out;
+  }
+
+  // worst case size of one sequence, checked before anything is written
+  size_t SequenceBound(const size_t t_literals, const size_t t_match) {
+    return 1 + t_literals / 255 + 1 + t_literals + 2 + t_match / 255 + 1;
+  }
+
+  bool ReadLength(const std::byte*& t_in, const std::byte* t_end, size_t& t_length) {
+    uint8_t byte;
+    do {
+      if (t_in == t_end) {
+        return false;
+      }
+      byte = static_cast<uint8_t>(*t_in++);
+      t_length += byte;
+    } while (byte == 255);
+    return true;
+  }
+}
+
+size_t Dds::LzCompress(const std::span<const std::byte> t_source, const std::span<std::byte> t_destination) {
+  const std::byte* in     = t_source.data();
+  const size_t     size   = t_source.size();
+  std::byte*       out    = t_destination.data();
+  std::byte* const outEnd = out + t_destination.size();
+
+  size_t anchor = 0;
+
+  auto emit = [&](const size_t t_literals, const size_t t_offset, const size_t t_match)
+  {
+    if (SequenceBound(t_literals, t_match) > static_cast<size_t>(outEnd - out)) {
+      return false;
+    }
+    std::byte* token = out++;
+    *token           = static_cast<std::byte>(std::min<size_t>(t_literals, 15) << 4);
+    if (t_literals >= 15) {
+      out = PutLength(out, t_literals - 15);
+    }
+    if (t_literals != 0) {
+      std::memcpy(out, in + anchor, t_literals);
+      out += t_literals;
+    }
+
+    if (t_match == 0) {
+      return true; // the last sequence has no match
+    }
+    *out++ = static_cast<std::byte>(t_offset & 0xFF);
+    *out++ = static_cast<std::byte>(t_offset >> 8);
+    *token |= static_cast<std::byte>(std::min<size_t>(t_match - MIN_MATCH, 15));
+    if (t_match - MIN_MATCH >= 15) {
+      out = PutLength(out, t_match - MIN_MATCH - 15);
+    }
+    return true;
+  };
+
+  if (size > MATCH_LIMIT) {
+    // positions by hash of the 4 bytes there, candidates are verified so stale entries are harmless
+    std::vector<uint32_t> table(size_t{1} << HASH_BITS, 0);
+    const size_t          matchStartLimit = size - MATCH_LIMIT;
+    const size_t          matchEndLimit   = size - LAST_LITERALS;
+
+    size_t position = 0;
+    while (position < matchStartLimit) {
+      const uint32_t sequence  = Read32(in + position);
+      uint32_t&      slot      = table[HashOf(sequence)];
+      const size_t   candidate = slot;
+      slot                     = static_cast<uint32_t>(position);
+
+      if (candidate >= position || position - candidate > MAX_OFFSET || Read32(in + candidate) != sequence) {
+        // step faster through data that does not compress
+        position += 1 + ((position - anchor) >> 6);
+        continue;
+      }
+
+      size_t match = MIN_MATCH;
+      while (position + match < matchEndLimit && in[candidate + match] == in[position + match]) {
+        ++match;
+      }
+      if (!emit(position - anchor, position - candidate, match)) {
+        return 0;
+      }
+      position += match;
+      anchor = position;
+    }
+  }
+
+  if (!emit(size - anchor, 0, 0)) {
+    return 0;
+  }
+  return static_cast<size_t>(out - t_destination.data());
+}
+
+bool Dds::LzDecompress(const std::span<const std::byte> t_source, const std::span<std::byte> t_destination) {
+  const std::byte*       in     = t_source.data();
+  const std::byte* const inEnd  = in + t_source.size();
+  std::byte* const       out    = t_destination.data();
+  const size_t           outEnd = t_destination.size();
+  size_t                 cursor = 0;
+
+  while (in != inEnd) {
+    const uint8_t token    = static_cast<uint8_t>(*in++);
+    size_t        literals = token >> 4;
+    if (literals == 15 && !ReadLength(in, inEnd, literals)) {
+      return false;
+    }
+    if (literals > static_cast<size_t>(inEnd - in) || literals > outEnd - cursor) {
+      return false;
+    }
+    if (literals != 0) {
+      std::memcpy(out + cursor, in, literals);
+      in += literals;
+      cursor += literals;
+    }
+
+    if (in == inEnd) {
+      break; // the last sequence has no match
+    }
+    if (inEnd - in < 2) {
+      return false;
+    }
+    const size_t offset = static_cast<size_t>(in[0]) | static_cast<size_t>(in[1]) << 8;
+    in += 2;
+    size_t match = token & 15;
+    if (match == 15 && !ReadLength(in, inEnd, match)) {
+      return false;
+    }
+    match += MIN_MATCH;
+    if (offset == 0 || offset > cursor || match > outEnd - cursor) {
+      return false;
+    }
+
+    // overlapping matches repeat the last offset bytes, each copy doubles what is already in place
+    const std::byte* from   = out + cursor - offset;
+    size_t           copied = 0;
+    while (copied < match) {
+      const size_t piece = std::min(offset + copied, match - copied);
+      std::memcpy(out + cursor + copied, from, piece);
+      copied += piece;
+    }
+    cursor += match;
+  }
+  return cursor == outEnd;
+}
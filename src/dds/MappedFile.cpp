@@ -0,0 +1,111 @@
+#include "dds/MappedFile.h"
+
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+Dds::MappedFile::~MappedFile() {
+  Close();
+}
+
+Dds::MappedFile::MappedFile(MappedFile&& t_other) noexcept
+  : m_data(std::exchange(t_other.m_data, nullptr)),
+    m_size(std::exchange(t_other.m_size, 0)) {}
+
+Dds::MappedFile& Dds::MappedFile::operator=(MappedFile&& t_other) noexcept {
+  if (this != &t_other) {
+    Close();
+    m_data = std::exchange(t_other.m_data, nullptr);
+    m_size = std::exchange(t_other.m_size, 0);
+  }
+  return *this;
+}
+
+bool Dds::MappedFile::Open(const char* t_path) {
+  Close();
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(t_path,
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return false;
+  }
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+    CloseHandle(file);
+    return false;
+  }
+
+  // the view keeps the mapping object alive, so both handles can be closed straight away
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  CloseHandle(file);
+  if (!mapping) {
+    return false;
+  }
+
+  void* view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+  CloseHandle(mapping);
+  if (!view) {
+    return false;
+  }
+
+  m_data = static_cast<std::byte*>(view);
+  m_size = static_cast<size_t>(size.QuadPart);
+#else
+  const int fd = ::open(t_path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st{};
+  if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+    ::close(fd);
+    return false;
+  }
+
+  const auto size = static_cast<size_t>(st.st_size);
+  // MAP_PRIVATE gives copy-on-write pages, the mapping stays valid after the descriptor is closed
+  void* view = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED) {
+    return false;
+  }
+
+  ::madvise(view, size, MADV_WILLNEED);
+
+  m_data = static_cast<std::byte*>(view);
+  m_size = size;
+#endif
+
+  return true;
+}
+
+void Dds::MappedFile::Close() {
+  if (!m_data) {
+    return;
+  }
+
+#if defined(_WIN32)
+  UnmapViewOfFile(m_data);
+#else
+  ::munmap(m_data, m_size);
+#endif
+
+  m_data = nullptr;
+  m_size = 0;
+}
@@ -0,0 +1,351 @@
+#include "dds/MipGenerator.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <latch>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "dds/Decoder.h"
+#include "dds/EncodeKernels.h"
+#include "dds/Formats.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DDS_MIPS_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define DDS_MIPS_NEON
+#include <arm_neon.h>
+#endif
+
+// Levels are filtered as RGBA floats, one 16 byte vector per texel, so the box filter is four vector
+// loads, three adds and a multiply per output texel on SSE2 and NEON. Each level after the top one is
+// produced and encoded in the same pass over its block rows, its source level is the previous float
+// level, never the encoded one, so quantisation errors do not pile up down the chain.
+
+namespace
+{
+  using Dds::Format;
+
+  // how a format's texels reach the filter
+  enum class Pixels : uint8_t
+  {
+    Unsupported,
+    Blocks, // decoded to RGBA8 by the Decoder, encoded by an EncodeKernel
+    Rgba,
+    Bgra,
+    Bgrx // alpha reads 1 and is written as 255
+  };
+
+  Pixels PixelsOf(const Format t_format) {
+    switch (t_format) {
+      case Format::RGBA8:
+        return Pixels::Rgba;
+      case Format::BGRA8:
+        return Pixels::Bgra;
+      case Format::BGRX8:
+        return Pixels::Bgrx;
+      default:
+        break;
+    }
+    // every format with an encoder decodes to RGBA8
+    return Dds::SelectEncodeKernel(t_format) ? Pixels::Blocks : Pixels::Unsupported;
+  }
+
+  // sRGB transfer function both ways for 8-bit values. Encoding looks up linear values quantised to 14
+  // bits, fine enough that the steep start of the curve still rounds to the right byte
+  struct SRGB_TABLES
+  {
+    static constexpr size_t LINEAR_STEPS = 1 << 14;
+
+    std::array<float, 256>            toLinear{};
+    std::array<uint8_t, LINEAR_STEPS> fromLinear{};
+  };
+
+  const SRGB_TABLES& SrgbTables() {
+    static const SRGB_TABLES tables = []
+    {
+      SRGB_TABLES built;
+      for (size_t value = 0; value < 256; ++value) {
+        const double srgb     = static_cast<double>(value) / 255.0;
+        built.toLinear[value] = static_cast<float>(srgb <= 0.04045 ? srgb / 12.92 : std::pow((srgb + 0.055) / 1.055, 2.4));
+      }
+      for (size_t step = 0; step < SRGB_TABLES::LINEAR_STEPS; ++step) {
+        const double linear    = static_cast<double>(step) / (SRGB_TABLES::LINEAR_STEPS - 1);
+        const double srgb      = linear <= 0.0031308 ? linear * 12.92 : 1.055 * std::pow(linear, 1.0 / 2.4) - 0.055;
+        built.fromLinear[step] = static_cast<uint8_t>(srgb * 255.0 + 0.5);
+      }
+      return built;
+    }();
+    return tables;
+  }
+
+  // t_count texels in t_pixels' memory order to linear RGBA floats
+  void ToLinear(const uint8_t* t_texels, const size_t t_count, const Pixels t_pixels, const bool t_srgb, float* t_out) {
+    const SRGB_TABLES& tables = SrgbTables();
+    const bool         bgr    = t_pixels == Pixels::Bgra || t_pixels == Pixels::Bgrx;
+
+    for (size_t texel = 0; texel < t_count; ++texel) {
+      const uint8_t* in     = t_texels + texel * 4;
+      float*         out    = t_out + texel * 4;
+      const uint8_t  rgb[3] = {in[bgr ? 2 : 0], in[1], in[bgr ? 0 : 2]};
+      for (size_t channel = 0; channel < 3; ++channel) {
+        out[channel] = t_srgb ? tables.toLinear[rgb[channel]] : rgb[channel] * (1.0f / 255.0f);
+      }
+      out[3] = t_pixels == Pixels::Bgrx ? 1.0f : in[3] * (1.0f / 255.0f);
+    }
+  }
+
+  uint8_t ToUnorm(const float t_value) {
+    return static_cast<uint8_t>(std::clamp(t_value, 0.0f, 1.0f) * 255.0f + 0.5f);
+  }
+
+  uint8_t ToSrgb(const float t_value) {
+    const float step = std::clamp(t_value, 0.0f, 1.0f) * (SRGB_TABLES::LINEAR_STEPS - 1) + 0.5f;
+    return SrgbTables().fromLinear[static_cast<size_t>(step)];
+  }
+
+  // linear RGBA floats back to t_count texels in t_pixels' memory order, Pixels::Blocks writes RGBA8
+  void FromLinear(const float* t_texels, const size_t t_count, const Pixels t_pixels, const bool t_srgb, uint8_t* t_out) {
+    const bool bgr = t_pixels == Pixels::Bgra || t_pixels == Pixels::Bgrx;
+
+    for (size_t texel = 0; texel < t_count; ++texel) {
+      const float* in = t_texels + texel * 4;
+      uint8_t*     out = t_out + texel * 4;
+      for (size_t channel = 0; channel < 3; ++channel) {
+        out[bgr ? 2 - channel : channel] = t_srgb ? ToSrgb(in[channel]) : ToUnorm(in[channel]);
+      }
+      out[3] = t_pixels == Pixels::Bgrx ? 255 : ToUnorm(in[3]);
+    }
+  }
+
+  // one level of one layer as linear RGBA floats
+  struct IMAGE
+  {
+    uint32_t           width  = 0;
+    uint32_t           height = 0;
+    std::vector<float> texels;
+
+    [[nodiscard]] const float* Row(const size_t t_y) const {
+      return texels.data() + t_y * width * 4;
+    }
+
+    [[nodiscard]] float* Row(const size_t t_y) {
+      return texels.data() + t_y * width * 4;
+    }
+  };
+
+  // rows [t_begin, t_end) of t_destination, each texel the average of a 2x2 texel square of t_source.
+  // An odd extent drops the source's last row or column, an extent of 1 reads its only one twice
+  void Downsample(const IMAGE& t_source, IMAGE& t_destination, const size_t t_begin, const size_t t_end) {
+    for (size_t y = t_begin; y < t_end; ++y) {
+      const float* top    = t_source.Row(std::min<size_t>(2 * y, t_source.height - 1));
+      const float* bottom = t_source.Row(std::min<size_t>(2 * y + 1, t_source.height - 1));
+      float*       out    = t_destination.Row(y);
+
+      for (size_t x = 0; x < t_destination.width; ++x) {
+        const size_t left  = std::min<size_t>(2 * x, t_source.width - 1) * 4;
+        const size_t right = std::min<size_t>(2 * x + 1, t_source.width - 1) * 4;
+#if defined(DDS_MIPS_SSE2)
+        const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(top + left), _mm_loadu_ps(top + right)),
+                                      _mm_add_ps(_mm_loadu_ps(bottom + left), _mm_loadu_ps(bottom + right)));
+        _mm_storeu_ps(out + x * 4, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#elif defined(DDS_MIPS_NEON)
+        const float32x4_t sum = vaddq_f32(vaddq_f32(vld1q_f32(top + left), vld1q_f32(top + right)),
+                                          vaddq_f32(vld1q_f32(bottom + left), vld1q_f32(bottom + right)));
+        vst1q_f32(out + x * 4, vmulq_n_f32(sum, 0.25f));
+#else
+        for (size_t channel = 0; channel < 4; ++channel) {
+          out[x * 4 + channel] =
+            (top[left + channel] + top[right + channel] + bottom[left + channel] + bottom[right + channel]) * 0.25f;
+        }
+#endif
+      }
+    }
+  }
+
+  // block rows [t_begin, t_end) of t_image encoded into t_blocks (the whole layer of the level). Blocks
+  // hanging over the edge of small levels repeat the last row and column
+  void EncodeBlockRows(const IMAGE&           t_image,
+                       const Dds::EncodeKernel t_encode,
+                       const size_t           t_blockSize,
+                       const bool             t_srgb,
+                       const size_t           t_begin,
+                       const size_t           t_end,
+                       std::byte*             t_blocks) {
+    const size_t           blocksWide = (t_image.width + 3) / 4;
+    std::vector<std::byte> tiles(blocksWide * 64);
+    const auto             tileBytes = reinterpret_cast<uint8_t*>(tiles.data());
+
+    for (size_t blockRow = t_begin; blockRow < t_end; ++blockRow) {
+      for (size_t row = 0; row < 4; ++row) {
+        const float* in = t_image.Row(std::min<size_t>(blockRow * 4 + row, t_image.height - 1));
+        for (size_t x = 0; x < blocksWide * 4; ++x) {
+          const size_t column = std::min<size_t>(x, t_image.width - 1);
+          FromLinear(in + column * 4, 1, Pixels::Blocks, t_srgb, tileBytes + (x / 4) * 64 + (row * 4 + x % 4) * 4);
+        }
+      }
+      t_encode(tiles.data(), blocksWide, t_blocks + blockRow * blocksWide * t_blockSize);
+    }
+  }
+}
+
+Dds::MipGenerator::MipGenerator(const size_t t_workerCount)
+  : m_pool(t_workerCount) {}
+
+Dds::Result<LoadDds::DDS_FILE> Dds::MipGenerator::Generate(const LoadDds::DDS_FILE& t_ddsFile, const MIP_OPTIONS& t_options) {
+  LoadDds::DDS_FILE result;
+  STATUS            status;
+
+  try {
+    status = GenerateImpl(result, t_ddsFile, t_options);
+  }
+  catch (const std::bad_alloc&) {
+    status = {Error::OutOfMemory};
+  }
+
+  if (!status.Ok()) {
+    Log(status, nullptr);
+    return status;
+  }
+  return result;
+}
+
+uint32_t Dds::MipGenerator::FullMipCount(const uint32_t t_width, const uint32_t t_height) {
+  return std::max<uint32_t>(1, std::bit_width(std::max(t_width, t_height)));
+}
+
+Dds::STATUS Dds::MipGenerator::GenerateImpl(LoadDds::DDS_FILE&       t_result,
+                                            const LoadDds::DDS_FILE& t_ddsFile,
+                                            const MIP_OPTIONS&       t_options) {
+  if (t_ddsFile.mipMaps.empty() || t_ddsFile.data.size() < t_ddsFile.mipMaps[0].offset + t_ddsFile.mipMaps[0].size) {
+    return {Error::InvalidMipRange, t_ddsFile.firstMip};
+  }
+
+  const LoadDds::MIP_LEVEL top    = t_ddsFile.mipMaps[0];
+  const Pixels             pixels = PixelsOf(t_ddsFile.format);
+  if (pixels == Pixels::Unsupported || top.depth > 1) {
+    return {Error::NoEncoder, static_cast<uint32_t>(t_ddsFile.format)};
+  }
+
+  const FORMAT_INFO& info   = GetFormatInfo(t_ddsFile.format);
+  const bool         srgb   = info.glSrgbInternalFormat != 0 && t_ddsFile.glFormat == info.glSrgbInternalFormat;
+  const size_t       layers = t_ddsFile.LayerCount();
+  const uint32_t     count  = std::clamp(t_options.mipCount, 1u, FullMipCount(top.width, top.height));
+
+  // same texture and headers, new chain
+  static_cast<LoadDds::DDS_INFO&>(t_result) = t_ddsFile;
+  t_result.mipMaps.clear();
+  t_result.fileLayerStride = 0;
+  size_t offset            = 0;
+  for (uint32_t mip = 0; mip < count; ++mip) {
+    const uint32_t width     = std::max(1u, top.width >> mip);
+    const uint32_t height    = std::max(1u, top.height >> mip);
+    const size_t   layerSize = info.SurfaceSize(width, height);
+    t_result.mipMaps.push_back({width, height, 1, offset, layerSize * layers, layerSize});
+    t_result.fileLayerStride += layerSize;
+    offset += layerSize * layers;
+  }
+  t_result.totalSizeBytes       = offset;
+  t_result.firstMip             = 0;
+  t_result.header.dwWidth       = top.width;
+  t_result.header.dwHeight      = top.height;
+  t_result.header.dwMipMapCount = count;
+  t_result.buffer               = AlignedBuffer(offset, LoadDds::PAYLOAD_ALIGNMENT);
+  t_result.data                 = {t_result.buffer.Data(), offset};
+
+  // the top level is not touched, whatever encoder produced it did a better job than this one would
+  std::memcpy(t_result.data.data(), t_ddsFile.MipData(0).data(), top.size);
+  if (count == 1) {
+    return {};
+  }
+
+  const EncodeKernel encode = pixels == Pixels::Blocks ? SelectEncodeKernel(t_ddsFile.format) : nullptr;
+  const size_t       rowsPerBlock = info.blockHeight;
+
+  IMAGE current{top.width, top.height, std::vector<float>(static_cast<size_t>(top.width) * top.height * 4)};
+  IMAGE next;
+  next.texels.resize(static_cast<size_t>(std::max(1u, top.width >> 1)) * std::max(1u, top.height >> 1) * 4);
+
+  for (size_t layer = 0; layer < layers; ++layer) {
+    current.width  = top.width;
+    current.height = top.height;
+
+    const std::byte* source = t_ddsFile.LayerData(0, layer).data();
+    if (encode) {
+      const size_t blocksWide = (top.width + 3) / 4;
+      const size_t blocksHigh = (top.height + 3) / 4;
+      ForEachBand(blocksHigh, static_cast<size_t>(top.width) * top.height, [&](const size_t t_begin, const size_t t_end)
+      {
+        const size_t           rows = std::min<size_t>(top.height - t_begin * 4, (t_end - t_begin) * 4);
+        std::vector<std::byte> decoded(rows * top.width * 4);
+        Decoder::DecodeSurface(t_ddsFile.format, source + t_begin * blocksWide * t_ddsFile.blockSize, top.width,
+                               static_cast<uint32_t>(rows), decoded.data(), top.width * 4);
+        ToLinear(reinterpret_cast<const uint8_t*>(decoded.data()), rows * top.width, pixels, srgb, current.Row(t_begin * 4));
+      });
+    }
+    else {
+      ForEachBand(top.height, static_cast<size_t>(top.width) * top.height, [&](const size_t t_begin, const size_t t_end)
+      {
+        ToLinear(reinterpret_cast<const uint8_t*>(source) + t_begin * top.width * 4, (t_end - t_begin) * top.width, pixels, srgb,
+                 current.Row(t_begin));
+      });
+    }
+
+    for (uint32_t mip = 1; mip < count; ++mip) {
+      const LoadDds::MIP_LEVEL& level       = t_result.mipMaps[mip];
+      std::byte*                destination = t_result.LayerData(mip, layer).data();
+      next.width                            = level.width;
+      next.height                           = level.height;
+
+      // filter a band's rows, then encode them while they are still in cache
+      const size_t bandRows = (level.height + rowsPerBlock - 1) / rowsPerBlock;
+      ForEachBand(bandRows, static_cast<size_t>(level.width) * level.height, [&](const size_t t_begin, const size_t t_end)
+      {
+        Downsample(current, next, t_begin * rowsPerBlock, std::min<size_t>(level.height, t_end * rowsPerBlock));
+        if (encode) {
+          EncodeBlockRows(next, encode, t_ddsFile.blockSize, srgb, t_begin, t_end, destination);
+        }
+        else {
+          FromLinear(next.Row(t_begin), (t_end - t_begin) * level.width, pixels, srgb,
+                     reinterpret_cast<uint8_t*>(destination) + t_begin * level.width * 4);
+        }
+      });
+      std::swap(current, next);
+    }
+    // the top level's buffer is the larger one and has to be current for the next layer
+    if (count % 2 == 0) {
+      std::swap(current, next);
+    }
+  }
+  return {};
+}
+
+void Dds::MipGenerator::ForEachBand(const size_t                                                t_rows,
+                                    const size_t                                                t_pixels,
+                                    const std::function<void(size_t t_begin, size_t t_end)>& t_work) {
+  if (t_pixels < PARALLEL_PIXELS || m_pool.ThreadCount() < 2 || t_rows < 2) {
+    t_work(0, t_rows);
+    return;
+  }
+
+  // same banding as the Decoder, the calling thread takes the last band instead of idling on the latch
+  const size_t bandCount = std::min(t_rows, m_pool.ThreadCount() * 4);
+  const size_t bandRows  = (t_rows + bandCount - 1) / bandCount;
+  const size_t bands     = (t_rows + bandRows - 1) / bandRows;
+
+  std::latch done(static_cast<std::ptrdiff_t>(bands - 1));
+  for (size_t band = 0; band + 1 < bands; ++band) {
+    m_pool.Submit([&, band]
+    {
+      t_work(band * bandRows, (band + 1) * bandRows);
+      done.count_down();
+    });
+  }
+  t_work((bands - 1) * bandRows, t_rows);
+  done.wait();
+}
@@ -0,0 +1,336 @@
+#include "dds/Pack.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <filesystem>
+#include <system_error>
+
+#include "dds/FileWriter.h"
+#include "dds/Hash.h"
+
+namespace
+{
+  constexpr uint32_t PACK_MAGIC   = 0x50534444; // "DDSP"
+  constexpr uint32_t PACK_VERSION = 1;
+  // one bucket per entry up to 16M entries, more only makes the buckets fuller
+  constexpr uint32_t MAX_FAN_OUT_BITS = 24;
+
+#pragma pack(push, 1)
+  struct PACK_HEADER
+  {
+    uint32_t magic        = PACK_MAGIC;
+    uint32_t version      = PACK_VERSION;
+    uint32_t entryCount   = 0;
+    uint32_t fanOutBits   = 0;
+    uint64_t indexOffset  = 0;
+    uint64_t fanOutOffset = 0;
+    uint64_t namesOffset  = 0;
+    uint64_t namesSize    = 0;
+    uint64_t packSize     = 0; // catches truncated copies
+    uint64_t reserved     = 0;
+  };
+
+  struct PACK_ENTRY
+  {
+    uint64_t nameHash   = 0;
+    uint64_t fileOffset = 0; // of the "DDS " magic
+    uint64_t fileSize   = 0;
+    uint32_t nameOffset = 0; // into the names section
+    uint32_t nameSize   = 0;
+  };
+#pragma pack(pop)
+
+  static_assert(sizeof(PACK_HEADER) == 64 && sizeof(PACK_ENTRY) == 32);
+
+  uint64_t AlignUp(const uint64_t t_value, const uint64_t t_alignment) {
+    return (t_value + t_alignment - 1) / t_alignment * t_alignment;
+  }
+
+  uint64_t NameHash(const std::string_view t_name) {
+    return Dds::Hash64({reinterpret_cast<const std::byte*>(t_name.data()), t_name.size()});
+  }
+
+  uint32_t Bucket(const uint64_t t_hash, const uint32_t t_fanOutBits) {
+    return t_fanOutBits == 0 ? 0 : static_cast<uint32_t>(t_hash >> (64 - t_fanOutBits));
+  }
+
+  template <typename T>
+  T Read(const std::byte* t_data, const size_t t_index = 0) {
+    T value;
+    std::memcpy(&value, t_data + t_index * sizeof(T), sizeof(T));
+    return value;
+  }
+
+  Dds::STATUS Fail(const Dds::STATUS t_status, const char* t_source) {
+    Dds::Log(t_status, t_source);
+    return t_status;
+  }
+}
+
+Dds::STATUS Dds::PackBuilder::Add(std::string t_name, const char* t_path) {
+  // a probe checks the headers and that the file holds the whole mip chain
+  const Result<LoadDds::DDS_INFO> info = LoadDds::ProbeDds(t_path);
+  if (!info) {
+    return info.Status();
+  }
+
+  std::error_code error;
+  const uint64_t  size = std::filesystem::file_size(t_path, error);
+  if (error) {
+    return Fail({Error::OpenFailed}, t_path);
+  }
+  if (t_name.size() > UINT32_MAX) {
+    return Fail({Error::InvalidHeader}, t_path);
+  }
+
+  const uint64_t hash = NameHash(t_name);
+  m_sources.push_back({std::move(t_name), t_path, hash, size, info->payloadOffset});
+  return {};
+}
+
+Dds::STATUS Dds::PackBuilder::Write(const char* t_path) const {
+  std::vector<const SOURCE*> sources(m_sources.size());
+  std::transform(m_sources.begin(), m_sources.end(), sources.begin(), [](const SOURCE& t_source)
+  {
+    return &t_source;
+  });
+  std::sort(sources.begin(), sources.end(), [](const SOURCE* t_a, const SOURCE* t_b)
+  {
+    return t_a->hash != t_b->hash ? t_a->hash < t_b->hash : t_a->name < t_b->name;
+  });
+
+  for (size_t i = 1; i < sources.size(); ++i) {
+    if (sources[i]->hash == sources[i - 1]->hash && sources[i]->name == sources[i - 1]->name) {
+      return Fail({Error::DuplicateName, static_cast<uint32_t>(i)}, sources[i]->path.c_str());
+    }
+  }
+
+  // the whole layout is known up front, so the pack is written front to back in one pass
+  PACK_HEADER header;
+  header.entryCount = static_cast<uint32_t>(sources.size());
+  header.fanOutBits = std::min<uint32_t>(std::bit_width(std::bit_ceil(std::max<size_t>(sources.size(), 1)) - 1), MAX_FAN_OUT_BITS);
+
+  std::vector<PACK_ENTRY> entries(sources.size());
+  std::string             names;
+  uint64_t                cursor = sizeof(PACK_HEADER);
+
+  for (size_t i = 0; i < sources.size(); ++i) {
+    const SOURCE& source = *sources[i];
+    PACK_ENTRY&   entry  = entries[i];
+    entry.nameHash       = source.hash;
+    entry.fileOffset     = AlignUp(cursor + source.payloadOffset, LoadDds::PAYLOAD_ALIGNMENT) - source.payloadOffset;
+    entry.fileSize       = source.size;
+    entry.nameOffset     = static_cast<uint32_t>(names.size());
+    entry.nameSize       = static_cast<uint32_t>(source.name.size());
+    names += source.name;
+    cursor = entry.fileOffset + entry.fileSize;
+  }
+
+  std::vector<uint32_t> fanOut((size_t{1} << header.fanOutBits) + 1, 0);
+  for (const PACK_ENTRY& entry : entries) {
+    ++fanOut[Bucket(entry.nameHash, header.fanOutBits) + 1];
+  }
+  for (size_t bucket = 1; bucket < fanOut.size(); ++bucket) {
+    fanOut[bucket] += fanOut[bucket - 1];
+  }
+
+  header.indexOffset  = AlignUp(cursor, alignof(uint64_t));
+  header.fanOutOffset = header.indexOffset + entries.size() * sizeof(PACK_ENTRY);
+  header.namesOffset  = header.fanOutOffset + fanOut.size() * sizeof(uint32_t);
+  header.namesSize    = names.size();
+  header.packSize     = header.namesOffset + header.namesSize;
+
+  if (names.size() > UINT32_MAX) {
+    return Fail({Error::InvalidHeader}, t_path);
+  }
+
+  FileWriter out;
+  if (!out.Open(t_path)) {
+    return Fail({Error::WriteFailed}, t_path);
+  }
+
+  static constexpr std::byte padding[LoadDds::PAYLOAD_ALIGNMENT + sizeof(uint64_t)] = {};
+
+  const std::span<const std::byte> headerPiece[] = {std::as_bytes(std::span(&header, 1))};
+
+  STATUS   status;
+  uint64_t written = sizeof(PACK_HEADER);
+  if (!out.Write(headerPiece)) {
+    status = Fail({Error::WriteFailed}, t_path);
+  }
+
+  // one source mapped at a time, its padding and bytes go out together
+  for (size_t i = 0; i < sources.size() && status.Ok(); ++i) {
+    MappedFile source;
+    if (!source.Open(sources[i]->path.c_str())) {
+      status = Fail({Error::OpenFailed}, sources[i]->path.c_str());
+      break;
+    }
+    if (source.Size() != entries[i].fileSize) {
+      status = Fail({Error::LayoutMismatch}, sources[i]->path.c_str());
+      break;
+    }
+
+    const std::span<const std::byte> pieces[] = {std::span(padding, entries[i].fileOffset - written),
+                                                 std::span(source.Data(), source.Size())};
+    if (!out.Write(pieces)) {
+      status = Fail({Error::WriteFailed}, t_path);
+    }
+    written = entries[i].fileOffset + entries[i].fileSize;
+  }
+
+  if (status.Ok()) {
+    const std::span<const std::byte> pieces[] = {std::span(padding, header.indexOffset - written),
+                                                 std::as_bytes(std::span(entries)),
+                                                 std::as_bytes(std::span(fanOut)),
+                                                 std::as_bytes(std::span(names))};
+    if (!out.Write(pieces)) {
+      status = Fail({Error::WriteFailed}, t_path);
+    }
+  }
+
+  // a failed pack leaves an existing t_path as it was, the writer drops its temporary file
+  if (status.Ok() && !out.Commit()) {
+    status = Fail({Error::WriteFailed}, t_path);
+  }
+  return status;
+}
+
+Dds::STATUS Dds::PackReader::Open(const char* t_path) {
+  Close();
+  m_path = t_path;
+
+  if (!m_mapping.Open(t_path)) {
+    return Fail({Error::OpenFailed}, t_path);
+  }
+
+  const std::byte* pack = m_mapping.Data();
+  const size_t     size = m_mapping.Size();
+
+  PACK_HEADER header;
+  if (size < sizeof(header)) {
+    Close();
+    return Fail({Error::TruncatedHeader}, t_path);
+  }
+  std::memcpy(&header, pack, sizeof(header));
+
+  STATUS status;
+  if (header.magic != PACK_MAGIC || header.version != PACK_VERSION) {
+    status = {Error::BadMagic};
+  }
+  else if (header.packSize != size) {
+    status = {Error::TruncatedHeader};
+  }
+  else if (header.fanOutBits > MAX_FAN_OUT_BITS || header.indexOffset > size ||
+           header.fanOutOffset != header.indexOffset + uint64_t{header.entryCount} * sizeof(PACK_ENTRY) ||
+           header.namesOffset != header.fanOutOffset + ((uint64_t{1} << header.fanOutBits) + 1) * sizeof(uint32_t) ||
+           header.namesOffset + header.namesSize != size) {
+    status = {Error::InvalidHeader};
+  }
+  if (!status.Ok()) {
+    Close();
+    return Fail(status, t_path);
+  }
+
+  m_entries    = pack + header.indexOffset;
+  m_fanOut     = pack + header.fanOutOffset;
+  m_names      = pack + header.namesOffset;
+  m_entryCount = header.entryCount;
+  m_fanOutBits = header.fanOutBits;
+
+  // every entry is checked once here, so lookups and loads can trust the index
+  for (uint32_t id = 0; id < m_entryCount && status.Ok(); ++id) {
+    const PACK_ENTRY entry = Read<PACK_ENTRY>(m_entries, id);
+    if (entry.fileOffset < sizeof(PACK_HEADER) || entry.fileOffset > header.indexOffset ||
+        entry.fileSize > header.indexOffset - entry.fileOffset || entry.nameOffset > header.namesSize ||
+        entry.nameSize > header.namesSize - entry.nameOffset ||
+        (id > 0 && Read<PACK_ENTRY>(m_entries, id - 1).nameHash > entry.nameHash)) {
+      status = {Error::InvalidHeader, id};
+    }
+  }
+  for (uint32_t bucket = 0; bucket < (1u << m_fanOutBits) && status.Ok(); ++bucket) {
+    const uint32_t begin = Read<uint32_t>(m_fanOut, bucket);
+    const uint32_t end   = Read<uint32_t>(m_fanOut, bucket + 1);
+    if (begin > end || end > m_entryCount) {
+      status = {Error::InvalidHeader};
+    }
+  }
+  if (status.Ok() && Read<uint32_t>(m_fanOut, size_t{1} << m_fanOutBits) != m_entryCount) {
+    status = {Error::InvalidHeader};
+  }
+
+  if (!status.Ok()) {
+    Close();
+    return Fail(status, t_path);
+  }
+  return {};
+}
+
+void Dds::PackReader::Close() {
+  m_mapping.Close();
+  m_entries    = nullptr;
+  m_fanOut     = nullptr;
+  m_names      = nullptr;
+  m_entryCount = 0;
+  m_fanOutBits = 0;
+}
+
+uint32_t Dds::PackReader::Find(const std::string_view t_name) const {
+  if (m_entryCount == 0) {
+    return INVALID_ID;
+  }
+
+  const uint64_t hash   = NameHash(t_name);
+  const uint32_t bucket = Bucket(hash, m_fanOutBits);
+  const uint32_t end    = Read<uint32_t>(m_fanOut, bucket + 1);
+
+  // a bucket averages at most one entry, scanning it beats a binary search
+  for (uint32_t id = Read<uint32_t>(m_fanOut, bucket); id < end; ++id) {
+    const PACK_ENTRY entry = Read<PACK_ENTRY>(m_entries, id);
+    if (entry.nameHash > hash) {
+      break;
+    }
+    if (entry.nameHash == hash && Name(id) == t_name) {
+      return id;
+    }
+  }
+  return INVALID_ID;
+}
+
+std::string_view Dds::PackReader::Name(const uint32_t t_id) const {
+  if (t_id >= m_entryCount) {
+    return {};
+  }
+  const PACK_ENTRY entry = Read<PACK_ENTRY>(m_entries, t_id);
+  return {reinterpret_cast<const char*>(m_names) + entry.nameOffset, entry.nameSize};
+}
+
+std::span<const std::byte> Dds::PackReader::FileData(const uint32_t t_id) const {
+  if (t_id >= m_entryCount) {
+    return {};
+  }
+  const PACK_ENTRY entry = Read<PACK_ENTRY>(m_entries, t_id);
+  return {m_mapping.Data() + entry.fileOffset, entry.fileSize};
+}
+
+Dds::Result<LoadDds::DDS_FILE> Dds::PackReader::Load(const uint32_t t_id, const LoadOptions& t_options) const {
+  const std::span<const std::byte> file = FileData(t_id);
+  if (file.empty()) {
+    return Fail({Error::NotFound, t_id}, m_path.c_str());
+  }
+
+  LoadOptions options = t_options;
+  if (options.storage == Storage::Mapped) {
+    options.storage = Storage::Borrowed; // the pack already is the mapping
+  }
+  return LoadDds::TextureLoadDds(file, options);
+}
+
+Dds::Result<LoadDds::DDS_FILE> Dds::PackReader::Load(const std::string_view t_name, const LoadOptions& t_options) const {
+  const uint32_t id = Find(t_name);
+  if (id == INVALID_ID) {
+    return Fail({Error::NotFound}, m_path.c_str());
+  }
+  return Load(id, t_options);
+}
@@ -0,0 +1,90 @@
+#include "dds/Result.h"
+
+#include <atomic>
+#include <cstdio>
+
+namespace
+{
+  std::atomic<Dds::LogFn> g_logHook = nullptr;
+}
+
+const char* Dds::ErrorMessage(const Error t_error) {
+  switch (t_error) {
+    case Error::None:
+      return "No error";
+    case Error::OpenFailed:
+      return "Failed to open file";
+    case Error::EmptyFile:
+      return "Filesize 0";
+    case Error::ReadFailed:
+      return "Failed to read file";
+    case Error::ShortRead:
+      return "Source ended before the mip chain";
+    case Error::BadMagic:
+      return "Not a .dds file";
+    case Error::TruncatedHeader:
+      return "Truncated header";
+    case Error::InvalidHeader:
+      return "Invalid header";
+    case Error::InvalidMipCount:
+      return "Invalid mip map count";
+    case Error::InvalidArraySize:
+      return "Invalid array size";
+    case Error::InvalidDimension:
+      return "Volume textures cannot be arrays or cubemaps";
+    case Error::UnsupportedFormat:
+      return "Unsupported format";
+    case Error::TruncatedMip:
+      return "Data size smaller than expected (corrupt or mismatched header)";
+    case Error::TrailingData:
+      return "Trailing data after the mip chain";
+    case Error::InvalidMipRange:
+      return "Requested mip range is outside the texture";
+    case Error::UnsupportedStorage:
+      return "Mapped storage needs a file path";
+    case Error::DestinationTooSmall:
+      return "Destination too small";
+    case Error::LayoutMismatch:
+      return "Streamed levels do not match the loaded tail";
+    case Error::OutOfMemory:
+      return "Out of memory";
+    case Error::NoDecoder:
+      return "No decoder for this format";
+    case Error::WriteFailed:
+      return "Failed to write the output";
+    case Error::NotFound:
+      return "No such entry in the pack";
+    case Error::DuplicateName:
+      return "Entry name already in the pack";
+    case Error::UnsupportedCodec:
+      return "Compression codec not built in";
+    case Error::CorruptChunk:
+      return "Corrupt compressed chunk";
+    case Error::InvalidRegion:
+      return "Region outside the level or not block aligned";
+    case Error::NoEncoder:
+      return "No encoder for the format or layout";
+    case Error::Count:
+      break;
+  }
+  return "Unknown error";
+}
+
+Dds::LogFn Dds::SetLogHook(const LogFn t_hook) {
+  return g_logHook.exchange(t_hook);
+}
+
+void Dds::Log(const STATUS& t_status, const char* t_source) {
+  if (const LogFn hook = g_logHook.load(std::memory_order_relaxed)) {
+    hook(t_status, t_source);
+  }
+}
+
+void Dds::LogToStderr(const STATUS& t_status, const char* t_source) {
+  std::fprintf(stderr,
+               "[DDS] - Error: %s (%u)%s%s\n",
+               ErrorMessage(t_status.error),
+               t_status.detail,
+               t_source ? ": " : "",
+               t_source ? t_source : "");
+}
@@ -0,0 +1,159 @@
+#include "dds/Stats.h"
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+
+#include "dds/Formats.h"
+
+namespace
+{
+  constexpr const char* STAGE_NAMES[] = {"open", "parse", "allocate", "read", "copy", "flip"};
+  static_assert(std::size(STAGE_NAMES) == static_cast<size_t>(Dds::Stage::Count));
+
+  std::mutex                g_mutex;
+  Dds::LOAD_STATS           g_totals;
+  std::atomic<Dds::StatsFn> g_hook = nullptr;
+
+#if defined(DDS_ENABLE_STATS)
+  // the load running on this thread, nullptr outside of one
+  thread_local Dds::LOAD_STATS* g_current = nullptr;
+#endif
+
+  void AppendField(std::string& t_json, const char* t_name, const uint64_t t_value, const bool t_last = false) {
+    t_json += '"';
+    t_json += t_name;
+    t_json += "\":";
+    t_json += std::to_string(t_value);
+    if (!t_last) {
+      t_json += ',';
+    }
+  }
+}
+
+Dds::LOAD_STATS& Dds::LOAD_STATS::operator+=(const LOAD_STATS& t_other) {
+  loads += t_other.loads;
+  failures += t_other.failures;
+  bytesRead += t_other.bytesRead;
+  bytesCopied += t_other.bytesCopied;
+  allocations += t_other.allocations;
+  allocatedBytes += t_other.allocatedBytes;
+  for (size_t stage = 0; stage < stages.size(); ++stage) {
+    stages[stage].calls += t_other.stages[stage].calls;
+    stages[stage].nanoseconds += t_other.stages[stage].nanoseconds;
+  }
+  for (size_t format = 0; format < formats.size(); ++format) {
+    formats[format].loads += t_other.formats[format].loads;
+    formats[format].bytes += t_other.formats[format].bytes;
+  }
+  return *this;
+}
+
+Dds::StatsFn Dds::SetStatsHook(const StatsFn t_hook) {
+  return g_hook.exchange(t_hook);
+}
+
+Dds::LOAD_STATS Dds::GetLoadStats() {
+  std::lock_guard lock(g_mutex);
+  return g_totals;
+}
+
+void Dds::ResetLoadStats() {
+  std::lock_guard lock(g_mutex);
+  g_totals = {};
+}
+
+std::string Dds::LoadStatsToJson(const LOAD_STATS& t_stats) {
+  std::string json = "{";
+  AppendField(json, "loads", t_stats.loads);
+  AppendField(json, "failures", t_stats.failures);
+  AppendField(json, "bytesRead", t_stats.bytesRead);
+  AppendField(json, "bytesCopied", t_stats.bytesCopied);
+  AppendField(json, "allocations", t_stats.allocations);
+  AppendField(json, "allocatedBytes", t_stats.allocatedBytes);
+
+  json += "\"stages\":{";
+  for (size_t stage = 0; stage < t_stats.stages.size(); ++stage) {
+    json += stage == 0 ? "\"" : ",\"";
+    json += STAGE_NAMES[stage];
+    json += "\":{";
+    AppendField(json, "calls", t_stats.stages[stage].calls);
+    AppendField(json, "ns", t_stats.stages[stage].nanoseconds, true);
+    json += '}';
+  }
+
+  // format names are plain identifiers, nothing to escape
+  json += "},\"formats\":{";
+  bool first = true;
+  for (size_t format = 0; format < t_stats.formats.size(); ++format) {
+    if (t_stats.formats[format].loads == 0) {
+      continue;
+    }
+    json += first ? "\"" : ",\"";
+    json += GetFormatInfo(static_cast<Format>(format)).name;
+    json += "\":{";
+    AppendField(json, "loads", t_stats.formats[format].loads);
+    AppendField(json, "bytes", t_stats.formats[format].bytes, true);
+    json += '}';
+    first = false;
+  }
+  json += "}}";
+
+  return json;
+}
+
+#if defined(DDS_ENABLE_STATS)
+Dds::LoadScope::LoadScope(const char* t_source)
+  : m_source(t_source),
+    m_outer(std::exchange(g_current, &m_stats)) {}
+
+Dds::LoadScope::~LoadScope() {
+  g_current = m_outer;
+}
+
+void Dds::LoadScope::Finish(const STATUS& t_status, const Format t_format, const size_t t_bytes) {
+  m_stats.loads    = 1;
+  m_stats.failures = t_status.Ok() ? 0 : 1;
+  if (t_status.Ok() && t_format < Format::Count) {
+    m_stats.formats[static_cast<size_t>(t_format)] = {1, t_bytes};
+  }
+
+  {
+    std::lock_guard lock(g_mutex);
+    g_totals += m_stats;
+  }
+
+  if (const StatsFn hook = g_hook.load(std::memory_order_relaxed)) {
+    hook(m_stats, m_source);
+  }
+}
+
+Dds::StageTimer::~StageTimer() {
+  if (g_current) {
+    const auto elapsed = std::chrono::steady_clock::now() - m_start;
+
+    STAGE_STATS& stage = g_current->stages[static_cast<size_t>(m_stage)];
+    stage.calls += 1;
+    stage.nanoseconds += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+}
+
+void Dds::CountBytesRead(const size_t t_bytes) {
+  if (g_current) {
+    g_current->bytesRead += t_bytes;
+  }
+}
+
+void Dds::CountBytesCopied(const size_t t_bytes) {
+  if (g_current) {
+    g_current->bytesCopied += t_bytes;
+  }
+}
+
+void Dds::CountAllocation(const size_t t_bytes) {
+  if (g_current) {
+    g_current->allocations += 1;
+    g_current->allocatedBytes += t_bytes;
+  }
+}
+#endif
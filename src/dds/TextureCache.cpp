@@ -0,0 +1,382 @@
+#include "dds/TextureCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+#include "dds/FileWriter.h"
+#include "dds/Hash.h"
+#include "dds/MappedFile.h"
+
+namespace
+{
+  constexpr uint32_t CACHE_MAGIC    = 0x43534444; // "DDSC"
+  constexpr uint32_t CACHE_VERSION  = 1;
+  constexpr uint32_t STAMPS_MAGIC   = 0x53534444; // "DDSS"
+  constexpr uint32_t STAMPS_VERSION = 1;
+  constexpr char     STAMPS_NAME[]  = "stamps.idx";
+
+#pragma pack(push, 1)
+  // DDS_INFO without the mip vector, followed by mipCount CACHE_MIPs and, at dataOffset, the payload
+  struct CACHE_HEADER
+  {
+    uint32_t                  magic      = CACHE_MAGIC;
+    uint32_t                  version    = CACHE_VERSION;
+    uint64_t                  sourceHash = 0;
+    uint64_t                  options    = 0;
+    LoadDds::DDS_HEADER       header;
+    LoadDds::DDS_HEADER_DXT10 dxt10Header;
+    uint16_t                  flags           = 0;
+    uint8_t                   format          = 0;
+    uint8_t                   mipCount        = 0;
+    uint32_t                  blockSize       = 0;
+    uint32_t                  glFormat        = 0;
+    uint32_t                  firstMip        = 0;
+    uint32_t                  arraySize       = 0;
+    uint32_t                  faceCount       = 0;
+    uint64_t                  totalSizeBytes  = 0;
+    uint64_t                  payloadOffset   = 0;
+    uint64_t                  fileLayerStride = 0;
+    uint64_t                  dataOffset      = 0; // PAYLOAD_ALIGNMENT aligned, so a mapping hands out aligned data
+  };
+
+  struct CACHE_MIP
+  {
+    uint32_t width     = 0;
+    uint32_t height    = 0;
+    uint32_t depth     = 0;
+    uint32_t reserved  = 0;
+    uint64_t offset    = 0;
+    uint64_t size      = 0;
+    uint64_t layerSize = 0;
+  };
+
+  // stamps index: a STAMPS_HEADER, then count STAMP_RECORDs each followed by its pathLength path bytes
+  struct STAMPS_HEADER
+  {
+    uint32_t magic   = STAMPS_MAGIC;
+    uint32_t version = STAMPS_VERSION;
+    uint64_t count   = 0;
+  };
+
+  struct STAMP_RECORD
+  {
+    uint64_t size       = 0;
+    int64_t  writeTime  = 0;
+    uint64_t hash       = 0;
+    uint32_t pathLength = 0;
+    uint32_t reserved   = 0;
+  };
+#pragma pack(pop)
+
+  size_t AlignUp(const size_t t_value, const size_t t_alignment) {
+    return (t_value + t_alignment - 1) / t_alignment * t_alignment;
+  }
+
+  Dds::STATUS Fail(const Dds::STATUS t_status, const char* t_source) {
+    Dds::Log(t_status, t_source);
+    return t_status;
+  }
+
+  // FileWriter goes through a temporary file, so readers in other processes only ever see whole files
+  bool WriteAtomically(const std::filesystem::path& t_path, const std::span<const std::span<const std::byte>> t_pieces) {
+    std::error_code error;
+    std::filesystem::create_directories(t_path.parent_path(), error);
+
+    Dds::FileWriter out;
+    return out.Open(t_path.string().c_str()) && out.Write(t_pieces) && out.Commit();
+  }
+}
+
+Dds::TextureCache::TextureCache(std::filesystem::path t_directory, const size_t t_memoryBudget)
+  : m_directory(std::move(t_directory)),
+    m_memoryBudget(t_memoryBudget) {
+  ReadStamps();
+}
+
+Dds::TextureCache::~TextureCache() {
+  Flush();
+}
+
+Dds::Result<Dds::TextureCache::TexturePtr> Dds::TextureCache::Load(const char* t_path, const LoadOptions& t_options) {
+  std::error_code error;
+  const uint64_t  size      = std::filesystem::file_size(t_path, error);
+  const int64_t   writeTime = error ? 0 : std::filesystem::last_write_time(t_path, error).time_since_epoch().count();
+  if (error) {
+    return Fail({Error::OpenFailed}, t_path);
+  }
+
+  // stamps outlive the process, so they are keyed by a path that does not depend on the working directory
+  std::string stampPath = std::filesystem::absolute(t_path, error).lexically_normal().string();
+  if (error) {
+    stampPath = t_path;
+  }
+
+  KEY  key{0, OptionsKey(t_options)};
+  bool hashed = false;
+  {
+    std::lock_guard lock(m_mutex);
+    const auto      stamp = m_stamps.find(stampPath);
+    if (stamp != m_stamps.end() && stamp->second.size == size && stamp->second.writeTime == writeTime) {
+      key.sourceHash = stamp->second.hash;
+      hashed         = true;
+      if (TexturePtr texture = FindInMemory(key)) {
+        return texture;
+      }
+    }
+  }
+
+  // the source is only touched to hash it or, on a miss, to load it
+  MappedFile source;
+  if (!hashed) {
+    if (!source.Open(t_path)) {
+      return Fail({Error::OpenFailed}, t_path);
+    }
+    key.sourceHash = Hash64({source.Data(), source.Size()});
+
+    std::lock_guard lock(m_mutex);
+    m_stamps[stampPath] = {size, writeTime, key.sourceHash};
+    m_stampsDirty       = true;
+    ++m_stats.hashes;
+    // the same content may already be loaded under another path or before a touch
+    if (TexturePtr texture = FindInMemory(key)) {
+      return texture;
+    }
+  }
+
+  const std::filesystem::path entryPath = m_directory / EntryName(key.sourceHash, t_options);
+  auto                        ddsFile   = std::make_shared<LoadDds::DDS_FILE>();
+
+  if (ReadEntry(entryPath, key, *ddsFile).Ok()) {
+    std::lock_guard lock(m_mutex);
+    ++m_stats.diskHits;
+    Remember(key, ddsFile);
+    return TexturePtr(std::move(ddsFile));
+  }
+
+  if (!source.IsOpen() && !source.Open(t_path)) {
+    return Fail({Error::OpenFailed}, t_path);
+  }
+
+  LoadOptions options = t_options;
+  options.storage     = Storage::Heap;
+
+  Result<LoadDds::DDS_FILE> loaded = LoadDds::TextureLoadDds(std::span<const std::byte>(source.Data(), source.Size()), options);
+  if (!loaded) {
+    return loaded.Status(); // already logged by the loader
+  }
+  *ddsFile = *std::move(loaded);
+
+  WriteEntry(entryPath, key, *ddsFile);
+
+  std::lock_guard lock(m_mutex);
+  ++m_stats.misses;
+  Remember(key, ddsFile);
+  return TexturePtr(std::move(ddsFile));
+}
+
+void Dds::TextureCache::Clear() {
+  std::lock_guard lock(m_mutex);
+  m_entries.clear();
+  m_lru.clear();
+  m_stats.memoryBytes = 0;
+}
+
+Dds::TextureCache::STATS Dds::TextureCache::Stats() const {
+  std::lock_guard lock(m_mutex);
+  return m_stats;
+}
+
+std::string Dds::TextureCache::EntryName(const uint64_t t_sourceHash, const LoadOptions& t_options) {
+  char name[48];
+  std::snprintf(name,
+                sizeof(name),
+                "%016llx-%06llx.ddsc",
+                static_cast<unsigned long long>(t_sourceHash),
+                static_cast<unsigned long long>(OptionsKey(t_options)));
+  return name;
+}
+
+uint64_t Dds::TextureCache::OptionsKey(const LoadOptions& t_options) {
+  // only what changes the payload or the header, storage does not. no file has more than 32 levels, so
+  // both mip fields fit a byte
+  return static_cast<uint64_t>(t_options.flipVertical) |
+         static_cast<uint64_t>(t_options.legacyColorSpace) << 1 |
+         static_cast<uint64_t>(t_options.validation) << 2 |
+         static_cast<uint64_t>(t_options.partialFlip) << 3 |
+         static_cast<uint64_t>(std::min(t_options.firstMip, 0xFFu)) << 8 |
+         static_cast<uint64_t>(std::min(t_options.mipCount, 0xFFu)) << 16;
+}
+
+Dds::STATUS Dds::TextureCache::ReadEntry(const std::filesystem::path& t_path, const KEY& t_key, LoadDds::DDS_FILE& t_ddsFile) {
+  if (!t_ddsFile.mapping.Open(t_path.string().c_str())) {
+    return {Error::OpenFailed};
+  }
+
+  const std::byte* file = t_ddsFile.mapping.Data();
+  const size_t     size = t_ddsFile.mapping.Size();
+
+  CACHE_HEADER header;
+  if (size < sizeof(header)) {
+    return {Error::TruncatedHeader};
+  }
+  std::memcpy(&header, file, sizeof(header));
+
+  if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION) {
+    return {Error::BadMagic};
+  }
+  if (header.sourceHash != t_key.sourceHash || header.options != t_key.options) {
+    return {Error::LayoutMismatch};
+  }
+  if (header.mipCount == 0 || header.mipCount > 32 || header.format >= static_cast<uint8_t>(Format::Count)) {
+    return {Error::InvalidHeader};
+  }
+  if (sizeof(header) + header.mipCount * sizeof(CACHE_MIP) > header.dataOffset || header.dataOffset > size ||
+      header.totalSizeBytes > size - header.dataOffset) {
+    return {Error::TruncatedMip};
+  }
+
+  t_ddsFile.mipMaps.resize(header.mipCount);
+  for (size_t mip = 0; mip < header.mipCount; ++mip) {
+    CACHE_MIP level;
+    std::memcpy(&level, file + sizeof(header) + mip * sizeof(CACHE_MIP), sizeof(level));
+    if (level.offset > header.totalSizeBytes || level.size > header.totalSizeBytes - level.offset) {
+      return {Error::TruncatedMip, static_cast<uint32_t>(mip)};
+    }
+    t_ddsFile.mipMaps[mip] = {level.width, level.height, level.depth, level.offset, level.size, level.layerSize};
+  }
+
+  t_ddsFile.header           = header.header;
+  t_ddsFile.dxt10Header      = header.dxt10Header;
+  t_ddsFile.flags.flagValue  = header.flags;
+  t_ddsFile.format           = static_cast<Format>(header.format);
+  t_ddsFile.blockSize        = header.blockSize;
+  t_ddsFile.glFormat         = header.glFormat;
+  t_ddsFile.totalSizeBytes   = header.totalSizeBytes;
+  t_ddsFile.payloadOffset    = header.payloadOffset;
+  t_ddsFile.firstMip         = header.firstMip;
+  t_ddsFile.arraySize        = header.arraySize;
+  t_ddsFile.faceCount        = header.faceCount;
+  t_ddsFile.fileLayerStride  = header.fileLayerStride;
+  t_ddsFile.data             = {t_ddsFile.mapping.Data() + header.dataOffset, header.totalSizeBytes};
+
+  return {};
+}
+
+bool Dds::TextureCache::WriteEntry(const std::filesystem::path& t_path, const KEY& t_key, const LoadDds::DDS_FILE& t_ddsFile) {
+  CACHE_HEADER header;
+  header.sourceHash      = t_key.sourceHash;
+  header.options         = t_key.options;
+  header.header          = t_ddsFile.header;
+  header.dxt10Header     = t_ddsFile.dxt10Header;
+  header.flags           = t_ddsFile.flags.flagValue;
+  header.format          = static_cast<uint8_t>(t_ddsFile.format);
+  header.mipCount        = static_cast<uint8_t>(t_ddsFile.mipMaps.size());
+  header.blockSize       = t_ddsFile.blockSize;
+  header.glFormat        = t_ddsFile.glFormat;
+  header.firstMip        = t_ddsFile.firstMip;
+  header.arraySize       = t_ddsFile.arraySize;
+  header.faceCount       = t_ddsFile.faceCount;
+  header.totalSizeBytes  = t_ddsFile.totalSizeBytes;
+  header.payloadOffset   = t_ddsFile.payloadOffset;
+  header.fileLayerStride = t_ddsFile.fileLayerStride;
+  header.dataOffset      = AlignUp(sizeof(header) + t_ddsFile.mipMaps.size() * sizeof(CACHE_MIP), LoadDds::PAYLOAD_ALIGNMENT);
+
+  // header, mip table and padding up to the payload, written together with the payload in one gather write
+  std::vector<std::byte> prefix(header.dataOffset);
+  std::memcpy(prefix.data(), &header, sizeof(header));
+  for (size_t mip = 0; mip < t_ddsFile.mipMaps.size(); ++mip) {
+    const LoadDds::MIP_LEVEL& level = t_ddsFile.mipMaps[mip];
+    const CACHE_MIP           entry{level.width, level.height, level.depth, 0, level.offset, level.size, level.layerSize};
+    std::memcpy(prefix.data() + sizeof(header) + mip * sizeof(CACHE_MIP), &entry, sizeof(entry));
+  }
+
+  const std::span<const std::byte> pieces[] = {prefix, t_ddsFile.data.first(t_ddsFile.totalSizeBytes)};
+  return WriteAtomically(t_path, pieces);
+}
+
+void Dds::TextureCache::ReadStamps() {
+  std::ifstream in(m_directory / STAMPS_NAME, std::ios::binary);
+  STAMPS_HEADER header;
+  if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != STAMPS_MAGIC ||
+      header.version != STAMPS_VERSION) {
+    return;
+  }
+
+  // a record cut short ends the index, the ones before it are still good
+  std::lock_guard lock(m_mutex);
+  std::string     path;
+  for (uint64_t index = 0; index < header.count; ++index) {
+    STAMP_RECORD record;
+    if (!in.read(reinterpret_cast<char*>(&record), sizeof(record)) || record.pathLength > 4096) {
+      return;
+    }
+    path.resize(record.pathLength);
+    if (!in.read(path.data(), static_cast<std::streamsize>(path.size()))) {
+      return;
+    }
+    m_stamps.try_emplace(path, STAMP{record.size, record.writeTime, record.hash});
+  }
+}
+
+void Dds::TextureCache::Flush() {
+  {
+    std::lock_guard lock(m_mutex);
+    if (!m_stampsDirty) {
+      return;
+    }
+  }
+  ReadStamps();
+
+  std::vector<std::byte> index;
+  {
+    std::lock_guard lock(m_mutex);
+    m_stampsDirty = false;
+    const STAMPS_HEADER header{STAMPS_MAGIC, STAMPS_VERSION, m_stamps.size()};
+    index.resize(sizeof(header));
+    std::memcpy(index.data(), &header, sizeof(header));
+    for (const auto& [path, stamp] : m_stamps) {
+      const STAMP_RECORD record{stamp.size, stamp.writeTime, stamp.hash, static_cast<uint32_t>(path.size()), 0};
+      const size_t       offset = index.size();
+      index.resize(offset + sizeof(record) + path.size());
+      std::memcpy(index.data() + offset, &record, sizeof(record));
+      std::memcpy(index.data() + offset + sizeof(record), path.data(), path.size());
+    }
+  }
+
+  // a failed write only costs the next launch a hash of the sources hashed since the last good one
+  const std::span<const std::byte> pieces[] = {index};
+  WriteAtomically(m_directory / STAMPS_NAME, pieces);
+}
+
+Dds::TextureCache::TexturePtr Dds::TextureCache::FindInMemory(const KEY& t_key) {
+  const auto entry = m_entries.find(t_key);
+  if (entry == m_entries.end()) {
+    return nullptr;
+  }
+
+  m_lru.splice(m_lru.begin(), m_lru, entry->second.use);
+  ++m_stats.memoryHits;
+  return entry->second.texture;
+}
+
+void Dds::TextureCache::Remember(const KEY& t_key, const TexturePtr& t_texture) {
+  const size_t bytes = t_texture->totalSizeBytes;
+  if (bytes > m_memoryBudget || m_entries.contains(t_key)) {
+    return; // too large to keep, or another thread got there first
+  }
+
+  m_lru.push_front(t_key);
+  m_entries.emplace(t_key, ENTRY{t_texture, bytes, m_lru.begin()});
+  m_stats.memoryBytes += bytes;
+
+  while (m_stats.memoryBytes > m_memoryBudget) {
+    const auto oldest = m_entries.find(m_lru.back());
+    m_stats.memoryBytes -= oldest->second.bytes;
+    m_entries.erase(oldest);
+    m_lru.pop_back();
+  }
+}
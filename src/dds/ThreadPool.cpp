@@ -0,0 +1,114 @@
+#include "dds/ThreadPool.h"
+
+#include <algorithm>
+
+namespace
+{
+  // lets Submit() find the calling worker's own deque
+  thread_local const Dds::ThreadPool* currentPool  = nullptr;
+  thread_local size_t                 currentIndex = 0;
+}
+
+Dds::ThreadPool::ThreadPool(size_t t_threadCount) {
+  if (t_threadCount == 0) {
+    t_threadCount = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  m_queues.reserve(t_threadCount);
+  for (size_t i = 0; i < t_threadCount; ++i) {
+    m_queues.push_back(std::make_unique<WORKER_QUEUE>());
+  }
+
+  m_threads.reserve(t_threadCount);
+  for (size_t i = 0; i < t_threadCount; ++i) {
+    m_threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+  }
+}
+
+Dds::ThreadPool::~ThreadPool() {
+  Wait();
+
+  {
+    std::lock_guard lock(m_mutex);
+    m_stop = true;
+  }
+  m_wake.notify_all();
+
+  for (std::thread& thread : m_threads) {
+    thread.join();
+  }
+}
+
+void Dds::ThreadPool::Submit(std::function<void()> t_task) {
+  const size_t index = currentPool == this
+                         ? currentIndex
+                         : m_nextQueue.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+  m_pending.fetch_add(1, std::memory_order_relaxed);
+  {
+    std::lock_guard lock(m_queues[index]->mutex);
+    m_queues[index]->tasks.push_front(std::move(t_task));
+  }
+
+  {
+    std::lock_guard lock(m_mutex);
+    m_queued.fetch_add(1, std::memory_order_release);
+  }
+  m_wake.notify_one();
+}
+
+void Dds::ThreadPool::Wait() {
+  std::unique_lock lock(m_mutex);
+  m_idle.wait(lock, [this] { return m_pending.load(std::memory_order_acquire) == 0; });
+}
+
+void Dds::ThreadPool::WorkerLoop(const size_t t_index) {
+  currentPool  = this;
+  currentIndex = t_index;
+
+  std::function<void()> task;
+  while (true) {
+    if (TryPop(t_index, task)) {
+      task();
+      task = nullptr;
+
+      if (m_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard lock(m_mutex);
+        m_idle.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock lock(m_mutex);
+    m_wake.wait(lock, [this] { return m_stop || m_queued.load(std::memory_order_acquire) > 0; });
+    if (m_stop && m_queued.load(std::memory_order_acquire) == 0) {
+      return;
+    }
+  }
+}
+
+bool Dds::ThreadPool::TryPop(const size_t t_index, std::function<void()>& t_task) {
+  // own deque from the front (most recently submitted, still warm in cache), others from the back
+  for (size_t i = 0; i < m_queues.size(); ++i) {
+    WORKER_QUEUE& queue = *m_queues[(t_index + i) % m_queues.size()];
+
+    std::lock_guard lock(queue.mutex);
+    if (queue.tasks.empty()) {
+      continue;
+    }
+
+    if (i == 0) {
+      t_task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    else {
+      t_task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+
+    m_queued.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+  }
+
+  return false;
+}
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "TestSupport.h"
+#include "dds/AsyncLoader.h"
+#include "dds/BatchLoader.h"
+#include "dds/ThreadPool.h"
+
+namespace
+{
+  using Dds::Test::TestDirectory;
+
+  // a small mixed corpus plus a path that does not exist at the end
+  std::vector<std::string> CorpusPaths() {
+    std::vector<std::string> paths = Dds::Bench::WriteCorpus(TestDirectory(), Dds::Bench::CorpusDescs(16, 64, SIZE_MAX));
+    paths.push_back((TestDirectory() / "missing.dds").string());
+    return paths;
+  }
+
+  void ExpectMatchesSyncLoad(const std::string& t_path, const Dds::BatchLoader::RESULT& t_result) {
+    const Dds::Result<LoadDds::DDS_FILE> reference = LoadDds::TextureLoadDds(t_path.c_str());
+    if (!reference) {
+      EXPECT_EQ(t_result.status.error, reference.Status().error) << t_path;
+      return;
+    }
+    ASSERT_TRUE(t_result.Ok()) << t_path << ": " << Dds::ErrorMessage(t_result.status.error);
+    SCOPED_TRACE(t_path);
+    Dds::Test::ExpectSamePayload(t_result.file, *reference);
+  }
+}
+
+TEST(ThreadPool, RunsEveryTask) {
+  Dds::ThreadPool     pool(4);
+  std::atomic<size_t> done = 0;
+  for (size_t i = 0; i < 1000; ++i) {
+    pool.Submit([&]
+    {
+      // tasks queued from a worker land in its own deque
+      pool.Submit([&]
+      {
+        ++done;
+      });
+    });
+  }
+  pool.Wait();
+  EXPECT_EQ(done, 1000u);
+}
+
+TEST(BatchLoader, FuturesMatchSyncLoads) {
+  const std::vector<std::string> paths = CorpusPaths();
+  ASSERT_GT(paths.size(), 1u);
+
+  Dds::BatchLoader loader(4);
+  auto             results = loader.Load(paths);
+  ASSERT_EQ(results.size(), paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    const Dds::BatchLoader::RESULT result = results[i].get();
+    EXPECT_EQ(result.path, paths[i]);
+    ExpectMatchesSyncLoad(paths[i], result);
+  }
+}
+
+TEST(BatchLoader, CallbackSeesEveryIndex) {
+  const std::vector<std::string> paths = CorpusPaths();
+
+  Dds::BatchLoader  loader(3);
+  std::mutex        mutex;
+  std::vector<bool> seen(paths.size());
+  size_t            failures = 0;
+  loader.Load(paths, [&](const size_t t_index, Dds::BatchLoader::RESULT&& t_result)
+  {
+    const std::scoped_lock lock(mutex);
+    seen[t_index] = true;
+    failures += t_result.Ok() ? 0 : 1;
+  });
+  loader.Wait();
+
+  EXPECT_EQ(std::count(seen.begin(), seen.end(), true), static_cast<ptrdiff_t>(paths.size()));
+  EXPECT_EQ(failures, 1u);
+}
+
+TEST(AsyncLoader, MatchesSyncLoads) {
+  const std::vector<std::string> paths = CorpusPaths();
+
+  // a shallow queue makes the I/O thread recycle slots
+  Dds::AsyncLoader loader(8, 2);
+  std::vector<std::future<Dds::AsyncLoader::RESULT>> results;
+  for (const std::string& path : paths) {
+    results.push_back(loader.Load(path));
+  }
+  for (size_t i = 0; i < paths.size(); ++i) {
+    ExpectMatchesSyncLoad(paths[i], results[i].get());
+  }
+}
+
+TEST(AsyncLoader, FlipsLikeTheSyncLoader) {
+  const Dds::Bench::TEXTURE_DESC desc{Dds::Format::BC7, 64, true, Dds::Bench::Layout::Cubemap};
+  const std::vector<std::string> paths = Dds::Bench::WriteCorpus(TestDirectory(), std::span(&desc, 1));
+  ASSERT_EQ(paths.size(), 1u);
+
+  Dds::LoadOptions options;
+  options.flipVertical = true;
+
+  Dds::AsyncLoader               loader;
+  const Dds::AsyncLoader::RESULT result    = loader.Load(paths[0], options).get();
+  const LoadDds::DDS_FILE        reference = *LoadDds::TextureLoadDds(paths[0].c_str(), options);
+  ASSERT_TRUE(result.Ok()) << Dds::ErrorMessage(result.status.error);
+  Dds::Test::ExpectSamePayload(result.file, reference);
+}
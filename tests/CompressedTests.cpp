@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "TestSupport.h"
+#include "dds/Compressed.h"
+#include "dds/DDSWriter.h"
+#include "dds/Lz.h"
+
+namespace
+{
+  using Dds::Format;
+  using Dds::Bench::Layout;
+  using Dds::Bench::TEXTURE_DESC;
+  using Dds::Test::TestDirectory;
+
+  std::string ContainerPath() {
+    return (TestDirectory() / "texture.ddsz").string();
+  }
+
+  // a synthetic texture loaded into heap memory
+  LoadDds::DDS_FILE MakeTexture(const TEXTURE_DESC& t_desc, const uint64_t t_seed = 1) {
+    const std::vector<std::byte> file   = Dds::Bench::MakeDds(t_desc, t_seed);
+    auto                         loaded = LoadDds::TextureLoadDds(std::span<const std::byte>(file));
+    EXPECT_TRUE(loaded);
+    return std::move(loaded.Value());
+  }
+
+  // repeating blocks with the odd change, compresses well like flat regions of real textures do
+  void FillCompressible(LoadDds::DDS_FILE& t_ddsFile) {
+    for (size_t i = 0; i < t_ddsFile.data.size(); ++i) {
+      t_ddsFile.data[i] = static_cast<std::byte>((i % 16) * 7 + (i / 4096));
+    }
+  }
+
+  // containers always decompress into aligned heap memory
+  void ExpectDecompressed(const LoadDds::DDS_FILE& t_loaded, const LoadDds::DDS_FILE& t_expected) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(t_loaded.data.data()) % LoadDds::PAYLOAD_ALIGNMENT, 0u);
+    Dds::Test::ExpectSamePayload(t_loaded, t_expected);
+  }
+
+  class Compressed : public Dds::Test::TempDirectoryTest
+  {
+  protected:
+    Dds::CompressedLoader m_loader{4};
+  };
+}
+
+TEST(Lz, RoundTrip) {
+  std::vector<std::byte> source(100000);
+  for (size_t i = 0; i < source.size(); ++i) {
+    // runs, short repeats at every offset and a noisy stretch that does not compress
+    const uint32_t noise = static_cast<uint32_t>(i * 2654435761u) >> 24;
+    source[i]            = static_cast<std::byte>(i < 30000 ? 0 : i < 60000 ? i % (1 + i / 1000) : noise);
+  }
+
+  for (const size_t size : {size_t{0}, size_t{1}, size_t{12}, size_t{13}, size_t{300}, source.size()}) {
+    const std::span<const std::byte> input(source.data(), size);
+    std::vector<std::byte>           block(Dds::LzCompressBound(size));
+    const size_t                     blockSize = Dds::LzCompress(input, block);
+    ASSERT_NE(blockSize, 0u) << size;
+
+    std::vector<std::byte> output(size);
+    ASSERT_TRUE(Dds::LzDecompress(std::span(block.data(), blockSize), output)) << size;
+    EXPECT_EQ(output, std::vector<std::byte>(input.begin(), input.end())) << size;
+  }
+
+  // the zero run and the short repeats have to shrink
+  std::vector<std::byte> block(Dds::LzCompressBound(60000));
+  EXPECT_LT(Dds::LzCompress(std::span(source.data(), 60000), block), 60000u / 4);
+}
+
+TEST(Lz, RejectsCorruptBlocks) {
+  std::vector<std::byte> source(4096, std::byte{42});
+  std::vector<std::byte> block(Dds::LzCompressBound(source.size()));
+  block.resize(Dds::LzCompress(source, block));
+  ASSERT_FALSE(block.empty());
+
+  std::vector<std::byte> output(source.size());
+  // truncated, the wrong size and a match reaching back before the start
+  EXPECT_FALSE(Dds::LzDecompress(std::span(block.data(), block.size() - 1), output));
+  EXPECT_FALSE(Dds::LzDecompress(block, std::span(output.data(), output.size() - 1)));
+  const std::byte badOffset[] = {std::byte{0x10}, std::byte{1}, std::byte{9}, std::byte{0}, std::byte{0x00}};
+  EXPECT_FALSE(Dds::LzDecompress(badOffset, output));
+
+  // a destination too small to compress into
+  EXPECT_EQ(Dds::LzCompress(source, std::span(block.data(), 8)), 0u);
+}
+
+TEST_F(Compressed, RoundTrip) {
+  const TEXTURE_DESC descs[] = {{Format::BC1, 256},
+                                {Format::BC7, 64, true, Layout::Array},
+                                {Format::RGBA8, 32, true, Layout::Cubemap},
+                                {Format::BC3, 16, false}};
+  for (const TEXTURE_DESC& desc : descs) {
+    LoadDds::DDS_FILE texture = MakeTexture(desc);
+    FillCompressible(texture);
+
+    // small chunks so the large levels span several of them
+    Dds::COMPRESS_OPTIONS options;
+    options.chunkSize = 4096;
+    ASSERT_TRUE(Dds::SaveCompressedDds(ContainerPath().c_str(), texture, options).Ok()) << desc.Name();
+    if (texture.totalSizeBytes >= 16384) {
+      EXPECT_LT(std::filesystem::file_size(ContainerPath()), texture.totalSizeBytes / 2) << desc.Name();
+    }
+
+    const auto loaded = m_loader.Load(ContainerPath().c_str());
+    ASSERT_TRUE(loaded) << desc.Name();
+    ExpectDecompressed(*loaded, texture);
+  }
+}
+
+TEST_F(Compressed, IncompressibleChunksAreStored) {
+  // the synthetic payload is noise
+  const LoadDds::DDS_FILE texture = MakeTexture({Format::BC1, 128});
+  ASSERT_TRUE(Dds::SaveCompressedDds(ContainerPath().c_str(), texture).Ok());
+  EXPECT_LT(std::filesystem::file_size(ContainerPath()), texture.totalSizeBytes + 1024);
+
+  const auto loaded = m_loader.Load(ContainerPath().c_str());
+  ASSERT_TRUE(loaded);
+  ExpectDecompressed(*loaded, texture);
+}
+
+TEST_F(Compressed, MipRangeAndFlip) {
+  const TEXTURE_DESC desc{Format::BC1, 256, true, Layout::Cubemap};
+  const std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+
+  // half noise, half compressible, so the range mixes stored and compressed chunks
+  LoadDds::DDS_FILE texture = MakeTexture(desc);
+  FillCompressible(texture);
+  std::memcpy(texture.data.data(), file.data() + file.size() - texture.totalSizeBytes / 2, texture.totalSizeBytes / 2);
+
+  Dds::COMPRESS_OPTIONS compress;
+  compress.chunkSize = 2048;
+  ASSERT_TRUE(Dds::SaveCompressedDds(ContainerPath().c_str(), texture, compress).Ok());
+  const std::string plain = (TestDirectory() / "texture.dds").string();
+  ASSERT_TRUE(Dds::SaveDds(plain.c_str(), texture).Ok());
+
+  Dds::LoadOptions options;
+  options.firstMip     = 1;
+  options.mipCount     = 3;
+  options.flipVertical = true;
+
+  const auto loaded   = m_loader.Load(ContainerPath().c_str(), options);
+  const auto expected = LoadDds::TextureLoadDds(plain.c_str(), options);
+  ASSERT_TRUE(loaded);
+  ASSERT_TRUE(expected);
+  ExpectDecompressed(*loaded, *expected);
+  EXPECT_EQ(loaded->header.dwWidth, 128u);
+}
+
+TEST_F(Compressed, RejectsDamagedContainers) {
+  LoadDds::DDS_FILE texture = MakeTexture({Format::RGBA8, 64});
+  FillCompressible(texture);
+  ASSERT_TRUE(Dds::SaveCompressedDds(ContainerPath().c_str(), texture).Ok());
+  const uintmax_t size = std::filesystem::file_size(ContainerPath());
+
+  // overwrite the first chunk (the top level, compressed) with a literal length that never ends
+  {
+    std::fstream file(ContainerPath(), std::ios::binary | std::ios::in | std::ios::out);
+    uint32_t     headerSize = 0;
+    file.seekg(16); // DDSZ_HEADER::headerSize
+    file.read(reinterpret_cast<char*>(&headerSize), sizeof(headerSize));
+
+    uint64_t offset         = 0;
+    uint32_t compressedSize = 0;
+    file.seekg(static_cast<std::streamoff>(32 + headerSize));
+    file.read(reinterpret_cast<char*>(&offset), sizeof(offset));
+    file.read(reinterpret_cast<char*>(&compressedSize), sizeof(compressedSize));
+    ASSERT_LT(compressedSize, 64u * 64 * 4);
+
+    file.seekp(static_cast<std::streamoff>(offset));
+    file.write(std::string(compressedSize, '\xFF').data(), compressedSize);
+  }
+  EXPECT_EQ(m_loader.Load(ContainerPath().c_str()).Status().error, Dds::Error::CorruptChunk);
+
+  std::filesystem::resize_file(ContainerPath(), size - 1);
+  EXPECT_EQ(m_loader.Load(ContainerPath().c_str()).Status().error, Dds::Error::ShortRead);
+  std::filesystem::resize_file(ContainerPath(), 40);
+  EXPECT_EQ(m_loader.Load(ContainerPath().c_str()).Status().error, Dds::Error::TruncatedHeader);
+
+  // a plain DDS file is not a container
+  const std::string plain = (TestDirectory() / "texture.dds").string();
+  ASSERT_TRUE(Dds::SaveDds(plain.c_str(), texture).Ok());
+  EXPECT_EQ(m_loader.Load(plain.c_str()).Status().error, Dds::Error::BadMagic);
+}
+
+TEST_F(Compressed, Zstd) {
+  LoadDds::DDS_FILE texture = MakeTexture({Format::BC7, 128});
+  FillCompressible(texture);
+
+  Dds::COMPRESS_OPTIONS options;
+  options.codec = Dds::Codec::Zstd;
+  if (!Dds::CodecAvailable(Dds::Codec::Zstd)) {
+    EXPECT_EQ(Dds::SaveCompressedDds(ContainerPath().c_str(), texture, options).error, Dds::Error::UnsupportedCodec);
+    EXPECT_FALSE(std::filesystem::exists(ContainerPath()));
+    GTEST_SKIP() << "built without zstd";
+  }
+
+  ASSERT_TRUE(Dds::SaveCompressedDds(ContainerPath().c_str(), texture, options).Ok());
+  const auto loaded = m_loader.Load(ContainerPath().c_str());
+  ASSERT_TRUE(loaded);
+  ExpectDecompressed(*loaded, texture);
+}
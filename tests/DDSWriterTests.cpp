@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "TestSupport.h"
+#include "dds/DDSWriter.h"
+
+namespace
+{
+  using Dds::Format;
+  using Dds::Bench::Layout;
+  using Dds::Bench::TEXTURE_DESC;
+  using Dds::Test::Bytes;
+  using Dds::Test::TestDirectory;
+
+  const std::byte* Payload(const std::vector<std::byte>& t_file, const LoadDds::DDS_FILE& t_ddsFile) {
+    return t_file.data() + t_file.size() - t_ddsFile.totalSizeBytes;
+  }
+
+  // the whole file a save produces, with the number of buffers it came in
+  std::vector<std::byte> SaveToMemory(const LoadDds::DDS_FILE& t_ddsFile, size_t* t_buffers = nullptr) {
+    std::vector<std::byte> file;
+    const Dds::STATUS      status = Dds::SaveDds([&](const std::span<const std::span<const std::byte>> t_pieces)
+    {
+      for (const std::span<const std::byte> piece : t_pieces) {
+        file.insert(file.end(), piece.begin(), piece.end());
+      }
+      if (t_buffers) {
+        *t_buffers = t_pieces.size();
+      }
+      return true;
+    }, t_ddsFile);
+    EXPECT_TRUE(status.Ok());
+    return file;
+  }
+}
+
+TEST(Writer, RoundTripsEveryFormatAndLayout) {
+  // the synthetic files carry exactly the header fields a writer should produce, so an unmodified
+  // texture has to come out byte for byte identical
+  for (const TEXTURE_DESC& desc : Dds::Bench::CorpusDescs(16, 64, SIZE_MAX)) {
+    SCOPED_TRACE(desc.Name());
+    const std::vector<std::byte> file    = Dds::Bench::MakeDds(desc);
+    const LoadDds::DDS_FILE      ddsFile = *LoadDds::TextureLoadDds(Bytes(file));
+
+    const std::vector<std::byte> saved = SaveToMemory(ddsFile);
+    ASSERT_EQ(saved.size(), file.size());
+    EXPECT_EQ(std::memcmp(saved.data(), file.data(), file.size()), 0);
+  }
+}
+
+TEST(Writer, PayloadPieces) {
+  const LoadDds::DDS_FILE plain = *LoadDds::TextureLoadDds(Bytes(Dds::Bench::MakeDds({Format::BC1, 64})));
+  size_t                  buffers = 0;
+  static_cast<void>(SaveToMemory(plain, &buffers));
+  EXPECT_EQ(buffers, 2u); // headers and the payload
+
+  // layers are interleaved level by level in memory, every level of every layer is a piece of its own
+  const TEXTURE_DESC      desc{Format::BC1, 64, true, Layout::Cubemap};
+  const LoadDds::DDS_FILE cube = *LoadDds::TextureLoadDds(Bytes(Dds::Bench::MakeDds(desc)));
+  static_cast<void>(SaveToMemory(cube, &buffers));
+  EXPECT_EQ(buffers, 1 + desc.LayerCount() * desc.MipCount());
+}
+
+TEST(Writer, SavesFlippedAndTrimmed) {
+  const TEXTURE_DESC           desc{Format::BC3, 64, true, Layout::Array};
+  const std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+
+  Dds::LoadOptions options;
+  options.flipVertical = true;
+  options.firstMip     = 2;
+  const LoadDds::DDS_FILE baked = *LoadDds::TextureLoadDds(Bytes(file), options);
+
+  const std::string path = (TestDirectory() / "baked.dds").string();
+  std::filesystem::create_directories(TestDirectory());
+  ASSERT_TRUE(Dds::SaveDds(path.c_str(), baked).Ok());
+
+  // the saved file is the baked texture, loading it needs neither option
+  const LoadDds::DDS_FILE reloaded = *LoadDds::TextureLoadDds(path.c_str());
+  ASSERT_EQ(reloaded.mipMaps.size(), desc.MipCount() - 2);
+  EXPECT_EQ(reloaded.header.dwWidth, 16u);
+  EXPECT_EQ(reloaded.header.dwHeight, 16u);
+  EXPECT_EQ(reloaded.header.dwPitchOrLinearSize, Dds::GetFormatInfo(Format::BC3).SurfaceSize(16, 16));
+  EXPECT_EQ(reloaded.arraySize, desc.LayerCount());
+  ASSERT_EQ(reloaded.totalSizeBytes, baked.totalSizeBytes);
+  EXPECT_EQ(std::memcmp(reloaded.data.data(), baked.data.data(), baked.totalSizeBytes), 0);
+}
+
+TEST(Writer, SavesOverItsOwnMappedSource) {
+  const std::vector<std::byte> file = Dds::Bench::MakeDds({Format::BC1, 256});
+  const std::string            path = (TestDirectory() / "mapped.dds").string();
+  std::filesystem::remove_all(TestDirectory());
+  std::filesystem::create_directories(TestDirectory());
+  Dds::Test::WriteFile(path, Bytes(file));
+
+  Dds::LoadOptions mapped;
+  mapped.storage                  = Dds::Storage::Mapped;
+  const LoadDds::DDS_FILE ddsFile = *LoadDds::TextureLoadDds(path.c_str(), mapped);
+  ASSERT_TRUE(Dds::SaveDds(path.c_str(), ddsFile).Ok());
+
+  // the new file replaced the old one in one step, the mapping still sees the old one intact
+  EXPECT_EQ(std::memcmp(ddsFile.data.data(), Payload(file, ddsFile), ddsFile.totalSizeBytes), 0);
+  Dds::Test::ExpectSamePayload(*LoadDds::TextureLoadDds(path.c_str()), ddsFile);
+  EXPECT_EQ(std::distance(std::filesystem::directory_iterator(TestDirectory()), std::filesystem::directory_iterator()), 1);
+}
+
+TEST(Writer, KeepsLegacyPixelFormat) {
+  const TEXTURE_DESC      desc{Format::BGR8, 16, true, Layout::Cubemap};
+  const LoadDds::DDS_FILE ddsFile = *LoadDds::TextureLoadDds(Bytes(Dds::Bench::MakeDds(desc)));
+
+  const LoadDds::DDS_FILE reloaded = *LoadDds::TextureLoadDds(Bytes(SaveToMemory(ddsFile)));
+  EXPECT_NE(reloaded.header.ddspf.dwFourCC, 0x30315844u); // "DX10"
+  EXPECT_EQ(reloaded.format, Format::BGR8);
+  EXPECT_EQ(reloaded.faceCount, 6u);
+}
+
+TEST(Writer, RejectsInconsistentLayout) {
+  LoadDds::DDS_FILE ddsFile = *LoadDds::TextureLoadDds(Bytes(Dds::Bench::MakeDds({Format::RGBA8, 32})));
+  ddsFile.data              = ddsFile.data.first(ddsFile.data.size() / 2);
+
+  const std::string path = (TestDirectory() / "broken.dds").string();
+  std::filesystem::create_directories(TestDirectory());
+  EXPECT_EQ(Dds::SaveDds(path.c_str(), ddsFile).error, Dds::Error::TruncatedMip);
+  EXPECT_FALSE(std::filesystem::exists(path));
+
+  EXPECT_EQ(Dds::SaveDds(path.c_str(), LoadDds::DDS_FILE{}).error, Dds::Error::InvalidMipCount);
+}
+
+TEST(Writer, ReportsFailedWrites) {
+  const LoadDds::DDS_FILE ddsFile = *LoadDds::TextureLoadDds(Bytes(Dds::Bench::MakeDds({Format::BC1, 16})));
+
+  EXPECT_EQ(Dds::SaveDds([](auto) { return false; }, ddsFile).error, Dds::Error::WriteFailed);
+  EXPECT_EQ(Dds::SaveDds((TestDirectory() / "missing" / "out.dds").string().c_str(), ddsFile).error, Dds::Error::WriteFailed);
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstring>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "dds/Decoder.h"
+
+namespace
+{
+  using Dds::Format;
+
+  // RGBA8 texel t of a decoded 4x4 tile
+  std::array<uint8_t, 4> Texel(const std::array<std::byte, 64>& t_pixels, const size_t t_texel) {
+    std::array<uint8_t, 4> texel{};
+    std::memcpy(texel.data(), t_pixels.data() + t_texel * 4, 4);
+    return texel;
+  }
+
+  std::array<std::byte, 64> DecodeBlock(const Format t_format, const std::array<uint8_t, 16>& t_block) {
+    std::array<std::byte, 64> pixels{};
+    EXPECT_TRUE(Dds::Decoder::DecodeSurface(t_format, reinterpret_cast<const std::byte*>(t_block.data()), 4, 4, pixels.data(), 16));
+    return pixels;
+  }
+}
+
+TEST(Decoder, Bc1OpaqueAndPunchThrough) {
+  // color0 = red (0xF800) > color1 = blue (0x001F): four colour mode, texel 0 picks color0, texel 1 color1
+  const auto opaque = DecodeBlock(Format::BC1, {0x00, 0xF8, 0x1F, 0x00, 0x04, 0, 0, 0});
+  EXPECT_EQ(Texel(opaque, 0), (std::array<uint8_t, 4>{255, 0, 0, 255}));
+  EXPECT_EQ(Texel(opaque, 1), (std::array<uint8_t, 4>{0, 0, 255, 255}));
+  EXPECT_EQ(Texel(opaque, 2), (std::array<uint8_t, 4>{255, 0, 0, 255}));
+
+  // color0 <= color1: three colour mode, index 3 is transparent black
+  const auto punchThrough = DecodeBlock(Format::BC1, {0x1F, 0x00, 0x00, 0xF8, 0x03, 0, 0, 0});
+  EXPECT_EQ(Texel(punchThrough, 0), (std::array<uint8_t, 4>{0, 0, 0, 0}));
+  EXPECT_EQ(Texel(punchThrough, 1), (std::array<uint8_t, 4>{0, 0, 255, 255}));
+}
+
+TEST(Decoder, Bc4Endpoints) {
+  // red0 = 200, red1 = 100, index 0 and 1 pick the endpoints, channels BC4 does not store read 0
+  const auto pixels = DecodeBlock(Format::BC4, {200, 100, 0x08, 0, 0, 0, 0, 0});
+  EXPECT_EQ(Texel(pixels, 0), (std::array<uint8_t, 4>{200, 0, 0, 255}));
+  EXPECT_EQ(Texel(pixels, 1), (std::array<uint8_t, 4>{100, 0, 0, 255}));
+}
+
+TEST(Decoder, Bc7Mode6SolidBlock) {
+  // mode 6, both endpoints (254, 254, 254, 254) with p-bits 1 -> 255, every weight reads that colour
+  std::array<uint8_t, 16> block{};
+  block[0]        = 0x40;                // mode 6
+  uint64_t low    = 0x40;
+  // R0 R1 G0 G1 B0 B1 A0 A1, 7 bits each starting at bit 7
+  for (int field = 0; field < 8; ++field) {
+    low |= uint64_t{0x7F} << (7 + field * 7);
+  }
+  low |= uint64_t{1} << 63; // p-bit 0
+  std::memcpy(block.data(), &low, 8);
+  block[8] = 0x01;          // p-bit 1, all indices 0
+
+  const auto pixels = DecodeBlock(Format::BC7, block);
+  for (size_t texel = 0; texel < 16; ++texel) {
+    EXPECT_EQ(Texel(pixels, texel), (std::array<uint8_t, 4>{255, 255, 255, 255})) << texel;
+  }
+}
+
+TEST(Decoder, UnsupportedFormatsGiveAnEmptyImage) {
+  const std::vector<std::byte> file    = Dds::Bench::MakeDds({Format::RGBA8, 16});
+  const LoadDds::DDS_FILE      ddsFile = *LoadDds::TextureLoadDds(std::span<const std::byte>(file));
+
+  Dds::Decoder decoder(1);
+  EXPECT_FALSE(decoder.Decode(ddsFile, 0).Ok());
+}
+
+TEST(Decoder, OutOfRangeLevelAndSlice) {
+  const std::vector<std::byte> file    = Dds::Bench::MakeDds({Format::BC1, 16, false});
+  const LoadDds::DDS_FILE      ddsFile = *LoadDds::TextureLoadDds(std::span<const std::byte>(file));
+
+  Dds::Decoder decoder(1);
+  EXPECT_FALSE(decoder.Decode(ddsFile, 1).Ok());
+  EXPECT_FALSE(decoder.Decode(ddsFile, 0, 1).Ok());
+}
+
+TEST(Decoder, OddSizesAndPitch) {
+  const std::vector<std::byte> file    = Dds::Bench::MakeDds({Format::BC3, 5, false});
+  const LoadDds::DDS_FILE      ddsFile = *LoadDds::TextureLoadDds(std::span<const std::byte>(file));
+
+  Dds::Decoder              decoder(1);
+  const Dds::Decoder::IMAGE image = decoder.Decode(ddsFile, 0);
+  ASSERT_TRUE(image.Ok());
+  EXPECT_EQ(image.width, 5u);
+  EXPECT_EQ(image.height, 5u);
+  EXPECT_EQ(image.rowPitch, 20u);
+
+  // a padded destination gets the same rows
+  std::vector<std::byte> padded(64 * 5);
+  ASSERT_TRUE(decoder.Decode(ddsFile, 0, 0, padded, 64));
+  for (size_t row = 0; row < 5; ++row) {
+    EXPECT_EQ(std::memcmp(padded.data() + row * 64, image.pixels.Data() + row * 20, 20), 0);
+  }
+  EXPECT_FALSE(decoder.Decode(ddsFile, 0, 0, std::span(padded).first(64 * 4), 64));
+}
+
+TEST(Decoder, ParallelMatchesSingleThreaded) {
+  for (const Format format : {Format::BC1, Format::BC7, Format::BC6H_SF16}) {
+    // 4096 blocks, the smallest level that is split across workers
+    const std::vector<std::byte> file    = Dds::Bench::MakeDds({format, 256, false});
+    const LoadDds::DDS_FILE      ddsFile = *LoadDds::TextureLoadDds(std::span<const std::byte>(file));
+
+    Dds::Decoder              single(1);
+    Dds::Decoder              parallel(4);
+    const Dds::Decoder::IMAGE expected = single.Decode(ddsFile, 0);
+    const Dds::Decoder::IMAGE actual   = parallel.Decode(ddsFile, 0);
+    ASSERT_TRUE(expected.Ok());
+    ASSERT_TRUE(actual.Ok());
+    EXPECT_EQ(std::memcmp(actual.pixels.Data(), expected.pixels.Data(), expected.pixels.Size()), 0)
+      << Dds::GetFormatInfo(format).name;
+  }
+}
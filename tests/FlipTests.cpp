@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "TestSupport.h"
+#include "dds/Bc7.h"
+#include "dds/DDSLoader.h"
+#include "dds/DecodeKernels.h"
+#include "dds/Decoder.h"
+#include "dds/EncodeKernels.h"
+#include "dds/FlipKernels.h"
+
+namespace
+{
+  using Dds::Format;
+  using Dds::Bench::TEXTURE_DESC;
+  using Dds::Test::Bytes;
+
+  // the first xorshift words of a small seed are mostly zero bits, which would leave the index rows of
+  // tiny levels all the same and their flip invisible
+  constexpr uint64_t SEED = 0x9E3779B97F4A7C15;
+
+  LoadDds::DDS_FILE Load(const std::vector<std::byte>& t_file,
+                         const bool                    t_flip,
+                         const Dds::PartialFlip        t_partialFlip = Dds::PartialFlip::BlockRows) {
+    Dds::LoadOptions options;
+    options.flipVertical = t_flip;
+    options.partialFlip  = t_partialFlip;
+    return *LoadDds::TextureLoadDds(Bytes(t_file), options);
+  }
+
+  // the same file with its payload replaced by a loaded (level-major) mip chain, fine for single layers
+  std::vector<std::byte> WithPayload(std::vector<std::byte> t_file, const LoadDds::DDS_FILE& t_ddsFile) {
+    std::memcpy(t_file.data() + t_file.size() - t_ddsFile.totalSizeBytes, t_ddsFile.data.data(), t_ddsFile.totalSizeBytes);
+    return t_file;
+  }
+
+  // BC7 blocks whose partition has no mirrored counterpart are re-encoded when flipped, which is not
+  // exact for noise, so the exact checks rewrite every block to one of the single subset modes 4, 5 and 6
+  void ForceSingleSubsetBc7(std::vector<std::byte>& t_file, const size_t t_payloadSize) {
+    std::byte* block = t_file.data() + t_file.size() - t_payloadSize;
+    for (size_t i = 0; i < t_payloadSize / 16; ++i, block += 16) {
+      const int mode = 4 + static_cast<int>(i % 3);
+      block[0]       = (block[0] & static_cast<std::byte>(~((2 << mode) - 1))) | static_cast<std::byte>(1 << mode);
+    }
+  }
+
+  // the lowest set bit of the first byte
+  int Bc7Mode(const std::byte* t_block) {
+    return std::countr_zero(std::to_integer<unsigned>(t_block[0]));
+  }
+
+  std::vector<Format> FlippableFormats() {
+    std::vector<Format> formats;
+    for (size_t i = 1; i < static_cast<size_t>(Format::Count); ++i) {
+      if (Dds::SelectFlipKernel(Dds::GetFormatInfo(static_cast<Format>(i)))) {
+        formats.push_back(static_cast<Format>(i));
+      }
+    }
+    return formats;
+  }
+}
+
+TEST(Flip, TwiceIsIdentity) {
+  for (const Format format : FlippableFormats()) {
+    // the chain of 4 ends in a 2x2 level that is a single partial block row, the chain of 36 has 18x18
+    // and 9x9 levels taller than a block row that end in a partial one, whose block rows are reversed
+    for (const uint32_t size : {4u, 36u, 64u}) {
+      const TEXTURE_DESC desc{format, size};
+      SCOPED_TRACE(desc.Name());
+
+      const std::vector<std::byte> file    = Dds::Bench::MakeDds(desc, SEED);
+      const LoadDds::DDS_FILE      plain   = Load(file, false);
+      const LoadDds::DDS_FILE      flipped = Load(file, true);
+      const LoadDds::DDS_FILE      back    = Load(WithPayload(file, flipped), true);
+
+      ASSERT_EQ(back.totalSizeBytes, plain.totalSizeBytes);
+      EXPECT_NE(std::memcmp(flipped.data.data(), plain.data.data(), plain.totalSizeBytes), 0);
+      for (size_t mip = 0; mip < plain.mipMaps.size(); ++mip) {
+        const LoadDds::MIP_LEVEL& level = plain.mipMaps[mip];
+        // a BC7 level shorter than a block may come back with another partition shape, one that only
+        // agrees with the original on the rows inside the image
+        if (format == Format::BC7 && level.height < 4) {
+          continue;
+        }
+        if (format != Format::BC7) {
+          EXPECT_EQ(std::memcmp(back.data.data() + level.offset, plain.data.data() + level.offset, level.size), 0) << "mip " << mip;
+          continue;
+        }
+        // BC7 blocks whose shape has no mirrored counterpart come back re-encoded, in another mode
+        for (size_t offset = level.offset; offset < level.offset + level.size; offset += 16) {
+          if (Bc7Mode(back.data.data() + offset) == Bc7Mode(plain.data.data() + offset)) {
+            EXPECT_EQ(std::memcmp(back.data.data() + offset, plain.data.data() + offset, 16), 0) << "mip " << mip << " offset " << offset;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(Flip, UncompressedReversesRows) {
+  const TEXTURE_DESC           desc{Format::RGBA8, 16, false};
+  const std::vector<std::byte> file    = Dds::Bench::MakeDds(desc);
+  const LoadDds::DDS_FILE      plain   = Load(file, false);
+  const LoadDds::DDS_FILE      flipped = Load(file, true);
+
+  const size_t rowSize = 16 * 4;
+  for (size_t row = 0; row < 16; ++row) {
+    EXPECT_EQ(std::memcmp(flipped.data.data() + row * rowSize, plain.data.data() + (15 - row) * rowSize, rowSize), 0);
+  }
+}
+
+TEST(Flip, DecodedImageIsMirrored) {
+  // the decoder covers every block format that flips, so flipping the blocks has to mirror the pixels.
+  // 32 takes the chain down to the 2x2 and 1x1 levels, 3 is a level shorter than a block
+  for (const Format format : {Format::BC1, Format::BC2, Format::BC3, Format::BC4, Format::BC5, Format::BC7}) {
+    for (const uint32_t size : {32u, 3u}) {
+      const TEXTURE_DESC desc{format, size};
+      SCOPED_TRACE(desc.Name());
+
+      std::vector<std::byte> file = Dds::Bench::MakeDds(desc, SEED);
+      if (format == Format::BC7) {
+        ForceSingleSubsetBc7(file, desc.PayloadSize());
+      }
+      const LoadDds::DDS_FILE plain   = Load(file, false);
+      const LoadDds::DDS_FILE flipped = Load(file, true);
+
+      Dds::Decoder decoder(1);
+      for (size_t mip = 0; mip < plain.mipMaps.size(); ++mip) {
+        const Dds::Decoder::IMAGE original = decoder.Decode(plain, mip);
+        const Dds::Decoder::IMAGE mirrored = decoder.Decode(flipped, mip);
+        ASSERT_TRUE(original.Ok());
+        ASSERT_TRUE(mirrored.Ok());
+
+        for (size_t row = 0; row < original.height; ++row) {
+          ASSERT_EQ(std::memcmp(mirrored.pixels.Data() + row * mirrored.rowPitch,
+                                original.pixels.Data() + (original.height - 1 - row) * original.rowPitch,
+                                original.rowPitch),
+                    0)
+            << "mip " << mip << " row " << row;
+        }
+      }
+    }
+  }
+}
+
+TEST(Flip, PartialBlockRowIsMirroredTexelByTexel) {
+  // 6 and 10 end in a block row that is half padding, the blocks cannot simply trade places, so with
+  // PartialFlip::Reencode these levels are decoded, mirrored and encoded again. the content is a smooth
+  // gradient, which the encoders reproduce closely
+  for (const Format format : {Format::BC1, Format::BC2, Format::BC3, Format::BC4, Format::BC5, Format::BC7}) {
+    for (const uint32_t size : {6u, 10u}) {
+      const TEXTURE_DESC desc{format, size, false};
+      SCOPED_TRACE(desc.Name());
+
+      const size_t         blocks = ((size + 3) / 4) * ((size + 3) / 4);
+      std::vector<uint8_t> tiles(blocks * 64);
+      for (size_t block = 0; block < blocks; ++block) {
+        for (size_t texel = 0; texel < 16; ++texel) {
+          const size_t  x        = std::min<size_t>(block % ((size + 3) / 4) * 4 + texel % 4, size - 1);
+          const size_t  y        = std::min<size_t>(block / ((size + 3) / 4) * 4 + texel / 4, size - 1);
+          const uint8_t color[4] = {static_cast<uint8_t>(30 + 12 * y), static_cast<uint8_t>(200 - 9 * y - 4 * x),
+                                    static_cast<uint8_t>(60 + 6 * x), static_cast<uint8_t>(255 - 10 * y)};
+          std::memcpy(tiles.data() + block * 64 + texel * 4, color, 4);
+        }
+      }
+
+      std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+      Dds::SelectEncodeKernel(format)(reinterpret_cast<const std::byte*>(tiles.data()), blocks, file.data() + file.size() - desc.PayloadSize());
+
+      const LoadDds::DDS_FILE   plain    = Load(file, false);
+      const LoadDds::DDS_FILE   flipped  = Load(file, true, Dds::PartialFlip::Reencode);
+      Dds::Decoder              decoder(1);
+      const Dds::Decoder::IMAGE original = decoder.Decode(plain, 0);
+      const Dds::Decoder::IMAGE mirrored = decoder.Decode(flipped, 0);
+      ASSERT_TRUE(original.Ok());
+      ASSERT_TRUE(mirrored.Ok());
+
+      for (size_t row = 0; row < size; ++row) {
+        const std::byte* expected = original.pixels.Data() + (size - 1 - row) * original.rowPitch;
+        const std::byte* actual   = mirrored.pixels.Data() + row * mirrored.rowPitch;
+        for (size_t value = 0; value < original.rowPitch; ++value) {
+          EXPECT_NEAR(std::to_integer<int>(actual[value]), std::to_integer<int>(expected[value]), 12)
+            << "row " << row << " byte " << value;
+        }
+      }
+    }
+  }
+}
+
+TEST(Flip, EveryBc7PartitionIsMirrored) {
+  // every shape of every multi subset mode, including the few without a mirrored counterpart, which
+  // are re-encoded. the subsets lie on one grey ramp, which the re-encoded mode 6 block reproduces
+  const Dds::FORMAT_INFO&  info   = Dds::GetFormatInfo(Format::BC7);
+  const Dds::FlipKernel    flip   = Dds::SelectFlipKernel(info);
+  const Dds::DecodeKernel  decode = Dds::SelectDecodeKernel(info).kernel;
+  for (const uint8_t mode : {0, 1, 2, 3, 7}) {
+    const Dds::Bc7::MODE_INFO& modeInfo = Dds::Bc7::MODES[mode];
+    for (uint8_t partition = 0; partition < 1u << modeInfo.partitionBits; ++partition) {
+      SCOPED_TRACE(testing::Message() << "mode " << int{mode} << " partition " << int{partition});
+
+      Dds::Bc7::BLOCK block;
+      block.mode      = mode;
+      block.partition = partition;
+      for (unsigned endpoint = 0; endpoint < modeInfo.subsets * 2u; ++endpoint) {
+        const unsigned grey = 40 + endpoint * 30;
+        for (unsigned channel = 0; channel < 3; ++channel) {
+          block.endpoints[endpoint][channel] = static_cast<uint8_t>(grey >> (8 - modeInfo.colorBits));
+        }
+        if (modeInfo.alphaBits) {
+          block.endpoints[endpoint][3] = static_cast<uint8_t>(grey >> (8 - modeInfo.alphaBits));
+        }
+      }
+      // every row different, and below the anchor limit so no index loses its top bit
+      for (size_t texel = 0; texel < 16; ++texel) {
+        block.indices[texel] = static_cast<uint8_t>((texel / 4 * 3 + texel % 4) % (1u << (modeInfo.indexBits - 1)));
+      }
+
+      std::byte original[16];
+      std::byte flipped[16];
+      Dds::Bc7::Pack(block, original);
+      flip(original, flipped, 1);
+
+      std::byte expected[64];
+      std::byte actual[64];
+      decode(original, 1, expected);
+      decode(flipped, 1, actual);
+      for (size_t texel = 0; texel < 16; ++texel) {
+        for (size_t channel = 0; channel < 4; ++channel) {
+          EXPECT_NEAR(std::to_integer<int>(actual[texel * 4 + channel]),
+                      std::to_integer<int>(expected[((3 - texel / 4) * 4 + texel % 4) * 4 + channel]),
+                      12)
+            << "texel " << texel;
+        }
+      }
+    }
+  }
+}
+
+TEST(Flip, Bc6hIsLeftAsStored) {
+  const std::vector<std::byte> file = Dds::Bench::MakeDds({Format::BC6H_UF16, 16});
+  const LoadDds::DDS_FILE      plain   = Load(file, false);
+  const LoadDds::DDS_FILE      flipped = Load(file, true);
+
+  ASSERT_EQ(flipped.totalSizeBytes, plain.totalSizeBytes);
+  EXPECT_EQ(std::memcmp(flipped.data.data(), plain.data.data(), plain.totalSizeBytes), 0);
+}
+
+TEST(Flip, SurfaceCopiesWhenSourceDiffers) {
+  const Dds::FORMAT_INFO& info = Dds::GetFormatInfo(Format::BC1);
+
+  const std::vector<std::byte> file = Dds::Bench::MakeDds({Format::BC1, 16, false});
+  const std::byte*             source = file.data() + file.size() - 128;
+
+  std::vector<std::byte> inPlace(source, source + 128);
+  std::vector<std::byte> copied(128);
+  Dds::FlipSurface(info, inPlace.data(), inPlace.data(), 16, 16);
+  Dds::FlipSurface(info, source, copied.data(), 16, 16);
+  EXPECT_EQ(inPlace, copied);
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "dds/Formats.h"
+
+namespace
+{
+  using Dds::Format;
+
+  constexpr uint32_t DDPF_ALPHAPIXELS = 0x1;
+  constexpr uint32_t DDPF_RGB         = 0x40;
+  constexpr uint32_t DDPF_LUMINANCE   = 0x20000;
+
+  LoadDds::DDS_PIXELFORMAT Masks(const uint32_t t_flags,
+                                 const uint32_t t_bitCount,
+                                 const uint32_t t_r,
+                                 const uint32_t t_g,
+                                 const uint32_t t_b,
+                                 const uint32_t t_a) {
+    return {32, t_flags, 0, t_bitCount, t_r, t_g, t_b, t_a};
+  }
+
+  uint32_t FourCC(const char (&t_code)[5]) {
+    return static_cast<uint32_t>(t_code[0]) | static_cast<uint32_t>(t_code[1]) << 8 |
+           static_cast<uint32_t>(t_code[2]) << 16 | static_cast<uint32_t>(t_code[3]) << 24;
+  }
+}
+
+TEST(Formats, TableIsIndexedByFormat) {
+  for (size_t i = 0; i < static_cast<size_t>(Format::Count); ++i) {
+    EXPECT_EQ(static_cast<size_t>(Dds::GetFormatInfo(static_cast<Format>(i)).format), i);
+  }
+}
+
+TEST(Formats, DxgiRoundTrips) {
+  for (size_t i = 1; i < static_cast<size_t>(Format::Count); ++i) {
+    const auto     format     = static_cast<Format>(i);
+    const uint32_t dxgiFormat = Dds::GetDxgiFormat(format);
+    if (dxgiFormat == 0) {
+      EXPECT_EQ(format, Format::BGR8) << "only BGR8 lacks a DXGI format";
+      continue;
+    }
+
+    bool                    srgb = true;
+    const Dds::FORMAT_INFO* info = Dds::FindDxgiFormat(dxgiFormat, srgb);
+    ASSERT_NE(info, nullptr) << Dds::GetFormatInfo(format).name;
+    EXPECT_EQ(info->format, format);
+    EXPECT_FALSE(srgb);
+  }
+}
+
+TEST(Formats, SrgbVariants) {
+  for (const Format format : {Format::BC1, Format::BC2, Format::BC3, Format::BC7, Format::RGBA8, Format::BGRA8}) {
+    const uint32_t dxgiFormat = Dds::GetDxgiFormat(format, true);
+    ASSERT_NE(dxgiFormat, 0u) << Dds::GetFormatInfo(format).name;
+    EXPECT_NE(dxgiFormat, Dds::GetDxgiFormat(format));
+
+    bool srgb = false;
+    ASSERT_NE(Dds::FindDxgiFormat(dxgiFormat, srgb), nullptr);
+    EXPECT_TRUE(srgb);
+    EXPECT_NE(Dds::GetFormatInfo(format).glSrgbInternalFormat, 0u);
+  }
+  EXPECT_EQ(Dds::GetDxgiFormat(Format::BC4, true), 0u);
+}
+
+TEST(Formats, TypelessResolvesToTheTypedFormat) {
+  bool srgb = false;
+  EXPECT_EQ(Dds::FindDxgiFormat(DXGI_FORMAT_BC1_TYPELESS, srgb)->format, Format::BC1);
+  EXPECT_EQ(Dds::FindDxgiFormat(DXGI_FORMAT_BC7_TYPELESS, srgb)->format, Format::BC7);
+  EXPECT_EQ(Dds::FindDxgiFormat(DXGI_FORMAT_R8G8B8A8_TYPELESS, srgb)->format, Format::RGBA8);
+}
+
+TEST(Formats, UnsupportedDxgiFormats) {
+  bool srgb = false;
+  EXPECT_EQ(Dds::FindDxgiFormat(DXGI_FORMAT_UNKNOWN, srgb), nullptr);
+  EXPECT_EQ(Dds::FindDxgiFormat(DXGI_FORMAT_R11G11B10_FLOAT, srgb), nullptr);
+  EXPECT_EQ(Dds::FindDxgiFormat(DXGI_FORMAT_NV12, srgb), nullptr);
+  EXPECT_EQ(Dds::FindDxgiFormat(DXGI_FORMAT_A4B4G4R4_UNORM, srgb), nullptr);
+  EXPECT_EQ(Dds::FindDxgiFormat(0xFFFFFFFF, srgb), nullptr);
+}
+
+TEST(Formats, FourCC) {
+  EXPECT_EQ(Dds::FindFourCC(FourCC("DXT1"))->format, Format::BC1);
+  EXPECT_EQ(Dds::FindFourCC(FourCC("DXT2"))->format, Format::BC2);
+  EXPECT_EQ(Dds::FindFourCC(FourCC("DXT5"))->format, Format::BC3);
+  EXPECT_EQ(Dds::FindFourCC(FourCC("ATI1"))->format, Format::BC4);
+  EXPECT_EQ(Dds::FindFourCC(FourCC("BC4S"))->format, Format::BC4_S);
+  EXPECT_EQ(Dds::FindFourCC(FourCC("ATI2"))->format, Format::BC5);
+  EXPECT_EQ(Dds::FindFourCC(113)->format, Format::RGBA16F);
+  EXPECT_EQ(Dds::FindFourCC(116)->format, Format::RGBA32F);
+  EXPECT_EQ(Dds::FindFourCC(FourCC("DX10")), nullptr);
+  EXPECT_EQ(Dds::FindFourCC(FourCC("UYVY")), nullptr);
+}
+
+TEST(Formats, PixelMasks) {
+  EXPECT_EQ(Dds::FindPixelMasks(Masks(DDPF_RGB | DDPF_ALPHAPIXELS, 32, 0xFF0000, 0xFF00, 0xFF, 0xFF000000))->format, Format::BGRA8);
+  EXPECT_EQ(Dds::FindPixelMasks(Masks(DDPF_RGB | DDPF_ALPHAPIXELS, 32, 0xFF, 0xFF00, 0xFF0000, 0xFF000000))->format, Format::RGBA8);
+  EXPECT_EQ(Dds::FindPixelMasks(Masks(DDPF_RGB, 24, 0xFF0000, 0xFF00, 0xFF, 0))->format, Format::BGR8);
+  EXPECT_EQ(Dds::FindPixelMasks(Masks(DDPF_RGB, 16, 0xF800, 0x7E0, 0x1F, 0))->format, Format::B5G6R5);
+  EXPECT_EQ(Dds::FindPixelMasks(Masks(DDPF_LUMINANCE, 8, 0xFF, 0, 0, 0))->format, Format::R8);
+  EXPECT_EQ(Dds::FindPixelMasks(Masks(DDPF_RGB, 32, 0xFF, 0xFF, 0xFF, 0)), nullptr);
+}
+
+TEST(Formats, UnflaggedAlphaMaskIsIgnored) {
+  // writers leave the alpha mask of opaque formats set now and then
+  EXPECT_EQ(Dds::FindPixelMasks(Masks(DDPF_RGB, 32, 0xFF0000, 0xFF00, 0xFF, 0xFF000000))->format, Format::BGRX8);
+}
+
+TEST(Formats, SurfaceSize) {
+  EXPECT_EQ(Dds::GetFormatInfo(Format::BC1).SurfaceSize(1, 1), 8u);
+  EXPECT_EQ(Dds::GetFormatInfo(Format::BC1).SurfaceSize(5, 4), 16u);
+  EXPECT_EQ(Dds::GetFormatInfo(Format::BC7).SurfaceSize(5, 5), 64u);
+  EXPECT_EQ(Dds::GetFormatInfo(Format::RGBA8).SurfaceSize(3, 2), 24u);
+  EXPECT_EQ(Dds::GetFormatInfo(Format::BGR8).SurfaceSize(3, 3), 27u);
+  EXPECT_EQ(Dds::GetFormatInfo(Format::RGBA32F).SurfaceSize(2, 2), 64u);
+}
+
+TEST(Formats, CompressedFormatsHaveFourByFourBlocks) {
+  for (size_t i = 1; i < static_cast<size_t>(Format::Count); ++i) {
+    const Dds::FORMAT_INFO& info = Dds::GetFormatInfo(static_cast<Format>(i));
+    if (info.Compressed()) {
+      EXPECT_EQ(info.blockWidth, 4);
+      EXPECT_EQ(info.blockHeight, 4);
+      EXPECT_TRUE(info.blockBytes == 8 || info.blockBytes == 16) << info.name;
+    }
+    else {
+      EXPECT_EQ(info.flag, Dds::Flag::Uncompressed) << info.name;
+      EXPECT_NE(info.glPixelFormat, 0u) << info.name;
+    }
+    EXPECT_NE(info.glInternalFormat, 0u) << info.name;
+  }
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "TestSupport.h"
+#include "dds/HotReloader.h"
+
+namespace
+{
+  using Dds::Format;
+  using Dds::Bench::Layout;
+  using Dds::Bench::TEXTURE_DESC;
+  using Dds::Test::ExpectSamePayload;
+  using Dds::Test::TestDirectory;
+  using Dds::Test::WriteFile;
+  using namespace std::chrono_literals;
+
+  // the tests below reload by hand, a watch thread that never scans keeps out of their way
+  Dds::WATCH_OPTIONS ManualOptions() {
+    Dds::WATCH_OPTIONS options;
+    options.forcePolling = true;
+    options.pollInterval = 1h;
+    return options;
+  }
+
+  using HotReloader = Dds::Test::TempDirectoryTest;
+}
+
+TEST_F(HotReloader, SkipsNoOpSavesAndReloadsOnlyChangedLevels) {
+  const TEXTURE_DESC     desc{Format::BC1, 64, true, Layout::Cubemap};
+  const std::string      path = (TestDirectory() / "cube.dds").string();
+  std::vector<std::byte> file = Dds::Bench::MakeDds(desc, 1);
+  WriteFile(path, file);
+
+  Dds::LoadOptions options;
+  options.flipVertical = true;
+  Dds::WATCH_OPTIONS watch = ManualOptions();
+  watch.load               = options;
+
+  size_t           hooks = 0;
+  Dds::HotReloader reloader([&](const Dds::HotReloader::RELOAD&)
+  {
+    ++hooks;
+  }, watch);
+  ASSERT_TRUE(reloader.Watch(TestDirectory().string()).Ok());
+
+  const Dds::HotReloader::TexturePtr initial = reloader.Get(path);
+  ASSERT_NE(initial, nullptr);
+  ExpectSamePayload(*initial, *LoadDds::TextureLoadDds(path.c_str(), options));
+
+  // saved as it was
+  const Dds::Result<Dds::HotReloader::RELOAD> unchanged = reloader.Reload(path);
+  ASSERT_TRUE(unchanged);
+  EXPECT_EQ(unchanged->changedMips, 0u);
+  EXPECT_EQ(unchanged->texture, initial);
+  EXPECT_EQ(hooks, 0u);
+
+  // one byte of level 2 in the last face
+  const LoadDds::DDS_INFO info   = *LoadDds::ProbeDds(std::span<const std::byte>(file));
+  const uint64_t          offset = info.payloadOffset + 5 * info.fileLayerStride + info.mipMaps[0].layerSize + info.mipMaps[1].layerSize;
+  file[offset] ^= std::byte{0xFF};
+  WriteFile(path, file);
+
+  const Dds::Result<Dds::HotReloader::RELOAD> changed = reloader.Reload(path);
+  ASSERT_TRUE(changed);
+  EXPECT_EQ(changed->changedMips, 1u << 2);
+  EXPECT_FALSE(changed->layoutChanged);
+  EXPECT_EQ(hooks, 1u);
+  EXPECT_EQ(reloader.Get(path), changed->texture);
+  ExpectSamePayload(*changed->texture, *LoadDds::TextureLoadDds(path.c_str(), options));
+
+  // whoever held the old texture still has it as it was
+  ExpectSamePayload(*initial, *LoadDds::TextureLoadDds(std::span<const std::byte>(Dds::Bench::MakeDds(desc, 1)), options));
+}
+
+TEST_F(HotReloader, NewLayoutIsAFullLoad) {
+  const std::string path = (TestDirectory() / "texture.dds").string();
+  WriteFile(path, Dds::Bench::MakeDds({Format::BC3, 32}, 1));
+
+  Dds::HotReloader reloader({}, ManualOptions());
+  ASSERT_TRUE(reloader.Watch(TestDirectory().string()).Ok());
+  ASSERT_EQ(reloader.Get(path)->mipMaps.size(), 6u);
+
+  WriteFile(path, Dds::Bench::MakeDds({Format::BC7, 64}, 2));
+  const Dds::Result<Dds::HotReloader::RELOAD> reload = reloader.Reload(path);
+  ASSERT_TRUE(reload);
+  EXPECT_TRUE(reload->layoutChanged);
+  EXPECT_EQ(reload->changedMips, (1u << 7) - 1);
+  EXPECT_EQ(reload->texture->format, Format::BC7);
+  ExpectSamePayload(*reloader.Get(path), *LoadDds::TextureLoadDds(path.c_str()));
+}
+
+TEST_F(HotReloader, FailuresKeepThePublishedTexture) {
+  const std::string path = (TestDirectory() / "texture.dds").string();
+  WriteFile(path, Dds::Bench::MakeDds({Format::BC1, 32}, 1));
+
+  Dds::HotReloader reloader({}, ManualOptions());
+  EXPECT_EQ(reloader.Watch((TestDirectory() / "missing").string()).error, Dds::Error::OpenFailed);
+  ASSERT_TRUE(reloader.Watch(TestDirectory().string()).Ok());
+  const Dds::HotReloader::TexturePtr initial = reloader.Get(path);
+  ASSERT_NE(initial, nullptr);
+
+  // a save that was cut short
+  std::vector<std::byte> file = Dds::Bench::MakeDds({Format::BC1, 32}, 2);
+  file.resize(file.size() - 8);
+  WriteFile(path, file);
+  EXPECT_EQ(reloader.Reload(path).Status().error, Dds::Error::TruncatedMip);
+  EXPECT_EQ(reloader.Get(path), initial);
+  EXPECT_EQ(reloader.Get((TestDirectory() / "other.dds").string()), nullptr);
+}
+
+TEST_F(HotReloader, PicksUpChangesInTheBackground) {
+  const std::filesystem::path path = TestDirectory() / "texture.dds";
+  WriteFile(path, Dds::Bench::MakeDds({Format::BC1, 32}, 1));
+
+  Dds::WATCH_OPTIONS polling;
+  polling.forcePolling = true;
+  polling.pollInterval = 10ms;
+
+  for (const Dds::WATCH_OPTIONS& options : {Dds::WATCH_OPTIONS{}, polling}) {
+    std::mutex               mutex;
+    std::condition_variable  reloaded;
+    std::vector<std::string> paths;
+    Dds::HotReloader         reloader([&](const Dds::HotReloader::RELOAD& t_reload)
+    {
+      const std::lock_guard lock(mutex);
+      paths.push_back(t_reload.path);
+      reloaded.notify_all();
+    }, options);
+    ASSERT_TRUE(reloader.Watch(TestDirectory().string()).Ok());
+#if defined(__linux__)
+    if (!options.forcePolling) {
+      EXPECT_EQ(reloader.ActiveBackend(), Dds::HotReloader::Backend::Inotify);
+    }
+#endif
+
+    // rewritten in place, then a new file renamed into place the way editors save
+    const uint64_t seed = options.forcePolling ? 4 : 3;
+    WriteFile(path, Dds::Bench::MakeDds({Format::BC1, 64}, seed));
+    WriteFile(TestDirectory() / "added.tmp", Dds::Bench::MakeDds({Format::BC3, 16}, seed));
+    std::filesystem::rename(TestDirectory() / "added.tmp", TestDirectory() / "added.dds");
+
+    const std::string added = (TestDirectory() / "added.dds").string();
+    std::unique_lock  lock(mutex);
+    ASSERT_TRUE(reloaded.wait_for(lock, 5s, [&]
+    {
+      return std::find(paths.begin(), paths.end(), path.string()) != paths.end() &&
+             std::find(paths.begin(), paths.end(), added) != paths.end();
+    }));
+    lock.unlock();
+    ASSERT_NE(reloader.Get(added), nullptr);
+    ExpectSamePayload(*reloader.Get(path.string()), *LoadDds::TextureLoadDds(path.string().c_str()));
+
+    std::filesystem::remove(TestDirectory() / "added.dds");
+    WriteFile(path, Dds::Bench::MakeDds({Format::BC1, 32}, 1));
+  }
+}
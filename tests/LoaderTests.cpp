@@ -0,0 +1,359 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "TestSupport.h"
+#include "dds/DDSLoader.h"
+
+namespace
+{
+  using Dds::Format;
+  using Dds::Bench::Layout;
+  using Dds::Bench::TEXTURE_DESC;
+  using Dds::Test::Bytes;
+  using Dds::Test::TestDirectory;
+  using Dds::Test::WriteTexture;
+
+  // byte offset of level t_mip of layer t_layer in the file's payload, layers store whole mip chains
+  size_t FileOffset(const TEXTURE_DESC& t_desc, const uint32_t t_mip, const uint32_t t_layer) {
+    const Dds::FORMAT_INFO& info   = Dds::GetFormatInfo(t_desc.format);
+    size_t                  offset = t_layer * (t_desc.PayloadSize() / t_desc.LayerCount());
+    for (uint32_t mip = 0; mip < t_mip; ++mip) {
+      const uint32_t extent = std::max(1u, t_desc.size >> mip);
+      offset += info.SurfaceSize(extent, extent);
+    }
+    return offset;
+  }
+
+  const std::byte* Payload(const std::vector<std::byte>& t_file, const TEXTURE_DESC& t_desc) {
+    return t_file.data() + t_file.size() - t_desc.PayloadSize();
+  }
+
+  // the block rows of t_region cut out of a full load with the same options
+  std::vector<std::byte> Crop(const LoadDds::DDS_FILE& t_full, const LoadDds::REGION& t_region) {
+    const Dds::FORMAT_INFO&    info     = Dds::GetFormatInfo(t_full.format);
+    const LoadDds::MIP_LEVEL&  level    = t_full.mipMaps[t_region.mip - t_full.firstMip];
+    const std::span<std::byte> layer    = t_full.LayerData(t_region.mip - t_full.firstMip, t_region.layer);
+    const size_t               rowPitch = info.SurfaceSize(level.width, 1);
+    const size_t               rowBytes = info.SurfaceSize(t_region.width, 1);
+    const size_t               rows     = (t_region.height + info.blockHeight - 1) / info.blockHeight;
+
+    std::vector<std::byte> crop;
+    for (size_t row = 0; row < rows; ++row) {
+      const std::byte* source = layer.data() + (t_region.y / info.blockHeight + row) * rowPitch +
+                                t_region.x / info.blockWidth * info.blockBytes;
+      crop.insert(crop.end(), source, source + rowBytes);
+    }
+    return crop;
+  }
+
+  void ExpectRegion(const Dds::Result<LoadDds::DDS_FILE>& t_region, const std::vector<std::byte>& t_expected) {
+    ASSERT_TRUE(t_region);
+    ASSERT_EQ(t_region->totalSizeBytes, t_expected.size());
+    EXPECT_EQ(std::memcmp(t_region->data.data(), t_expected.data(), t_expected.size()), 0);
+  }
+}
+
+TEST(Loader, EveryFormatAndLayout) {
+  for (const TEXTURE_DESC& desc : Dds::Bench::CorpusDescs(16, 64, SIZE_MAX)) {
+    SCOPED_TRACE(desc.Name());
+    const std::vector<std::byte> file    = Dds::Bench::MakeDds(desc);
+    const LoadDds::DDS_FILE      ddsFile = *LoadDds::TextureLoadDds(Bytes(file));
+
+    ASSERT_EQ(ddsFile.mipMaps.size(), desc.MipCount());
+    EXPECT_EQ(ddsFile.format, desc.format);
+    EXPECT_EQ(ddsFile.LayerCount(), desc.LayerCount());
+    EXPECT_EQ(ddsFile.totalSizeBytes, desc.PayloadSize());
+    EXPECT_EQ(ddsFile.glFormat != 0, true);
+
+    // levels are regrouped so every layer of a level sits back to back
+    for (uint32_t mip = 0; mip < desc.MipCount(); ++mip) {
+      for (uint32_t layer = 0; layer < desc.LayerCount(); ++layer) {
+        const std::span<std::byte> layerData = ddsFile.LayerData(mip, layer);
+        ASSERT_EQ(std::memcmp(layerData.data(), Payload(file, desc) + FileOffset(desc, mip, layer), layerData.size()), 0)
+          << "mip " << mip << " layer " << layer;
+      }
+    }
+  }
+}
+
+TEST(Loader, MipDimensions) {
+  const TEXTURE_DESC      desc{Format::BC1, 64};
+  const LoadDds::DDS_FILE ddsFile = *LoadDds::TextureLoadDds(Bytes(Dds::Bench::MakeDds(desc)));
+
+  ASSERT_EQ(ddsFile.mipMaps.size(), 7u);
+  for (size_t mip = 0; mip < ddsFile.mipMaps.size(); ++mip) {
+    EXPECT_EQ(ddsFile.mipMaps[mip].width, 64u >> mip);
+    EXPECT_EQ(ddsFile.mipMaps[mip].height, 64u >> mip);
+    // a level smaller than a block still takes a whole block
+    EXPECT_EQ(ddsFile.mipMaps[mip].size, std::max<size_t>(8, (64u >> mip) * (64u >> mip) / 2));
+  }
+}
+
+TEST(Loader, SrgbFollowsTheDxgiFormat) {
+  const TEXTURE_DESC     desc{Format::BC7, 16};
+  std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+  EXPECT_EQ(LoadDds::TextureLoadDds(Bytes(file))->glFormat, Dds::GetFormatInfo(Format::BC7).glInternalFormat);
+
+  const uint32_t srgb = Dds::GetDxgiFormat(Format::BC7, true);
+  std::memcpy(file.data() + 128, &srgb, sizeof(srgb));
+  EXPECT_EQ(LoadDds::TextureLoadDds(Bytes(file))->glFormat, Dds::GetFormatInfo(Format::BC7).glSrgbInternalFormat);
+}
+
+TEST(Loader, MipRange) {
+  const TEXTURE_DESC           desc{Format::RGBA8, 64};
+  const std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+
+  Dds::LoadOptions options;
+  options.firstMip = 2;
+  options.mipCount = 2;
+
+  const LoadDds::DDS_FILE ddsFile = *LoadDds::TextureLoadDds(Bytes(file), options);
+  ASSERT_EQ(ddsFile.mipMaps.size(), 2u);
+  EXPECT_EQ(ddsFile.firstMip, 2u);
+  EXPECT_EQ(ddsFile.header.dwWidth, 16u);
+  EXPECT_EQ(ddsFile.header.dwMipMapCount, 2u);
+  EXPECT_EQ(ddsFile.totalSizeBytes, (16u * 16 + 8 * 8) * 4);
+  EXPECT_EQ(std::memcmp(ddsFile.data.data(), Payload(file, desc) + FileOffset(desc, 2, 0), ddsFile.totalSizeBytes), 0);
+}
+
+TEST(Loader, FileStoragesMatchMemory) {
+  const TEXTURE_DESC           desc{Format::BC3, 128, true, Layout::Cubemap};
+  const std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+  const std::string            path = WriteTexture(desc, "texture.dds");
+  ASSERT_FALSE(path.empty());
+
+  const LoadDds::DDS_FILE reference = *LoadDds::TextureLoadDds(Bytes(file));
+  for (const Dds::Storage storage : {Dds::Storage::Heap, Dds::Storage::Mapped}) {
+    Dds::LoadOptions options;
+    options.storage = storage;
+
+    const LoadDds::DDS_FILE ddsFile = *LoadDds::TextureLoadDds(path.c_str(), options);
+    ASSERT_EQ(ddsFile.totalSizeBytes, reference.totalSizeBytes);
+    EXPECT_EQ(std::memcmp(ddsFile.data.data(), reference.data.data(), reference.totalSizeBytes), 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ddsFile.data.data()) % LoadDds::PAYLOAD_ALIGNMENT, 0u);
+  }
+}
+
+TEST(Loader, BorrowedStoragePointsIntoTheInput) {
+  const TEXTURE_DESC           desc{Format::BC1, 32};
+  const std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+
+  Dds::LoadOptions options;
+  options.storage = Dds::Storage::Borrowed;
+
+  const LoadDds::DDS_FILE ddsFile = *LoadDds::TextureLoadDds(Bytes(file), options);
+  EXPECT_EQ(ddsFile.data.data(), Payload(file, desc));
+}
+
+TEST(Loader, CallerDestinationAndReadAt) {
+  const TEXTURE_DESC           desc{Format::BC5, 64, true, Layout::Array};
+  const std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+  const std::string            path = WriteTexture(desc, "texture.dds");
+  const LoadDds::DDS_FILE      reference = *LoadDds::TextureLoadDds(Bytes(file));
+
+  const LoadDds::PAYLOAD_REQUIREMENTS requirements = *LoadDds::QueryPayloadRequirements(path.c_str());
+  ASSERT_EQ(requirements.size, desc.PayloadSize());
+
+  Dds::AlignedBuffer      destination(requirements.size, requirements.alignment);
+  const LoadDds::DDS_FILE intoDestination = *LoadDds::TextureLoadDds(path.c_str(), std::span(destination.Data(), destination.Size()));
+  ASSERT_EQ(intoDestination.data.data(), destination.Data());
+  EXPECT_EQ(std::memcmp(destination.Data(), reference.data.data(), requirements.size), 0);
+
+  const LoadDds::ReadAtFn readAt = [&](const uint64_t t_offset, const std::span<std::byte> t_destination)
+  {
+    if (t_offset + t_destination.size() > file.size()) {
+      return false;
+    }
+    std::memcpy(t_destination.data(), file.data() + t_offset, t_destination.size());
+    return true;
+  };
+  const LoadDds::DDS_FILE throughReadAt = *LoadDds::TextureLoadDds(readAt);
+  ASSERT_EQ(throughReadAt.totalSizeBytes, reference.totalSizeBytes);
+  EXPECT_EQ(std::memcmp(throughReadAt.data.data(), reference.data.data(), reference.totalSizeBytes), 0);
+}
+
+TEST(Loader, ProbeMatchesLoad) {
+  const TEXTURE_DESC           desc{Format::RGBA16F, 32, true, Layout::Cubemap};
+  const std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+
+  const LoadDds::DDS_INFO info    = *LoadDds::ProbeDds(Bytes(file).first(148));
+  const LoadDds::DDS_FILE ddsFile = *LoadDds::TextureLoadDds(Bytes(file));
+  ASSERT_EQ(info.mipMaps.size(), ddsFile.mipMaps.size());
+  EXPECT_EQ(info.totalSizeBytes, ddsFile.totalSizeBytes);
+  EXPECT_EQ(info.faceCount, 6u);
+  EXPECT_EQ(info.format, Format::RGBA16F);
+}
+
+TEST(Loader, StreamInAndEvict) {
+  const TEXTURE_DESC desc{Format::BC7, 128};
+  const std::string  path = WriteTexture(desc, "texture.dds");
+  ASSERT_FALSE(path.empty());
+  const LoadDds::DDS_FILE reference = *LoadDds::TextureLoadDds(path.c_str());
+
+  Dds::LoadOptions options;
+  options.firstMip          = 3;
+  LoadDds::DDS_FILE ddsFile = *LoadDds::TextureLoadDds(path.c_str(), options);
+  ASSERT_EQ(ddsFile.mipMaps.size(), 5u);
+
+  ASSERT_TRUE(LoadDds::StreamInMips(path.c_str(), ddsFile, 0).Ok());
+  ASSERT_EQ(ddsFile.mipMaps.size(), reference.mipMaps.size());
+  ASSERT_EQ(ddsFile.totalSizeBytes, reference.totalSizeBytes);
+  EXPECT_EQ(std::memcmp(ddsFile.data.data(), reference.data.data(), reference.totalSizeBytes), 0);
+
+  ASSERT_TRUE(LoadDds::EvictMips(ddsFile, 2).Ok());
+  EXPECT_EQ(ddsFile.firstMip, 2u);
+  EXPECT_EQ(ddsFile.mipMaps[0].width, 32u);
+  EXPECT_EQ(std::memcmp(ddsFile.MipData(0).data(), reference.MipData(2).data(), ddsFile.MipData(0).size()), 0);
+}
+
+TEST(Loader, TruncatedPayloadFails) {
+  std::vector<std::byte> file = Dds::Bench::MakeDds({Format::BC1, 64});
+  file.resize(file.size() - 1);
+
+  // the last level (1x1, file level 6) is the one cut short
+  const Dds::Result<LoadDds::DDS_FILE> ddsFile = LoadDds::TextureLoadDds(Bytes(file));
+  ASSERT_FALSE(ddsFile.Ok());
+  EXPECT_EQ(ddsFile.Status().error, Dds::Error::TruncatedMip);
+  EXPECT_EQ(ddsFile.Status().detail, 6u);
+}
+
+TEST(Loader, ErrorsAreReported) {
+  const std::string missing = (TestDirectory() / "missing.dds").string();
+  EXPECT_EQ(LoadDds::TextureLoadDds(missing.c_str()).Status().error, Dds::Error::OpenFailed);
+  EXPECT_EQ(LoadDds::ProbeDds(missing.c_str()).Status().error, Dds::Error::OpenFailed);
+
+  std::vector<std::byte> file       = Dds::Bench::MakeDds({Format::BC1, 16});
+  const uint32_t         dxgiFormat = DXGI_FORMAT_R11G11B10_FLOAT;
+  std::memcpy(file.data() + 128, &dxgiFormat, sizeof(dxgiFormat));
+  const Dds::STATUS unsupported = LoadDds::TextureLoadDds(Bytes(file)).Status();
+  EXPECT_EQ(unsupported.error, Dds::Error::UnsupportedFormat);
+  EXPECT_EQ(unsupported.detail, static_cast<uint32_t>(DXGI_FORMAT_R11G11B10_FLOAT));
+
+  std::vector<std::byte> notDds(256);
+  EXPECT_EQ(LoadDds::TextureLoadDds(Bytes(notDds)).Status().error, Dds::Error::BadMagic);
+  EXPECT_EQ(LoadDds::TextureLoadDds(Bytes(file).first(100)).Status().error, Dds::Error::TruncatedHeader);
+
+  Dds::LoadOptions mapped;
+  mapped.storage = Dds::Storage::Mapped;
+  EXPECT_EQ(LoadDds::TextureLoadDds(Bytes(notDds), mapped).Status().error, Dds::Error::BadMagic);
+
+  Dds::LoadOptions pastTheChain;
+  pastTheChain.firstMip = 5;
+  const Dds::STATUS range = LoadDds::TextureLoadDds(Bytes(Dds::Bench::MakeDds({Format::BC1, 16})), pastTheChain).Status();
+  EXPECT_EQ(range.error, Dds::Error::InvalidMipRange);
+  EXPECT_EQ(range.detail, 5u);
+}
+
+TEST(Loader, LogHookSeesEveryFailureOnce) {
+  static std::vector<Dds::STATUS> logged;
+  logged.clear();
+  const Dds::LogFn previous = Dds::SetLogHook([](const Dds::STATUS& t_status, const char*)
+  {
+    logged.push_back(t_status);
+  });
+
+  std::vector<std::byte> file = Dds::Bench::MakeDds({Format::BC7, 32});
+  EXPECT_TRUE(LoadDds::TextureLoadDds(Bytes(file)).Ok());
+  file.resize(200);
+  EXPECT_FALSE(LoadDds::TextureLoadDds(Bytes(file)).Ok());
+  EXPECT_FALSE(LoadDds::ProbeDds(Bytes(file).first(3)).Ok());
+
+  Dds::SetLogHook(previous);
+  ASSERT_EQ(logged.size(), 2u);
+  EXPECT_EQ(logged[0].error, Dds::Error::TruncatedMip);
+  EXPECT_EQ(logged[1].error, Dds::Error::BadMagic);
+  EXPECT_STRNE(Dds::ErrorMessage(logged[0].error), Dds::ErrorMessage(Dds::Error::Count));
+}
+
+TEST(Loader, StrictValidation) {
+  std::vector<std::byte> file = Dds::Bench::MakeDds({Format::BC1, 64});
+  Dds::LoadOptions       options;
+  options.validation = Dds::Validation::Strict;
+  EXPECT_TRUE(LoadDds::TextureLoadDds(Bytes(file), options).Ok());
+
+  // trailing bytes are only an error for strict loads
+  file.resize(file.size() + 16);
+  EXPECT_TRUE(LoadDds::TextureLoadDds(Bytes(file)).Ok());
+  EXPECT_EQ(LoadDds::TextureLoadDds(Bytes(file), options).Status().error, Dds::Error::TrailingData);
+
+  // 8 levels on a 64x64 texture is one more than the full chain
+  file.resize(file.size() - 16);
+  const uint32_t mipCount = 8;
+  std::memcpy(file.data() + 28, &mipCount, sizeof(mipCount));
+  EXPECT_EQ(LoadDds::TextureLoadDds(Bytes(file), options).Status().error, Dds::Error::InvalidMipCount);
+}
+
+TEST(Loader, Regions) {
+  const TEXTURE_DESC desc{Format::BC7, 128, true, Layout::Array};
+  const std::string  path = WriteTexture(desc, "texture.dds");
+  ASSERT_FALSE(path.empty());
+  const std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+
+  Dds::LoadOptions mapped;
+  mapped.storage = Dds::Storage::Mapped;
+  Dds::LoadOptions flipped;
+  flipped.flipVertical = true;
+
+  const LoadDds::DDS_FILE full        = *LoadDds::TextureLoadDds(path.c_str());
+  const LoadDds::DDS_FILE fullFlipped = *LoadDds::TextureLoadDds(path.c_str(), flipped);
+
+  // inside the level, the whole width (a single read) and a 2x2 level that ends inside its only block
+  const LoadDds::REGION regions[] = {{1, 2, 0, 16, 24, 32, 8}, {0, 3, 0, 0, 64, 128, 16}, {6, 1, 0, 0, 0, 2, 2}};
+  for (const LoadDds::REGION& region : regions) {
+    SCOPED_TRACE(region.mip);
+    const std::vector<std::byte> expected = Crop(full, region);
+    ExpectRegion(LoadDds::LoadRegion(path.c_str(), region), expected);
+    ExpectRegion(LoadDds::LoadRegion(path.c_str(), region, mapped), expected);
+    ExpectRegion(LoadDds::LoadRegion(Bytes(file), region), expected);
+    ExpectRegion(LoadDds::LoadRegion(path.c_str(), region, flipped), Crop(fullFlipped, region));
+  }
+
+  // the region is a plain 2D texture of its own
+  const auto region = LoadDds::LoadRegion(path.c_str(), regions[0]);
+  ASSERT_TRUE(region);
+  EXPECT_EQ(region->header.dwWidth, 32u);
+  EXPECT_EQ(region->header.dwHeight, 8u);
+  EXPECT_EQ(region->firstMip, 1u);
+  EXPECT_EQ(region->LayerCount(), 1u);
+  ASSERT_EQ(region->mipMaps.size(), 1u);
+  EXPECT_EQ(region->mipMaps[0].size, 8u * 2 * 16);
+}
+
+TEST(Loader, FlippedRegionsOfPartialLevels) {
+  // 10x10 and 5x5 levels: re-encoded, their flipped rows straddle one more block row of the file than
+  // they cover, with whole block rows reversed they map to block rows like any other level
+  const TEXTURE_DESC desc{Format::BC1, 40, true, Layout::Array};
+  const std::string  path = WriteTexture(desc, "texture.dds");
+  ASSERT_FALSE(path.empty());
+
+  for (const Dds::PartialFlip partialFlip : {Dds::PartialFlip::BlockRows, Dds::PartialFlip::Reencode}) {
+    Dds::LoadOptions flipped;
+    flipped.flipVertical                = true;
+    flipped.partialFlip                 = partialFlip;
+    const LoadDds::DDS_FILE fullFlipped = *LoadDds::TextureLoadDds(path.c_str(), flipped);
+
+    const LoadDds::REGION regions[] = {{2, 0, 0, 0, 4, 8, 4}, {2, 0, 0, 4, 8, 6, 2}, {2, 0, 0, 0, 0, 10, 10}, {3, 0, 0, 0, 0, 5, 5}};
+    for (const LoadDds::REGION& region : regions) {
+      SCOPED_TRACE(testing::Message() << static_cast<int>(partialFlip) << ' ' << region.mip << ' ' << region.y);
+      ExpectRegion(LoadDds::LoadRegion(path.c_str(), region, flipped), Crop(fullFlipped, region));
+    }
+  }
+}
+
+TEST(Loader, InvalidRegions) {
+  const std::vector<std::byte> file = Dds::Bench::MakeDds({Format::BC1, 64, true, Layout::Cubemap});
+
+  // misaligned, past the edge, empty, a seventh face and a level the file does not have
+  const LoadDds::REGION invalid[] = {
+    {0, 0, 0, 2, 0, 4, 4}, {0, 0, 0, 0, 0, 6, 4}, {0, 0, 0, 60, 0, 8, 4}, {0, 0, 0, 0, 0, 0, 4}, {0, 6, 0, 0, 0, 4, 4}, {1, 0, 1, 0, 0, 4, 4}};
+  for (const LoadDds::REGION& region : invalid) {
+    EXPECT_EQ(LoadDds::LoadRegion(Bytes(file), region).Status().error, Dds::Error::InvalidRegion);
+  }
+  EXPECT_EQ(LoadDds::LoadRegion(Bytes(file), {7, 0, 0, 0, 0, 1, 1}).Status().error, Dds::Error::InvalidMipRange);
+}
@@ -0,0 +1,262 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "TestSupport.h"
+#include "dds/DDSWriter.h"
+#include "dds/Decoder.h"
+#include "dds/EncodeKernels.h"
+#include "dds/MipGenerator.h"
+
+namespace
+{
+  using Dds::Format;
+  using Dds::Bench::Layout;
+  using Dds::Bench::TEXTURE_DESC;
+  using Dds::Test::Bytes;
+
+  LoadDds::DDS_FILE Load(const TEXTURE_DESC& t_desc) {
+    Dds::Result<LoadDds::DDS_FILE> loaded = LoadDds::TextureLoadDds(Bytes(Dds::Bench::MakeDds(t_desc)));
+    EXPECT_TRUE(loaded.Ok());
+    return std::move(loaded).Value();
+  }
+
+  std::vector<std::byte> SaveToMemory(const LoadDds::DDS_FILE& t_ddsFile) {
+    std::vector<std::byte> file;
+    const Dds::STATUS      status = Dds::SaveDds([&](const std::span<const std::span<const std::byte>> t_pieces)
+    {
+      for (const std::span<const std::byte> piece : t_pieces) {
+        file.insert(file.end(), piece.begin(), piece.end());
+      }
+      return true;
+    }, t_ddsFile);
+    EXPECT_TRUE(status.Ok());
+    return file;
+  }
+
+  // RGBA8 texel of an uncompressed level
+  std::array<uint8_t, 4> Texel(const LoadDds::DDS_FILE& t_ddsFile, const size_t t_mip, const size_t t_x, const size_t t_y) {
+    std::array<uint8_t, 4> texel{};
+    std::memcpy(texel.data(), t_ddsFile.LayerData(t_mip, 0).data() + (t_y * t_ddsFile.mipMaps[t_mip].width + t_x) * 4, 4);
+    return texel;
+  }
+
+  int MaxDifference(const uint8_t* t_a, const uint8_t* t_b, const size_t t_texels, const size_t t_channels) {
+    int difference = 0;
+    for (size_t texel = 0; texel < t_texels; ++texel) {
+      for (size_t channel = 0; channel < t_channels; ++channel) {
+        difference = std::max(difference, std::abs(t_a[texel * 4 + channel] - t_b[texel * 4 + channel]));
+      }
+    }
+    return difference;
+  }
+}
+
+TEST(MipGenerator, EncodersRoundTripSmoothTiles) {
+  struct CASE
+  {
+    Format format;
+    size_t channels;  // channels the format stores, the rest decode to constants
+    int    tolerance; // half a palette step over the gradient's range plus endpoint quantisation
+  };
+  constexpr CASE CASES[] = {
+    {Format::BC1, 3, 24},
+    {Format::BC2, 4, 24},
+    {Format::BC3, 4, 24},
+    {Format::BC4, 1, 10},
+    {Format::BC5, 2, 10},
+    {Format::BC7, 4, 6},
+  };
+
+  // a gradient along one line, and a flat colour
+  std::array<uint8_t, 64> gradient{};
+  std::array<uint8_t, 64> flat{};
+  for (size_t texel = 0; texel < 16; ++texel) {
+    const uint8_t color[4] = {static_cast<uint8_t>(40 + 8 * texel), static_cast<uint8_t>(200 - 6 * texel),
+                              static_cast<uint8_t>(100 + 3 * texel), static_cast<uint8_t>(255 - 7 * texel)};
+    std::memcpy(gradient.data() + texel * 4, color, 4);
+    const uint8_t solid[4] = {37, 200, 91, 255};
+    std::memcpy(flat.data() + texel * 4, solid, 4);
+  }
+
+  for (const CASE& test : CASES) {
+    const Dds::EncodeKernel encode = Dds::SelectEncodeKernel(test.format);
+    ASSERT_NE(encode, nullptr);
+
+    for (const std::array<uint8_t, 64>* tile : {&gradient, &flat}) {
+      std::array<std::byte, 16> block{};
+      std::array<uint8_t, 64>   decoded{};
+      encode(reinterpret_cast<const std::byte*>(tile->data()), 1, block.data());
+      ASSERT_TRUE(Dds::Decoder::DecodeSurface(test.format, block.data(), 4, 4, reinterpret_cast<std::byte*>(decoded.data()), 16));
+
+      // a flat tile only loses the endpoint precision (5:6:5 for BC1-BC3 colour, the shared p-bit for BC7)
+      const int tolerance = tile == &flat ? 4 : test.tolerance;
+      EXPECT_LE(MaxDifference(tile->data(), decoded.data(), 16, test.channels), tolerance) << static_cast<int>(test.format);
+    }
+  }
+
+  // no encoder for BC6H, the signed formats or plain pixels
+  EXPECT_EQ(Dds::SelectEncodeKernel(Format::BC6H_UF16), nullptr);
+  EXPECT_EQ(Dds::SelectEncodeKernel(Format::BC5_S), nullptr);
+  EXPECT_EQ(Dds::SelectEncodeKernel(Format::RGBA8), nullptr);
+}
+
+TEST(MipGenerator, Bc1PunchThrough) {
+  std::array<uint8_t, 64> tile{};
+  for (size_t texel = 0; texel < 16; ++texel) {
+    const uint8_t color[4] = {200, 60, 20, static_cast<uint8_t>(texel % 2 ? 0 : 255)};
+    std::memcpy(tile.data() + texel * 4, color, 4);
+  }
+
+  std::array<std::byte, 8> block{};
+  std::array<uint8_t, 64>  decoded{};
+  Dds::SelectEncodeKernel(Format::BC1)(reinterpret_cast<const std::byte*>(tile.data()), 1, block.data());
+  ASSERT_TRUE(Dds::Decoder::DecodeSurface(Format::BC1, block.data(), 4, 4, reinterpret_cast<std::byte*>(decoded.data()), 16));
+
+  for (size_t texel = 0; texel < 16; ++texel) {
+    EXPECT_EQ(decoded[texel * 4 + 3], tile[texel * 4 + 3]) << texel;
+  }
+}
+
+TEST(MipGenerator, BoxFilterAndSaveRoundTrip) {
+  LoadDds::DDS_FILE source = Load({Format::RGBA8, 8, false});
+  ASSERT_EQ(source.mipMaps.size(), 1u);
+  // the unfiltered top level, so the result can be checked against it
+  const std::vector<std::byte> top(source.data.begin(), source.data.end());
+
+  Dds::MipGenerator              generator;
+  Dds::Result<LoadDds::DDS_FILE> result = generator.Generate(source);
+  ASSERT_TRUE(result.Ok()) << Dds::ErrorMessage(result.Status().error);
+  ASSERT_EQ(result->mipMaps.size(), Dds::MipGenerator::FullMipCount(8, 8));
+  EXPECT_EQ(result->mipMaps.size(), 4u);
+  EXPECT_EQ(result->header.dwMipMapCount, 4u);
+  EXPECT_EQ(result->mipMaps[3].width, 1u);
+  EXPECT_EQ(result->totalSizeBytes, (64u + 16 + 4 + 1) * 4);
+  EXPECT_TRUE(std::equal(top.begin(), top.end(), result->MipData(0).begin()));
+  // the source is left alone
+  EXPECT_EQ(source.mipMaps.size(), 1u);
+
+  for (size_t y = 0; y < 4; ++y) {
+    for (size_t x = 0; x < 4; ++x) {
+      const std::array<uint8_t, 4> filtered = Texel(*result, 1, x, y);
+      for (size_t channel = 0; channel < 4; ++channel) {
+        int sum = 0;
+        for (size_t dy = 0; dy < 2; ++dy) {
+          for (size_t dx = 0; dx < 2; ++dx) {
+            sum += Texel(*result, 0, x * 2 + dx, y * 2 + dy)[channel];
+          }
+        }
+        EXPECT_LE(std::abs(filtered[channel] - (sum + 2) / 4), 1) << x << ", " << y;
+      }
+    }
+  }
+
+  // a complete chain that loads back the same
+  Dds::Result<LoadDds::DDS_FILE> reloaded = LoadDds::TextureLoadDds(Bytes(SaveToMemory(*result)));
+  ASSERT_TRUE(reloaded.Ok());
+  ASSERT_EQ(reloaded->mipMaps.size(), 4u);
+  EXPECT_TRUE(std::equal(reloaded->data.begin(), reloaded->data.end(), result->data.begin(), result->data.end()));
+
+  // a shorter chain on request, the top level alone when mipCount is 1
+  Dds::MIP_OPTIONS options;
+  options.mipCount = 2;
+  EXPECT_EQ(generator.Generate(source, options)->mipMaps.size(), 2u);
+  options.mipCount = 1;
+  EXPECT_EQ(generator.Generate(source, options)->totalSizeBytes, top.size());
+}
+
+TEST(MipGenerator, FiltersSrgbInLinearLight) {
+  LoadDds::DDS_FILE source = Load({Format::RGBA8, 2, false});
+  // black and white checker with half alpha, the average of 0 and 1 in linear light is sRGB 188
+  for (size_t texel = 0; texel < 4; ++texel) {
+    const uint8_t value    = texel == 0 || texel == 3 ? 255 : 0;
+    const uint8_t color[4] = {value, value, value, value};
+    std::memcpy(source.data.data() + texel * 4, color, 4);
+  }
+
+  Dds::MipGenerator generator(1);
+  const auto        linear = generator.Generate(source);
+  ASSERT_TRUE(linear.Ok());
+  EXPECT_EQ(Texel(*linear, 1, 0, 0), (std::array<uint8_t, 4>{128, 128, 128, 128}));
+
+  source.glFormat = Dds::GetFormatInfo(Format::RGBA8).glSrgbInternalFormat;
+  const auto srgb = generator.Generate(source);
+  ASSERT_TRUE(srgb.Ok());
+  // alpha is never linearised
+  EXPECT_EQ(Texel(*srgb, 1, 0, 0), (std::array<uint8_t, 4>{188, 188, 188, 128}));
+}
+
+TEST(MipGenerator, EveryLayerOfBlockFormats) {
+  struct CASE
+  {
+    TEXTURE_DESC desc;
+    size_t       channels;  // BC1 alpha is a single bit, the mean of its top level would not round to it
+    int          tolerance; // of the 1x1 level against the mean of the top level
+  };
+  const CASE CASES[] = {
+    {{Format::BC7, 64, false, Layout::Cubemap}, 4, 2},
+    {{Format::BC1, 32, false, Layout::Array}, 3, 6},
+    {{Format::BC3, 16, false}, 4, 6},
+    {{Format::BC4, 16, false}, 4, 1},
+  };
+
+  Dds::MipGenerator generator;
+  for (const CASE& test : CASES) {
+    const LoadDds::DDS_FILE        source = Load(test.desc);
+    Dds::Result<LoadDds::DDS_FILE> result = generator.Generate(source);
+    ASSERT_TRUE(result.Ok()) << test.desc.Name();
+
+    // laid out like the same texture written with its mips
+    TEXTURE_DESC complete = test.desc;
+    complete.mipMaps      = true;
+    ASSERT_EQ(result->mipMaps.size(), complete.MipCount()) << test.desc.Name();
+    ASSERT_EQ(result->totalSizeBytes, complete.PayloadSize());
+    EXPECT_TRUE(std::equal(source.data.begin(), source.data.end(), result->MipData(0).begin()));
+
+    Dds::Decoder decoder(1);
+    const size_t last = result->mipMaps.size() - 1;
+    for (size_t layer = 0; layer < source.LayerCount(); ++layer) {
+      // power of two levels average every texel of the top level into the 1x1 one
+      const Dds::Decoder::IMAGE topLevel = decoder.Decode(source, 0, layer);
+      const Dds::Decoder::IMAGE bottom   = decoder.Decode(*result, last, layer);
+      ASSERT_TRUE(topLevel.Ok() && bottom.Ok());
+
+      const auto* pixels = reinterpret_cast<const uint8_t*>(topLevel.pixels.Data());
+      const auto* single = reinterpret_cast<const uint8_t*>(bottom.pixels.Data());
+      for (size_t channel = 0; channel < test.channels; ++channel) {
+        double sum = 0;
+        for (size_t texel = 0; texel < static_cast<size_t>(topLevel.width) * topLevel.height; ++texel) {
+          sum += pixels[texel * 4 + channel];
+        }
+        const double mean = sum / (topLevel.width * topLevel.height);
+        EXPECT_NEAR(single[channel], mean, test.tolerance) << test.desc.Name() << " layer " << layer << " channel " << channel;
+      }
+    }
+  }
+}
+
+TEST(MipGenerator, ParallelMatchesSingleThreaded) {
+  const LoadDds::DDS_FILE source = Load({Format::BC1, 512, false});
+
+  Dds::MipGenerator single(1);
+  Dds::MipGenerator parallel(4);
+  const auto        a = single.Generate(source);
+  const auto        b = parallel.Generate(source);
+  ASSERT_TRUE(a.Ok() && b.Ok());
+  EXPECT_TRUE(std::equal(a->data.begin(), a->data.end(), b->data.begin(), b->data.end()));
+}
+
+TEST(MipGenerator, RejectsWhatItCannotEncode) {
+  Dds::MipGenerator generator(1);
+
+  for (const Format format : {Format::BC6H_UF16, Format::BC5_S, Format::RGBA16F}) {
+    const LoadDds::DDS_FILE source = Load({format, 16, false});
+    EXPECT_EQ(generator.Generate(source).Status().error, Dds::Error::NoEncoder);
+  }
+  EXPECT_EQ(generator.Generate(LoadDds::DDS_FILE{}).Status().error, Dds::Error::InvalidMipRange);
+}
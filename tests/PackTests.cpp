@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "TestSupport.h"
+#include "dds/Pack.h"
+
+namespace
+{
+  using Dds::Format;
+  using Dds::Bench::Layout;
+  using Dds::Bench::TEXTURE_DESC;
+  using Dds::Test::TestDirectory;
+
+  std::string PackPath() {
+    return (TestDirectory() / "textures.pack").string();
+  }
+
+  const TEXTURE_DESC DESCS[] = {{Format::BC1, 64},
+                                {Format::BC7, 32, true, Layout::Array},
+                                {Format::RGBA8, 16, false},
+                                {Format::BC3, 128, true, Layout::Cubemap}};
+
+  // packs DESCS under their file names and returns the source paths in the same order
+  std::vector<std::string> BuildPack() {
+    const std::vector<std::string> paths = Dds::Bench::WriteCorpus(TestDirectory() / "sources", DESCS);
+    EXPECT_EQ(paths.size(), std::size(DESCS));
+
+    Dds::PackBuilder builder;
+    for (const std::string& path : paths) {
+      EXPECT_TRUE(builder.Add(std::filesystem::path(path).filename().string(), path.c_str()).Ok());
+    }
+    EXPECT_TRUE(builder.Write(PackPath().c_str()).Ok());
+    return paths;
+  }
+
+  using Pack = Dds::Test::TempDirectoryTest;
+}
+
+TEST_F(Pack, LoadsMatchTheSources) {
+  const std::vector<std::string> paths = BuildPack();
+
+  Dds::PackReader pack;
+  ASSERT_TRUE(pack.Open(PackPath().c_str()).Ok());
+  ASSERT_EQ(pack.Count(), paths.size());
+
+  for (const std::string& path : paths) {
+    const std::string name = std::filesystem::path(path).filename().string();
+    const uint32_t    id   = pack.Find(name);
+    ASSERT_NE(id, Dds::PackReader::INVALID_ID) << name;
+    EXPECT_EQ(pack.Name(id), name);
+
+    const auto packed = pack.Load(id);
+    const auto loaded = LoadDds::TextureLoadDds(path.c_str());
+    ASSERT_TRUE(packed) << name;
+    ASSERT_TRUE(loaded);
+    SCOPED_TRACE(name);
+    Dds::Test::ExpectSamePayload(*packed, *loaded);
+
+    // the stored file is byte for byte the source
+    const std::span<const std::byte> file = pack.FileData(id);
+    ASSERT_EQ(file.size(), std::filesystem::file_size(path));
+    std::vector<char> source(file.size());
+    std::ifstream(path, std::ios::binary).read(source.data(), static_cast<std::streamsize>(source.size()));
+    EXPECT_EQ(std::memcmp(file.data(), source.data(), source.size()), 0);
+  }
+}
+
+TEST_F(Pack, MappedLoadsPointIntoThePack) {
+  BuildPack();
+
+  Dds::PackReader pack;
+  ASSERT_TRUE(pack.Open(PackPath().c_str()).Ok());
+
+  Dds::LoadOptions options;
+  options.storage = Dds::Storage::Mapped;
+  for (uint32_t id = 0; id < pack.Count(); ++id) {
+    const auto file = pack.Load(id, options);
+    ASSERT_TRUE(file);
+    // every mip chain starts aligned, whatever the header size of the file before it
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(file->data.data()) % LoadDds::PAYLOAD_ALIGNMENT, 0u) << pack.Name(id);
+
+    const std::span<const std::byte> stored = pack.FileData(id);
+    if (file->LayerCount() == 1) {
+      EXPECT_EQ(file->data.data(), stored.data() + file->payloadOffset);
+    }
+  }
+}
+
+TEST_F(Pack, MissingNames) {
+  BuildPack();
+
+  Dds::PackReader pack;
+  ASSERT_TRUE(pack.Open(PackPath().c_str()).Ok());
+  EXPECT_EQ(pack.Find("missing.dds"), Dds::PackReader::INVALID_ID);
+  EXPECT_EQ(pack.Find(""), Dds::PackReader::INVALID_ID);
+  EXPECT_EQ(pack.Load("missing.dds").Status().error, Dds::Error::NotFound);
+  EXPECT_EQ(pack.Load(pack.Count()).Status().error, Dds::Error::NotFound);
+  EXPECT_TRUE(pack.Name(pack.Count()).empty());
+}
+
+TEST_F(Pack, DuplicateNames) {
+  const std::vector<std::string> paths = Dds::Bench::WriteCorpus(TestDirectory() / "sources", std::span(DESCS, 2));
+  ASSERT_EQ(paths.size(), 2u);
+
+  Dds::PackBuilder builder;
+  ASSERT_TRUE(builder.Add("texture.dds", paths[0].c_str()).Ok());
+  ASSERT_TRUE(builder.Add("texture.dds", paths[1].c_str()).Ok());
+  EXPECT_EQ(builder.Write(PackPath().c_str()).error, Dds::Error::DuplicateName);
+  EXPECT_FALSE(std::filesystem::exists(PackPath()));
+}
+
+TEST_F(Pack, RejectsNonDdsSources) {
+  const std::filesystem::path path = TestDirectory() / "not.dds";
+  std::ofstream(path) << "not a dds file";
+
+  Dds::PackBuilder builder;
+  EXPECT_FALSE(builder.Add("not.dds", path.string().c_str()).Ok());
+  EXPECT_EQ(builder.Count(), 0u);
+}
+
+TEST_F(Pack, Empty) {
+  ASSERT_TRUE(Dds::PackBuilder().Write(PackPath().c_str()).Ok());
+
+  Dds::PackReader pack;
+  ASSERT_TRUE(pack.Open(PackPath().c_str()).Ok());
+  EXPECT_EQ(pack.Count(), 0u);
+  EXPECT_EQ(pack.Find("anything"), Dds::PackReader::INVALID_ID);
+}
+
+TEST_F(Pack, RejectsDamagedPacks) {
+  BuildPack();
+  const uintmax_t size = std::filesystem::file_size(PackPath());
+
+  Dds::PackReader pack;
+  EXPECT_EQ(pack.Open((TestDirectory() / "missing.pack").string().c_str()).error, Dds::Error::OpenFailed);
+
+  // a truncated copy
+  std::filesystem::resize_file(PackPath(), size - 1);
+  EXPECT_EQ(pack.Open(PackPath().c_str()).error, Dds::Error::TruncatedHeader);
+  std::filesystem::resize_file(PackPath(), 16);
+  EXPECT_EQ(pack.Open(PackPath().c_str()).error, Dds::Error::TruncatedHeader);
+
+  // not a pack at all
+  {
+    std::ofstream(PackPath(), std::ios::binary | std::ios::trunc) << std::string(256, 'x');
+  }
+  EXPECT_EQ(pack.Open(PackPath().c_str()).error, Dds::Error::BadMagic);
+  EXPECT_EQ(pack.Count(), 0u);
+}
+
+TEST_F(Pack, RejectsCorruptIndex) {
+  BuildPack();
+
+  // point the first entry far past the end of the pack
+  {
+    std::fstream file(PackPath(), std::ios::binary | std::ios::in | std::ios::out);
+    uint64_t     indexOffset = 0;
+    file.seekg(16); // PACK_HEADER::indexOffset
+    file.read(reinterpret_cast<char*>(&indexOffset), sizeof(indexOffset));
+    const uint64_t corrupt = UINT64_MAX / 2;
+    file.seekp(static_cast<std::streamoff>(indexOffset + 8)); // PACK_ENTRY::fileOffset of the first entry
+    file.write(reinterpret_cast<const char*>(&corrupt), sizeof(corrupt));
+  }
+
+  Dds::PackReader pack;
+  EXPECT_EQ(pack.Open(PackPath().c_str()).error, Dds::Error::InvalidHeader);
+}
@@ -0,0 +1,140 @@
+// Throughput floors for the hot paths. Floors are fractions of the memcpy bandwidth measured in the same
+// process, so they hold on slow CI machines and still catch an order of magnitude regression (a kernel
+// falling back to scalar code, an extra copy or allocation per block). dds_bench has the exact numbers.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "dds/DDSLoader.h"
+#include "dds/Decoder.h"
+#include "dds/FlipKernels.h"
+
+namespace
+{
+  using Dds::Format;
+  using Dds::Bench::TEXTURE_DESC;
+
+  // big enough to leave L2, small enough to keep the suite under a few seconds
+  constexpr uint32_t SIZE = 2048;
+
+  // best of t_runs, in bytes per second
+  template <typename FN>
+  double Throughput(const size_t t_bytes, const int t_runs, FN&& t_fn) {
+    double best = 0.0;
+    for (int run = 0; run < t_runs; ++run) {
+      const auto start = std::chrono::steady_clock::now();
+      t_fn();
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      best = std::max(best, static_cast<double>(t_bytes) / std::max(elapsed.count(), 1e-9));
+    }
+    return best;
+  }
+
+  volatile std::byte sink;
+
+  double MemcpyThroughput(const size_t t_bytes) {
+    static double bandwidth = 0.0;
+    if (bandwidth == 0.0) {
+      std::vector<std::byte> source(t_bytes, std::byte{1});
+      std::vector<std::byte> destination(t_bytes);
+      bandwidth = Throughput(t_bytes, 5, [&]
+      {
+        std::memcpy(destination.data(), source.data(), t_bytes);
+        sink = destination[t_bytes / 2]; // keeps the copy observable
+      });
+    }
+    return bandwidth;
+  }
+
+  void ExpectAtLeast(const char* t_what, const double t_throughput, const double t_fraction, const size_t t_bytes) {
+    const double floor = MemcpyThroughput(t_bytes) * t_fraction;
+    std::printf("%-24s %10.1f MB/s (floor %.1f MB/s)\n", t_what, t_throughput / 1e6, floor / 1e6);
+    testing::Test::RecordProperty(t_what, static_cast<int>(t_throughput / 1e6));
+    EXPECT_GE(t_throughput, floor) << t_what;
+  }
+
+  class Perf : public testing::Test
+  {
+  protected:
+    void SetUp() override {
+#if !defined(NDEBUG)
+      GTEST_SKIP() << "throughput floors only hold for optimized builds";
+#endif
+    }
+  };
+}
+
+TEST_F(Perf, LoadFromMemory) {
+  for (const Format format : {Format::BC1, Format::BC7, Format::RGBA8}) {
+    const TEXTURE_DESC           desc{format, SIZE};
+    const std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+
+    const double throughput = Throughput(desc.PayloadSize(), 5, [&]
+    {
+      const LoadDds::DDS_FILE ddsFile = *LoadDds::TextureLoadDds(std::span<const std::byte>(file));
+      ASSERT_EQ(ddsFile.totalSizeBytes, desc.PayloadSize());
+    });
+    // a load is one copy plus a fresh allocation
+    ExpectAtLeast((std::string("Load ") + desc.Name()).c_str(), throughput, 0.1, desc.PayloadSize());
+  }
+}
+
+TEST_F(Perf, FlipInPlace) {
+  struct CASE
+  {
+    Format format;
+    double fraction;
+  };
+  // BC7 rewrites every block field by field and is an order of magnitude slower than the rest
+  for (const CASE& test : {CASE{Format::BC1, 0.05}, CASE{Format::BC3, 0.05}, CASE{Format::BC4, 0.05},
+                           CASE{Format::BC5, 0.05}, CASE{Format::RGBA8, 0.05}, CASE{Format::BC7, 0.0005}}) {
+    const TEXTURE_DESC           desc{test.format, SIZE, false};
+    std::vector<std::byte>       file = Dds::Bench::MakeDds(desc);
+    const Dds::FORMAT_INFO&      info = Dds::GetFormatInfo(test.format);
+    std::byte*                   surface = file.data() + file.size() - desc.PayloadSize();
+
+    const double throughput = Throughput(desc.PayloadSize(), 5, [&]
+    {
+      Dds::FlipSurface(info, surface, surface, SIZE, SIZE);
+    });
+    ExpectAtLeast((std::string("Flip ") + info.name).c_str(), throughput, test.fraction, desc.PayloadSize());
+  }
+}
+
+TEST_F(Perf, Probe) {
+  const std::vector<std::byte> file = Dds::Bench::MakeDds({Format::BC7, 16, true, Dds::Bench::Layout::Cubemap});
+  constexpr size_t             PROBES = 100000;
+
+  const double probesPerSecond = Throughput(PROBES, 3, [&]
+  {
+    for (size_t i = 0; i < PROBES; ++i) {
+      const LoadDds::DDS_INFO info = *LoadDds::ProbeDds(std::span<const std::byte>(file).first(148));
+      ASSERT_FALSE(info.mipMaps.empty());
+    }
+  });
+  std::printf("%-24s %10.0f headers/s\n", "Probe", probesPerSecond);
+  // parsing a header is a few hundred instructions, a floor of 10us each only trips on something like
+  // an accidental file open or a throw per probe
+  EXPECT_GE(probesPerSecond, 100000.0);
+}
+
+TEST_F(Perf, DecodeBc1) {
+  const TEXTURE_DESC           desc{Format::BC1, SIZE / 2, false};
+  const std::vector<std::byte> file    = Dds::Bench::MakeDds(desc);
+  const LoadDds::DDS_FILE      ddsFile = *LoadDds::TextureLoadDds(std::span<const std::byte>(file));
+
+  Dds::Decoder        decoder(1);
+  Dds::AlignedBuffer  pixels(static_cast<size_t>(desc.size) * desc.size * 4, 64);
+  const double        throughput = Throughput(pixels.Size(), 3, [&]
+  {
+    ASSERT_TRUE(decoder.Decode(ddsFile, 0, 0, {pixels.Data(), pixels.Size()}, desc.size * 4));
+  });
+  ExpectAtLeast("Decode BC1 (output)", throughput, 0.02, pixels.Size());
+}
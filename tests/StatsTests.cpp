@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "TestSupport.h"
+#include "dds/Stats.h"
+
+namespace
+{
+  using Dds::Format;
+  using Dds::Stage;
+  using Dds::Bench::Layout;
+  using Dds::Bench::TEXTURE_DESC;
+  using Dds::Test::Bytes;
+
+  const Dds::STAGE_STATS& StageOf(const Dds::LOAD_STATS& t_stats, const Stage t_stage) {
+    return t_stats.stages[static_cast<size_t>(t_stage)];
+  }
+
+  const Dds::FORMAT_STATS& FormatOf(const Dds::LOAD_STATS& t_stats, const Format t_format) {
+    return t_stats.formats[static_cast<size_t>(t_format)];
+  }
+
+  Dds::LOAD_STATS g_lastLoad;
+
+  void RememberLoad(const Dds::LOAD_STATS& t_load, const char*) {
+    g_lastLoad = t_load;
+  }
+}
+
+TEST(Stats, JsonLayout) {
+  Dds::LOAD_STATS stats;
+  stats.loads                                     = 2;
+  stats.bytesRead                                 = 4096;
+  stats.stages[static_cast<size_t>(Stage::Flip)]  = {2, 1500};
+  stats.formats[static_cast<size_t>(Format::BC7)] = {2, 2048};
+
+  const std::string json = Dds::LoadStatsToJson(stats);
+  EXPECT_EQ(json.front(), '{');
+  EXPECT_EQ(json.back(), '}');
+  EXPECT_NE(json.find("\"loads\":2,"), std::string::npos);
+  EXPECT_NE(json.find("\"bytesRead\":4096,"), std::string::npos);
+  EXPECT_NE(json.find("\"flip\":{\"calls\":2,\"ns\":1500}"), std::string::npos);
+  EXPECT_NE(json.find("\"formats\":{\"BC7\":{\"loads\":2,\"bytes\":2048}}"), std::string::npos);
+  // formats that were never loaded are left out
+  EXPECT_EQ(json.find("BC1"), std::string::npos);
+}
+
+TEST(Stats, CountsLoadStages) {
+  if constexpr (!Dds::STATS_ENABLED) {
+    GTEST_SKIP() << "built without DDS_ENABLE_STATS";
+  }
+
+  const TEXTURE_DESC           desc{Format::BC1, 64, true, Layout::Cubemap};
+  const std::vector<std::byte> file = Dds::Bench::MakeDds(desc);
+
+  Dds::ResetLoadStats();
+  const Dds::StatsFn previous = Dds::SetStatsHook(RememberLoad);
+
+  Dds::LoadOptions options;
+  options.flipVertical = true;
+  ASSERT_TRUE(LoadDds::TextureLoadDds(Bytes(file), options));
+  EXPECT_EQ(LoadDds::TextureLoadDds(Bytes(std::vector<std::byte>(16))).Status().error, Dds::Error::BadMagic);
+  // probes are not loads
+  ASSERT_TRUE(LoadDds::ProbeDds(Bytes(file)));
+
+  Dds::SetStatsHook(previous);
+  const Dds::LOAD_STATS stats = Dds::GetLoadStats();
+
+  EXPECT_EQ(stats.loads, 2u);
+  EXPECT_EQ(stats.failures, 1u);
+  EXPECT_EQ(stats.allocations, 1u);
+  EXPECT_EQ(stats.allocatedBytes, desc.PayloadSize());
+  // regrouping the cube by level copies the payload once, flipping then works in place
+  EXPECT_EQ(stats.bytesCopied, desc.PayloadSize());
+  EXPECT_EQ(StageOf(stats, Stage::Parse).calls, 2u);
+  EXPECT_EQ(StageOf(stats, Stage::Copy).calls, 1u);
+  EXPECT_EQ(StageOf(stats, Stage::Flip).calls, 1u);
+  EXPECT_EQ(FormatOf(stats, Format::BC1).loads, 1u);
+  EXPECT_EQ(FormatOf(stats, Format::BC1).bytes, desc.PayloadSize());
+
+  // the hook saw the failed load last, on its own
+  EXPECT_EQ(g_lastLoad.loads, 1u);
+  EXPECT_EQ(g_lastLoad.failures, 1u);
+  EXPECT_EQ(g_lastLoad.allocations, 0u);
+}
+
+TEST(Stats, CountsFileReads) {
+  if constexpr (!Dds::STATS_ENABLED) {
+    GTEST_SKIP() << "built without DDS_ENABLE_STATS";
+  }
+
+  const TEXTURE_DESC             desc{Format::RGBA8, 32};
+  const std::vector<std::string> paths = Dds::Bench::WriteCorpus(Dds::Test::TestDirectory(), std::span(&desc, 1));
+  ASSERT_EQ(paths.size(), 1u);
+
+  Dds::ResetLoadStats();
+  ASSERT_TRUE(LoadDds::TextureLoadDds(paths[0].c_str()));
+  const Dds::LOAD_STATS stats = Dds::GetLoadStats();
+
+  EXPECT_EQ(StageOf(stats, Stage::Open).calls, 1u);
+  EXPECT_EQ(stats.bytesRead, 4 + sizeof(LoadDds::DDS_HEADER) + sizeof(LoadDds::DDS_HEADER_DXT10) + desc.PayloadSize());
+  EXPECT_EQ(stats.bytesCopied, 0u);
+}
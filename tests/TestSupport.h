@@ -0,0 +1,71 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "dds/DDSLoader.h"
+
+// Helpers shared by the unit test suites
+namespace Dds::Test
+{
+  inline std::span<const std::byte> Bytes(const std::vector<std::byte>& t_file) {
+    return {t_file.data(), t_file.size()};
+  }
+
+  // one directory per test, ctest runs tests as separate processes that may overlap
+  inline std::filesystem::path TestDirectory() {
+    const testing::TestInfo* test = testing::UnitTest::GetInstance()->current_test_info();
+    return std::filesystem::temp_directory_path() / "dds_tests" / (std::string(test->test_suite_name()) + "_" + test->name());
+  }
+
+  inline void WriteFile(const std::filesystem::path& t_path, const std::span<const std::byte> t_file) {
+    std::ofstream(t_path, std::ios::binary | std::ios::trunc)
+      .write(reinterpret_cast<const char*>(t_file.data()), static_cast<std::streamsize>(t_file.size()));
+  }
+
+  // writes the synthetic t_desc to t_name in the test directory and returns its path
+  inline std::string WriteTexture(const Bench::TEXTURE_DESC& t_desc, const std::string& t_name, const uint64_t t_seed = 1) {
+    std::filesystem::create_directories(TestDirectory());
+    const std::filesystem::path path = TestDirectory() / t_name;
+    WriteFile(path, Bench::MakeDds(t_desc, t_seed));
+    return path.string();
+  }
+
+  // t_actual has the layout and payload of t_expected, wherever either of them is stored
+  inline void ExpectSamePayload(const LoadDds::DDS_FILE& t_actual, const LoadDds::DDS_FILE& t_expected) {
+    EXPECT_EQ(t_actual.format, t_expected.format);
+    EXPECT_EQ(t_actual.firstMip, t_expected.firstMip);
+    EXPECT_EQ(t_actual.LayerCount(), t_expected.LayerCount());
+    ASSERT_EQ(t_actual.mipMaps.size(), t_expected.mipMaps.size());
+    for (size_t mip = 0; mip < t_expected.mipMaps.size(); ++mip) {
+      const LoadDds::MIP_LEVEL& actual   = t_actual.mipMaps[mip];
+      const LoadDds::MIP_LEVEL& expected = t_expected.mipMaps[mip];
+      EXPECT_EQ(actual.width, expected.width) << "mip " << mip;
+      EXPECT_EQ(actual.height, expected.height) << "mip " << mip;
+      EXPECT_EQ(actual.depth, expected.depth) << "mip " << mip;
+      EXPECT_EQ(actual.offset, expected.offset) << "mip " << mip;
+      EXPECT_EQ(actual.layerSize, expected.layerSize) << "mip " << mip;
+    }
+    ASSERT_EQ(t_actual.totalSizeBytes, t_expected.totalSizeBytes);
+    EXPECT_EQ(std::memcmp(t_actual.data.data(), t_expected.data.data(), t_expected.totalSizeBytes), 0);
+  }
+
+  // fixture base for suites that write files: every test starts with an empty directory of its own,
+  // files of an earlier run would turn expected misses and creations into hits
+  class TempDirectoryTest : public testing::Test
+  {
+  protected:
+    void SetUp() override {
+      std::filesystem::remove_all(TestDirectory());
+      std::filesystem::create_directories(TestDirectory());
+    }
+  };
+}
@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SyntheticDds.h"
+#include "TestSupport.h"
+#include "dds/Hash.h"
+#include "dds/TextureCache.h"
+
+namespace
+{
+  using Dds::Format;
+  using Dds::Bench::Layout;
+  using Dds::Bench::TEXTURE_DESC;
+  using Dds::Test::ExpectSamePayload;
+  using Dds::Test::TestDirectory;
+  using Dds::Test::WriteTexture;
+
+  std::span<const std::byte> Text(const std::string_view t_text) {
+    return {reinterpret_cast<const std::byte*>(t_text.data()), t_text.size()};
+  }
+
+  // the cache lives in a subdirectory of the test directory
+  std::filesystem::path CacheDirectory() {
+    return TestDirectory() / "cache";
+  }
+
+  // cache entries of an earlier run would turn the expected misses into disk hits
+  using TextureCache = Dds::Test::TempDirectoryTest;
+}
+
+TEST(Hash64, ReferenceVectors) {
+  EXPECT_EQ(Dds::Hash64(Text("")), 0xEF46DB3751D8E999ull);
+  EXPECT_EQ(Dds::Hash64(Text("a")), 0xD24EC4F1A98C6E5Bull);
+  EXPECT_EQ(Dds::Hash64(Text("abc")), 0x44BC2CF5AD770999ull);
+  // long enough for the four lane loop and every tail step
+  EXPECT_EQ(Dds::Hash64(Text("Nobody inspects the spammish repetition")), 0xFBCEA83C8A378BF1ull);
+}
+
+TEST_F(TextureCache, MissThenDiskThenMemory) {
+  const TEXTURE_DESC desc{Format::BC1, 64, true, Layout::Array};
+  const std::string  path = WriteTexture(desc, "source.dds");
+  Dds::LoadOptions   options;
+  options.flipVertical = true;
+
+  const LoadDds::DDS_FILE loaded = *LoadDds::TextureLoadDds(path.c_str(), options);
+
+  {
+    Dds::TextureCache                                 cache(CacheDirectory(), 1 << 20);
+    const Dds::Result<Dds::TextureCache::TexturePtr> miss = cache.Load(path.c_str(), options);
+    ASSERT_TRUE(miss);
+    ExpectSamePayload(**miss, loaded);
+    EXPECT_EQ(cache.Stats().misses, 1u);
+  }
+
+  // a new cache (the next launch) finds the entry on disk, then keeps it in memory
+  Dds::TextureCache                                 cache(CacheDirectory(), 1 << 20);
+  const Dds::Result<Dds::TextureCache::TexturePtr> disk = cache.Load(path.c_str(), options);
+  ASSERT_TRUE(disk);
+  ExpectSamePayload(**disk, loaded);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>((*disk)->data.data()) % LoadDds::PAYLOAD_ALIGNMENT, 0u);
+
+  const Dds::Result<Dds::TextureCache::TexturePtr> memory = cache.Load(path.c_str(), options);
+  ASSERT_TRUE(memory);
+  EXPECT_EQ(memory->get(), disk->get());
+
+  const Dds::TextureCache::STATS stats = cache.Stats();
+  EXPECT_EQ(stats.misses, 0u);
+  EXPECT_EQ(stats.diskHits, 1u);
+  EXPECT_EQ(stats.memoryHits, 1u);
+  EXPECT_EQ(stats.memoryBytes, loaded.totalSizeBytes);
+}
+
+TEST_F(TextureCache, OptionsAreSeparateEntries) {
+  const std::string path = WriteTexture({Format::RGBA8, 32}, "source.dds");
+  Dds::LoadOptions  flipped;
+  flipped.flipVertical = true;
+  Dds::LoadOptions trimmed;
+  trimmed.firstMip = 2;
+  Dds::LoadOptions reencoded = flipped;
+  reencoded.partialFlip      = Dds::PartialFlip::Reencode;
+
+  EXPECT_NE(Dds::TextureCache::EntryName(1, {}), Dds::TextureCache::EntryName(1, flipped));
+  EXPECT_NE(Dds::TextureCache::EntryName(1, {}), Dds::TextureCache::EntryName(1, trimmed));
+  EXPECT_NE(Dds::TextureCache::EntryName(1, flipped), Dds::TextureCache::EntryName(1, reencoded));
+
+  Dds::TextureCache cache(CacheDirectory(), 1 << 20);
+  for (const Dds::LoadOptions& options : {Dds::LoadOptions{}, flipped, trimmed}) {
+    const Dds::Result<Dds::TextureCache::TexturePtr> texture = cache.Load(path.c_str(), options);
+    ASSERT_TRUE(texture);
+    ExpectSamePayload(**texture, *LoadDds::TextureLoadDds(path.c_str(), options));
+  }
+  EXPECT_EQ(cache.Stats().misses, 3u);
+  EXPECT_EQ(cache.Stats().memoryHits, 0u);
+}
+
+TEST_F(TextureCache, ChangedSourceIsReloaded) {
+  const TEXTURE_DESC desc{Format::BC3, 32};
+  const std::string  path = WriteTexture(desc, "source.dds", 1);
+
+  Dds::TextureCache cache(CacheDirectory(), 1 << 20);
+  ASSERT_TRUE(cache.Load(path.c_str()));
+
+  // same size, different content, and a write time that is guaranteed to differ
+  const auto writeTime = std::filesystem::last_write_time(path);
+  WriteTexture(desc, "source.dds", 2);
+  std::filesystem::last_write_time(path, writeTime + std::chrono::seconds(1));
+
+  const Dds::Result<Dds::TextureCache::TexturePtr> texture = cache.Load(path.c_str());
+  ASSERT_TRUE(texture);
+  ExpectSamePayload(**texture, *LoadDds::TextureLoadDds(path.c_str()));
+  EXPECT_EQ(cache.Stats().misses, 2u);
+}
+
+TEST_F(TextureCache, StampsOutliveTheCache) {
+  const TEXTURE_DESC desc{Format::BC1, 32};
+  const std::string  path = WriteTexture(desc, "source.dds", 1);
+  {
+    Dds::TextureCache cache(CacheDirectory(), 1 << 20);
+    ASSERT_TRUE(cache.Load(path.c_str()));
+    EXPECT_EQ(cache.Stats().hashes, 1u);
+
+    // hashing only marks the stamps, the index is written once
+    EXPECT_FALSE(std::filesystem::exists(CacheDirectory() / "stamps.idx"));
+    cache.Flush();
+    EXPECT_TRUE(std::filesystem::exists(CacheDirectory() / "stamps.idx"));
+  }
+
+  // the next launch knows the source from the stamps index and maps the entry without reading it
+  {
+    Dds::TextureCache cache(CacheDirectory(), 1 << 20);
+    ASSERT_TRUE(cache.Load(path.c_str()));
+    EXPECT_EQ(cache.Stats().hashes, 0u);
+    EXPECT_EQ(cache.Stats().diskHits, 1u);
+  }
+
+  // a stamp that no longer matches the source is not trusted
+  const auto writeTime = std::filesystem::last_write_time(path);
+  WriteTexture(desc, "source.dds", 2);
+  std::filesystem::last_write_time(path, writeTime + std::chrono::seconds(1));
+
+  Dds::TextureCache                                 cache(CacheDirectory(), 1 << 20);
+  const Dds::Result<Dds::TextureCache::TexturePtr> texture = cache.Load(path.c_str());
+  ASSERT_TRUE(texture);
+  ExpectSamePayload(**texture, *LoadDds::TextureLoadDds(path.c_str()));
+  EXPECT_EQ(cache.Stats().hashes, 1u);
+  EXPECT_EQ(cache.Stats().misses, 1u);
+}
+
+TEST_F(TextureCache, MemoryBudgetEvictsLeastRecentlyUsed) {
+  const TEXTURE_DESC desc{Format::RGBA8, 32, false};
+  const std::string  first  = WriteTexture(desc, "first.dds", 1);
+  const std::string  second = WriteTexture(desc, "second.dds", 2);
+  const size_t       bytes  = desc.PayloadSize();
+
+  // room for one texture only
+  Dds::TextureCache cache(CacheDirectory(), bytes + bytes / 2);
+  ASSERT_TRUE(cache.Load(first.c_str()));
+  ASSERT_TRUE(cache.Load(second.c_str()));
+  EXPECT_EQ(cache.Stats().memoryBytes, bytes);
+
+  ASSERT_TRUE(cache.Load(second.c_str()));
+  EXPECT_EQ(cache.Stats().memoryHits, 1u);
+  ASSERT_TRUE(cache.Load(first.c_str()));
+  EXPECT_EQ(cache.Stats().diskHits, 1u);
+
+  cache.Clear();
+  EXPECT_EQ(cache.Stats().memoryBytes, 0u);
+}
+
+TEST_F(TextureCache, CorruptEntryIsRebuilt) {
+  const std::string path = WriteTexture({Format::BC1, 32}, "source.dds");
+
+  Dds::TextureCache cache(CacheDirectory(), 0);
+  ASSERT_TRUE(cache.Load(path.c_str()));
+
+  for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(CacheDirectory())) {
+    std::filesystem::resize_file(entry.path(), 100);
+  }
+
+  const Dds::Result<Dds::TextureCache::TexturePtr> texture = cache.Load(path.c_str());
+  ASSERT_TRUE(texture);
+  ExpectSamePayload(**texture, *LoadDds::TextureLoadDds(path.c_str()));
+  EXPECT_EQ(cache.Stats().misses, 2u);
+  EXPECT_EQ(cache.Stats().diskHits, 0u);
+
+  // and the rewritten entry is good again
+  ASSERT_TRUE(cache.Load(path.c_str()));
+  EXPECT_EQ(cache.Stats().diskHits, 1u);
+}
+
+TEST_F(TextureCache, MissingSource) {
+  Dds::TextureCache cache(CacheDirectory(), 1 << 20);
+  EXPECT_EQ(cache.Load((TestDirectory() / "missing.dds").string().c_str()).Status().error, Dds::Error::OpenFailed);
+}
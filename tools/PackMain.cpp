@@ -0,0 +1,55 @@
+// dds_pack: writes every .dds file under the given directories into one pack, see dds/Pack.h. Entries
+// are named by their path relative to the directory they were found in, with forward slashes
+//
+//   dds_pack <output.pack> <directory>...
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dds/Pack.h"
+
+int main(const int t_argc, char** t_argv) {
+  if (t_argc < 3) {
+    std::fprintf(stderr, "Usage: %s <output.pack> <directory>...\n", t_argv[0]);
+    return 1;
+  }
+
+  // sorted so the same tree always builds the same pack
+  std::vector<std::pair<std::string, std::string>> files;
+  for (int i = 2; i < t_argc; ++i) {
+    const std::filesystem::path root = t_argv[i];
+    std::error_code             error;
+    for (auto it = std::filesystem::recursive_directory_iterator(root, error); !error && it != std::filesystem::recursive_directory_iterator();
+         it.increment(error)) {
+      if (it->is_regular_file() && it->path().extension() == ".dds") {
+        files.emplace_back(it->path().lexically_relative(root).generic_string(), it->path().string());
+      }
+    }
+    if (error) {
+      std::fprintf(stderr, "Failed to list %s: %s\n", t_argv[i], error.message().c_str());
+      return 1;
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  Dds::PackBuilder builder;
+  size_t           skipped = 0;
+  for (auto& [name, path] : files) {
+    // Add already logged why
+    if (!builder.Add(std::move(name), path.c_str()).Ok()) {
+      ++skipped;
+    }
+  }
+
+  if (!builder.Write(t_argv[1]).Ok()) {
+    std::fprintf(stderr, "Failed to write %s\n", t_argv[1]);
+    return 1;
+  }
+
+  std::printf("Packed %zu files into %s, skipped %zu\n", builder.Count(), t_argv[1], skipped);
+  return 0;
+}